@@ -151,6 +151,9 @@ namespace graphit {
 
         void genScalarAlloc(mir::VarDecl::Ptr shared_ptr);
 
+        // string to priority queue delta conversion used for deltas read from argv
+        std::string genDeltaConversion(mir::ScalarType::Ptr priority_type);
+
         // creates the lambda function to apply the edgeMapCount operator
 	    void get_edge_count_lambda(mir::UpdatePriorityEdgeCountEdgeSetApplyExpr::Ptr call);
         void genTypesRequiringTypeDefs();
@@ -63,9 +63,23 @@ namespace graphit {
         void genEdgePushApplyFunctionDeclBody(mir::EdgeSetApplyExpr::Ptr apply);
         void genEdgeHybridDenseApplyFunctionDeclBody(mir::EdgeSetApplyExpr::Ptr apply);
         void genEdgeHybridDenseForwardApplyFunctionDeclBody(mir::EdgeSetApplyExpr::Ptr apply);
+        void genEdgeStreamingPushApplyFunctionDeclBody(mir::EdgeSetApplyExpr::Ptr apply,
+                                                       bool from_vertexset_specified,
+                                                       bool apply_expr_gen_frontier,
+                                                       std::string dst_type);
         void setupGlobalVariables(mir::EdgeSetApplyExpr::Ptr apply,
                                   bool apply_expr_gen_frontier,
                                   bool from_vertexset_specified);
+        // computes the out degrees of the frontier and their sum outDegrees (push traversals)
+        void printFrontierDegrees(bool from_vertexset_specified);
+        // declares the pool the frontiers and scratch arrays of the apply are taken from
+        void printFrontierPool(mir::EdgeSetApplyExpr::Ptr apply, bool apply_expr_gen_frontier);
+        // declares the direction switch of a hybrid apply over from_vertexset (after the frontier pool)
+        void printDirectionSwitch(mir::EdgeSetApplyExpr::Ptr apply);
+        // the neighbors of vertex in the layout the apply traverses (direction is out or in)
+        std::string genNeighborhood(mir::EdgeSetApplyExpr::Ptr apply, std::string direction, std::string vertex);
+        // the edgeset the apply traverses, its weight type decides the runtime graph and neighbor types
+        mir::EdgeSetType::Ptr getEdgeSetType(mir::EdgeSetApplyExpr::Ptr apply);
         void setupFlags(mir::EdgeSetApplyExpr::Ptr apply,
                         bool & from_vertexset_specified,
                         bool & apply_expr_gen_frontier,
@@ -94,7 +108,8 @@ namespace graphit {
         void printDenseForwardEdgeTraversalReturnFrontier(mir::EdgeSetApplyExpr::Ptr apply,
                                                                 bool from_vertexset_specified,
                                                                 bool apply_expr_gen_frontier,
-                                                                std::string dst_type);
+                                                                std::string dst_type,
+                                                                std::string apply_func_name = "apply_func");
 
         //prints the inner loop on in neighbors for pull based direction
         void printPullEdgeTraversalInnerNeighborLoop(mir::EdgeSetApplyExpr::Ptr apply,
@@ -92,6 +92,14 @@ namespace graphit {
                 high_level_schedule::ProgramScheduleNode::Ptr
                 configApplyDirection(std::string apply_label, std::string apply_direction);
 
+                // High level API for the push/pull switch of hybrid directions (SparsePush-DensePull, SparsePush-DensePush)
+                // A round pulls once the frontier and its out edges exceed numEdges / alpha, and once pulling, it keeps
+                // pulling while the frontier grows or holds more than numVertices / beta vertices (beta = 0 disables this)
+                // The out edges of a frontier are estimated from a sample of 1024 of its vertices. Without it, alpha
+                // is 20, every round picks its direction on its own and the out edges are summed exactly
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyDirectionThresholds(std::string apply_label, int alpha, int beta = 18);
+
                 // High level API for specifying which intersection method to use
                 // Currently it supports five intersection methods:
                 //   1. MultiSkipIntersection
@@ -156,6 +164,12 @@ namespace graphit {
                 high_level_schedule::ProgramScheduleNode::Ptr
                 configApplyNumSSG(std::string apply_label, std::string config, string num_segment_argv, std::string direction="all");
 
+                // High level API for keeping the segments of configApplyNumSSG in a cache directory, so later
+                // runs on the same input file map them instead of building them again
+                // The directory can also be a string "argv[x]" to use argv[x] as the directory at runtime
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplySegmentCache(std::string apply_label, std::string cache_dir);
+
                 // High level API for enabling NUMA optimization
                 // Deprecated, to be replaced with configApplyNUMA
                 high_level_schedule::ProgramScheduleNode::Ptr
@@ -166,6 +180,57 @@ namespace graphit {
                 high_level_schedule::ProgramScheduleNode::Ptr
                 configApplyNUMA(std::string apply_label, std::string config, std::string direction = "all");
 
+                // High level API for traversing a compressed copy of the edgeset
+                // Options are delta-varint (delta + variable length coded neighbor lists) and none
+                // Applies to push, pull and hybrid traversals, but not to segmented (cache/NUMA) pull traversals
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyEdgeCompression(std::string apply_label, std::string config);
+
+                // High level API for the layout of the weights of a weighted edgeset
+                // Options are soa (neighbor IDs and weights in separate arrays, traversals whose apply
+                // function ignores the weight only read the IDs) and aos (NodeWeight pairs, the default)
+                // Applies to push, pull and hybrid traversals of weighted edgesets, ignored with edge compression
+                // The soa copy is built next to the loaded NodeWeight arrays, which are freed afterwards unless
+                // something else in the program still reads them
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyWeightLayout(std::string apply_label, std::string config);
+
+                // High level API for keeping a copy of the edgeset topology (offsets, neighbors and weights)
+                // on every NUMA node, threads pinned to a node read their own copy. The copies are only built
+                // when every thread is pinned, builds without -DOPENMP warn and read the shared arrays
+                // Options are sockets (sets configNUMAPlacement("sockets") unless the program sets a placement) and none
+                // Applies to the push, pull, sparse and hybrid traversals of the edgeset
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyTopologyReplication(std::string apply_label, std::string config);
+
+                // High level API for running on graphs larger than memory
+                // Options are semi-external (vertex data stays in memory, edges are streamed from disk
+                // in partitions of at most buffer_edges edges) and none
+                // Applies to every edgeset apply on the same edgeset, push traversals sweep the partitions for
+                // large frontiers and read the neighbors of each vertex for small ones
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyEdgeStreaming(std::string apply_label, std::string config, int buffer_edges = 1 << 26);
+
+                // High level API for relabeling the vertices of an edgeset for locality after loading it
+                // Options are degree, hub-sort, hub-cluster, rcm, gorder and none
+                // Applies to the whole edgeset, source vertices read from argv are translated to the new IDs
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configApplyVertexReordering(std::string apply_label, std::string config);
+
+                // High level API for placing the graph, vertex data and frontier arrays of the whole program
+                // Options are thp (transparent huge pages), hugetlb (falls back to thp) and off
+                // The program prints how much of its memory got huge pages before it exits
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configHugePages(std::string config);
+
+                // High level API for pinning the threads of the whole program to cores or sockets
+                // The graph and vertex data arrays are then initialized in parallel with the static
+                // partitioning of the traversals, and the program prints their page placement before it exits
+                // Options are cores, sockets and off. Unlike configApplyNUMA it applies to every traversal
+                // Only programs compiled with -DOPENMP pin their threads, other builds warn and leave it off
+                high_level_schedule::ProgramScheduleNode::Ptr
+                configNUMAPlacement(std::string config);
+
                 // configures the type of priority update
                 high_level_schedule::ProgramScheduleNode::Ptr
                 configApplyPriorityUpdate(std::string apply_label, std::string config);
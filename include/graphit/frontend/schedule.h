@@ -220,6 +220,21 @@ namespace graphit {
             bool numa_aware;
             int merge_threshold;
             int num_open_buckets;
+            bool compressed_edges;
+            // keep a copy of the edgeset topology on every NUMA node
+            bool replicated_topology;
+            // traverse a copy of a weighted edgeset with the neighbor IDs and weights in separate arrays
+            bool soa_weights;
+            // edges per streamed partition, 0 keeps the edgeset in memory
+            int stream_buffer_edges;
+            // vertex ordering the edgeset is relabeled with after loading (reorder.h), or none
+            std::string vertex_reordering;
+            // push/pull switch of hybrid directions, pull once the frontier and its out edges
+            // exceed numEdges / alpha, keep pulling until the frontier shrinks below numVertices / beta
+            int direction_alpha;
+            int direction_beta;
+            // directory (or argv[x]) the segments are cached in, empty to build them on every run
+            std::string segment_cache_dir;
         };
 
         /**
@@ -257,6 +272,12 @@ namespace graphit {
             std::map<std::string, ParForSchedule::ParForType> *par_for_type_schedules;
             std::map<std::string, int> *par_for_num_threads;
 
+            // huge page placement of the large arrays of the program (huge_pages.h), empty for the default
+            std::string huge_pages;
+
+            // thread pinning and first touch placement of the program (numa_placement.h), empty for the default
+            std::string numa_placement;
+
 
         };
     }
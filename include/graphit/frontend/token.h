@@ -25,6 +25,7 @@ namespace graphit {
             INT,
             UINT,
             UINT_64,
+            INT_64,
             FLOAT,
             BOOL,
             COMPLEX,
@@ -8,6 +8,8 @@
 #include <graphit/midend/mir_context.h>
 #include <graphit/frontend/schedule.h>
 #include <graphit/midend/mir_rewriter.h>
+#include <graphit/midend/mir_visitor.h>
+#include <set>
 
 namespace graphit {
     class ApplyExprLower {
@@ -37,11 +39,92 @@ namespace graphit {
             virtual void visit(mir::EdgeSetApplyExpr::Ptr edgeset_apply_expr);
             virtual void visit(mir::VertexSetApplyExpr::Ptr vertexset_apply_expr);
 
+            // whether the apply function uses its weight argument
+            bool readsWeight(std::string apply_func_name);
+
 
             Schedule * schedule_;
             MIRContext* mir_context_;
         };
 
+        //mir visitor for finding the uses of a variable
+        struct FindVarReads : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            FindVarReads(std::string var_name) : var_name_(var_name) {};
+
+            virtual void visit(mir::VarExpr::Ptr var_expr) {
+                if (var_expr->var.getName() == var_name_)
+                    found = true;
+            }
+
+            std::string var_name_;
+            bool found = false;
+        };
+
+        //mir visitor for switching all the edgeset applies on semi-external edgesets to streaming
+        struct MarkStreamedApplyExpr : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            MarkStreamedApplyExpr(MIRContext* mir_context) : mir_context_(mir_context) {};
+
+            virtual void visit(mir::PushEdgeSetApplyExpr::Ptr apply) { markApply(apply); }
+            virtual void visit(mir::PullEdgeSetApplyExpr::Ptr apply) { markApply(apply); }
+            virtual void visit(mir::HybridDenseEdgeSetApplyExpr::Ptr apply) { markApply(apply); }
+            virtual void visit(mir::HybridDenseForwardEdgeSetApplyExpr::Ptr apply) { markApply(apply); }
+
+            void markApply(mir::EdgeSetApplyExpr::Ptr apply);
+
+            MIRContext* mir_context_;
+        };
+
+        //mir visitor for finding the edgesets some apply traverses without edge compression
+        struct FindUncompressedApplies : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            virtual void visit(mir::PushEdgeSetApplyExpr::Ptr apply) { addApply(apply); }
+            virtual void visit(mir::PullEdgeSetApplyExpr::Ptr apply) { addApply(apply); }
+            virtual void visit(mir::HybridDenseEdgeSetApplyExpr::Ptr apply) { addApply(apply); }
+            virtual void visit(mir::HybridDenseForwardEdgeSetApplyExpr::Ptr apply) { addApply(apply); }
+
+            void addApply(mir::EdgeSetApplyExpr::Ptr apply);
+
+            std::set<std::string> edgesets;
+        };
+
+        //mir visitor for finding the edgesets whose neighbors are read other than through their soa copy
+        struct FindNonSoAUses : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            virtual void visit(mir::PushEdgeSetApplyExpr::Ptr apply) { visitApply(apply); }
+            virtual void visit(mir::PullEdgeSetApplyExpr::Ptr apply) { visitApply(apply); }
+            virtual void visit(mir::HybridDenseEdgeSetApplyExpr::Ptr apply) { visitApply(apply); }
+            virtual void visit(mir::HybridDenseForwardEdgeSetApplyExpr::Ptr apply) { visitApply(apply); }
+            virtual void visit(mir::Call::Ptr call);
+            virtual void visit(mir::VarExpr::Ptr var_expr);
+
+            void visitApply(mir::EdgeSetApplyExpr::Ptr apply);
+
+            std::set<std::string> edgesets;
+        };
+
+        //mir visitor for finding the edgesets whose in-edges are read (pull and hybrid dense applies, getRandomInNgh)
+        struct FindInverseUses : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            virtual void visit(mir::PullEdgeSetApplyExpr::Ptr apply);
+            virtual void visit(mir::HybridDenseEdgeSetApplyExpr::Ptr apply);
+            virtual void visit(mir::VarDecl::Ptr var_decl);
+            virtual void visit(mir::AssignStmt::Ptr assign_stmt);
+            virtual void visit(mir::Call::Ptr call);
+
+            void addInverseUse(mir::Expr::Ptr edgeset);
+
+            std::set<std::string> edgesets;
+            // transpose(edges) already holds the in-edges of edges as its out-edges and the other way around
+            std::set<std::string> transposed_edgesets;
+        };
+
     private:
         Schedule *schedule_ = nullptr;
         MIRContext *mir_context_ = nullptr;
@@ -215,7 +215,7 @@ namespace graphit {
 
         struct ScalarType : public Type {
             enum class Type {
-                INT, UINT, UINT_64, FLOAT, DOUBLE, BOOL, COMPLEX, STRING
+                INT, UINT, UINT_64, INT_64, FLOAT, DOUBLE, BOOL, COMPLEX, STRING
             };
             Type type;
             typedef std::shared_ptr<ScalarType> Ptr;
@@ -230,6 +230,8 @@ namespace graphit {
                     output_str = "float";
                 } else if (type == mir::ScalarType::Type::INT){
                     output_str = "int";
+                } else if (type == mir::ScalarType::Type::INT_64){
+                    output_str = "int64_t";
                 } else if (type == mir::ScalarType::Type::BOOL){
                     output_str = "bool";
                 } else if (type == mir::ScalarType::Type::DOUBLE){
@@ -342,12 +344,42 @@ namespace graphit {
             std::vector<ElementType::Ptr> *vertex_element_type_list;
 
 	        PriorityUpdateType priority_update_type = NoPriorityUpdate;
+            // updated with insertEdges / deleteEdges, the runtime graph is then a DynamicGraph
+            bool is_dynamic = false;
             typedef std::shared_ptr<EdgeSetType> Ptr;
 
             virtual void accept(MIRVisitor *visitor) {
                 visitor->visit(self<EdgeSetType>());
             }
 
+            // unweighted or int weights, which the runtime's Graph / WGraph shorthands cover
+            bool hasDefaultWeightType(){
+                return weight_type == nullptr
+                       || (weight_type->type != mir::ScalarType::Type::FLOAT
+                           && weight_type->type != mir::ScalarType::Type::DOUBLE
+                           && weight_type->type != mir::ScalarType::Type::INT_64);
+            }
+
+            // graph type in the runtime library (CSRGraph or DynamicGraph instance)
+            std::string toGraphTypeString(){
+                if (is_dynamic)
+                    return "DynamicGraph<NodeID" + (weight_type == nullptr ? "" : ", " + toNeighborTypeString()) + ">";
+                if (weight_type == nullptr)
+                    return "Graph";
+                if (hasDefaultWeightType())
+                    return "WGraph";
+                return "WGraphT<" + weight_type->toString() + ">";
+            }
+
+            // type of a neighbor in the runtime graph (ID, or ID and weight)
+            std::string toNeighborTypeString(){
+                if (weight_type == nullptr)
+                    return "NodeID";
+                if (hasDefaultWeightType())
+                    return "WNode";
+                return "WNodeT<" + weight_type->toString() + ">";
+            }
+
         protected:
             virtual void copy(MIRNode::Ptr);
 
@@ -898,7 +930,16 @@ namespace graphit {
         struct EdgeSetLoadExpr : public Expr {
             Expr::Ptr file_name;
             bool is_weighted_ = false;
+            // C++ weight type if it isn't the default int (e.g. "float"), empty otherwise
+            std::string weight_type_ = "";
             PriorityUpdateType priority_update_type = NoPriorityUpdate;
+            // edges per streamed partition if only the offsets are loaded (0 loads the whole graph)
+            int stream_buffer_edges = 0;
+            // vertex reordering applied to the loaded graph (degree, hub-sort, hub-cluster, rcm, gorder)
+            std::string vertex_reordering = "";
+            // false if nothing reads the in-edges of the edgeset (pull, hybrid dense, reordering), the
+            // inverse is then only built if the runtime needs it (e.g. transpose)
+            bool build_inverse = true;
             typedef std::shared_ptr<EdgeSetLoadExpr> Ptr;
      
 
@@ -930,6 +971,8 @@ namespace graphit {
             typedef std::shared_ptr<VertexSetApplyExpr> Ptr;
             //default to parallel
             bool is_parallel = true;
+            // the reordered edgeset whose input vertex order the apply follows (used for printing)
+            std::string input_order_edgeset = "";
 
             virtual void accept(MIRVisitor *visitor) {
                 visitor->visit(self<VertexSetApplyExpr>());
@@ -974,10 +1017,23 @@ namespace graphit {
             bool use_sliding_queue = false;
             bool use_pull_frontier_bitvector = false;
             bool use_pull_edge_based_load_balance = false;
+            // traverse the delta + varint coded copy of the edgeset
+            bool use_compressed_edges = false;
+            // stream the edges from disk one partition at a time (semi-external edgeset)
+            bool use_edge_streaming = false;
+            // traverse the copy with separate neighbor ID and weight arrays
+            bool use_soa_weights = false;
+            // read the copy of the topology on the node of the thread (buildReplicatedGraph)
+            bool use_replicated_topology = false;
+            // the apply function reads the edge weight (only the IDs are read otherwise)
+            bool reads_weights = true;
             //hard coded default value for grain size
             int pull_edge_based_load_balance_grain_size = 4096;
             //grain size for parallel for
             int grain_size = 256;
+            // thresholds of the push/pull switch of hybrid directions (DirectionSwitch in vertexsubset.h)
+            int direction_alpha = 20;
+            int direction_beta = 0;
             std::string scope_label_name;
             MergeReduceField::Ptr merge_reduce;
 
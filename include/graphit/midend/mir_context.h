@@ -389,6 +389,36 @@ namespace graphit {
 
         // used by cache/numa optimization
         std::map<std::string, std::map<std::string, int>> edgeset_to_label_to_num_segment;
+        // segment cache directory (a path or argv[x]) of the segmented labels that have one
+        std::map<std::string, std::map<std::string, std::string>> edgeset_to_label_to_segment_cache;
+
+        // edgesets that need a compressed copy built after they are loaded
+        std::set<std::string> compressed_edgesets;
+        // compressed edgesets that no apply traverses uncompressed, their plain neighbor arrays
+        // are released after compression when built with -DCOMPRESSED_ONLY
+        std::set<std::string> compressed_only_edgesets;
+        // weighted edgesets that need a copy with separate neighbor ID and weight arrays
+        std::set<std::string> soa_weighted_edgesets;
+        // soa weighted edgesets that nothing reads other than through the soa copy, their array of structs
+        // neighbors are released once the copy is built
+        std::set<std::string> soa_only_edgesets;
+        // edgesets copied to every NUMA node after they are loaded
+        std::set<std::string> replicated_edgesets;
+
+        // semi-external edgesets, which only load their offsets and stream the edges from disk
+        std::set<std::string> streamed_edgesets;
+
+        // int vertex properties assigned vertices (parent[dst] = src), generated as NodeID arrays
+        std::set<std::string> vertex_valued_vectors;
+
+        // edgesets relabeled after they are loaded, mapped to the reordering method
+        std::map<std::string, std::string> reordered_edgesets;
+
+        // huge page mode set at the start of main (thp, hugetlb or off), empty if not scheduled
+        std::string huge_pages;
+
+        // NUMA placement set at the start of main (cores, sockets or off), empty if not scheduled
+        std::string numa_placement;
 
         std::vector<mir::FuncDecl::Ptr> exported_functions_list_;
 
@@ -50,6 +50,19 @@ namespace graphit {
             Schedule * schedule_;
         };
 
+        //finds the int vectors that store vertices (parent[dst] = src), they are stored as NodeIDs
+        struct FindVertexValuedVectors : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            FindVertexValuedVectors(MIRContext *mir_context) : mir_context_(mir_context){
+
+            };
+
+            virtual void visit(mir::AssignStmt::Ptr assign_stmt);
+
+            MIRContext *mir_context_;
+        };
+
         private:
         Schedule *schedule_ = nullptr;
         MIRContext *mir_context_ = nullptr;
@@ -0,0 +1,116 @@
+//
+// Renumbers the source vertices given on the command line for edgesets
+// loaded with a vertex reordering (configApplyVertexReordering), and
+// prints and returns the per-vertex outputs in the IDs of the input graph
+//
+
+#ifndef GRAPHIT_VERTEX_REORDER_LOWER_H
+#define GRAPHIT_VERTEX_REORDER_LOWER_H
+
+#include <graphit/midend/mir_context.h>
+#include <graphit/midend/mir_visitor.h>
+#include <set>
+#include <map>
+
+namespace graphit {
+    class VertexReorderLower {
+    public:
+        VertexReorderLower(MIRContext *mir_context) : mir_context_(mir_context) {};
+
+        void lower();
+
+        // finds the variables read from argv with atoi or declared as a vertex literal (the IDs
+        // of the input graph) and the variables used as vertices
+        struct FindArgvVertices : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            FindArgvVertices(MIRContext* mir_context) : mir_context_(mir_context) {};
+
+            virtual void visit(mir::VarDecl::Ptr var_decl);
+            virtual void visit(mir::AssignStmt::Ptr assign_stmt);
+            virtual void visit(mir::TensorReadExpr::Ptr tensor_read);
+            virtual void visit(mir::TensorArrayReadExpr::Ptr tensor_read);
+            virtual void visit(mir::Call::Ptr call);
+            virtual void visit(mir::PriorityQueueAllocExpr::Ptr pq_alloc);
+
+            void addVertexUse(mir::Expr::Ptr expr);
+
+            MIRContext* mir_context_;
+            std::set<std::string> argv_vars;
+            std::set<std::string> vertex_vars;
+        };
+
+        // maps the argv and literal vertices from the IDs of the input graph to the reordered IDs
+        struct TranslateArgvVertices : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            TranslateArgvVertices(std::set<std::string> vertices, mir::Var edgeset)
+                    : vertices_(vertices), edgeset_(edgeset) {};
+
+            virtual void visit(mir::VarDecl::Ptr var_decl);
+            virtual void visit(mir::AssignStmt::Ptr assign_stmt);
+
+            mir::Expr::Ptr toNewID(mir::Expr::Ptr vertex);
+
+            std::set<std::string> vertices_;
+            mir::Var edgeset_;
+        };
+
+        // finds the vectors indexed by vertices, the vectors holding vertices and the functions that print
+        struct FindVertexOutputs : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            FindVertexOutputs(std::string vertex_type) : vertex_type_(vertex_type) {};
+
+            virtual void visit(mir::FuncDecl::Ptr func_decl);
+            virtual void visit(mir::VarDecl::Ptr var_decl);
+            virtual void visit(mir::AssignStmt::Ptr assign_stmt);
+            virtual void visit(mir::PrintStmt::Ptr print_stmt);
+            virtual void visit(mir::Call::Ptr call);
+            virtual void visit(mir::VertexSetApplyExpr::Ptr apply_expr);
+
+            bool isVertex(mir::Type::Ptr type);
+            bool isVertexValue(mir::Expr::Ptr expr);
+            // true if the function or a function it calls or applies prints
+            bool prints(std::string func_name);
+
+            std::string vertex_type_;
+            std::string current_func_ = "";
+            std::set<std::string> vertex_vectors;
+            std::set<std::string> vertex_valued_vectors;
+            std::set<std::string> printing_funcs;
+            std::map<std::string, std::set<std::string>> callees;
+        };
+
+        // iterates the printing vertexset applies in the vertex order of the input graph, and
+        // translates the printed and returned vertices back to their input IDs
+        struct TranslateVertexOutputs : public mir::MIRVisitor {
+            using mir::MIRVisitor::visit;
+
+            TranslateVertexOutputs(MIRContext* mir_context, FindVertexOutputs &outputs, mir::Var edgeset)
+                    : mir_context_(mir_context), outputs_(outputs), edgeset_(edgeset) {};
+
+            virtual void visit(mir::FuncDecl::Ptr func_decl);
+            virtual void visit(mir::PrintStmt::Ptr print_stmt);
+            virtual void visit(mir::VertexSetApplyExpr::Ptr apply_expr);
+
+            MIRContext* mir_context_;
+            FindVertexOutputs &outputs_;
+            mir::Var edgeset_;
+        };
+
+    private:
+        MIRContext *mir_context_ = nullptr;
+    };
+
+    // true for atoi(argv[i])
+    bool isArgvAtoi(mir::Expr::Ptr expr);
+
+    // true for var v : Vertex = <int literal>
+    bool isVertexLiteral(mir::VarDecl::Ptr var_decl);
+
+    // builds the call name(edgeset, arg)
+    mir::Call::Ptr edgesetCall(std::string name, mir::Var edgeset, mir::Expr::Ptr arg);
+}
+
+#endif //GRAPHIT_VERTEX_REORDER_LOWER_H
@@ -631,6 +631,14 @@ namespace graphit {
             //generate special initialization code for main function
             //TODO: this is probably a hack that could be fixed for later
 
+            // The huge page mode and NUMA placement have to be set before the first large array is allocated
+            if (mir_context_->huge_pages != "") {
+                oss << "  builtin_setHugePages(\"" << mir_context_->huge_pages << "\");" << std::endl;
+            }
+            if (mir_context_->numa_placement != "") {
+                oss << "  builtin_setNUMAPlacement(\"" << mir_context_->numa_placement << "\");" << std::endl;
+            }
+
             //First, allocate the edgesets (read them from outside files if needed)
             for (auto stmt : mir_context_->edgeset_alloc_stmts) {
                 stmt->accept(this);
@@ -649,22 +657,51 @@ namespace graphit {
                     auto label_iter_second = (*label_iter).second;
                     auto numa_aware_flag = mir_context_->edgeset_to_label_to_merge_reduce[edge_iter_first][label_iter_first]->numa_aware;
 
+                    // the segment cache directory is either a path or an argv[x] read at runtime
+                    std::string cache_args = numa_aware_flag ? ", true" : "";
+                    auto cache_dirs = mir_context_->edgeset_to_label_to_segment_cache[edge_iter_first];
+                    if (cache_dirs.count(label_iter_first) > 0) {
+                        std::string cache_dir = cache_dirs[label_iter_first];
+                        if (cache_dir.rfind("argv[", 0) != 0)
+                            cache_dir = "\"" + cache_dir + "\"";
+                        cache_args = std::string(numa_aware_flag ? ", true" : ", false") + ", " + cache_dir;
+                    }
+
                     if (label_iter_second < 0) {
                         //do a specical case for negative number of segments. I
                         // in the case of negative integer, we use the number as argument to runtimve argument argv
                         // this is the only place in the generated code that we set the number of segments
                         oss << "  " << edgeset->name << ".buildPullSegmentedGraphs(\"" << label_iter_first
                             << "\", " << "atoi(argv[" << -1 * label_iter_second << "])"
-                            << (numa_aware_flag ? ", true" : "") << ");" << std::endl;
+                            << cache_args << ");" << std::endl;
                     } else {
                         // just use the positive integer as argument to number of segments
                         oss << "  " << edgeset->name << ".buildPullSegmentedGraphs(\"" << label_iter_first
                             << "\", " << label_iter_second
-                            << (numa_aware_flag ? ", true" : "") << ");" << std::endl;
+                            << cache_args << ");" << std::endl;
                     }
                 }
             }
 
+            // Build the compressed edgesets used by edge compression schedules
+            for (auto edgeset_name : mir_context_->compressed_edgesets) {
+                bool compressed_only = mir_context_->compressed_only_edgesets.count(edgeset_name) > 0;
+                oss << "  " << edgeset_name << ".buildCompressedGraph(" << (compressed_only ? "true" : "")
+                    << ");" << std::endl;
+            }
+
+            // Split the weights of edgesets traversed with separate neighbor ID and weight arrays
+            for (auto edgeset_name : mir_context_->soa_weighted_edgesets) {
+                bool soa_only = mir_context_->soa_only_edgesets.count(edgeset_name) > 0;
+                oss << "  " << edgeset_name << ".buildSoAWeights(" << (soa_only ? "true" : "")
+                    << ");" << std::endl;
+            }
+
+            // Copy the topology of replicated edgesets to every NUMA node
+            for (auto edgeset_name : mir_context_->replicated_edgesets) {
+                oss << "  " << edgeset_name << ".buildReplicatedGraph();" << std::endl;
+            }
+
             //generate allocation statemetns for field vectors
             for (auto constant : mir_context_->getLoweredConstants()) {
                 if ((std::dynamic_pointer_cast<mir::VectorType>(constant->type)) != nullptr) {
@@ -719,9 +756,9 @@ namespace graphit {
                         count_expr->accept(this);
                         oss << ", socketId);\n";
 
-                        oss << "    ligra::parallel_for_lambda((int)0, (int)";
+                        oss << "    ligra::parallel_for_lambda((NodeID)0, (NodeID)";
                         count_expr->accept(this);
-                        oss << ", [&] (int n) {\n";
+                        oss << ", [&] (NodeID n) {\n";
                         oss << "      " << local_field << "[socketId][n] = " << merge_reduce->field_name << "[n];\n";
                         oss << "    });\n  }\n";
 
@@ -765,6 +802,12 @@ namespace graphit {
         }
 
         if (func_decl->name == "main") {
+            if (mir_context_->huge_pages != "") {
+                oss << "  builtin_printHugePageReport();" << std::endl;
+            }
+            if (mir_context_->numa_placement != "") {
+                oss << "  builtin_printPagePlacement();" << std::endl;
+            }
             for (auto iter : mir_context_->edgeset_to_label_to_merge_reduce) {
                 for (auto inner_iter : iter.second) {
                     if (inner_iter.second->numa_aware) {
@@ -860,9 +903,9 @@ namespace graphit {
 				   oss << ">>();" << std::endl;
 
 				    printIndent();
-				    oss << "py::array_t<int> " << arg.getName() << "__indices = _" << arg.getName() << ".attr(\"indices\").cast<py::array_t<int>>();" << std::endl;
+				    oss << "py::array_t<NodeID> " << arg.getName() << "__indices = _" << arg.getName() << ".attr(\"indices\").cast<py::array_t<NodeID>>();" << std::endl;
 				    printIndent();
-				    oss << "py::array_t<int> " << arg.getName() << "__indptr = _" << arg.getName() << ".attr(\"indptr\").cast<py::array_t<int>>();" << std::endl;
+				    oss << "py::array_t<SGOffset> " << arg.getName() << "__indptr = _" << arg.getName() << ".attr(\"indptr\").cast<py::array_t<SGOffset>>();" << std::endl;
 				    printIndent();
 				    arg.getType()->accept(this);
 				    oss << arg.getName() << " = builtin_loadWeightedEdgesFromCSR(";
@@ -872,9 +915,9 @@ namespace graphit {
 				    printIndent();
 				    oss << "py::array_t<int> " << arg.getName() << "__data = _" << arg.getName() << ".attr(\"data\").cast<py::array_t<int>>();" << std::endl;
 				    printIndent();
-				    oss << "py::array_t<int> " << arg.getName() << "__indices = _" << arg.getName() << ".attr(\"indices\").cast<py::array_t<int>>();" << std::endl;
+				    oss << "py::array_t<NodeID> " << arg.getName() << "__indices = _" << arg.getName() << ".attr(\"indices\").cast<py::array_t<NodeID>>();" << std::endl;
 				    printIndent();
-				    oss << "py::array_t<int> " << arg.getName() << "__indptr = _" << arg.getName() << ".attr(\"indptr\").cast<py::array_t<int>>();" << std::endl;
+				    oss << "py::array_t<SGOffset> " << arg.getName() << "__indptr = _" << arg.getName() << ".attr(\"indptr\").cast<py::array_t<SGOffset>>();" << std::endl;
 				    printIndent();
 				    arg.getType()->accept(this);
 				    oss << arg.getName() << " = builtin_loadEdgesFromCSR(";
@@ -989,6 +1032,9 @@ namespace graphit {
             case mir::ScalarType::Type::UINT_64:
                 oss << "uint64_t ";
                 break;
+            case mir::ScalarType::Type::INT_64:
+                oss << "int64_t ";
+                break;
             case mir::ScalarType::Type::FLOAT:
                 oss << "float ";
                 break;
@@ -1047,7 +1093,16 @@ namespace graphit {
         if (call_on_built_in_priority_queue){
             oss << priority_queue_name << "->";
         }
-        oss << call_expr->name;
+
+        // vertex arrays are allocated with NewArray (property arrays and local vectors), not new
+        std::string call_name = call_expr->name;
+        if (call_name == "deleteObject" && call_expr->args.size() == 1 && mir::isa<mir::VarExpr>(call_expr->args[0])) {
+            auto type = mir::to<mir::VarExpr>(call_expr->args[0])->var.getType();
+            if (mir::isa<mir::VectorType>(type) && mir::to<mir::VectorType>(type)->element_type != nullptr
+                && mir_context_->getElementCount(mir::to<mir::VectorType>(type)->element_type) != nullptr)
+                call_name = "DeleteArray";
+        }
+        oss << call_name;
 
         if (call_expr->generic_type != nullptr) {
             oss << " < ";
@@ -1360,7 +1415,10 @@ namespace graphit {
         oss << ";" << std::endl;
          **/
 
-        if (!mir::isa<mir::VectorType>(vector_element_type)) {
+        if (mir_context_->vertex_valued_vectors.count(name)) {
+            // holds vertices, 64 bit with -DEDGELONG
+            oss << "NodeID  * __restrict " << name << ";" << std::endl;
+        } else if (!mir::isa<mir::VectorType>(vector_element_type)) {
             vector_element_type->accept(this);
             oss << " * __restrict " << name << ";" << std::endl;
         } else if (mir::isa<mir::VectorType>(vector_element_type)) {
@@ -1425,17 +1483,18 @@ namespace graphit {
                 oss << ";" << std::endl;
 
             } else if (isLiteral(init_val)){
-                oss << " = new ";
+                // allocated like the global property arrays, delete releases it with DeleteArray
+                oss << " = NewArray< ";
                 const auto vector_element_type = vector_type->vector_element_type;
                 vector_element_type->accept(this);
                 const auto size_expr = mir_context_->getElementCount(vector_type->element_type);
-                oss << " [ ";
+                oss << " >( ";
                 size_expr->accept(this);
-                oss << " ]; " << std::endl;
+                oss << " ); " << std::endl;
                 printIndent();
-                oss << "ligra::parallel_for_lambda((int)0, (int)";
+                oss << "ligra::parallel_for_lambda((NodeID)0, (NodeID)";
                 size_expr->accept(this);
-                oss << ", [&] (int i) { ";
+                oss << ", [&] (NodeID i) { ";
                 oss << name << "[i]=";
                 init_val->accept(this);
                 oss << "; });" << std::endl;
@@ -1474,20 +1533,23 @@ namespace graphit {
         oss << " ); " << std::endl;
          **/
 
-        oss << " = new ";
+        // cache line aligned and on huge pages when the program enables them (huge_pages.h)
+        oss << " = NewArray< ";
 
         if (mir::isa<mir::VectorType>(vector_element_type)) {
             //for vector type, we use the name from typedef
             auto vector_type_vector_element_type = mir::to<mir::VectorType>(vector_element_type);
             assert(vector_type_vector_element_type->typedef_name_ != "");
             oss << vector_type_vector_element_type->typedef_name_ << " ";
+        } else if (mir_context_->vertex_valued_vectors.count(name)) {
+            oss << "NodeID ";
         } else {
             vector_element_type->accept(this);
         }
 
-        oss << "[ ";
+        oss << " >( ";
         size_expr->accept(this);
-        oss << "];" << std::endl;
+        oss << ");" << std::endl;
     }
 
     void CodeGenCPP::genPropertyArrayImplementationWithInitialization(mir::VarDecl::Ptr var_decl) {
@@ -1537,7 +1599,7 @@ namespace graphit {
     }
 
     void CodeGenCPP::visit(mir::VertexSetAllocExpr::Ptr alloc_expr) {
-        oss << "new VertexSubset<int> ( ";
+        oss << "new VertexSubset<NodeID> ( ";
         //This is the current number of elements, but we need the range
         //alloc_expr->size_expr->accept(this);
         const auto size_expr = mir_context_->getElementCount(alloc_expr->element_type);
@@ -1573,25 +1635,30 @@ namespace graphit {
             auto associated_element_type_size = mir_context_->getElementCount(associated_element_type);
             assert(associated_element_type_size);
             if (apply_expr->is_parallel) {
-                oss << "ligra::parallel_for_lambda((int)0, (int)";
+                oss << "ligra::parallel_for_lambda((NodeID)0, (NodeID)";
                 associated_element_type_size->accept(this);
-                oss << ", [&] (int vertexsetapply_iter) {" << std::endl;
+                oss << ", [&] (NodeID vertexsetapply_iter) {" << std::endl;
             } else {
-                oss << "for" << " (int vertexsetapply_iter = 0; vertexsetapply_iter < ";
+                oss << "for" << " (NodeID vertexsetapply_iter = 0; vertexsetapply_iter < ";
                 associated_element_type_size->accept(this);
                 oss << "; vertexsetapply_iter++) {" << std::endl;
             }
             indent();
             printIndent();
 
+            // the i-th call gets the vertex with ID i in the input graph of a reordered edgeset
+            std::string vertex = "vertexsetapply_iter";
+            if (apply_expr->input_order_edgeset != "")
+                vertex = "builtin_toNewID(" + apply_expr->input_order_edgeset + ", vertexsetapply_iter)";
+
             // if functor arg is not empty, we wrap another paranthesis to not confuse it with vertexsetapply_iter
             if (!apply_expr->input_function->functorArgs.empty()) {
                 oss << "(";
                 apply_expr->input_function->accept(this);
-                oss << ")(vertexsetapply_iter);" << std::endl;
+                oss << ")(" << vertex << ");" << std::endl;
             } else {
                 apply_expr->input_function->accept(this);
-                oss << "(vertexsetapply_iter);" << std::endl;
+                oss << "(" << vertex << ");" << std::endl;
             }
 
 
@@ -1753,7 +1820,7 @@ namespace graphit {
 	if (vertexset_type->priority_update_type == mir::PriorityUpdateType::ExternPriorityUpdate || vertexset_type->priority_update_type == mir::PriorityUpdateType::ConstSumReduceBeforePriorityUpdate)
 	    oss << "julienne::vertexSubset ";
 	else 
-	    oss << "VertexSubset<int> *  ";
+	    oss << "VertexSubset<NodeID> *  ";
     }
 
     void CodeGenCPP::visit(mir::ListType::Ptr list_type) {
@@ -1917,47 +1984,67 @@ namespace graphit {
     }
 
     void CodeGenCPP::visit(mir::EdgeSetLoadExpr::Ptr edgeset_load_expr) {
-        if (edgeset_load_expr->is_weighted_) {
-            oss << "builtin_loadWeightedEdgesFromFile ( ";
+        if (edgeset_load_expr->vertex_reordering != "") {
+            // relabel the loaded graph, the vertex IDs in the rest of the program are the new ones
+            oss << "builtin_reorder ( ";
+        }
+        if (edgeset_load_expr->stream_buffer_edges > 0) {
+            // semi-external edgeset, the edges stay on disk
+            oss << (edgeset_load_expr->is_weighted_ ? "builtin_loadWeightedEdgesSemiExternal" : "builtin_loadEdgesSemiExternal");
+            if (edgeset_load_expr->weight_type_ != "")
+                oss << "<" << edgeset_load_expr->weight_type_ << ">";
+            oss << " ( ";
             edgeset_load_expr->file_name->accept(this);
+            oss << ", " << edgeset_load_expr->stream_buffer_edges << ") ";
+        } else if (edgeset_load_expr->is_weighted_) {
+            oss << "builtin_loadWeightedEdgesFromFile";
+            if (edgeset_load_expr->weight_type_ != "")
+                oss << "<" << edgeset_load_expr->weight_type_ << ">";
+            oss << " ( ";
+            edgeset_load_expr->file_name->accept(this);
+            // push-only programs skip the inverse of directed graphs (built on demand if needed)
+            if (!edgeset_load_expr->build_inverse)
+                oss << ", false";
             oss << ") ";
         } else {
             oss << "builtin_loadEdgesFromFile ( ";
             edgeset_load_expr->file_name->accept(this);
+            if (!edgeset_load_expr->build_inverse)
+                oss << ", false";
             oss << ") ";
         }
+        if (edgeset_load_expr->vertex_reordering != "") {
+            oss << ", \"" << edgeset_load_expr->vertex_reordering << "\") ";
+        }
     }
 
     void CodeGenCPP::visit(mir::EdgeSetType::Ptr edgeset_type) {
-        if (edgeset_type->weight_type != nullptr) {
-            //weighted edgeset
-            //unweighted edgeset
-            oss << "WGraph ";
-        } else {
-            //unweighted edgeset
-            oss << "Graph ";
-        }
+        // Graph, WGraph (int weights) or WGraphT<weight type>
+        oss << edgeset_type->toGraphTypeString() << " ";
     }
 
     void CodeGenCPP::visit(mir::VectorAllocExpr::Ptr alloc_expr) {
-        oss << "new ";
+        //This is the current number of elements, but we need the range
+        //alloc_expr->size_expr->accept(this);
+        const auto size_expr = mir_context_->getElementCount(alloc_expr->element_type);
+        // vertex arrays come from NewArray like the global property arrays, delete releases them with DeleteArray
+        oss << (size_expr != nullptr ? "NewArray< " : "new ");
 
         if (alloc_expr->scalar_type != nullptr){
             alloc_expr->scalar_type->accept(this);
         } else if (alloc_expr->vector_type != nullptr){
             oss << alloc_expr->vector_type->toString();
         }
-        oss << "[ ";
-        //This is the current number of elements, but we need the range
-        //alloc_expr->size_expr->accept(this);
-        const auto size_expr = mir_context_->getElementCount(alloc_expr->element_type);
-        if (size_expr != nullptr)
+        if (size_expr != nullptr) {
+            oss << " >( ";
             size_expr->accept(this);
-	else {
-	    // This means it is a vector of constant size. The size_expr now directly holds the constant literal.
-	    alloc_expr->size_expr->accept(this);
-	}
-        oss << "]";
+            oss << " )";
+        } else {
+            // This means it is a vector of constant size. The size_expr now directly holds the constant literal.
+            oss << "[ ";
+            alloc_expr->size_expr->accept(this);
+            oss << "]";
+        }
     }
 
 
@@ -2032,7 +2119,8 @@ namespace graphit {
 
 
             if (priority_queue_alloc_expr->delta < 0 ){
-                oss << ", stoi(argv[" << -1*priority_queue_alloc_expr->delta << "])";
+                oss << ", " << genDeltaConversion(priority_queue_alloc_expr->priority_type)
+                    << "(argv[" << -1*priority_queue_alloc_expr->delta << "])";
             } else {
                 oss << ", " << priority_queue_alloc_expr->delta;
             }
@@ -2074,7 +2162,8 @@ namespace graphit {
 
 
             if (mir_context_->delta_ < 0){
-                oss << ", stoi(argv[" << -1*mir_context_->delta_ << "]) ";
+                oss << ", " << genDeltaConversion(priority_queue_alloc_expr->priority_type)
+                    << "(argv[" << -1*mir_context_->delta_ << "]) ";
             } else {
                 if (mir_context_->delta_ != 1){
                     oss << ", " << mir_context_->delta_;
@@ -2092,6 +2181,14 @@ namespace graphit {
 
     }
 
+    // deltas given on the command line can be fractional for floating point priorities
+    std::string CodeGenCPP::genDeltaConversion(mir::ScalarType::Ptr priority_type) {
+        if (priority_type->type == mir::ScalarType::Type::FLOAT
+            || priority_type->type == mir::ScalarType::Type::DOUBLE)
+            return "stod";
+        return "stoi";
+    }
+
     void CodeGenCPP::visit(mir::OrderedProcessingOperator::Ptr ordered_op) {
         printIndent();
         if (ordered_op->priority_udpate_type == mir::PriorityUpdateType::EagerPriorityUpdate){
@@ -2264,12 +2361,7 @@ namespace graphit {
             oss << "updateBucketWithGraphItVertexSubset(";
             oss << update_call->lambda_name << ", ";
             oss << update_call->priority_queue_name << ", ";
-            oss << update_call->nodes_init_in_bucket << ", ";
-            if (update_call->delta > 0){
-                oss << update_call->delta;
-            } else {
-                oss << "stoi(argv[" << -1*update_call->delta << "])";
-            }
+            oss << update_call->nodes_init_in_bucket;
             oss << ");" << std::endl;
         } else {
             std::cout << "UpdatePriorityUpdateBucketsCall not supported." << std::endl;
@@ -58,6 +58,30 @@ namespace graphit {
         }
     }
 
+    std::string EdgesetApplyFunctionDeclGenerator::genNeighborhood(mir::EdgeSetApplyExpr::Ptr apply,
+                                                                   std::string direction,
+                                                                   std::string vertex) {
+        // streamed edges are read from disk one vertex at a time (EdgeStream::neigh)
+        if (apply->use_edge_streaming)
+            return "g." + direction + "_stream().neigh(" + vertex + ")";
+        std::string accessor = direction + "_neigh";
+        if (apply->use_compressed_edges) {
+            accessor += "_compressed";
+        } else if (apply->use_soa_weights) {
+            // the weight array is only read if the apply function uses the weights
+            accessor += apply->reads_weights ? "_soa" : "_soa_ids";
+        } else if (apply->use_replicated_topology) {
+            // the copy of the node the thread is pinned to
+            accessor += "_replicated";
+        }
+        return "g." + accessor + "(" + vertex + ")";
+    }
+
+    mir::EdgeSetType::Ptr EdgesetApplyFunctionDeclGenerator::getEdgeSetType(mir::EdgeSetApplyExpr::Ptr apply) {
+        auto target = mir::to<mir::VarExpr>(apply->target);
+        return mir::to<mir::EdgeSetType>(target->var.getType());
+    }
+
     void EdgesetApplyFunctionDeclGenerator::setupFlags(mir::EdgeSetApplyExpr::Ptr apply,
                                                        bool & apply_expr_gen_frontier,
                                                        bool &from_vertexset_specified,
@@ -79,10 +103,28 @@ namespace graphit {
     }
 
     // Set up the global variables numVertices, numEdges, outdegrees
+    // The frontiers returned by the apply and its scratch arrays come from a pool that lives as long
+    // as the program, so the rounds of a traversal recycle them (FrontierPool in vertexsubset.h)
+    void EdgesetApplyFunctionDeclGenerator::printFrontierPool(mir::EdgeSetApplyExpr::Ptr apply,
+                                                              bool apply_expr_gen_frontier) {
+        if (apply_expr_gen_frontier || mir::isa<mir::HybridDenseEdgeSetApplyExpr>(apply)
+            || mir::isa<mir::HybridDenseForwardEdgeSetApplyExpr>(apply))
+            oss_ << "    static FrontierPool<NodeID> frontier_pool;\n";
+    }
+
+    void EdgesetApplyFunctionDeclGenerator::printDirectionSwitch(mir::EdgeSetApplyExpr::Ptr apply) {
+        // the switch keeps the direction of the last round of the thread's traversal, a frontier
+        // that was not returned by this apply (frontier_pool) starts a new traversal
+        oss_ << "    static thread_local DirectionSwitch direction_switch(" << apply->direction_alpha << ", "
+             << apply->direction_beta << ", \"" << genFunctionName(apply) << "\");\n"
+                "    if (from_vertexset->pool_ != &frontier_pool) direction_switch.reset();\n";
+    }
+
     void EdgesetApplyFunctionDeclGenerator::setupGlobalVariables(mir::EdgeSetApplyExpr::Ptr apply,
                                                                  bool apply_expr_gen_frontier,
                                                                  bool from_vertexset_specified) {
         oss_ << "    int64_t numVertices = g.num_nodes(), numEdges = g.num_edges();\n";
+        printFrontierPool(apply, apply_expr_gen_frontier);
 
 
         if (!mir::isa<mir::PullEdgeSetApplyExpr>(apply)) {
@@ -92,38 +134,31 @@ namespace graphit {
 //                oss_ << "    long m = from_vertexset->size();\n";
 //            }
 
-            //we need to calculate the outdegrees and m if it is hybrid_dense, hybrid_denseforward or push with output
+            //we need to calculate the outdegrees and m if it is push with output, hybrid applies only
+            //need them for the rounds that push (printFrontierDegrees)
             if (mir::isa<mir::HybridDenseEdgeSetApplyExpr>(apply)
-                || mir::isa<mir::HybridDenseForwardEdgeSetApplyExpr>(apply)
-                    || (mir::isa<mir::PushEdgeSetApplyExpr>(apply) && apply_expr_gen_frontier)) {
+                || mir::isa<mir::HybridDenseForwardEdgeSetApplyExpr>(apply)) {
                 if (from_vertexset_specified) {
+                    printDirectionSwitch(apply);
                     oss_ << "    from_vertexset->toSparse();" << std::endl;
                     oss_ << "    long m = from_vertexset->size();\n";
-
+                    oss_ << "    bool use_pull = direction_switch.usePull(g, from_vertexset);\n";
                 } else {
+                    // every round goes over all the vertices, there is no state to keep between rounds
+                    oss_ << "    DirectionSwitch direction_switch(" << apply->direction_alpha << ", "
+                         << apply->direction_beta << ", \"" << genFunctionName(apply) << "\");\n";
                     oss_ << "    long m = numVertices; \n";
+                    oss_ << "    bool use_pull = direction_switch.usePull(g);\n";
                 }
-                oss_ << "    // used to generate nonzero indices to get degrees\n"
-                        "    uintT *degrees = newA(uintT, m);\n"
-                        "    // We probably need this when we get something that doesn't have a dense set, not sure\n"
-                        "    // We can also write our own, the eixsting one doesn't quite work for bitvectors\n"
-                        "    //from_vertexset->toSparse();\n"
-                        "    {\n";
-
-                if (from_vertexset_specified){
-                    oss_ <<  "        ligra::parallel_for_lambda((long)0, (long)m, [&] (long i) {\n"
-                            "            NodeID v = from_vertexset->dense_vertex_set_[i];\n"
-                            "            degrees[i] = g.out_degree(v);\n"
-                            "         });\n"
-                            "    }\n"
-                            "    uintT outDegrees = sequence::plusReduce(degrees, m);\n";
+            } else if (mir::isa<mir::PushEdgeSetApplyExpr>(apply) && apply_expr_gen_frontier) {
+                if (from_vertexset_specified) {
+                    oss_ << "    from_vertexset->toSparse();" << std::endl;
+                    oss_ << "    long m = from_vertexset->size();\n";
+
                 } else {
-                    oss_ << "        ligra::parallel_for_lambda((long)0, (long)numVertices, [&] (long i) {\n"
-                            "            degrees[i] = g.out_degree(i);\n"
-                            "        });\n"
-                            "    }\n"
-                            "    uintT outDegrees = sequence::plusReduce(degrees, m);\n";
+                    oss_ << "    long m = numVertices; \n";
                 }
+                printFrontierDegrees(from_vertexset_specified);
             }
             else if (mir::isa<mir::PushEdgeSetApplyExpr>(apply)){
                 //we still need to convert the from_vertexset to sparse, and compute m for SparsePush
@@ -139,6 +174,32 @@ namespace graphit {
         }
     }
 
+    // Print the code for computing the out degrees of the frontier (the offsets of the push traversal)
+    // and their sum outDegrees
+    void EdgesetApplyFunctionDeclGenerator::printFrontierDegrees(bool from_vertexset_specified) {
+        oss_ << "    // used to generate nonzero indices to get degrees\n"
+                "    uintT *degrees = frontier_pool.acquireBuffer<uintT>(m);\n"
+                "    // We probably need this when we get something that doesn't have a dense set, not sure\n"
+                "    // We can also write our own, the eixsting one doesn't quite work for bitvectors\n"
+                "    //from_vertexset->toSparse();\n"
+                "    {\n";
+
+        if (from_vertexset_specified){
+            oss_ <<  "        ligra::parallel_for_lambda((long)0, (long)m, [&] (long i) {\n"
+                    "            NodeID v = from_vertexset->dense_vertex_set_[i];\n"
+                    "            degrees[i] = g.out_degree(v);\n"
+                    "         });\n"
+                    "    }\n"
+                    "    uintT outDegrees = sequence::plusReduce(degrees, m);\n";
+        } else {
+            oss_ << "        ligra::parallel_for_lambda((long)0, (long)numVertices, [&] (long i) {\n"
+                    "            degrees[i] = g.out_degree(i);\n"
+                    "        });\n"
+                    "    }\n"
+                    "    uintT outDegrees = sequence::plusReduce(degrees, m);\n";
+        }
+    }
+
     // Print the code for traversing the edges in the push direction and return the new frontier
     // the apply_func_name is used for hybrid schedule, when a special push_apply_func is used
     // usually, the apply_func_name is fixed to "apply_func" (see the default argument)
@@ -150,27 +211,11 @@ namespace graphit {
             std::string apply_func_name) {
 
 
-        //set up logic fo enabling deduplication with CAS on flags (only if it returns a frontier)
-//        if (apply->enable_deduplication && apply_expr_gen_frontier) {
-//            oss_ << "    if (g.get_flags_() == nullptr){\n"
-////                    "      g.flags_ = new int[numVertices]();\n"
-//                    "      g.set_flags_(new int[numVertices]());\n"
-//                    "      ligra::parallel_for_lambda(0, (int)numVertices, [&] (int i) { g.get_flags_()[i]=0; });\n"
-//                    "    }\n";
-//        }
-
-
-        if (apply->enable_deduplication && apply_expr_gen_frontier) {
-
-            oss_ << "auto deduplication_flag = g.get_flags_atomic_();\n";
-
-        }
-
         // If apply function has a return value, then we need to return a temporary vertexsubset
         if (apply_expr_gen_frontier) {
             // build an empty vertex subset if apply function returns
             //set up code for outputing frontier for push based edgeset apply operations
-            oss_ << "    VertexSubset<NodeID> *next_frontier = new VertexSubset<NodeID>(g.num_nodes(), 0);\n";
+            oss_ << "    VertexSubset<NodeID> *next_frontier = frontier_pool.acquire(g.num_nodes());\n";
             if (from_vertexset_specified){
                 oss_ << "    if (numVertices != from_vertexset->getVerticesRange()) {\n"
                         "        cout << \"edgeMap: Sizes Don't match\" << endl;\n"
@@ -179,10 +224,19 @@ namespace graphit {
             }
 
             oss_ <<
-                         "    if (outDegrees == 0) return next_frontier;\n"
+                         "    if (outDegrees == 0) {\n"
+                         "        frontier_pool.releaseBuffer(degrees);\n"
+                         "        return next_frontier;\n"
+                         "    }\n"
                          "    uintT *offsets = degrees;\n"
                          "    long outEdgeCount = sequence::plusScan(offsets, degrees, m);\n"
-                         "    uintE *outEdges = newA(uintE, outEdgeCount);\n";
+                         "    uintE *outEdges = frontier_pool.acquireBuffer<uintE>(outEdgeCount);\n";
+
+            // the flags are stamped with the round, so they don't need to be reset afterwards
+            // (DeduplicationFlags in graph.h)
+            if (apply->enable_deduplication) {
+                oss_ << "    DeduplicationFlags *deduplication_flag = g.get_flags_atomic_();\n";
+            }
         }
 
 
@@ -191,8 +245,7 @@ namespace graphit {
         printIndent();
 
 
-        std::string node_id_type = "NodeID";
-        if (apply->is_weighted) node_id_type = "WNode";
+        std::string node_id_type = getEdgeSetType(apply)->toNeighborTypeString();
 
         std::string for_type = "for";
         if (apply->is_parallel) {
@@ -237,7 +290,7 @@ namespace graphit {
 
         printIndent();
 
-        oss_ << "for(" << node_id_type << " d : g.out_neigh(s)){" << std::endl;
+        oss_ << "for(" << node_id_type << " d : " << genNeighborhood(apply, "out", "s") << "){" << std::endl;
 
 
         // print the checks on filtering on sources s
@@ -253,7 +306,7 @@ namespace graphit {
 
             } else {
                 //the input expression is a vertex subset
-                oss_ << " (to_vertexset->bool_map_[s] ";
+                oss_ << " (to_vertexset->bitmap_->get_bit(s)";
             }
             oss_ << ") { " << std::endl;
         }
@@ -281,7 +334,7 @@ namespace graphit {
             //need to return a frontier
             if (apply->enable_deduplication && apply_expr_gen_frontier) {
 
-                oss_ << " && CAS(&(deduplication_flag[" << dst_type << "]), 0, 1) ";
+                oss_ << " && deduplication_flag->claim(" << dst_type << ") ";
 
 
             }
@@ -351,26 +404,25 @@ namespace graphit {
             oss_ << "}" << std::endl;
         }
 
+        // the degrees of a hybrid apply are otherwise returned with the new frontier
+        if (!apply_expr_gen_frontier && (mir::isa<mir::HybridDenseEdgeSetApplyExpr>(apply)
+                                         || mir::isa<mir::HybridDenseForwardEdgeSetApplyExpr>(apply))) {
+            oss_ << "  frontier_pool.releaseBuffer(degrees);\n";
+        }
+
         //return a new vertexset if no subset vertexset is returned
         if (apply_expr_gen_frontier) {
-            oss_ << "  uintE *nextIndices = newA(uintE, outEdgeCount);\n"
+            oss_ << "  uintE *nextIndices = frontier_pool.acquireBuffer<uintE>(outEdgeCount);\n"
                     "  long nextM = sequence::filter(outEdges, nextIndices, outEdgeCount, nonMaxF());\n"
-                    "  free(outEdges);\n"
-                    "  free(degrees);\n"
+                    "  frontier_pool.releaseBuffer(outEdges);\n"
+                    "  frontier_pool.releaseBuffer(degrees);\n"
                     "  next_frontier->num_vertices_ = nextM;\n"
                     "  next_frontier->dense_vertex_set_ = nextIndices;\n";
 
 
-            //set up logic fo enabling deduplication with CAS on flags (only if it returns a frontier)
-            if (apply->enable_deduplication && from_vertexset_specified) {
-                //clear up the indices that are set
-
-                oss_ << "  ligra::parallel_for_lambda((int)0, (int)nextM, [&] (int i) {\n"
-                        "     deduplication_flag[nextIndices[i]] = 0;\n"
-                        "  });\n"
-                        "  g.return_flags_atomic_(deduplication_flag);\n";
-
-
+            //hand the deduplication flags back to the graph for the next round (only if it returns a frontier)
+            if (apply->enable_deduplication) {
+                oss_ << "  g.return_flags_atomic_(deduplication_flag);\n";
             }
 
             oss_ << "  return next_frontier;\n";
@@ -394,8 +446,7 @@ namespace graphit {
             indent();
         }
 
-        std::string node_id_type = "NodeID";
-        if (apply->is_weighted) node_id_type = "WNode";
+        std::string node_id_type = getEdgeSetType(apply)->toNeighborTypeString();
         printIndent();
 
         if (cache_aware || numa_aware) {
@@ -403,7 +454,10 @@ namespace graphit {
             printIndent();
             oss_ << "  " << node_id_type << " s = sg->edgeArray[ngh];" << std::endl;
         } else {
-            oss_ << "for(" << node_id_type << " s : g.in_neigh(d)){" << std::endl;
+            std::string in_neigh = genNeighborhood(apply, "in", "d");
+            if (apply->use_edge_streaming)
+                in_neigh = "part.neigh(d)";
+            oss_ << "for(" << node_id_type << " s : " << in_neigh << "){" << std::endl;
         }
 
 
@@ -425,7 +479,7 @@ namespace graphit {
 
                 //the input expression is a vertex subset
                 if (! apply->use_pull_frontier_bitvector){
-                    oss_ << " (from_vertexset->bool_map_[" << src_type <<  "] ";
+                    oss_ << " (from_vertexset->bitmap_->get_bit(" << src_type <<  ")";
                 } else {
                     oss_ << " (bitmap.get_bit(" << src_type << ")";
                 }
@@ -456,7 +510,7 @@ namespace graphit {
             //TODO: fix later
             oss_ << " ) { " << std::endl;
             printIndent();
-            oss_ << "next[d] = 1; " << std::endl;
+            oss_ << "next->set_bit_atomic(d); " << std::endl;
             // generating code for early break
             if (apply->to_func) {
                 printIndent();
@@ -494,7 +548,7 @@ namespace graphit {
         oss_ << "}// end of per-socket parallel region\n\n";
         auto edgeset_name = mir::to<mir::VarExpr>(apply->target)->var.getName();
         auto merge_reduce = mir_context_->edgeset_to_label_to_merge_reduce[edgeset_name][apply->scope_label_name];
-        oss_ << "  ligra::parallel_for_lambda ((int)0, (int)numVertices, [&] (int n) {\n";
+        oss_ << "  ligra::parallel_for_lambda ((NodeID)0, (NodeID)numVertices, [&] (NodeID n) {\n";
         oss_ << "    for (int socketId = 0; socketId < omp_get_num_places(); socketId++) {\n";
         oss_ << "      " << apply->merge_reduce->field_name << "[n] ";
         switch (apply->merge_reduce->reduce_op) {
@@ -513,7 +567,7 @@ namespace graphit {
     }
 
     void EdgesetApplyFunctionDeclGenerator::printNumaScatter(mir::EdgeSetApplyExpr::Ptr apply) {
-        oss_ << "ligra::parallel_for_lambda((int)0, (int)numVertices, [&] (int n) {\n";
+        oss_ << "ligra::parallel_for_lambda((NodeID)0, (NodeID)numVertices, [&] (NodeID n) {\n";
         oss_ << "    for (int socketId = 0; socketId < omp_get_num_places(); socketId++) {\n";
         oss_ << "      local_" << apply->merge_reduce->field_name  << "[socketId][n] = "
              << apply->merge_reduce->field_name << "[n];\n";
@@ -535,9 +589,8 @@ namespace graphit {
             //        "  long numVertices = g.num_nodes(), numEdges = g.num_edges();\n"
             //        "  long m = from_vertexset->size();\n"
 
-            oss_ << "  VertexSubset<NodeID> *next_frontier = new VertexSubset<NodeID>(g.num_nodes(), 0);\n"
-                    "  bool * next = newA(bool, g.num_nodes());\n"
-                    "  ligra::parallel_for_lambda((int)0, (int)numVertices, [&] (int i) { next[i] = 0; });\n";
+            oss_ << "  VertexSubset<NodeID> *next_frontier = frontier_pool.acquire(g.num_nodes());\n"
+                    "  Bitmap * next = frontier_pool.acquireBitmap(g.num_nodes());\n";
         }
 
         indent();
@@ -550,18 +603,9 @@ namespace graphit {
             }
         }
 
-        //generate a bitvector from the dense vertexset (bool map)
+        //the dense vertexset is a bitvector already, the loops only read it through a local reference
         if (from_vertexset_specified && apply->use_pull_frontier_bitvector){
-            oss_ << "  Bitmap bitmap(numVertices);\n"
-                    "  bitmap.reset();\n"
-                    "  ligra::parallel_for_lambda((int) 0, (int)numVertices, 64, [&] (int i){\n"
-                    "     int start = i;\n"
-                    "     int end = (((i + 64) < numVertices)? (i+64):numVertices);\n"
-                    "     for(int j = start; j < end; j++){\n"
-                    "        if (from_vertexset->bool_map_[j])\n"
-                    "          bitmap.set_bit(j);\n"
-                    "     }\n"
-                    "  });" << std::endl;
+            oss_ << "  Bitmap &bitmap = *from_vertexset->bitmap_;" << std::endl;
         }
 
         printIndent();
@@ -588,13 +632,29 @@ namespace graphit {
             }
         }
 
+        // segments are built from the edges in memory, streamed edges use their own partitions instead
+        if (apply->use_edge_streaming) {
+            cache_aware = false;
+            numa_aware = false;
+        }
+
         if (numa_aware) {
             printNumaScatter(apply);
         }
 
+        std::string outer_begin = "0";
         std::string outer_end = "g.num_nodes()";
         std::string iter = "d";
 
+        if (apply->use_edge_streaming) {
+            // pull into the destinations of one partition at a time, while the next one is read from disk
+            oss_ << "  auto &stream = g.in_stream();\n"
+                    "  for (int partId = 0; partId < stream.num_partitions(); partId++) {\n"
+                    "    auto part = stream.partition(partId);\n";
+            outer_begin = "part.first";
+            outer_end = "part.last";
+        }
+
         if (numa_aware || cache_aware) {
             if (numa_aware) {
                 std::string num_segment_str = "g.getNumSegments(\"" + apply->scope_label_name + "\");";
@@ -625,9 +685,9 @@ namespace graphit {
 
             //printIndent();
             if (apply->is_parallel) {
-              oss_ << "ligra::parallel_for_lambda((NodeID)0, (NodeID)" << outer_end << ", [&] (NodeID " << iter << ") {" << std::endl;
+              oss_ << "ligra::parallel_for_lambda((NodeID)" << outer_begin << ", (NodeID)" << outer_end << ", [&] (NodeID " << iter << ") {" << std::endl;
             } else {
-              oss_ << for_type << " ( NodeID " << iter << "=0; " << iter << " < " << outer_end << "; " << iter << "++) {" << std::endl;
+              oss_ << for_type << " ( NodeID " << iter << "=" << outer_begin << "; " << iter << " < " << outer_end << "; " << iter << "++) {" << std::endl;
             }
             indent();
             if (cache_aware) {
@@ -638,13 +698,13 @@ namespace graphit {
             // use edge based load balance
             // recursive load balance scheme
 
-            //set up the edge index (in in edge array) for estimating number of edges
-            oss_ << "  if (g.get_offsets_() == nullptr) g.SetUpOffsets(true);\n"
-                    "  SGOffset * edge_in_index = g.get_offsets_();\n";
+            //the in edge offsets of the graph are used directly for estimating number of edges
+            oss_ << "  SGOffset * edge_in_index = g.get_in_offsets_();\n";
 
             oss_ << "    std::function<void(int,int,int)> recursive_lambda = \n"
                     "    [" << (apply->to_func ?  "&to_func, " : "")
-                 << "&apply_func, &g,  &recursive_lambda, edge_in_index" << (cache_aware ? ", sg" : "");
+                 << "&apply_func, &g,  &recursive_lambda, edge_in_index" << (cache_aware ? ", sg" : "")
+                 << (apply->use_edge_streaming ? ", &part" : "");
             // capture bitmap and next frontier if needed
             if (from_vertexset_specified) {
                 if(apply->use_pull_frontier_bitvector) oss_ << ", &bitmap ";
@@ -687,7 +747,10 @@ namespace graphit {
                     "                                         [&] { recursive_lambda(start + ((end-start)>>1), end, grain_size); });\n"
                     "        } \n"
                     "    }; //end of lambda function\n";
-            oss_ << "    recursive_lambda(0, " << (cache_aware ? "sg->" : "") << "numVertices, "  <<  apply->pull_edge_based_load_balance_grain_size << ");\n";
+            if (apply->use_edge_streaming)
+                oss_ << "    recursive_lambda(part.first, part.last, "  <<  apply->pull_edge_based_load_balance_grain_size << ");\n";
+            else
+                oss_ << "    recursive_lambda(0, " << (cache_aware ? "sg->" : "") << "numVertices, "  <<  apply->pull_edge_based_load_balance_grain_size << ");\n";
         }
 
         if (numa_aware) {
@@ -696,6 +759,9 @@ namespace graphit {
         if (cache_aware) {
             oss_ << "    } // end of segment for loop\n";
         }
+        if (apply->use_edge_streaming) {
+            oss_ << "  } // end of partition for loop\n";
+        }
 
         if (numa_aware) {
             printNumaMerge(apply);
@@ -703,8 +769,8 @@ namespace graphit {
 
         //return a new vertexset if no subset vertexset is returned
         if (apply_expr_gen_frontier) {
-            oss_ << "  next_frontier->num_vertices_ = sequence::sum(next, numVertices);\n"
-                    "  next_frontier->bool_map_ = next;\n"
+            oss_ << "  next_frontier->num_vertices_ = next->count();\n"
+                    "  next_frontier->bitmap_ = next;\n"
                     "  next_frontier->is_dense = true;\n"
                     "  return next_frontier;\n";
         }
@@ -719,7 +785,7 @@ namespace graphit {
             bool apply_expr_gen_frontier,
             std::string dst_type) {
 
-        oss_ << "    if (m + outDegrees > numEdges / 20) {\n";
+        oss_ << "    if (use_pull) {\n";
         indent();
         //suppplies the pull based apply function
         printPullEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
@@ -727,6 +793,7 @@ namespace graphit {
         oss_ << "} else {\n";
         indent();
         //uses a special "push_apply_func", which contains synchronizations for the push direction
+        printFrontierDegrees(from_vertexset_specified);
         printPushEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type,
                                              "push_apply_func");
         dedent();
@@ -737,7 +804,7 @@ namespace graphit {
     // print code for denseforward direction
     void EdgesetApplyFunctionDeclGenerator::printDenseForwardEdgeTraversalReturnFrontier(
             mir::EdgeSetApplyExpr::Ptr apply, bool from_vertexset_specified, bool apply_expr_gen_frontier,
-            std::string dst_type) {
+            std::string dst_type, std::string apply_func_name) {
 
         // If apply function has a return value, then we need to return a temporary vertexsubset
         if (apply_expr_gen_frontier) {
@@ -747,9 +814,8 @@ namespace graphit {
             //        "  long numVertices = g.num_nodes(), numEdges = g.num_edges();\n"
             //        "  long m = from_vertexset->size();\n"
 
-            oss_ << "  VertexSubset<NodeID> *next_frontier = new VertexSubset<NodeID>(g.num_nodes(), 0);\n"
-                    "  bool * next = newA(bool, g.num_nodes());\n"
-                    "  ligra::parallel_for_lambda((int)0, (int)numVertices, [&] (int i) { next[i] = 0; });\n";
+            oss_ << "  VertexSubset<NodeID> *next_frontier = frontier_pool.acquire(g.num_nodes());\n"
+                    "  Bitmap * next = frontier_pool.acquireBitmap(g.num_nodes());\n";
         }
 
         indent();
@@ -765,18 +831,47 @@ namespace graphit {
         if (apply->is_parallel)
             for_type = "parallel_for";
 
-        std::string node_id_type = "NodeID";
-        if (apply->is_weighted) node_id_type = "WNode";
+        std::string node_id_type = getEdgeSetType(apply)->toNeighborTypeString();
 
-        if (apply->is_parallel) {
-            oss_ << "ligra::parallel_for_lambda((NodeID)0, (NodeID)g.num_nodes(), [&] (NodeID s) {" << std::endl;
+        std::string outer_begin = "0";
+        std::string outer_end = "g.num_nodes()";
+        std::string out_neigh = genNeighborhood(apply, "out", "s");
+
+        if (apply->use_edge_streaming) {
+            // push the sources of one partition at a time, while the next one is read from disk
+            oss_ << "  auto &stream = g.out_stream();\n"
+                    "  for (int partId = 0; partId < stream.num_partitions(); partId++) {\n"
+                    "    auto part = stream.partition(partId);\n";
+            outer_begin = "part.first";
+            outer_end = "part.last";
+            out_neigh = "part.neigh(s)";
+        }
+
+        // the sources of a dense frontier are visited a word of the bitvector at a time,
+        // skipping the words without any vertex in the frontier
+        bool skip_words = from_vertexset_specified && !apply->use_edge_streaming;
+
+        if (skip_words) {
+            if (apply->is_parallel) {
+                oss_ << "ligra::parallel_for_lambda((int64_t)0, (int64_t)from_vertexset->bitmap_->num_words(), [&] (int64_t w) {" << std::endl;
+            } else {
+                oss_ << "for ( int64_t w=0; w < from_vertexset->bitmap_->num_words(); w++) {" << std::endl;
+            }
+        } else if (apply->is_parallel) {
+            oss_ << "ligra::parallel_for_lambda((NodeID)" << outer_begin << ", (NodeID)" << outer_end << ", [&] (NodeID s) {" << std::endl;
         } else {
-            oss_ << "for ( NodeID s=0; s < g.num_nodes(); s++) {" << std::endl;
+            oss_ << "for ( NodeID s=" << outer_begin << "; s < " << outer_end << "; s++) {" << std::endl;
         }
         indent();
 
         // print the checks on filtering on sources s
-        if (apply->from_func) {
+        if (skip_words) {
+            indent();
+            printIndent();
+            oss_ << "for (uint64_t word = from_vertexset->bitmap_->word(w); word != 0; word &= word - 1) {" << std::endl;
+            printIndent();
+            oss_ << "  NodeID s = w * 64 + __builtin_ctzll(word);" << std::endl;
+        } else if (apply->from_func) {
             indent();
             printIndent();
 
@@ -788,7 +883,7 @@ namespace graphit {
 
             } else {
                 //the input expression is a vertex subset
-                oss_ << " (from_vertexset->bool_map_[s] ";
+                oss_ << " (from_vertexset->bitmap_->get_bit(s)";
             }
             oss_ << ") { " << std::endl;
         }
@@ -796,7 +891,7 @@ namespace graphit {
         indent();
         printIndent();
 
-        oss_ << "for(" << node_id_type << " d : g.out_neigh(s)){" << std::endl;
+        oss_ << "for(" << node_id_type << " d : " << out_neigh << "){" << std::endl;
         indent();
         printIndent();
 
@@ -813,7 +908,7 @@ namespace graphit {
 
             } else {
                 //the input expression is a vertex subset
-                oss_ << " (to_vertexset->bool_map_[s] ";
+                oss_ << " (to_vertexset->bitmap_->get_bit(s)";
             }
             oss_ << ") { " << std::endl;
         }
@@ -824,9 +919,9 @@ namespace graphit {
 
         // generating the C++ code for the apply function call
         if (apply->is_weighted) {
-            oss_ << " apply_func ( s , d.v, d.w )";
+            oss_ << " " << apply_func_name << " ( s , d.v, d.w )";
         } else {
-            oss_ << " apply_func ( s , d  )";
+            oss_ << " " << apply_func_name << " ( s , d  )";
 
         }
 
@@ -839,7 +934,7 @@ namespace graphit {
             //TODO: fix later
             oss_ << " ) { " << std::endl;
             printIndent();
-            oss_ << "next[" << dst_type <<  "] = 1; " << std::endl;
+            oss_ << "next->set_bit_atomic(" << dst_type <<  "); " << std::endl;
             dedent();
             printIndent();
             oss_ << "} //end of generating the next frontier" << std::endl;
@@ -873,10 +968,15 @@ namespace graphit {
             oss_ << "} //end of outer for loop" << std::endl;
         }
 
+        if (apply->use_edge_streaming) {
+            oss_ << "  } // end of partition for loop\n";
+        }
+
         //return a new vertexset if no subset vertexset is returned
         if (apply_expr_gen_frontier) {
-            oss_ << "  next_frontier->num_vertices_ = sequence::sum(next, numVertices);\n"
-                    "  next_frontier->bool_map_ = next;\n"
+            oss_ << "  next_frontier->num_vertices_ = next->count();\n"
+                    "  next_frontier->bitmap_ = next;\n"
+                    "  next_frontier->is_dense = true;\n"
                     "  return next_frontier;\n";
         }
     }
@@ -885,7 +985,7 @@ namespace graphit {
             mir::EdgeSetApplyExpr::Ptr apply, bool from_vertexset_specified, bool apply_expr_gen_frontier,
             std::string dst_type) {
 
-        oss_ << "    if (m + outDegrees > numEdges / 20) {\n";
+        oss_ << "    if (use_pull) {\n";
         indent();
         //suppplies the pull based apply function
         printDenseForwardEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
@@ -893,6 +993,7 @@ namespace graphit {
         oss_ << "} else {\n";
         indent();
         //uses a special "push_apply_func", which contains synchronizations for the push direction
+        printFrontierDegrees(from_vertexset_specified);
         printPushEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type
                                              );
         dedent();
@@ -916,6 +1017,10 @@ namespace graphit {
         bool from_vertexset_specified = false;
         string dst_type;
         setupFlags(apply, apply_expr_gen_frontier, from_vertexset_specified, dst_type);
+        if (apply->use_edge_streaming) {
+            genEdgeStreamingPushApplyFunctionDeclBody(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
+            return;
+        }
         setupGlobalVariables(apply, apply_expr_gen_frontier, from_vertexset_specified);
         printPushEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
     }
@@ -935,11 +1040,45 @@ namespace graphit {
         bool from_vertexset_specified = false;
         string dst_type;
         setupFlags(apply, apply_expr_gen_frontier, from_vertexset_specified, dst_type);
+        if (apply->use_edge_streaming) {
+            genEdgeStreamingPushApplyFunctionDeclBody(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
+            return;
+        }
         setupGlobalVariables(apply, apply_expr_gen_frontier, from_vertexset_specified);
         printHybridDenseForwardEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier,
                                                            dst_type);
     }
 
+    // Pushes on streamed edges sweep the partitions of the out edges densely for large frontiers, small
+    // frontiers are pushed sparsely and only read the neighbors of their own vertices
+    void EdgesetApplyFunctionDeclGenerator::genEdgeStreamingPushApplyFunctionDeclBody(mir::EdgeSetApplyExpr::Ptr apply,
+                                                                                      bool from_vertexset_specified,
+                                                                                      bool apply_expr_gen_frontier,
+                                                                                      std::string dst_type) {
+        oss_ << "    int64_t numVertices = g.num_nodes(), numEdges = g.num_edges();\n";
+        printFrontierPool(apply, apply_expr_gen_frontier);
+        if (!from_vertexset_specified) {
+            printDenseForwardEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier,
+                                                         dst_type);
+            return;
+        }
+        printDirectionSwitch(apply);
+        oss_ << "    from_vertexset->toSparse();\n"
+                "    long m = from_vertexset->size();\n"
+                "    bool use_pull = direction_switch.usePull(g, from_vertexset);\n";
+        oss_ << "    if (use_pull) {\n";
+        indent();
+        printDenseForwardEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
+        dedent();
+        oss_ << "} else {\n";
+        indent();
+        if (apply_expr_gen_frontier)
+            printFrontierDegrees(from_vertexset_specified);
+        printPushEdgeTraversalReturnFrontier(apply, from_vertexset_specified, apply_expr_gen_frontier, dst_type);
+        dedent();
+        oss_ << "} //end of else\n";
+    }
+
     void EdgesetApplyFunctionDeclGenerator::genEdgeApplyFunctionSignature(mir::EdgeSetApplyExpr::Ptr apply) {
         auto func_name = genFunctionName(apply);
         func_name += mir_context_->getUniqueNameCounterString();
@@ -951,12 +1090,21 @@ namespace graphit {
         vector<string> templates = vector<string>();
         vector<string> arguments = vector<string>();
 
-        if (apply->is_weighted) {
-            arguments.push_back("WGraph & g");
-        } else {
-            arguments.push_back("Graph & g");
+        // dynamic edgesets are traversed through their delta blocks, the copies built from the CSR arrays
+        // (segments, compressed, streamed, SoA or replicated edges) and the edge based load balance don't exist for them
+        if (getEdgeSetType(apply)->is_dynamic) {
+            bool segmented = mir_context_->edgeset_to_label_to_num_segment.find(mir_var->var.getName())
+                             != mir_context_->edgeset_to_label_to_num_segment.end();
+            if (segmented || apply->use_compressed_edges || apply->use_edge_streaming || apply->use_soa_weights
+                || apply->use_replicated_topology || apply->use_pull_edge_based_load_balance) {
+                std::cout << "the schedule of " << apply->scope_label_name
+                          << " is not supported for edgesets updated with insertEdges/deleteEdges" << std::endl;
+                std::exit(-1);
+            }
         }
 
+        arguments.push_back(getEdgeSetType(apply)->toGraphTypeString() + " & g");
+
         if (apply->from_func) {
             if (mir_context_->isFunction(apply->from_func->function_name->name)) {
                 // the schedule is an input from function
@@ -1124,6 +1272,29 @@ namespace graphit {
             output_name += "_pull_edge_based_load_balance";
         }
 
+        if (apply->use_compressed_edges){
+            output_name += "_compressed_edges";
+        }
+
+        if (apply->use_soa_weights){
+            output_name += apply->reads_weights ? "_soa_weights" : "_soa_ids";
+        }
+
+        if (apply->use_edge_streaming){
+            output_name += "_streamed_edges";
+        }
+
+        if (apply->use_replicated_topology){
+            output_name += "_replicated_topology";
+        }
+
+        // hybrid applies with their own direction thresholds keep their own direction switch
+        if ((mir::isa<mir::HybridDenseEdgeSetApplyExpr>(apply) || mir::isa<mir::HybridDenseForwardEdgeSetApplyExpr>(apply))
+            && (apply->direction_alpha != 20 || apply->direction_beta != 0)){
+            output_name += "_alpha_" + std::to_string(apply->direction_alpha)
+                           + "_beta_" + std::to_string(apply->direction_beta);
+        }
+
         return output_name;
     }
 
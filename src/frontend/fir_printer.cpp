@@ -126,6 +126,9 @@ namespace graphit {
                 case ScalarType::Type::UINT:
                     oss << "uint";
                     break;
+                case ScalarType::Type::INT_64:
+                    oss << "int64";
+                    break;
                 case ScalarType::Type::FLOAT:
                     oss << "float";
                     break;
@@ -307,6 +307,12 @@ namespace graphit {
                 (*schedule_->apply_schedules)[apply_label].num_open_buckets = parameter;
             }  else if (apply_schedule_str == "grain_size"){
                 (*schedule_->apply_schedules)[apply_label].grain_size = parameter;
+            } else if (apply_schedule_str == "stream_buffer_edges"){
+                (*schedule_->apply_schedules)[apply_label].stream_buffer_edges = parameter;
+            } else if (apply_schedule_str == "direction_alpha"){
+                (*schedule_->apply_schedules)[apply_label].direction_alpha = parameter;
+            } else if (apply_schedule_str == "direction_beta"){
+                (*schedule_->apply_schedules)[apply_label].direction_beta = parameter;
 
             } else {
                 std::cout << "unrecognized schedule for apply: " << apply_schedule_str << std::endl;
@@ -364,6 +370,16 @@ namespace graphit {
                         = ApplySchedule::PullLoadBalance::EDGE_BASED;
             } else if (apply_schedule_str == "numa_aware") {
                 (*schedule_->apply_schedules)[apply_label].numa_aware = true;
+            } else if (apply_schedule_str == "compressed_edges") {
+                (*schedule_->apply_schedules)[apply_label].compressed_edges = true;
+            } else if (apply_schedule_str == "replicated_topology") {
+                (*schedule_->apply_schedules)[apply_label].replicated_topology = true;
+            } else if (apply_schedule_str == "soa_weights") {
+                (*schedule_->apply_schedules)[apply_label].soa_weights = true;
+            } else if (apply_schedule_str.compare(0, 14, "segment_cache_") == 0) {
+                (*schedule_->apply_schedules)[apply_label].segment_cache_dir = apply_schedule_str.substr(14);
+            } else if (apply_schedule_str.compare(0, 8, "reorder_") == 0) {
+                (*schedule_->apply_schedules)[apply_label].vertex_reordering = apply_schedule_str.substr(8);
             } else if (apply_schedule_str == "lazy_priority_update"){
                 (*schedule_->apply_schedules)[apply_label].priority_update_type
                         = ApplySchedule::PriorityUpdateType::REDUCTION_BEFORE_UPDATE;
@@ -591,6 +607,18 @@ namespace graphit {
 
         }
 
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyDirectionThresholds(std::string apply_label,
+                                                                                 int alpha,
+                                                                                 int beta) {
+            if (alpha <= 0 || beta < 0) {
+                std::cout << "unsupported direction thresholds: alpha " << alpha << ", beta " << beta << std::endl;
+                throw "Unsupported Schedule!";
+            }
+            setApply(apply_label, "direction_alpha", alpha);
+            return setApply(apply_label, "direction_beta", beta);
+        }
+
         high_level_schedule::ProgramScheduleNode::Ptr
         high_level_schedule::ProgramScheduleNode::configParForGrainSize(std::string apply_label, int grain_size) {
 
@@ -837,6 +865,18 @@ namespace graphit {
 
         }
 
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplySegmentCache(std::string apply_label,
+                                                                          std::string cache_dir) {
+            if (cache_dir == "") {
+                std::cout << "segment cache needs a directory" << std::endl;
+                throw "Unsupported Schedule!";
+            }
+            if (cache_dir.rfind("argv[", 0) == 0)
+                cache_dir = "argv[" + std::to_string(-1 * extractArgvNumFromStringArg(cache_dir)) + "]";
+            return setApply(apply_label, "segment_cache_" + cache_dir);
+        }
+
         high_level_schedule::ProgramScheduleNode::Ptr
         high_level_schedule::ProgramScheduleNode::configApplyNumSSG(std::string apply_label, std::string config,
                                                                     int num_segment, std::string direction) {
@@ -915,6 +955,105 @@ namespace graphit {
                 return this->shared_from_this();
         }
 
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyEdgeCompression(std::string apply_label,
+                                                                             std::string config) {
+            if (config == "delta-varint") {
+                return setApply(apply_label, "compressed_edges");
+            } else if (config == "none") {
+                return this->shared_from_this();
+            } else {
+                std::cout << "unsupported edge compression: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyWeightLayout(std::string apply_label,
+                                                                          std::string config) {
+            if (config == "soa") {
+                return setApply(apply_label, "soa_weights");
+            } else if (config == "aos") {
+                return this->shared_from_this();
+            } else {
+                std::cout << "unsupported weight layout: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyTopologyReplication(std::string apply_label,
+                                                                                 std::string config) {
+            if (config == "sockets") {
+                auto node = setApply(apply_label, "replicated_topology");
+                // the copies are read by pinned threads, pin them to sockets unless the program says otherwise
+                if (schedule_->numa_placement == "")
+                    schedule_->numa_placement = "sockets";
+                return node;
+            } else if (config == "none") {
+                return this->shared_from_this();
+            } else {
+                std::cout << "unsupported topology replication: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyEdgeStreaming(std::string apply_label,
+                                                                           std::string config,
+                                                                           int buffer_edges) {
+            if (config == "semi-external") {
+                if (buffer_edges <= 0) {
+                    std::cout << "edge streaming needs a positive buffer size: " << buffer_edges << std::endl;
+                    throw "Unsupported Schedule!";
+                }
+                return setApply(apply_label, "stream_buffer_edges", buffer_edges);
+            } else if (config == "none") {
+                return setApply(apply_label, "stream_buffer_edges", 0);
+            } else {
+                std::cout << "unsupported edge streaming: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configApplyVertexReordering(std::string apply_label,
+                                                                              std::string config) {
+            if (config == "degree" || config == "hub-sort" || config == "hub-cluster"
+                || config == "rcm" || config == "gorder" || config == "none") {
+                return setApply(apply_label, "reorder_" + config);
+            } else {
+                std::cout << "unsupported vertex reordering: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configHugePages(std::string config) {
+            if (config != "thp" && config != "hugetlb" && config != "off") {
+                std::cout << "unsupported huge page option: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+            if (schedule_ == nullptr) {
+                schedule_ = new Schedule();
+            }
+            schedule_->huge_pages = config;
+            return this->shared_from_this();
+        }
+
+        high_level_schedule::ProgramScheduleNode::Ptr
+        high_level_schedule::ProgramScheduleNode::configNUMAPlacement(std::string config) {
+            if (config != "cores" && config != "sockets" && config != "off") {
+                std::cout << "unsupported NUMA placement option: " << config << std::endl;
+                throw "Unsupported Schedule!";
+            }
+            if (schedule_ == nullptr) {
+                schedule_ = new Schedule();
+            }
+            schedule_->numa_placement = config;
+            return this->shared_from_this();
+        }
+
         high_level_schedule::ProgramScheduleNode::Ptr
         high_level_schedule::ProgramScheduleNode::configApplyPriorityUpdateDelta(std::string apply_label, int delta) {
             return setApply(apply_label, "delta", delta);
@@ -954,7 +1093,15 @@ namespace graphit {
                     256,
                     false, // enable_numa_aware?
                     1000, // merge threshold for eager prioirty queue
-                    128   // default number of open buckets for lazy priority queue
+                    128,  // default number of open buckets for lazy priority queue
+                    false, // traverse the uncompressed edgeset
+                    false, // a single copy of the edgeset topology
+                    false, // neighbor IDs and weights stored together
+                    0, // keep the edges in memory instead of streaming them from disk
+                    "none", // keep the vertex IDs of the input graph
+                    20, // pull once the frontier and its out edges exceed 1/20 of the edges
+                    0, // no hysteresis, the direction is picked every round
+                    "" // segments are built on every run
             };
         }
 
@@ -1697,6 +1697,7 @@ namespace graphit {
             case Token::Type::INT:
             case Token::Type::UINT:
             case Token::Type::UINT_64:
+            case Token::Type::INT_64:
             case Token::Type::FLOAT:
             case Token::Type::BOOL:
             case Token::Type::COMPLEX:
@@ -1889,6 +1890,7 @@ namespace graphit {
             case Token::Type::INT:
             case Token::Type::UINT:
             case Token::Type::UINT_64:
+            case Token::Type::INT_64:
             case Token::Type::FLOAT:
             case Token::Type::DOUBLE:
             case Token::Type::BOOL:
@@ -2029,6 +2031,10 @@ namespace graphit {
                 consume(Token::Type::UINT_64);
                 scalarType->type = fir::ScalarType::Type::UINT_64;
                 break;
+            case Token::Type::INT_64:
+                consume(Token::Type::INT_64);
+                scalarType->type = fir::ScalarType::Type::INT_64;
+                break;
             case Token::Type::FLOAT:
                 consume(Token::Type::FLOAT);
                 scalarType->type = fir::ScalarType::Type::FLOAT;
@@ -2787,6 +2793,9 @@ namespace graphit {
         intrinsics_.push_back("getOutDegree");
         intrinsics_.push_back("getNgh");
         intrinsics_.push_back("relabel");
+        intrinsics_.push_back("publish");
+        intrinsics_.push_back("insertEdges");
+        intrinsics_.push_back("deleteEdges");
 
         // library functions for vertexset
         intrinsics_.push_back("getVertexSetSize");
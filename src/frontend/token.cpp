@@ -38,6 +38,8 @@ namespace graphit {
                 return "'uint'";
             case Token::Type::UINT_64:
                 return "'uint64_t'";
+            case Token::Type::INT_64:
+                return "'int64'";
             case Token::Type::FLOAT:
                 return "'float'";
             case Token::Type::DOUBLE:
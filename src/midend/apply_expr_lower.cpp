@@ -12,6 +12,177 @@ namespace graphit {
         for (auto function : functions) {
             lower_apply_expr.rewrite(function);
         }
+
+        // every apply on a semi-external edgeset has to stream it, not just the scheduled ones
+        if (!mir_context_->streamed_edgesets.empty()) {
+            auto mark_streamed_apply_expr = MarkStreamedApplyExpr(mir_context_);
+            for (auto function : mir_context_->getFunctionList()) {
+                function->accept(&mark_streamed_apply_expr);
+            }
+            // the edges are not in memory to build compressed copies or segments from
+            for (auto edgeset_name : mir_context_->streamed_edgesets) {
+                mir_context_->compressed_edgesets.erase(edgeset_name);
+                mir_context_->soa_weighted_edgesets.erase(edgeset_name);
+                mir_context_->replicated_edgesets.erase(edgeset_name);
+                mir_context_->edgeset_to_label_to_num_segment.erase(edgeset_name);
+                mir_context_->reordered_edgesets.erase(edgeset_name);
+            }
+            for (auto stmt : mir_context_->edgeset_alloc_stmts) {
+                auto assign_stmt = mir::to<mir::AssignStmt>(stmt);
+                auto edgeset_name = mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName();
+                if (mir_context_->streamed_edgesets.find(edgeset_name) != mir_context_->streamed_edgesets.end()
+                    && mir::isa<mir::EdgeSetLoadExpr>(assign_stmt->expr)) {
+                    mir::to<mir::EdgeSetLoadExpr>(assign_stmt->expr)->vertex_reordering = "";
+                }
+            }
+        }
+
+        // the plain neighbor arrays of an edgeset can go once it is compressed if nothing else reads them
+        if (!mir_context_->compressed_edgesets.empty()) {
+            auto find_uncompressed_applies = FindUncompressedApplies();
+            for (auto function : mir_context_->getFunctionList()) {
+                function->accept(&find_uncompressed_applies);
+            }
+            for (auto edgeset_name : mir_context_->compressed_edgesets) {
+                if (find_uncompressed_applies.edgesets.count(edgeset_name) == 0
+                    && mir_context_->soa_weighted_edgesets.count(edgeset_name) == 0
+                    && mir_context_->replicated_edgesets.count(edgeset_name) == 0
+                    && mir_context_->edgeset_to_label_to_num_segment.count(edgeset_name) == 0)
+                    mir_context_->compressed_only_edgesets.insert(edgeset_name);
+            }
+        }
+
+        // the array of structs neighbors of an edgeset can go once its soa copy is built if nothing else reads them
+        if (!mir_context_->soa_weighted_edgesets.empty()) {
+            auto find_non_soa_uses = FindNonSoAUses();
+            for (auto function : mir_context_->getFunctionList()) {
+                function->accept(&find_non_soa_uses);
+            }
+            for (auto edgeset_name : mir_context_->soa_weighted_edgesets) {
+                if (find_non_soa_uses.edgesets.count(edgeset_name) == 0
+                    && mir_context_->compressed_edgesets.count(edgeset_name) == 0
+                    && mir_context_->replicated_edgesets.count(edgeset_name) == 0
+                    && mir_context_->edgeset_to_label_to_num_segment.count(edgeset_name) == 0)
+                    mir_context_->soa_only_edgesets.insert(edgeset_name);
+            }
+        }
+
+        // directed graphs only need their inverse if some schedule reads the in-edges,
+        // push-only programs load just the out-edges
+        auto find_inverse_uses = FindInverseUses();
+        for (auto function : mir_context_->getFunctionList()) {
+            function->accept(&find_inverse_uses);
+        }
+        std::set<std::string> loaded_edgesets;
+        for (auto stmt : mir_context_->edgeset_alloc_stmts) {
+            auto assign_stmt = mir::to<mir::AssignStmt>(stmt);
+            if (mir::isa<mir::EdgeSetLoadExpr>(assign_stmt->expr))
+                loaded_edgesets.insert(mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName());
+        }
+        for (auto edgeset_name : find_inverse_uses.edgesets) {
+            if (find_inverse_uses.transposed_edgesets.find(edgeset_name) != find_inverse_uses.transposed_edgesets.end())
+                continue;
+            // an edgeset we can't trace back to its load (e.g. a function argument) could be any of them
+            if (loaded_edgesets.find(edgeset_name) == loaded_edgesets.end())
+                return;
+        }
+        for (auto stmt : mir_context_->edgeset_alloc_stmts) {
+            auto assign_stmt = mir::to<mir::AssignStmt>(stmt);
+            auto edgeset_name = mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName();
+            if (!mir::isa<mir::EdgeSetLoadExpr>(assign_stmt->expr)
+                || find_inverse_uses.edgesets.find(edgeset_name) != find_inverse_uses.edgesets.end()
+                // reordering a directed graph ranks the vertices by their in-edges too
+                || mir_context_->reordered_edgesets.find(edgeset_name) != mir_context_->reordered_edgesets.end())
+                continue;
+            mir::to<mir::EdgeSetLoadExpr>(assign_stmt->expr)->build_inverse = false;
+        }
+    }
+
+    void ApplyExprLower::FindNonSoAUses::visitApply(mir::EdgeSetApplyExpr::Ptr apply) {
+        if (!apply->use_soa_weights)
+            apply->target->accept(this);
+    }
+
+    void ApplyExprLower::FindNonSoAUses::visit(mir::Call::Ptr call) {
+        // builtins that only read the offsets, the vertex count or the vertex permutation
+        static const std::set<std::string> offset_builtins = {
+                "builtin_getVertices", "builtin_getOutDegree", "builtin_getOutDegrees",
+                "builtin_getOutDegreesUint", "builtin_getOutDegreesPvec",
+                "builtin_toNewID", "builtin_toOldID", "builtin_toInputOrder"};
+        if (offset_builtins.count(call->name) == 0) {
+            mir::MIRVisitor::visit(call);
+            return;
+        }
+        for (int i = 1; i < call->args.size(); i++)
+            call->args[i]->accept(this);
+    }
+
+    void ApplyExprLower::FindNonSoAUses::visit(mir::VarExpr::Ptr var_expr) {
+        if (mir::isa<mir::EdgeSetType>(var_expr->var.getType()))
+            edgesets.insert(var_expr->var.getName());
+    }
+
+    void ApplyExprLower::FindInverseUses::addInverseUse(mir::Expr::Ptr edgeset) {
+        if (edgeset != nullptr && mir::isa<mir::VarExpr>(edgeset))
+            edgesets.insert(mir::to<mir::VarExpr>(edgeset)->var.getName());
+    }
+
+    void ApplyExprLower::FindInverseUses::visit(mir::PullEdgeSetApplyExpr::Ptr apply) {
+        addInverseUse(apply->target);
+        mir::MIRVisitor::visit(apply);
+    }
+
+    void ApplyExprLower::FindInverseUses::visit(mir::HybridDenseEdgeSetApplyExpr::Ptr apply) {
+        addInverseUse(apply->target);
+        mir::MIRVisitor::visit(apply);
+    }
+
+    void ApplyExprLower::FindInverseUses::visit(mir::VarDecl::Ptr var_decl) {
+        if (var_decl->initVal != nullptr && mir::isa<mir::Call>(var_decl->initVal)
+            && mir::to<mir::Call>(var_decl->initVal)->name == "builtin_transpose")
+            transposed_edgesets.insert(var_decl->name);
+        mir::MIRVisitor::visit(var_decl);
+    }
+
+    void ApplyExprLower::FindInverseUses::visit(mir::AssignStmt::Ptr assign_stmt) {
+        if (mir::isa<mir::VarExpr>(assign_stmt->lhs) && mir::isa<mir::Call>(assign_stmt->expr)
+            && mir::to<mir::Call>(assign_stmt->expr)->name == "builtin_transpose")
+            transposed_edgesets.insert(mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName());
+        mir::MIRVisitor::visit(assign_stmt);
+    }
+
+    void ApplyExprLower::FindInverseUses::visit(mir::Call::Ptr call) {
+        if (call->name == "getRandomInNgh" && !call->args.empty())
+            addInverseUse(call->args[0]);
+        mir::MIRVisitor::visit(call);
+    }
+
+    bool ApplyExprLower::LowerApplyExpr::readsWeight(std::string apply_func_name) {
+        // extern apply functions may read anything
+        if (!mir_context_->isFunction(apply_func_name))
+            return true;
+        auto apply_func = mir_context_->getFunction(apply_func_name);
+        // the weight is the third argument of an apply function on a weighted edgeset
+        if (apply_func->args.size() < 3 || apply_func->body == nullptr)
+            return true;
+        auto find_var_reads = FindVarReads(apply_func->args[2].getName());
+        apply_func->body->accept(&find_var_reads);
+        return find_var_reads.found;
+    }
+
+    void ApplyExprLower::FindUncompressedApplies::addApply(mir::EdgeSetApplyExpr::Ptr apply) {
+        if (!apply->use_compressed_edges)
+            edgesets.insert(mir::to<mir::VarExpr>(apply->target)->var.getName());
+    }
+
+    void ApplyExprLower::MarkStreamedApplyExpr::markApply(mir::EdgeSetApplyExpr::Ptr apply) {
+        auto edgeset_name = mir::to<mir::VarExpr>(apply->target)->var.getName();
+        if (mir_context_->streamed_edgesets.find(edgeset_name) != mir_context_->streamed_edgesets.end()) {
+            apply->use_edge_streaming = true;
+            apply->use_compressed_edges = false;
+            apply->use_soa_weights = false;
+            apply->use_replicated_topology = false;
+        }
     }
 
     void ApplyExprLower::LowerApplyExpr::visit(mir::VertexSetApplyExpr::Ptr vertexset_apply) {
@@ -94,6 +265,9 @@ namespace graphit {
                     mir::to<mir::EdgeSetApplyExpr>(node)->scope_label_name = apply_schedule->second.scope_label_name;
                     mir_context_->edgeset_to_label_to_num_segment[edgeset_expr->var.getName()][apply_schedule->second.scope_label_name] =
                             apply_schedule->second.num_segment;
+                    if (apply_schedule->second.segment_cache_dir != "")
+                        mir_context_->edgeset_to_label_to_segment_cache[edgeset_expr->var.getName()][apply_schedule->second.scope_label_name] =
+                                apply_schedule->second.segment_cache_dir;
                 }
 
                 //Check to see if it is parallel or serial
@@ -103,10 +277,58 @@ namespace graphit {
                     mir::to<mir::EdgeSetApplyExpr>(node)->is_parallel = false;
                 }
 
+                mir::to<mir::EdgeSetApplyExpr>(node)->direction_alpha = apply_schedule->second.direction_alpha;
+                mir::to<mir::EdgeSetApplyExpr>(node)->direction_beta = apply_schedule->second.direction_beta;
+
                 if (apply_schedule->second.opt == ApplySchedule::OtherOpt::SLIDING_QUEUE) {
                     mir::to<mir::EdgeSetApplyExpr>(node)->use_sliding_queue = true;
                 }
 
+                if (apply_schedule->second.compressed_edges) {
+                    mir::to<mir::EdgeSetApplyExpr>(node)->use_compressed_edges = true;
+                    mir_context_->compressed_edgesets.insert(edgeset_expr->var.getName());
+                }
+
+                if (apply_schedule->second.soa_weights && edgeset_apply->is_weighted
+                    && !apply_schedule->second.compressed_edges) {
+                    auto apply = mir::to<mir::EdgeSetApplyExpr>(node);
+                    apply->use_soa_weights = true;
+                    // the push version of a hybrid apply is a clone of the same function
+                    apply->reads_weights = readsWeight(apply->input_function->function_name->name);
+                    mir_context_->soa_weighted_edgesets.insert(edgeset_expr->var.getName());
+                }
+
+                if (apply_schedule->second.replicated_topology) {
+                    // the apply functions read the neighbors through the replicated accessors
+                    mir::to<mir::EdgeSetApplyExpr>(node)->use_replicated_topology = true;
+                    mir_context_->replicated_edgesets.insert(edgeset_expr->var.getName());
+                }
+
+                if (apply_schedule->second.stream_buffer_edges > 0) {
+                    // load only the offsets of the edgeset, the edges are streamed by the apply functions
+                    mir_context_->streamed_edgesets.insert(edgeset_expr->var.getName());
+                    for (auto stmt : mir_context_->edgeset_alloc_stmts) {
+                        auto assign_stmt = mir::to<mir::AssignStmt>(stmt);
+                        if (mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName() == edgeset_expr->var.getName()) {
+                            mir::to<mir::EdgeSetLoadExpr>(assign_stmt->expr)->stream_buffer_edges
+                                    = apply_schedule->second.stream_buffer_edges;
+                        }
+                    }
+                }
+
+                if (apply_schedule->second.vertex_reordering != "none") {
+                    // relabel the vertices of the edgeset right after it is loaded
+                    mir_context_->reordered_edgesets[edgeset_expr->var.getName()]
+                            = apply_schedule->second.vertex_reordering;
+                    for (auto stmt : mir_context_->edgeset_alloc_stmts) {
+                        auto assign_stmt = mir::to<mir::AssignStmt>(stmt);
+                        if (mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName() == edgeset_expr->var.getName()) {
+                            mir::to<mir::EdgeSetLoadExpr>(assign_stmt->expr)->vertex_reordering
+                                    = apply_schedule->second.vertex_reordering;
+                        }
+                    }
+                }
+
                 if (apply_schedule->second.pull_frontier_type == ApplySchedule::PullFrontierType ::BITVECTOR) {
                     mir::to<mir::EdgeSetApplyExpr>(node)->use_pull_frontier_bitvector = true;
                 }
@@ -119,6 +119,7 @@ bool graphit::AtomicsOpLower::ApplyExprVisitor::lowerCompareAndSwap(mir::FuncExp
                     }
 
                     if (scalar_type->type == mir::ScalarType::Type::INT
+                        || scalar_type->type == mir::ScalarType::Type::INT_64
                         || scalar_type->type == mir::ScalarType::Type::FLOAT){
                         // the tensor has to be of CAS compaitlbe type, currently we only do int and floats
                         // now we can set the expression
@@ -276,6 +277,7 @@ void graphit::AtomicsOpLower::ReduceStmtLower::visit(graphit::mir::ReduceStmt::P
         if (mir::isa<mir::ScalarType>(field_type)){
             mir::ScalarType::Ptr scalar_type = mir::to<mir::ScalarType>(field_type);
             if (scalar_type->type == mir::ScalarType::Type::INT
+                || scalar_type->type == mir::ScalarType::Type::INT_64
                 || scalar_type->type == mir::ScalarType::Type::FLOAT
                 || scalar_type->type == mir::ScalarType::Type::DOUBLE) {
                 //update the type to atomic op
@@ -303,6 +305,7 @@ void graphit::AtomicsOpLower::ReduceStmtLower::visit(graphit::mir::ReduceStmt::P
                 //check if it is an supported type for atomic operations
                 mir::ScalarType::Ptr scalar_type = mir::to<mir::ScalarType>(local_field_type);
                     if (scalar_type->type == mir::ScalarType::Type::INT
+                        || scalar_type->type == mir::ScalarType::Type::INT_64
                         || scalar_type->type == mir::ScalarType::Type::FLOAT
                         || scalar_type->type == mir::ScalarType::Type::DOUBLE) {
                         //update the type to atomic op
@@ -205,6 +205,10 @@ namespace graphit {
             auto expr = to<mir::EdgeSetLoadExpr>(node);
             file_name = expr->file_name->clone<Expr>();
             is_weighted_ = expr->is_weighted_;
+            weight_type_ = expr->weight_type_;
+            stream_buffer_edges = expr->stream_buffer_edges;
+            vertex_reordering = expr->vertex_reordering;
+            build_inverse = expr->build_inverse;
         }
 
 
@@ -233,6 +237,7 @@ namespace graphit {
         void VertexSetApplyExpr::copy(MIRNode::Ptr node) {
             const auto expr = to<VertexSetApplyExpr>(node);
             ApplyExpr::copy(expr);
+            input_order_edgeset = expr->input_order_edgeset;
         }
 
 
@@ -257,6 +262,8 @@ namespace graphit {
             is_parallel = expr->is_parallel;
             enable_deduplication = expr->enable_deduplication;
             is_weighted = expr->is_weighted;
+            direction_alpha = expr->direction_alpha;
+            direction_beta = expr->direction_beta;
             scope_label_name = expr->scope_label_name;
         }
 
@@ -681,6 +688,7 @@ namespace graphit {
             auto type_node = to<mir::EdgeSetType>(node);
             element = type_node->element->clone<ElementType>();
             weight_type = type_node->weight_type->clone<ScalarType>();
+            is_dynamic = type_node->is_dynamic;
         }
 
 
@@ -177,6 +177,10 @@ namespace graphit {
                 output->type = mir::ScalarType::Type::UINT_64;
                 retType = output;
                 break;
+            case fir::ScalarType::Type::INT_64:
+                output->type = mir::ScalarType::Type::INT_64;
+                retType = output;
+                break;
             case fir::ScalarType::Type::FLOAT:
                 output->type = mir::ScalarType::Type::FLOAT;
                 retType = output;
@@ -561,6 +565,11 @@ namespace graphit {
             mir_call_expr->generic_type = ctx->getVectorItemType(target_expr->ident);
             mir_call_expr->name = method_call_expr->method_name->ident;
 
+            // edgesets updated in place are declared and traversed as dynamic graphs
+            if ((mir_call_expr->name == "builtin_insertEdges" || mir_call_expr->name == "builtin_deleteEdges")
+                && mir::isa<mir::EdgeSetType>(mir_target_type))
+                mir::to<mir::EdgeSetType>(mir_target_type)->is_dynamic = true;
+
             std::vector<mir::Expr::Ptr> args;
             const auto self_arg = emitExpr(method_call_expr->target);
             //add the target to the argument
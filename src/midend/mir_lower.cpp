@@ -6,6 +6,7 @@
 #include <graphit/midend/physical_data_layout_lower.h>
 #include <graphit/midend/apply_expr_lower.h>
 #include <graphit/midend/intersection_expr_lower.h>
+#include <graphit/midend/vertex_reorder_lower.h>
 #include <graphit/midend/par_for_lower.h>
 #include <graphit/midend/vector_op_lower.h>
 #include <graphit/midend/change_tracking_lower.h>
@@ -28,6 +29,12 @@ namespace graphit {
         // before performing any analysis
         UDFReuseFinder(mir_context).lower();
 
+        // The huge page and NUMA placements apply to the whole program, the main function sets them up
+        if (schedule != nullptr) {
+            mir_context->huge_pages = schedule->huge_pages;
+            mir_context->numa_placement = schedule->numa_placement;
+        }
+
         //lower global vector assignment to vector operations
         GlobalFieldVectorLower(mir_context).lower();
 
@@ -48,6 +55,10 @@ namespace graphit {
         //  sets the flags for other parts of the lowering process
         ApplyExprLower(mir_context, schedule).lower();
 
+        // This pass renumbers the vertices read from the command line (atoi(argv[i])) for edgesets
+        // with a vertex reordering schedule, since the program runs on the relabeled graph
+        VertexReorderLower(mir_context).lower();
+
         // This pass sets properties of intersection operations based on scheduling languages.
         // intersection types: HiroshiIntersection, Naive, Multiskip, Binary, Combined
         // If there is no schedule specified, it just chooses naive intersection.
@@ -14,8 +14,13 @@ namespace graphit {
         //reset the tensor reads
         auto lower_tensor_read = LowerTensorRead(schedule_);
         auto lower_vertexset_layout = LowerVertexsetDecl(schedule_);
+        auto find_vertex_valued_vectors = FindVertexValuedVectors(mir_context_);
         std::vector<mir::FuncDecl::Ptr> functions = mir_context_->getFunctionList();
 
+        for (auto function : functions) {
+            function->accept(&find_vertex_valued_vectors);
+        }
+
         for (auto stmt : mir_context_->field_vector_init_stmts) {
             lower_tensor_read.rewrite(stmt);
         }
@@ -153,6 +158,21 @@ namespace graphit {
 
     }
 
+    void PhysicalDataLayoutLower::FindVertexValuedVectors::visit(mir::AssignStmt::Ptr assign_stmt) {
+        mir::MIRVisitor::visit(assign_stmt);
+        if (!mir::isa<mir::TensorReadExpr>(assign_stmt->lhs) || !mir::isa<mir::VarExpr>(assign_stmt->expr))
+            return;
+        auto value_type = mir::to<mir::VarExpr>(assign_stmt->expr)->var.getType();
+        if (!mir::isa<mir::ElementType>(value_type))
+            return;
+        // an int array can't hold 64 bit vertex IDs (-DEDGELONG), the array uses the NodeID type instead
+        auto vector_name = mir::to<mir::TensorReadExpr>(assign_stmt->lhs)->getTargetNameStr();
+        auto item_type = mir_context_->getVectorItemType(vector_name);
+        if (mir::isa<mir::ScalarType>(item_type)
+            && mir::to<mir::ScalarType>(item_type)->type == mir::ScalarType::Type::INT)
+            mir_context_->vertex_valued_vectors.insert(vector_name);
+    }
+
     void PhysicalDataLayoutLower::LowerVertexsetDecl::visit(mir::VarDecl::Ptr var_decl) {
         if (mir::isa<mir::VertexSetType>(var_decl->type)) {
             //attach scheduling labels to vertexset declarations
@@ -31,6 +31,8 @@ namespace graphit {
                 auto edge_set_type = mir::to<mir::EdgeSetType>(edgeset_decl->type);
                 if (edge_set_type->weight_type != nullptr) {
                     edgeset_load_expr->is_weighted_ = true;
+                    if (!edge_set_type->hasDefaultWeightType())
+                        edgeset_load_expr->weight_type_ = edge_set_type->weight_type->toString();
                 }
                 assign_stmt->expr = edgeset_load_expr;
                 mir_context_->edgeset_alloc_stmts.push_back(assign_stmt);
@@ -0,0 +1,253 @@
+//
+// Renumbers the source vertices given on the command line for edgesets
+// loaded with a vertex reordering (configApplyVertexReordering), and
+// prints and returns the per-vertex outputs in the IDs of the input graph
+//
+
+#include <graphit/midend/vertex_reorder_lower.h>
+
+namespace graphit {
+
+    void VertexReorderLower::lower() {
+        if (mir_context_->reordered_edgesets.empty())
+            return;
+
+        // the vertices of a program are the vertices of its edgesets, so the first reordered one is used
+        auto edgeset_decl = mir_context_->getConstEdgeSetByName(mir_context_->reordered_edgesets.begin()->first);
+
+        auto find_argv_vertices = FindArgvVertices(mir_context_);
+        for (auto constant : mir_context_->getConstants()) {
+            constant->accept(&find_argv_vertices);
+        }
+        for (auto function : mir_context_->getFunctionList()) {
+            function->accept(&find_argv_vertices);
+        }
+
+        // only the argv values used as vertices get renumbered, other arguments keep their value
+        std::set<std::string> argv_vertices;
+        for (auto var_name : find_argv_vertices.argv_vars) {
+            if (find_argv_vertices.vertex_vars.find(var_name) != find_argv_vertices.vertex_vars.end())
+                argv_vertices.insert(var_name);
+        }
+        auto edgeset = mir::Var(edgeset_decl->name, edgeset_decl->type);
+        if (!argv_vertices.empty()) {
+            auto translate_argv_vertices = TranslateArgvVertices(argv_vertices, edgeset);
+            for (auto function : mir_context_->getFunctionList()) {
+                function->accept(&translate_argv_vertices);
+            }
+        }
+
+        // the results are indexed by and hold the reordered IDs, the outputs are translated back
+        auto edgeset_type = mir::to<mir::EdgeSetType>(edgeset_decl->type);
+        auto find_vertex_outputs = FindVertexOutputs((*edgeset_type->vertex_element_type_list)[0]->ident);
+        for (auto constant : mir_context_->getConstants()) {
+            constant->accept(&find_vertex_outputs);
+        }
+        for (auto function : mir_context_->getFunctionList()) {
+            function->accept(&find_vertex_outputs);
+        }
+        auto translate_vertex_outputs = TranslateVertexOutputs(mir_context_, find_vertex_outputs, edgeset);
+        for (auto function : mir_context_->getFunctionList()) {
+            function->accept(&translate_vertex_outputs);
+        }
+    }
+
+    bool isArgvAtoi(mir::Expr::Ptr expr) {
+        if (expr == nullptr || !mir::isa<mir::Call>(expr))
+            return false;
+        auto call = mir::to<mir::Call>(expr);
+        if (call->name != "atoi" || call->args.size() != 1 || !mir::isa<mir::TensorReadExpr>(call->args[0]))
+            return false;
+        return mir::to<mir::TensorReadExpr>(call->args[0])->getTargetNameStr() == "argv";
+    }
+
+    bool isVertexLiteral(mir::VarDecl::Ptr var_decl) {
+        return var_decl->type != nullptr && mir::isa<mir::ElementType>(var_decl->type)
+               && var_decl->initVal != nullptr && mir::isa<mir::IntLiteral>(var_decl->initVal);
+    }
+
+    void VertexReorderLower::FindArgvVertices::addVertexUse(mir::Expr::Ptr expr) {
+        if (expr != nullptr && mir::isa<mir::VarExpr>(expr))
+            vertex_vars.insert(mir::to<mir::VarExpr>(expr)->var.getName());
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::VarDecl::Ptr var_decl) {
+        if (isArgvAtoi(var_decl->initVal) || isVertexLiteral(var_decl))
+            argv_vars.insert(var_decl->name);
+        if (var_decl->type != nullptr && mir::isa<mir::ElementType>(var_decl->type))
+            vertex_vars.insert(var_decl->name);
+        mir::MIRVisitor::visit(var_decl);
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::AssignStmt::Ptr assign_stmt) {
+        if (mir::isa<mir::VarExpr>(assign_stmt->lhs) && isArgvAtoi(assign_stmt->expr))
+            argv_vars.insert(mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName());
+        mir::MIRVisitor::visit(assign_stmt);
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::TensorReadExpr::Ptr tensor_read) {
+        if (tensor_read->getTargetNameStr() != "argv")
+            addVertexUse(tensor_read->index);
+        mir::MIRVisitor::visit(tensor_read);
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::TensorArrayReadExpr::Ptr tensor_read) {
+        addVertexUse(tensor_read->index);
+        mir::MIRVisitor::visit(tensor_read);
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::Call::Ptr call) {
+        if (call->name == "builtin_addVertex" || call->name == "finishedNode") {
+            // the first argument is the vertexset or the priority queue
+            for (int i = 1; i < call->args.size(); i++)
+                addVertexUse(call->args[i]);
+        } else if (mir_context_->isFunction(call->name)) {
+            auto func_decl = mir_context_->getFunction(call->name);
+            for (int i = 0; i < call->args.size() && i < func_decl->args.size(); i++) {
+                if (mir::isa<mir::ElementType>(func_decl->args[i].getType()))
+                    addVertexUse(call->args[i]);
+            }
+        }
+        mir::MIRVisitor::visit(call);
+    }
+
+    void VertexReorderLower::FindArgvVertices::visit(mir::PriorityQueueAllocExpr::Ptr pq_alloc) {
+        addVertexUse(pq_alloc->starting_node);
+        mir::MIRVisitor::visit(pq_alloc);
+    }
+
+    mir::Call::Ptr edgesetCall(std::string name, mir::Var edgeset, mir::Expr::Ptr arg) {
+        auto edgeset_expr = std::make_shared<mir::VarExpr>();
+        edgeset_expr->var = edgeset;
+        auto call = std::make_shared<mir::Call>();
+        call->name = name;
+        call->args.push_back(edgeset_expr);
+        call->args.push_back(arg);
+        return call;
+    }
+
+    mir::Expr::Ptr VertexReorderLower::TranslateArgvVertices::toNewID(mir::Expr::Ptr vertex) {
+        return edgesetCall("builtin_toNewID", edgeset_, vertex);
+    }
+
+    void VertexReorderLower::TranslateArgvVertices::visit(mir::VarDecl::Ptr var_decl) {
+        if ((isArgvAtoi(var_decl->initVal) || isVertexLiteral(var_decl))
+            && vertices_.find(var_decl->name) != vertices_.end())
+            var_decl->initVal = toNewID(var_decl->initVal);
+        mir::MIRVisitor::visit(var_decl);
+    }
+
+    void VertexReorderLower::TranslateArgvVertices::visit(mir::AssignStmt::Ptr assign_stmt) {
+        if (mir::isa<mir::VarExpr>(assign_stmt->lhs) && isArgvAtoi(assign_stmt->expr)
+            && vertices_.find(mir::to<mir::VarExpr>(assign_stmt->lhs)->var.getName()) != vertices_.end())
+            assign_stmt->expr = toNewID(assign_stmt->expr);
+        mir::MIRVisitor::visit(assign_stmt);
+    }
+
+    bool VertexReorderLower::FindVertexOutputs::isVertex(mir::Type::Ptr type) {
+        return type != nullptr && mir::isa<mir::ElementType>(type)
+               && mir::to<mir::ElementType>(type)->ident == vertex_type_;
+    }
+
+    bool VertexReorderLower::FindVertexOutputs::isVertexValue(mir::Expr::Ptr expr) {
+        if (mir::isa<mir::VarExpr>(expr))
+            return isVertex(mir::to<mir::VarExpr>(expr)->var.getType());
+        if (mir::isa<mir::TensorReadExpr>(expr))
+            return vertex_valued_vectors.find(mir::to<mir::TensorReadExpr>(expr)->getTargetNameStr())
+                   != vertex_valued_vectors.end();
+        return false;
+    }
+
+    bool VertexReorderLower::FindVertexOutputs::prints(std::string func_name) {
+        std::set<std::string> visited;
+        std::vector<std::string> worklist = {func_name};
+        while (!worklist.empty()) {
+            auto name = worklist.back();
+            worklist.pop_back();
+            if (!visited.insert(name).second)
+                continue;
+            if (printing_funcs.find(name) != printing_funcs.end())
+                return true;
+            for (auto callee : callees[name])
+                worklist.push_back(callee);
+        }
+        return false;
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::FuncDecl::Ptr func_decl) {
+        current_func_ = func_decl->name;
+        mir::MIRVisitor::visit(func_decl);
+        current_func_ = "";
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::VarDecl::Ptr var_decl) {
+        if (var_decl->type != nullptr && mir::isa<mir::VectorType>(var_decl->type)) {
+            auto vector_type = mir::to<mir::VectorType>(var_decl->type);
+            if (vector_type->element_type != nullptr && vector_type->element_type->ident == vertex_type_)
+                vertex_vectors.insert(var_decl->name);
+            if (isVertex(vector_type->vector_element_type))
+                vertex_valued_vectors.insert(var_decl->name);
+        }
+        mir::MIRVisitor::visit(var_decl);
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::AssignStmt::Ptr assign_stmt) {
+        // vectors of ints that are assigned vertices (parent[dst] = src) hold vertices too
+        if (mir::isa<mir::TensorReadExpr>(assign_stmt->lhs) && mir::isa<mir::VarExpr>(assign_stmt->expr)
+            && isVertexValue(assign_stmt->expr))
+            vertex_valued_vectors.insert(mir::to<mir::TensorReadExpr>(assign_stmt->lhs)->getTargetNameStr());
+        mir::MIRVisitor::visit(assign_stmt);
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::PrintStmt::Ptr print_stmt) {
+        printing_funcs.insert(current_func_);
+        mir::MIRVisitor::visit(print_stmt);
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::Call::Ptr call) {
+        callees[current_func_].insert(call->name);
+        mir::MIRVisitor::visit(call);
+    }
+
+    void VertexReorderLower::FindVertexOutputs::visit(mir::VertexSetApplyExpr::Ptr apply_expr) {
+        callees[current_func_].insert(apply_expr->input_function->function_name->name);
+        mir::MIRVisitor::visit(apply_expr);
+    }
+
+    void VertexReorderLower::TranslateVertexOutputs::visit(mir::FuncDecl::Ptr func_decl) {
+        mir::MIRVisitor::visit(func_decl);
+        // exported functions return their per-vertex results in the input order
+        if (func_decl->type != mir::FuncDecl::Type::EXPORTED || !func_decl->result.isInitialized()
+            || func_decl->body == nullptr)
+            return;
+        auto result_name = func_decl->result.getName();
+        auto result_type = func_decl->result.getType();
+        if (!mir::isa<mir::VectorType>(result_type) || mir::to<mir::VectorType>(result_type)->element_type == nullptr
+            || mir::to<mir::VectorType>(result_type)->element_type->ident != outputs_.vertex_type_)
+            return;
+        auto result_expr = std::make_shared<mir::VarExpr>();
+        result_expr->var = func_decl->result;
+        auto vertex_values = std::make_shared<mir::BoolLiteral>();
+        vertex_values->val = outputs_.vertex_valued_vectors.find(result_name) != outputs_.vertex_valued_vectors.end()
+                             || outputs_.isVertex(mir::to<mir::VectorType>(result_type)->vector_element_type);
+        auto call = edgesetCall("builtin_toInputOrder", edgeset_, result_expr);
+        call->args.push_back(vertex_values);
+        auto call_stmt = std::make_shared<mir::ExprStmt>();
+        call_stmt->expr = call;
+        func_decl->body->insertStmtEnd(call_stmt);
+    }
+
+    void VertexReorderLower::TranslateVertexOutputs::visit(mir::PrintStmt::Ptr print_stmt) {
+        if (outputs_.isVertexValue(print_stmt->expr))
+            print_stmt->expr = edgesetCall("builtin_toOldID", edgeset_, print_stmt->expr);
+        mir::MIRVisitor::visit(print_stmt);
+    }
+
+    void VertexReorderLower::TranslateVertexOutputs::visit(mir::VertexSetApplyExpr::Ptr apply_expr) {
+        if (mir::isa<mir::VarExpr>(apply_expr->target)
+            && mir_context_->isConstVertexSet(mir::to<mir::VarExpr>(apply_expr->target)->var.getName())
+            && outputs_.prints(apply_expr->input_function->function_name->name))
+            apply_expr->input_order_edgeset = edgeset_.getName();
+        mir::MIRVisitor::visit(apply_expr);
+    }
+}
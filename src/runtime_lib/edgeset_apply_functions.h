@@ -27,17 +27,8 @@ VertexSubset<NodeID> * edgeset_apply_push_parallel_sliding_queue_weighted_dedupl
     next_frontier->sliding_queue_ = queue;
     queue->slide_window();
 
-    if (g.get_flags_() == nullptr){
-        //g.get_flags_() = new int[g.num_nodes()]();
-        g.set_flags_( new int[g.num_nodes()]());
-#pragma omp parallel for
-        for (NodeID i = 0; i < g.num_nodes(); i++){
-            g.get_flags_()[i] = 0;
-        }
-    }
-
-
-
+    // stamped with the round, nothing to reset afterwards
+    DeduplicationFlags *flags = g.get_flags_atomic_();
 
 #pragma omp parallel
     {
@@ -47,7 +38,7 @@ VertexSubset<NodeID> * edgeset_apply_push_parallel_sliding_queue_weighted_dedupl
             //since we now have wrap around, try to get the NodeId with mod
             NodeID src = * (queue->shared + (q_iter % queue->max_size));
             for (WNode dst : g.out_neigh(src)) {
-                if ( apply_func(src, dst.v, dst.w) && CAS(&g.get_flags_()[dst.v], 0, 1)) {
+                if ( apply_func(src, dst.v, dst.w) && flags->claim(dst.v)) {
                     lqueue.push_back(dst.v);
                 }
             }
@@ -56,14 +47,7 @@ VertexSubset<NodeID> * edgeset_apply_push_parallel_sliding_queue_weighted_dedupl
     };
 
     next_frontier->num_vertices_ = queue->size();
-
-    // reset the visited flags
-#pragma omp parallel for
-    for (auto q_iter = queue->shared_out_end; q_iter < queue->shared_in; q_iter++){
-        NodeID node = * (queue->shared + (q_iter % queue->max_size));
-        g.get_flags_()[node] = 0;
-    }
-
+    g.return_flags_atomic_(flags);
 
     return next_frontier;
 }
@@ -512,13 +496,6 @@ VertexSubset<NodeID> *edgeset_apply_push_parallel_weighted_deduplicatied_from_ve
 
     from_vertexset->toSparse();
 
-    if (g.get_flags_() == nullptr)
-        g.get_flags_() = new int[numVertices];
-
-    parallel_for (int i = 0; i < numVertices; i++) {
-        g.get_flags_()[i] = 0;
-    }
-
     // We probably need this when we get something that doesn't have a dense set, not sure
     // We can also write our own, the eixsting one doesn't quite work for bitvectors
     from_vertexset->toSparse();
@@ -539,6 +516,9 @@ VertexSubset<NodeID> *edgeset_apply_push_parallel_weighted_deduplicatied_from_ve
     PrintTime("Outdegree Time", out_d_timer.Seconds());
 #endif
 
+    // the flags are stamped with the round, so they don't need to be reset (DeduplicationFlags)
+    DeduplicationFlags *deduplication_flag = g.get_flags_atomic_();
+
     uintT *offsets = degrees;
     long outEdgeCount = sequence::plusScan(offsets, degrees, m);
     uintE *outEdges = newA(uintE, outEdgeCount);
@@ -558,7 +538,7 @@ VertexSubset<NodeID> *edgeset_apply_push_parallel_weighted_deduplicatied_from_ve
         int j = 0;
         for (WNode dst : g.out_neigh(src)) {
                 //using CAS for deduplication
-	  if (apply_func(src, dst.v, dst.w) && CAS(&(g.get_flags_()[dst.v]), 0, 1)) {
+	  if (apply_func(src, dst.v, dst.w) && deduplication_flag->claim(dst.v)) {
                     outEdges[offset + j] = dst.v;
             } else {
                 outEdges[offset + j] = UINT_E_MAX;
@@ -593,6 +573,7 @@ VertexSubset<NodeID> *edgeset_apply_push_parallel_weighted_deduplicatied_from_ve
     // Filter out the empty slots (marked with -1)
     long nextM = sequence::filter(outEdges, nextIndices, outEdgeCount, nonMaxF());
     free(outEdges);
+    g.return_flags_atomic_(deduplication_flag);
 
     free(degrees);
 
@@ -657,20 +638,16 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_deduplicatied_from_ver
         //convert to bit vector
         // this would be an add on optimization (first match Ligra's performance)
 
-        //Bitmap *next = new Bitmap(g.num_nodes());
-        //Bitmap *current_frontier = from_vertexset->bitmap_;
-        bool * next = newA(bool, g.num_nodes());
-        parallel_for (int i = 0; i < numVertices; i++)next[i] = 0;
+        Bitmap *next = new Bitmap(g.num_nodes());
+        Bitmap *current_frontier = from_vertexset->bitmap_;
+        next->reset();
 
         parallel_for (NodeID u = 0; u < g.num_nodes(); u++) {
             //if (to_func(u)) {
                 for (NodeID v : g.in_neigh(u)) {
-                    //if (current_frontier->get_bit(v)) {
-                    if (from_vertexset->bool_map_[v]) {
+                    if (current_frontier->get_bit(v)) {
                         if (pull_func(v, u)) {
-                            //write to a boolena array instead of bit vector
-                            //next->set_bit(u);
-                            next[u] = 1;
+                            next->set_bit_atomic(u);
                             //if (!to_func(u)) break;
                         }
                     }
@@ -678,21 +655,16 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_deduplicatied_from_ver
             //}
         }
 
-        // need to get a count out of the boolean array
-
-        next_frontier->num_vertices_ = sequence::sum(next, numVertices);
-        next_frontier->bool_map_ = next;
+        next_frontier->num_vertices_ = next->count();
+        next_frontier->bitmap_ = next;
+        next_frontier->is_dense = true;
         return next_frontier;
 
     } else {
       //std::cout << "sparse" << std::endl;
       
-        if (g.get_flags_() == nullptr)
-	  g.get_flags_() = new int[numVertices]();
-
-	parallel_for(long i = 0; i < m; i++){
-	  g.get_flags_()[from_vertexset->dense_vertex_set_[i]] = 0;
-	}
+        // the flags are stamped with the round, so they don't need to be reset (DeduplicationFlags)
+        DeduplicationFlags *deduplication_flag = g.get_flags_atomic_();
         //std::cout << "edge apply sparse" << std::endl;
 
 
@@ -714,7 +686,7 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_deduplicatied_from_ver
             int j = 0;
             for (NodeID dst : g.out_neigh(src)) {
                     //using CAS for deduplication, disabled for this library
-	      if (push_func(src, dst) && CAS(&(g.get_flags_()[dst]), 0, 1)) {
+	      if (push_func(src, dst) && deduplication_flag->claim(dst)) {
                         outEdges[offset + j] = dst;
                     //outEdges[offset + j] = dst;
                 } else {
@@ -735,7 +707,7 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_deduplicatied_from_ver
 
         next_frontier->num_vertices_ = nextM;
         next_frontier->dense_vertex_set_ = nextIndices;
-
+        g.return_flags_atomic_(deduplication_flag);
 
         return next_frontier;
 
@@ -797,22 +769,18 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_from_vertexset_to_filt
         //convert to bit vector
         // this would be an add on optimization (first match Ligra's performance)
 
-        //Bitmap *next = new Bitmap(g.num_nodes());
-        //Bitmap *current_frontier = from_vertexset->bitmap_;
-        bool * next = newA(bool, g.num_nodes());
-        parallel_for (int i = 0; i < numVertices; i++)next[i] = 0;
+        Bitmap *next = new Bitmap(g.num_nodes());
+        Bitmap *current_frontier = from_vertexset->bitmap_;
+        next->reset();
 
         int count = 0;
 
         parallel_for (NodeID u = 0; u < g.num_nodes(); u++) {
             if (to_func(u)) {
                 for (NodeID v : g.in_neigh(u)) {
-                    //if (current_frontier->get_bit(v)) {
-                    if (from_vertexset->bool_map_[v]) {
+                    if (current_frontier->get_bit(v)) {
                         if (pull_func(v, u)) {
-                            //write to a boolena array instead of bit vector
-                            //next->set_bit(u);
-                            next[u] = 1;
+                            next->set_bit_atomic(u);
                             if (!to_func(u)) break;
                         }
                     }
@@ -820,10 +788,9 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_from_vertexset_to_filt
             }
         }
 
-        // need to get a count out of the boolean array
-
-        next_frontier->num_vertices_ = sequence::sum(next, numVertices);
-        next_frontier->bool_map_ = next;
+        next_frontier->num_vertices_ = next->count();
+        next_frontier->bitmap_ = next;
+        next_frontier->is_dense = true;
         return next_frontier;
 
     } else {
@@ -849,10 +816,7 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_dense_parallel_from_vertexset_to_filt
             int j = 0;
             for (NodeID dst : g.out_neigh(src)) {
                 if (push_func(src, dst)) {
-                    //using CAS for deduplication, disabled for this library
-//                    if (CAS(&(g.get_flags_()[dst]), 0, 1)) {
-//                        outEdges[offset + j] = dst;
-//                    }
+                    //deduplication (DeduplicationFlags) is disabled for this library
                     outEdges[offset + j] = dst;
                 } else {
                     outEdges[offset + j] = UINT_E_MAX;
@@ -933,39 +897,30 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_denseforward_parallel_weighted_dedupl
         from_vertexset->toDense();
         free(degrees);
 
-//        Deprecated, switch to use boolean arrays due to performance issues
-//        Bitmap * next = new Bitmap(g.num_nodes());
-//        Bitmap * current = from_vertexset->bitmap_;
-//        next->reset();
-
-        bool *next = newA(bool, numVertices);
-        parallel_for (int i = 0; i < numVertices; i++)next[i] = 0;
-        bool *current = from_vertexset->bool_map_;
+        Bitmap * next = new Bitmap(g.num_nodes());
+        Bitmap * current = from_vertexset->bitmap_;
+        next->reset();
 
-        //int64_t count = 0;
-        //#pragma omp parallel for reduction(+ : count)  schedule (dynamic, 1024)
-        parallel_for (NodeID u = 0; u < numVertices; u++) {
-            //if (current->get_bit(u)){
-            if (current[u]) {
+        // only the words of the frontier with a vertex in it are visited
+        parallel_for (int64_t w = 0; w < (int64_t) current->num_words(); w++) {
+            for (uint64_t word = current->word(w); word != 0; word &= word - 1) {
+                NodeID u = w * 64 + __builtin_ctzll(word);
 	      for (WNode s : g.out_neigh(u)) {
                     if (apply_func(u, s.v, s.w)) {
-                        //next->set_bit_atomic(s.v);
-                        //count++;
-                        next[s.v] = 1;
+                        next->set_bit_atomic(s.v);
                     }
                 }
             }
         }
-        next_frontier->num_vertices_ = sequence::sum(next, numVertices);
-        //next_frontier->bitmap_ = next;
-        next_frontier->bool_map_ = next;
+        next_frontier->num_vertices_ = next->count();
+        next_frontier->bitmap_ = next;
+        next_frontier->is_dense = true;
         return next_frontier;
     } else {
 
 
-      if (g.get_flags_() == nullptr){
-        g.get_flags_() = new int[numVertices]();
-      }
+        // the flags are stamped with the round, so they don't need to be reset (DeduplicationFlags)
+        DeduplicationFlags *deduplication_flag = g.get_flags_atomic_();
 
         uintT *offsets = degrees;
         long outEdgeCount = sequence::plusScan(offsets, degrees, m);
@@ -983,7 +938,7 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_denseforward_parallel_weighted_dedupl
             //vert.decodeOutNghSparse(v, o, f, outEdges);
             int j = 0;
 	    for (WNode dst : g.out_neigh(src)) {
-	      if (apply_func(src, dst.v, dst.w) && CAS(&(g.get_flags_()[dst.v]), 0, 1)) {
+	      if (apply_func(src, dst.v, dst.w) && deduplication_flag->claim(dst.v)) {
                         outEdges[offset + j] = dst.v;
 
                 } else {
@@ -1004,9 +959,7 @@ VertexSubset<NodeID> *edgeset_apply_hybrid_denseforward_parallel_weighted_dedupl
 
         next_frontier->num_vertices_ = nextM;
         next_frontier->dense_vertex_set_ = nextIndices;
-	for(int i = 0; i < nextM; i++){
-	  g.get_flags_()[nextIndices[i]] = 0;
-	}
+        g.return_flags_atomic_(deduplication_flag);
 
         return next_frontier;
     }
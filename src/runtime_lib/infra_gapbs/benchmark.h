@@ -28,8 +28,13 @@ Various helper functions to ease writing of kernels
 
 
 // Default type signatures for commonly used types
-//typedef int32_t NodeID;
+// -DEDGELONG (the Ligra/Julienne switch for 64-bit vertex IDs in edge arrays)
+// also selects 64-bit NodeIDs, for graphs beyond 2^31 vertices or edges
+#ifdef EDGELONG
+typedef int64_t NodeID;
+#else
 typedef int32_t NodeID;
+#endif
 
 
 typedef int32_t WeightT;
@@ -44,6 +49,17 @@ typedef BuilderBase<NodeID, WNode, WeightT> WeightedBuilder;
 typedef WriterBase<NodeID, NodeID> Writer;
 typedef WriterBase<NodeID, WNode> WeightedWriter;
 
+// Weighted graphs with other weight types (float, double, int64_t), the
+// typedefs above are the int32_t instances
+template <typename WeightT_>
+using WNodeT = NodeWeight<NodeID, WeightT_>;
+
+template <typename WeightT_>
+using WGraphT = CSRGraph<NodeID, WNodeT<WeightT_>>;
+
+template <typename WeightT_>
+using WeightedBuilderT = BuilderBase<NodeID, WNodeT<WeightT_>, WeightT_>;
+
 
 // Used to pick random non-zero degree starting points for search algorithms
 template<typename GraphT_>
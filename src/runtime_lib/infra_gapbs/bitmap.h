@@ -17,12 +17,15 @@ Author: Scott Beamer
 
 Parallel bitmap that is thread-safe
  - Can set bits in parallel (set_bit_atomic) unlike std::vector<bool>
+ - Dense frontiers (VertexSubset) are bitmaps, count() sizes them with a
+   popcount per word and word() lets loops skip the empty words
 */
 
 
 class Bitmap {
  public:
   explicit Bitmap(size_t size) {
+    size_ = size;
     num_words_ = (size + kBitsPerWord - 1) / kBitsPerWord;
     start_ = new uint64_t[num_words_];
     end_ = start_ + num_words_;
@@ -33,7 +36,9 @@ class Bitmap {
   }
 
   void reset() {
-    std::fill(start_, end_, 0);
+    #pragma omp parallel for
+    for (int64_t i = 0; i < (int64_t) num_words_; i++)
+      start_[i] = 0;
   }
 
   void set_bit(size_t pos) {
@@ -41,41 +46,63 @@ class Bitmap {
   }
 
   void set_bit_atomic(size_t pos) {
-    uint64_t old_val, new_val;
-    do {
-      old_val = start_[word_offset(pos)];
-      new_val = old_val | ((uint64_t) 1l << bit_offset(pos));
-    } while (!compare_and_swap(start_[word_offset(pos)], old_val, new_val));
+    uint64_t bit = (uint64_t) 1l << bit_offset(pos);
+    // skips the locked write if the bit is set already
+    if ((start_[word_offset(pos)] & bit) == 0)
+      __sync_fetch_and_or(&start_[word_offset(pos)], bit);
   }
 
   bool get_bit(size_t pos) const {
     return (start_[word_offset(pos)] >> bit_offset(pos)) & 1l;
   }
 
-//    int getNumSetBits(){
-//      for (int i = 0; i< num_words_; i++) {
-//
-//      }
-//    }
+  uint64_t word(size_t i) const {
+    return start_[i];
+  }
+
+  void set_word(size_t i, uint64_t value) {
+    start_[i] = value;
+  }
+
+  size_t num_words() const {
+    return num_words_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // number of set bits
+  int64_t count() const {
+    int64_t total = 0;
+    #pragma omp parallel for reduction(+ : total)
+    for (int64_t i = 0; i < (int64_t) num_words_; i++)
+      total += __builtin_popcountll(start_[i]);
+    return total;
+  }
 
   void swap(Bitmap &other) {
     std::swap(start_, other.start_);
     std::swap(end_, other.end_);
+    std::swap(size_, other.size_);
+    std::swap(num_words_, other.num_words_);
   }
 
     // a quick API to set all the elements to 1 in bitmap
     void set_all(){
-      reset();
-      //int num_words = sizeof(start_)/sizeof(uint64_t);
-      for (int i = 0; i< num_words_; i++){
-        start_[i] = ~(start_[i]);
-      }
+      #pragma omp parallel for
+      for (int64_t i = 0; i < (int64_t) num_words_; i++)
+        start_[i] = ~(uint64_t) 0;
+      // keep the bits past the end clear, count() and the word loops see them
+      if (bit_offset(size_) != 0)
+        start_[num_words_ - 1] = ((uint64_t) 1l << bit_offset(size_)) - 1;
     }
 
 
 private:
   uint64_t *start_;
   uint64_t *end_;
+  uint64_t size_;
   uint64_t num_words_;
   static const uint64_t kBitsPerWord = 64;
   static uint64_t word_offset(size_t n) { return n / kBitsPerWord; }
@@ -4,21 +4,30 @@
 #ifndef BUILDER_H_
 #define BUILDER_H_
 
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
 #include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
+#include <string>
 #include <type_traits>
 #include <utility>
 
 #include "command_line.h"
 #include "generator.h"
 #include "graph.h"
+#include "graph_store.h"
 #include "platform_atomics.h"
 #include "pvector.h"
 #include "reader.h"
 #include "timer.h"
 #include "util.h"
+#include "writer.h"
 
 
 /*
@@ -31,6 +40,21 @@ Given arguements from the command line (cli), returns a built graph
    MakeGraphFromEL(edgelist) to perform actual graph construction
  - edgelist can be from file (reader) or synthetically generated (generator)
  - Common case: BuilderBase typedef'd (w/ params) to be Builder (benchmark.h)
+ - Graphs built from text files are cached in a serialized side-car file
+   (<input>[.sym].<ID bytes>-<neighbor bytes>[f].cache.sg or .wsg) that
+   later loads read instead, as long as the input's size and mtime and the
+   build options still match. The ID and weight types are part of the name
+   (f for floating point weights), so builds with other types keep their
+   own cache. Caches are written next to the input, or into the directory
+   given by the GRAPHIT_GRAPH_CACHE environment variable or
+   -DGRAPH_CACHE_DIR (disable with -DNO_GRAPH_CACHE)
+ - With -DRADIX_BUILDER (or sorted_build_ set), MakeGraph() radix sorts
+   the edge list into a squished CSR directly (MakeSortedGraphFromEL)
+   instead of squishing the CSR built by MakeGraphFromEL
+ - Without needs_inverse_ directed graphs are built (or read) without their
+   inverse, CSRGraph::buildInverse() adds it later if needed
+ - Filenames of the form store:<name> attach to a graph published in the
+   shared graph store (graph_store.h) instead of building one
 */
 
 
@@ -46,9 +70,17 @@ class BuilderBase {
 
  public:
   bool needs_weights_;
+  bool needs_inverse_;
+  bool sorted_build_;
   explicit BuilderBase(const CLBase &cli) : cli_(cli) {
     symmetrize_ = cli_.symmetrize();
     needs_weights_ = !std::is_same<NodeID_, DestID_>::value;
+    needs_inverse_ = invert;
+#ifdef RADIX_BUILDER
+    sorted_build_ = true;
+#else
+    sorted_build_ = false;
+#endif
   }
 
   DestID_ GetSource(EdgePair<NodeID_, NodeID_> e) {
@@ -59,6 +91,14 @@ class BuilderBase {
     return NodeWeight<NodeID_, WeightT_>(e.u, e.v.w);
   }
 
+  static NodeID_ GetID(NodeID_ n) {
+    return n;
+  }
+
+  static NodeID_ GetID(NodeWeight<NodeID_, WeightT_> n) {
+    return n.v;
+  }
+
   NodeID_ FindMaxNodeID(const EdgeList &el) {
     NodeID_ max_seen = 0;
     #pragma omp parallel for reduction(max : max_seen)
@@ -97,42 +137,13 @@ class BuilderBase {
 
   static
   pvector<SGOffset> ParallelPrefixSum(const pvector<NodeID_> &degrees) {
-    const size_t block_size = 1<<20;
-    const size_t num_blocks = (degrees.size() + block_size - 1) / block_size;
-    pvector<SGOffset> local_sums(num_blocks);
-    #pragma omp parallel for
-    for (size_t block=0; block < num_blocks; block++) {
-      SGOffset lsum = 0;
-      size_t block_end = std::min((block + 1) * block_size, degrees.size());
-      for (size_t i=block * block_size; i < block_end; i++)
-        lsum += degrees[i];
-      local_sums[block] = lsum;
-    }
-    pvector<SGOffset> bulk_prefix(num_blocks+1);
-    SGOffset total = 0;
-    for (size_t block=0; block < num_blocks; block++) {
-      bulk_prefix[block] = total;
-      total += local_sums[block];
-    }
-    bulk_prefix[num_blocks] = total;
-    pvector<SGOffset> prefix(degrees.size() + 1);
-    #pragma omp parallel for
-    for (size_t block=0; block < num_blocks; block++) {
-      SGOffset local_total = bulk_prefix[block];
-      size_t block_end = std::min((block + 1) * block_size, degrees.size());
-      for (size_t i=block * block_size; i < block_end; i++) {
-        prefix[i] = local_total;
-        local_total += degrees[i];
-      }
-    }
-    prefix[degrees.size()] = bulk_prefix[num_blocks];
-    return prefix;
+    return ::ParallelPrefixSum(degrees);
   }
 
   // Removes self-loops and redundant edges
   // Side effect: neighbor IDs will be sorted
   void SquishCSR(const CSRGraph<NodeID_, DestID_, invert> &g, bool transpose,
-                 DestID_*** sq_index, DestID_** sq_neighs) {
+                 SGOffset** sq_index, DestID_** sq_neighs) {
     pvector<NodeID_> diffs(g.num_nodes());
     DestID_ *n_start, *n_end;
     #pragma omp parallel for private(n_start, n_end)
@@ -150,24 +161,25 @@ class BuilderBase {
       diffs[n] = new_end - n_start;
     }
     pvector<SGOffset> sq_offsets = ParallelPrefixSum(diffs);
-    *sq_neighs = new DestID_[sq_offsets[g.num_nodes()]];
-    *sq_index = CSRGraph<NodeID_, DestID_>::GenIndex(sq_offsets, *sq_neighs);
+    *sq_neighs = NewNeighborArray<DestID_>(sq_offsets, g.num_nodes());
+    *sq_index = CSRGraph<NodeID_, DestID_>::GenIndex(sq_offsets);
     #pragma omp parallel for private(n_start)
     for (NodeID_ n=0; n < g.num_nodes(); n++) {
       if (transpose)
         n_start = g.in_neigh(n).begin();
       else
         n_start = g.out_neigh(n).begin();
-      std::copy(n_start, n_start+diffs[n], (*sq_index)[n]);
+      std::copy(n_start, n_start+diffs[n], *sq_neighs + sq_offsets[n]);
     }
   }
 
   CSRGraph<NodeID_, DestID_, invert> SquishGraph(
       const CSRGraph<NodeID_, DestID_, invert> &g) {
-    DestID_ **out_index, *out_neighs, **in_index, *in_neighs;
+    SGOffset *out_index, *in_index = nullptr;
+    DestID_ *out_neighs, *in_neighs = nullptr;
     SquishCSR(g, false, &out_index, &out_neighs);
     if (g.directed()) {
-      if (invert)
+      if (invert && g.has_inverse())
         SquishCSR(g, true, &in_index, &in_neighs);
       return CSRGraph<NodeID_, DestID_, invert>(g.num_nodes(), out_index,
                                                 out_neighs, in_index,
@@ -182,15 +194,15 @@ class BuilderBase {
   Graph Bulding Steps (for CSR):
     - Read edgelist once to determine vertex degrees (CountDegrees)
     - Determine vertex offsets by a prefix sum (ParallelPrefixSum)
-    - Allocate storage and set points according to offsets (GenIndex)
+    - Allocate storage and keep a copy of the offsets as index (GenIndex)
     - Copy edges into storage
   */
-  void MakeCSR(const EdgeList &el, bool transpose, DestID_*** index,
+  void MakeCSR(const EdgeList &el, bool transpose, SGOffset** index,
                DestID_** neighs) {
     pvector<NodeID_> degrees = CountDegrees(el, transpose);
     pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
-    *neighs = new DestID_[offsets[num_nodes_]];
-    *index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, *neighs);
+    *neighs = NewNeighborArray<DestID_>(offsets, num_nodes_);
+    *index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets);
     #pragma omp parallel for
     for (auto it = el.begin(); it < el.end(); it++) {
       Edge e = *it;
@@ -202,8 +214,114 @@ class BuilderBase {
     }
   }
 
+  /*
+  Sorted Graph Building Steps (for CSR, -DRADIX_BUILDER):
+    - Copy the edges (both ways if symmetrizing) without self-loops
+    - Stable LSD radix sort of the copies by (source, destination), each
+      pass counts digits per block and then scatters every block in order
+    - Keep the first of each run of equal edges (with the smallest weight)
+      and derive the offsets from where each source's edges start
+  Same result as MakeCSR followed by SquishCSR, but without sorting every
+  neighborhood separately (hubs serialize on those sorts) or building the
+  unsquished CSR
+  */
+  void MakeSortedCSR(const EdgeList &el, bool transpose, SGOffset** index,
+                     DestID_** neighs) {
+    const int64_t block_size = std::max<int64_t>(1 << 16, el.size() / 256);
+    int64_t num_blocks = (el.size() + block_size - 1) / block_size;
+    bool forward = symmetrize_ || !transpose;
+    bool backward = symmetrize_ || transpose;
+    pvector<SGOffset> block_counts(num_blocks + 1);
+    #pragma omp parallel for
+    for (int64_t block=0; block < num_blocks; block++) {
+      SGOffset count = 0;
+      int64_t block_end = std::min<int64_t>((block + 1) * block_size, el.size());
+      for (int64_t i=block * block_size; i < block_end; i++) {
+        if (el[i].u != GetID(el[i].v))
+          count += forward + backward;
+      }
+      block_counts[block] = count;
+    }
+    SGOffset num_copies = ExclusiveSum(block_counts, num_blocks);
+    EdgeList edges(num_copies);
+    #pragma omp parallel for
+    for (int64_t block=0; block < num_blocks; block++) {
+      SGOffset pos = block_counts[block];
+      int64_t block_end = std::min<int64_t>((block + 1) * block_size, el.size());
+      for (int64_t i=block * block_size; i < block_end; i++) {
+        Edge e = el[i];
+        if (e.u == GetID(e.v))
+          continue;
+        if (forward)
+          edges[pos++] = e;
+        if (backward)
+          edges[pos++] = Edge(GetID(e.v), GetSource(e));
+      }
+    }
+    RadixSortEdges(edges);
+
+    // Edges are only kept if they differ from their predecessor
+    const int64_t edge_block_size = std::max<int64_t>(1 << 16, num_copies / 256);
+    int64_t num_edge_blocks = (num_copies + edge_block_size - 1) / edge_block_size;
+    pvector<SGOffset> kept(num_edge_blocks + 1);
+    #pragma omp parallel for
+    for (int64_t block=0; block < num_edge_blocks; block++) {
+      SGOffset count = 0;
+      int64_t block_end = std::min<int64_t>((block + 1) * edge_block_size, num_copies);
+      for (int64_t i=block * edge_block_size; i < block_end; i++) {
+        if (i == 0 || !SameEdge(edges[i-1], edges[i]))
+          count++;
+      }
+      kept[block] = count;
+    }
+    SGOffset num_kept = ExclusiveSum(kept, num_edge_blocks);
+    *neighs = NewArray<DestID_>(num_kept);
+    *index = NewArray<SGOffset>(num_nodes_ + 1);
+    SGOffset *offsets = *index;
+    #pragma omp parallel for
+    for (int64_t block=0; block < num_edge_blocks; block++) {
+      SGOffset pos = kept[block];
+      int64_t block_end = std::min<int64_t>((block + 1) * edge_block_size, num_copies);
+      for (int64_t i=block * edge_block_size; i < block_end; i++) {
+        if (i > 0 && SameEdge(edges[i-1], edges[i]))
+          continue;
+        // the first edge of a source also starts the (empty) neighborhoods
+        // of the sources between it and the previous source
+        if (i == 0 || edges[i-1].u != edges[i].u) {
+          NodeID_ first = i == 0 ? 0 : edges[i-1].u + 1;
+          for (NodeID_ n=first; n <= edges[i].u; n++)
+            offsets[n] = pos;
+        }
+        DestID_ best = edges[i].v;
+        for (int64_t j=i+1; j < num_copies && SameEdge(edges[i], edges[j]); j++) {
+          if (edges[j].v < best)
+            best = edges[j].v;
+        }
+        (*neighs)[pos++] = best;
+      }
+    }
+    NodeID_ first = num_copies == 0 ? 0 : edges[num_copies-1].u + 1;
+    for (NodeID_ n=first; n <= num_nodes_; n++)
+      offsets[n] = num_kept;
+  }
+
+  CSRGraph<NodeID_, DestID_, invert> MakeSortedGraphFromEL(EdgeList &el) {
+    SGOffset *index = nullptr, *inv_index = nullptr;
+    DestID_ *neighs = nullptr, *inv_neighs = nullptr;
+    if (num_nodes_ == -1)
+      num_nodes_ = FindMaxNodeID(el)+1;
+    MakeSortedCSR(el, false, &index, &neighs);
+    if (!symmetrize_ && invert && needs_inverse_)
+      MakeSortedCSR(el, true, &inv_index, &inv_neighs);
+    if (symmetrize_)
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes_, index, neighs);
+    else
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes_, index, neighs,
+                                                inv_index, inv_neighs);
+  }
+
   CSRGraph<NodeID_, DestID_, invert> MakeGraphFromEL(EdgeList &el) {
-    DestID_ **index = nullptr, **inv_index = nullptr;
+    SGOffset *index = nullptr, *inv_index = nullptr;
     DestID_ *neighs = nullptr, *inv_neighs = nullptr;
     Timer t;
     t.Start();
@@ -214,7 +332,7 @@ class BuilderBase {
     //if (needs_weights_)
       //Generator<NodeID_, DestID_, WeightT_>::InsertWeights(el);
     MakeCSR(el, false, &index, &neighs);
-    if (!symmetrize_ && invert)
+    if (!symmetrize_ && invert && needs_inverse_)
       MakeCSR(el, true, &inv_index, &inv_neighs);
     t.Stop();
     //PrintTime("Build Time", t.Seconds());
@@ -225,24 +343,94 @@ class BuilderBase {
                                                 inv_index, inv_neighs);
   }
 
+  // Graphs loaded from a file are tagged with the file's identity (used by
+  // CSRGraph::InFingerprint to key segment caches without reading the edges)
   CSRGraph<NodeID_, DestID_, invert> MakeGraph() {
+    CSRGraph<NodeID_, DestID_, invert> g = BuildGraph();
+    SGSource source;
+    if (!IsGraphStoreName(cli_.filename()) && GetInputSource(source))
+      g.set_source(source);
+    return g;
+  }
+
+  CSRGraph<NodeID_, DestID_, invert> BuildGraph() {
     CSRGraph<NodeID_, DestID_, invert> g;
+    bool cache_graph = false;
+    SGSource source;
     {  // extra scope to trigger earlier deletion of el (save memory)
       EdgeList el;
-      if (cli_.filename() != "") {
+      if (IsGraphStoreName(cli_.filename())) {
+        g = AttachGraph<NodeID_, DestID_, WeightT_, invert>(
+            cli_.filename().substr(sizeof(graph_store::kPrefix) - 1),
+            needs_inverse_);
+        // the graph may have been published without its inverse
+        if (invert && needs_inverse_)
+          g.buildInverse();
+        return g;
+      } else if (cli_.filename() != "") {
         Reader<NodeID_, DestID_, WeightT_, invert> r(cli_.filename());
         if ((r.GetSuffix() == ".sg") || (r.GetSuffix() == ".wsg")) {
-          return r.ReadSerializedGraph();
+          return r.ReadSerializedGraph(true, needs_inverse_);
         } else {
+#ifndef NO_GRAPH_CACHE
+          cache_graph = GetCacheSource(source);
+          if (cache_graph && CacheIsValid(source)) {
+            Reader<NodeID_, DestID_, WeightT_, invert> cache(CacheFilename());
+            return cache.ReadSerializedGraph(true, needs_inverse_);
+          }
+#endif
           el = r.ReadFile(needs_weights_);
         }
       } else if (cli_.scale() != -1) {
         Generator<NodeID_, DestID_> gen(cli_.scale(), cli_.degree());
         el = gen.GenerateEL(cli_.uniform());
       }
-      g = MakeGraphFromEL(el);
+      if (sorted_build_)
+        g = MakeSortedGraphFromEL(el);
+      else
+        g = MakeGraphFromEL(el);
     }
-    return SquishGraph(g);
+    if (!sorted_build_)
+      g = SquishGraph(g);
+    if (cache_graph)
+      WriteCache(g, source);
+    return g;
+  }
+
+  // Keeps only the offsets in memory and streams the neighbors from disk in
+  // partitions of at most buffer_edges edges. Text inputs are streamed from
+  // their cache, which is written out of core (WriteStreamedCache) if it is
+  // missing. Inputs that can't be streamed into a cache are an error.
+  CSRGraph<NodeID_, DestID_, invert> MakeSemiExternalGraph(
+      int64_t buffer_edges) {
+    Reader<NodeID_, DestID_, WeightT_, invert> r(cli_.filename());
+    if ((r.GetSuffix() == ".sg") || (r.GetSuffix() == ".wsg"))
+      return r.ReadSemiExternalGraph(buffer_edges);
+#ifndef NO_GRAPH_CACHE
+    SGSource source;
+    if (GetCacheSource(source)) {
+      if (!CacheIsValid(source) && !WriteStreamedCache(source, buffer_edges)) {
+        std::cout << "Couldn't stream " << cli_.filename() << " into "
+                  << CacheFilename() << " (semi-external text inputs must be "
+                  << ".el, .wel, .gr or .mtx)" << std::endl;
+        std::exit(-33);
+      }
+      Reader<NodeID_, DestID_, WeightT_, invert> cache(CacheFilename());
+      return cache.ReadSemiExternalGraph(buffer_edges);
+    }
+#endif
+    std::cout << "Semi-external graphs need a serialized input or a cache for "
+              << cli_.filename() << std::endl;
+    std::exit(-5);
+  }
+
+  std::string CacheFilename() const {
+    std::string suffix = std::is_same<NodeID_, DestID_>::value ? ".sg" : ".wsg";
+    std::string types = "." + std::to_string(sizeof(NodeID_)) + "-" +
+                        std::to_string(sizeof(DestID_)) +
+                        (std::is_floating_point<WeightT_>::value ? "f" : "");
+    return CachedInputPath() + (symmetrize_ ? ".sym" : "") + types + ".cache" +
+           suffix;
   }
 
   // Relabels (and rebuilds) graph by order of decreasing degree
@@ -270,18 +458,384 @@ class BuilderBase {
       new_ids[degree_id_pairs[n].second] = n;
     }
     pvector<SGOffset> offsets = ParallelPrefixSum(degrees);
-    DestID_* neighs = new DestID_[offsets[g.num_nodes()]];
-    DestID_** index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, neighs);
+    DestID_* neighs = NewNeighborArray<DestID_>(offsets, g.num_nodes());
+    SGOffset* index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets);
     #pragma omp parallel for
     for (NodeID_ u=0; u < g.num_nodes(); u++) {
       for (NodeID_ v : g.out_neigh(u))
         neighs[offsets[new_ids[u]]++] = new_ids[v];
-      std::sort(index[new_ids[u]], index[new_ids[u]+1]);
+      std::sort(neighs + index[new_ids[u]], neighs + index[new_ids[u]+1]);
     }
     t.Stop();
     PrintTime("Relabel", t.Seconds());
     return CSRGraph<NodeID_, DestID_, invert>(g.num_nodes(), index, neighs);
   }
+
+ private:
+  static const int kRadixBits = 11;
+
+  static bool SameEdge(const Edge &a, const Edge &b) {
+    return a.u == b.u && GetID(a.v) == GetID(b.v);
+  }
+
+  // Turns per block counts into block starting positions, returns the total
+  static SGOffset ExclusiveSum(pvector<SGOffset> &counts, int64_t num_blocks) {
+    SGOffset total = 0;
+    for (int64_t block=0; block < num_blocks; block++) {
+      SGOffset count = counts[block];
+      counts[block] = total;
+      total += count;
+    }
+    counts[num_blocks] = total;
+    return total;
+  }
+
+  // Stable LSD radix sort by destination and then by source, only passes
+  // over digits that can be non-zero for num_nodes_ vertices
+  void RadixSortEdges(EdgeList &edges) {
+    const int64_t num_buckets = 1 << kRadixBits;
+    const int64_t num_edges = edges.size();
+    const int64_t block_size = std::max<int64_t>(1 << 16, num_edges / 256);
+    const int64_t num_blocks = (num_edges + block_size - 1) / block_size;
+    int id_bits = 1;
+    while (id_bits < 63 && (static_cast<int64_t>(1) << id_bits) < num_nodes_)
+      id_bits++;
+    int passes_per_id = (id_bits + kRadixBits - 1) / kRadixBits;
+    EdgeList sorted(num_edges);
+    pvector<SGOffset> counts(num_blocks * num_buckets);
+    for (int pass=0; pass < 2 * passes_per_id; pass++) {
+      bool by_source = pass >= passes_per_id;
+      int shift = (pass % passes_per_id) * kRadixBits;
+      auto digit = [&](const Edge &e) {
+        int64_t id = by_source ? e.u : GetID(e.v);
+        return (id >> shift) & (num_buckets - 1);
+      };
+      #pragma omp parallel for
+      for (int64_t block=0; block < num_blocks; block++) {
+        SGOffset *block_counts = counts.data() + block * num_buckets;
+        std::fill(block_counts, block_counts + num_buckets, 0);
+        int64_t block_end = std::min((block + 1) * block_size, num_edges);
+        for (int64_t i=block * block_size; i < block_end; i++)
+          block_counts[digit(edges[i])]++;
+      }
+      // positions ordered by digit first and block second keep it stable
+      SGOffset total = 0;
+      for (int64_t bucket=0; bucket < num_buckets; bucket++) {
+        for (int64_t block=0; block < num_blocks; block++) {
+          SGOffset count = counts[block * num_buckets + bucket];
+          counts[block * num_buckets + bucket] = total;
+          total += count;
+        }
+      }
+      #pragma omp parallel for
+      for (int64_t block=0; block < num_blocks; block++) {
+        SGOffset *block_pos = counts.data() + block * num_buckets;
+        int64_t block_end = std::min((block + 1) * block_size, num_edges);
+        for (int64_t i=block * block_size; i < block_end; i++)
+          sorted[block_pos[digit(edges[i])]++] = edges[i];
+      }
+      edges.swap(sorted);
+    }
+  }
+
+  // Input filename, moved into the cache directory if one is set
+  std::string CachedInputPath() const {
+    std::string dir;
+    const char *env_dir = getenv("GRAPHIT_GRAPH_CACHE");
+    if (env_dir != nullptr && env_dir[0] != '\0')
+      dir = env_dir;
+#ifdef GRAPH_CACHE_DIR
+    else
+      dir = GRAPH_CACHE_DIR;
+#endif
+    if (dir.empty())
+      return cli_.filename();
+    std::string name = cli_.filename();
+    size_t slash = name.find_last_of('/');
+    if (slash != std::string::npos)
+      name = name.substr(slash + 1);
+    return dir + "/" + name;
+  }
+
+  // Identifies the input file and the options that change the built graph,
+  // GetCacheSource returns false if caching isn't supported for this graph
+  // type, GetInputSource if there is no input file
+  bool GetCacheSource(SGSource &source) const {
+    return invert && GetInputSource(source);
+  }
+
+  bool GetInputSource(SGSource &source) const {
+    struct stat st;
+    if (stat(cli_.filename().c_str(), &st) != 0)
+      return false;
+    std::string options = cli_.filename() + (symmetrize_ ? "|sym" : "|") +
+                          std::to_string(sizeof(DestID_)) +
+                          (std::is_floating_point<WeightT_>::value ? "f" : "");
+    // FNV-1a, so keys stay stable across builds
+    source.key = 14695981039346656037ULL;
+    for (char c : options)
+      source.key = (source.key ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+    source.size = st.st_size;
+    source.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 +
+                   st.st_mtim.tv_nsec;
+    return true;
+  }
+
+  bool CacheIsValid(const SGSource &source) const {
+    Reader<NodeID_, DestID_, WeightT_, invert> r(CacheFilename());
+    SGHeader header;
+    return r.ReadSerializedHeader(header) && header.version == kSGVersion &&
+           header.id_bytes == sizeof(NodeID_) &&
+           header.dest_bytes == sizeof(DestID_) &&
+           (header.flags & (kSGWeighted | kSGFloatWeights)) ==
+               SGWeightFlags<DestID_>::value &&
+           (!needs_inverse_ || !(header.flags & kSGDirected) ||
+            header.in_offsets_pos != 0) &&
+           header.source.key == source.key &&
+           header.source.size == source.size &&
+           header.source.mtime == source.mtime;
+  }
+
+  /*
+  Streamed Cache Building Steps (for MakeSemiExternalGraph):
+    - Parse the text a window at a time (Reader::StreamEdges) to find the
+      number of vertices, then once more to count the degrees of both
+      directions
+    - Split the vertices of each direction into partitions of at most
+      buffer_edges edges (a vertex with more edges gets a partition of its
+      own)
+    - Parse the text a last time and append every edge to the section of
+      its partition in a temporary file, as (vertex, neighbor) pairs
+    - Per partition, read its section back, squish every vertex like
+      SquishCSR and append the partition to the neighbor section
+    - Offsets and the header are written last, once the squished degrees
+      are known
+  The text is parsed three times whatever the number of partitions. Only
+  vertex-sized arrays, one window and one partition are ever in memory.
+  Returns false if the input can't be streamed or the cache can't be
+  written.
+  */
+  bool WriteStreamedCache(const SGSource &source, int64_t buffer_edges) {
+    Reader<NodeID_, DestID_, WeightT_, invert> r(cli_.filename());
+    NodeID_ max_seen = 0;
+    if (!r.StreamEdges([&] (const EdgeList &el) {
+          max_seen = std::max(max_seen, FindMaxNodeID(el));
+        }))
+      return false;
+    if (num_nodes_ == -1)
+      num_nodes_ = max_seen + 1;
+    bool inverse = !symmetrize_ && invert && needs_inverse_;
+    pvector<NodeID_> out_degrees(num_nodes_, 0);
+    pvector<NodeID_> in_degrees(inverse ? num_nodes_ : 0, 0);
+    r.StreamEdges([&] (const EdgeList &el) {
+      #pragma omp parallel for
+      for (auto it = el.begin(); it < el.end(); it++) {
+        Edge e = *it;
+        fetch_and_add(out_degrees[e.u], 1);
+        if (symmetrize_)
+          fetch_and_add(out_degrees[GetID(e.v)], 1);
+        if (inverse)
+          fetch_and_add(in_degrees[GetID(e.v)], 1);
+      }
+    });
+    StreamedCSR out_csr = PartitionStreamedCSR(out_degrees, buffer_edges, 0);
+    StreamedCSR in_csr;
+    if (inverse)
+      in_csr = PartitionStreamedCSR(in_degrees, buffer_edges,
+                                    out_csr.raw_offsets[num_nodes_]);
+    std::string cache_name = CacheFilename();
+    std::string tmp_name = cache_name + ".tmp" + std::to_string(getpid());
+    std::string edges_name = tmp_name + ".edges";
+    std::fstream edges(edges_name, std::ios::in | std::ios::out |
+                                   std::ios::binary | std::ios::trunc);
+    // unlinked right away, the open stream keeps it until it is closed
+    std::remove(edges_name.c_str());
+    if (!edges)
+      return false;
+    r.StreamEdges([&] (const EdgeList &el) {
+      std::vector<std::vector<Edge>> out_parts(out_csr.num_partitions());
+      std::vector<std::vector<Edge>> in_parts(in_csr.num_partitions());
+      for (auto it = el.begin(); it < el.end(); it++) {
+        Edge e = *it;
+        NodeID_ v = GetID(e.v);
+        out_parts[out_csr.partition_of(e.u)].push_back(e);
+        if (symmetrize_)
+          out_parts[out_csr.partition_of(v)].push_back(Edge(v, GetSource(e)));
+        if (inverse)
+          in_parts[in_csr.partition_of(v)].push_back(Edge(v, GetSource(e)));
+      }
+      AppendPartitions(edges, out_csr, out_parts);
+      AppendPartitions(edges, in_csr, in_parts);
+    });
+    if (!edges)
+      return false;
+    std::fstream file(tmp_name, std::ios::out | std::ios::binary);
+    if (!file)
+      return false;
+    uint64_t index_bytes = (num_nodes_+1) * sizeof(SGOffset);
+    SGHeader header;
+    std::memset(&header, 0, sizeof(SGHeader));
+    std::memcpy(header.magic, kSGMagic, sizeof(kSGMagic));
+    header.version = kSGVersion;
+    header.flags = (symmetrize_ ? 0 : kSGDirected) |
+                   SGWeightFlags<DestID_>::value;
+    header.num_nodes = num_nodes_;
+    header.id_bytes = sizeof(NodeID_);
+    header.dest_bytes = sizeof(DestID_);
+    header.source = source;
+    header.out_offsets_pos = SGAlign(sizeof(SGHeader));
+    header.out_neighs_pos = SGAlign(header.out_offsets_pos + index_bytes);
+    pvector<SGOffset> offsets = StreamSquishedCSR(edges, out_csr, file,
+                                                  header.out_neighs_pos);
+    header.num_edges = offsets[num_nodes_];
+    file.seekp(header.out_offsets_pos);
+    file.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    if (inverse) {
+      header.in_offsets_pos = SGAlign(header.out_neighs_pos +
+                                      header.num_edges * sizeof(DestID_));
+      header.in_neighs_pos = SGAlign(header.in_offsets_pos + index_bytes);
+      offsets = StreamSquishedCSR(edges, in_csr, file, header.in_neighs_pos);
+      file.seekp(header.in_offsets_pos);
+      file.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    }
+    file.seekp(0);
+    file.write(reinterpret_cast<char*>(&header), sizeof(SGHeader));
+    file.close();
+    if (!edges || !file ||
+        std::rename(tmp_name.c_str(), cache_name.c_str()) != 0) {
+      std::remove(tmp_name.c_str());
+      return false;
+    }
+    return true;
+  }
+
+  // One direction of a streamed cache before it is squished, its edges are
+  // kept in a temporary file with a section per partition
+  struct StreamedCSR {
+    pvector<SGOffset> raw_offsets;
+    // partition p holds the vertices [bounds[p], bounds[p+1])
+    std::vector<NodeID_> bounds;
+    // edges appended to each partition's section so far
+    std::vector<SGOffset> appended;
+    // where the sections start in the temporary file, in edges
+    SGOffset edges_pos = 0;
+
+    size_t num_partitions() const {
+      return bounds.empty() ? 0 : bounds.size() - 1;
+    }
+
+    size_t partition_of(NodeID_ n) const {
+      return std::upper_bound(bounds.begin(), bounds.end(), n) -
+             bounds.begin() - 1;
+    }
+  };
+
+  StreamedCSR PartitionStreamedCSR(const pvector<NodeID_> &degrees,
+                                   int64_t buffer_edges, SGOffset edges_pos) {
+    StreamedCSR csr;
+    csr.raw_offsets = ParallelPrefixSum(degrees);
+    csr.edges_pos = edges_pos;
+    csr.bounds.push_back(0);
+    NodeID_ first = 0;
+    while (first < num_nodes_) {
+      NodeID_ last = std::upper_bound(csr.raw_offsets.begin() + first + 1,
+                                      csr.raw_offsets.end(),
+                                      csr.raw_offsets[first] + buffer_edges) -
+                     csr.raw_offsets.begin() - 1;
+      last = std::max<NodeID_>(std::min<NodeID_>(last, num_nodes_), first + 1);
+      csr.bounds.push_back(last);
+      first = last;
+    }
+    csr.appended.assign(csr.num_partitions(), 0);
+    return csr;
+  }
+
+  // Appends one window's edges to the sections of their partitions
+  void AppendPartitions(std::fstream &edges, StreamedCSR &csr,
+                        std::vector<std::vector<Edge>> &parts) {
+    for (size_t p = 0; p < parts.size(); p++) {
+      if (parts[p].empty())
+        continue;
+      SGOffset pos = csr.edges_pos + csr.raw_offsets[csr.bounds[p]] +
+                     csr.appended[p];
+      edges.seekp(pos * sizeof(Edge));
+      edges.write(reinterpret_cast<char*>(parts[p].data()),
+                  parts[p].size() * sizeof(Edge));
+      csr.appended[p] += parts[p].size();
+    }
+  }
+
+  // Writes the squished neighbors of one direction from neighs_pos on and
+  // returns their offsets
+  pvector<SGOffset> StreamSquishedCSR(std::fstream &edges,
+                                      const StreamedCSR &csr,
+                                      std::fstream &file, uint64_t neighs_pos) {
+    const pvector<SGOffset> &raw_offsets = csr.raw_offsets;
+    pvector<SGOffset> sq_offsets(num_nodes_ + 1);
+    sq_offsets[0] = 0;
+    file.seekp(neighs_pos);
+    for (size_t p = 0; p < csr.num_partitions(); p++) {
+      NodeID_ first = csr.bounds[p];
+      NodeID_ last = csr.bounds[p+1];
+      SGOffset base = raw_offsets[first];
+      pvector<DestID_> neighs(raw_offsets[last] - base);
+      {
+        pvector<Edge> part(neighs.size());
+        edges.seekg((csr.edges_pos + base) * sizeof(Edge));
+        edges.read(reinterpret_cast<char*>(part.data()),
+                   part.size() * sizeof(Edge));
+        pvector<SGOffset> next(last - first);
+        #pragma omp parallel for
+        for (NodeID_ n = first; n < last; n++)
+          next[n - first] = raw_offsets[n] - base;
+        #pragma omp parallel for
+        for (auto it = part.begin(); it < part.end(); it++)
+          neighs[fetch_and_add(next[it->u - first], 1)] = it->v;
+      }
+      pvector<NodeID_> degrees(last - first);
+      #pragma omp parallel for
+      for (NodeID_ n = first; n < last; n++) {
+        DestID_ *n_start = neighs.data() + raw_offsets[n] - base;
+        DestID_ *n_end = neighs.data() + raw_offsets[n+1] - base;
+        std::sort(n_start, n_end);
+        DestID_ *new_end = std::unique(n_start, n_end);
+        new_end = std::remove(n_start, new_end, n);
+        degrees[n - first] = new_end - n_start;
+      }
+      // compact the partition in order and append it
+      SGOffset written = 0;
+      for (NodeID_ n = first; n < last; n++) {
+        DestID_ *n_start = neighs.data() + raw_offsets[n] - base;
+        if (n_start != neighs.data() + written)
+          std::copy(n_start, n_start + degrees[n - first],
+                    neighs.data() + written);
+        written += degrees[n - first];
+        sq_offsets[n+1] = sq_offsets[n] + degrees[n - first];
+      }
+      file.write(reinterpret_cast<char*>(neighs.data()),
+                 written * sizeof(DestID_));
+    }
+    return sq_offsets;
+  }
+
+  // Written to a temporary file and renamed into place, so concurrent runs
+  // never see a partial cache. Failures (e.g. read-only directory) are
+  // ignored, the graph just isn't cached.
+  void WriteCache(CSRGraph<NodeID_, DestID_, true> &g,
+                  const SGSource &source) {
+    std::string cache_name = CacheFilename();
+    std::string tmp_name = cache_name + ".tmp" + std::to_string(getpid());
+    std::fstream file(tmp_name, std::ios::out | std::ios::binary);
+    if (!file)
+      return;
+    WriterBase<NodeID_, DestID_>(g).WriteMappableGraph(file, source);
+    file.close();
+    if (!file || std::rename(tmp_name.c_str(), cache_name.c_str()) != 0)
+      std::remove(tmp_name.c_str());
+  }
+
+  void WriteCache(CSRGraph<NodeID_, DestID_, false> &g,
+                  const SGSource &source) {}
 };
 
 #endif  // BUILDER_H_
@@ -0,0 +1,304 @@
+#ifndef COMPRESSED_GRAPH_H_
+#define COMPRESSED_GRAPH_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "huge_pages.h"
+#include "pvector.h"
+
+
+/*
+Class:  CompressedCSR
+
+One direction of a CSRGraph with its neighbor lists stored as byte codes
+ - Each neighborhood is sorted, then written as the zigzag coded distance
+   from the vertex to its first neighbor followed by the gaps between
+   consecutive neighbors, all as 7-bit varints (the Ligra byte code)
+ - Weights directly follow their neighbor, as zigzag varints if integral
+   and as raw bytes otherwise
+ - Degrees still come from the graph's offsets, only the neighbor arrays
+   are replaced
+ - Built and decoded in parallel across vertices, the same way edgeset
+   apply functions already split the uncompressed CSR
+ - With release_neighs the plain neighbors are written out in blocks of
+   kReleaseBlockEdges edges and the pages of every finished block go back to
+   the OS, so peak memory stays close to the plain CSR instead of the plain
+   and compressed copies together (the caller frees the array afterwards)
+*/
+
+
+template <typename NodeID_, typename WeightT_>
+struct NodeWeight;
+
+
+inline uint64_t ZigZag(int64_t x) {
+  return (static_cast<uint64_t>(x) << 1) ^ static_cast<uint64_t>(x >> 63);
+}
+
+inline int64_t UnZigZag(uint64_t x) {
+  return static_cast<int64_t>(x >> 1) ^ -static_cast<int64_t>(x & 1);
+}
+
+inline const uint8_t* GetVarint(const uint8_t *in, uint64_t &x) {
+  x = 0;
+  int shift = 0;
+  uint8_t b;
+  do {
+    b = *in++;
+    x |= static_cast<uint64_t>(b & 0x7f) << shift;
+    shift += 7;
+  } while (b & 0x80);
+  return in;
+}
+
+
+// Encodes the part of a neighbor that isn't its ID (nothing if unweighted)
+template <typename NodeID_, typename DestID_>
+struct NeighborCodec {
+  static NodeID_ Id(const DestID_ &d) { return d; }
+
+  template <typename Out>
+  static void PutWeight(Out &out, const DestID_ &d) {}
+
+  static const uint8_t* Get(const uint8_t *in, NodeID_ id, DestID_ &d) {
+    d = id;
+    return in;
+  }
+};
+
+template <typename NodeID_, typename WeightT_>
+struct NeighborCodec<NodeID_, NodeWeight<NodeID_, WeightT_>> {
+  typedef NodeWeight<NodeID_, WeightT_> DestID_;
+
+  static NodeID_ Id(const DestID_ &d) { return d.v; }
+
+  template <typename Out>
+  static void PutWeight(Out &out, const DestID_ &d) {
+    PutWeight(out, d.w, std::is_integral<WeightT_>());
+  }
+
+  static const uint8_t* Get(const uint8_t *in, NodeID_ id, DestID_ &d) {
+    d.v = id;
+    return GetWeight(in, d.w, std::is_integral<WeightT_>());
+  }
+
+ private:
+  template <typename Out>
+  static void PutWeight(Out &out, WeightT_ w, std::true_type) {
+    out.PutVarint(ZigZag(w));
+  }
+
+  template <typename Out>
+  static void PutWeight(Out &out, WeightT_ w, std::false_type) {
+    out.PutBytes(&w, sizeof(WeightT_));
+  }
+
+  static const uint8_t* GetWeight(const uint8_t *in, WeightT_ &w,
+                                  std::true_type) {
+    uint64_t x;
+    in = GetVarint(in, x);
+    w = static_cast<WeightT_>(UnZigZag(x));
+    return in;
+  }
+
+  static const uint8_t* GetWeight(const uint8_t *in, WeightT_ &w,
+                                  std::false_type) {
+    std::memcpy(&w, in, sizeof(WeightT_));
+    return in + sizeof(WeightT_);
+  }
+};
+
+
+template <class NodeID_, class DestID_>
+class CompressedCSR {
+  typedef NeighborCodec<NodeID_, DestID_> Codec;
+
+  // Sinks for Encode, so sizing and writing share one code path
+  struct ByteCounter {
+    int64_t bytes = 0;
+    void PutVarint(uint64_t x) {
+      do {
+        bytes++;
+        x >>= 7;
+      } while (x != 0);
+    }
+    void PutBytes(const void *src, size_t n) { bytes += n; }
+  };
+
+  struct ByteWriter {
+    uint8_t *out;
+    void PutVarint(uint64_t x) {
+      while (x >= 0x80) {
+        *out++ = static_cast<uint8_t>(x) | 0x80;
+        x >>= 7;
+      }
+      *out++ = static_cast<uint8_t>(x);
+    }
+    void PutBytes(const void *src, size_t n) {
+      std::memcpy(out, src, n);
+      out += n;
+    }
+  };
+
+ public:
+  // Decodes a neighborhood front to back, enough for range-based for loops
+  class iterator {
+   public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef DestID_ value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const DestID_* pointer;
+    typedef const DestID_& reference;
+
+    iterator() : pos_(nullptr), remaining_(0) {}
+    iterator(const uint8_t *pos, int64_t degree, NodeID_ n)
+        : pos_(pos), remaining_(degree), prev_(n) {
+      if (remaining_ > 0) {
+        uint64_t x;
+        pos_ = GetVarint(pos_, x);
+        Decode(static_cast<NodeID_>(prev_ + UnZigZag(x)));
+      }
+    }
+
+    const DestID_& operator*() const { return cur_; }
+    const DestID_* operator->() const { return &cur_; }
+
+    iterator& operator++() {
+      if (--remaining_ > 0) {
+        uint64_t x;
+        pos_ = GetVarint(pos_, x);
+        Decode(static_cast<NodeID_>(prev_ + x));
+      }
+      return *this;
+    }
+
+    bool operator==(const iterator &other) const {
+      return remaining_ == other.remaining_;
+    }
+    bool operator!=(const iterator &other) const {
+      return remaining_ != other.remaining_;
+    }
+
+   private:
+    void Decode(NodeID_ id) {
+      pos_ = Codec::Get(pos_, id, cur_);
+      prev_ = id;
+    }
+
+    const uint8_t *pos_;
+    int64_t remaining_;
+    NodeID_ prev_;
+    DestID_ cur_;
+  };
+
+  class Neighborhood {
+    const uint8_t *start_;
+    int64_t degree_;
+    NodeID_ n_;
+   public:
+    Neighborhood(const uint8_t *start, int64_t degree, NodeID_ n) :
+        start_(start), degree_(degree), n_(n) {}
+    iterator begin() const { return iterator(start_, degree_, n_); }
+    iterator end() const { return iterator(); }
+  };
+
+  static const int64_t kReleaseBlockEdges = 1 << 22;
+
+  // offsets and neighs are a CSR direction as kept by CSRGraph
+  CompressedCSR(int64_t num_nodes, const int64_t *offsets,
+                const DestID_ *neighs, bool release_neighs = false) :
+      num_nodes_(num_nodes), offsets_(offsets) {
+    // first pass sizes every neighborhood, second pass writes them
+    pvector<int64_t> num_bytes(num_nodes_);
+    #pragma omp parallel
+    {
+      std::vector<DestID_> sorted;
+      #pragma omp for schedule(dynamic, 64)
+      for (int64_t n=0; n < num_nodes_; n++) {
+        ByteCounter counter;
+        Encode(n, SortedNeighs(n, neighs, sorted), counter);
+        num_bytes[n] = counter.bytes;
+      }
+    }
+    byte_offsets_ = ParallelPrefixSum(num_bytes);
+    // untouched until written, so the pages fill in as the plain ones go
+    bytes_.resize(byte_offsets_[num_nodes_]);
+    int64_t start = 0;
+    // each block releases its own pages, from where the previous one stopped
+    const void *released = neighs;
+    while (start < num_nodes_) {
+      int64_t end = num_nodes_;
+      if (release_neighs) {
+        const int64_t *block_end = std::upper_bound(
+            offsets_ + start + 1, offsets_ + num_nodes_ + 1,
+            offsets_[start] + kReleaseBlockEdges);
+        end = std::min<int64_t>(block_end - offsets_, num_nodes_);
+      }
+      #pragma omp parallel
+      {
+        std::vector<DestID_> sorted;
+        #pragma omp for schedule(dynamic, 64)
+        for (int64_t n=start; n < end; n++) {
+          ByteWriter writer{bytes_.data() + byte_offsets_[n]};
+          Encode(n, SortedNeighs(n, neighs, sorted), writer);
+        }
+      }
+      if (release_neighs)
+        released = ReleasePages(released, neighs + offsets_[end]);
+      start = end;
+    }
+  }
+
+  Neighborhood neigh(NodeID_ n) const {
+    return Neighborhood(bytes_.data() + byte_offsets_[n],
+                        offsets_[n+1] - offsets_[n], n);
+  }
+
+  int64_t num_bytes() const {
+    return bytes_.size() + byte_offsets_.size() * sizeof(int64_t);
+  }
+
+ private:
+  // Points at the neighborhood itself if already sorted (builders sort)
+  const DestID_* SortedNeighs(int64_t n, const DestID_ *neighs,
+                              std::vector<DestID_> &sorted) const {
+    const DestID_ *begin = neighs + offsets_[n];
+    const DestID_ *end = neighs + offsets_[n+1];
+    auto by_id = [](const DestID_ &a, const DestID_ &b) {
+      return Codec::Id(a) < Codec::Id(b);
+    };
+    if (std::is_sorted(begin, end, by_id))
+      return begin;
+    sorted.assign(begin, end);
+    std::sort(sorted.begin(), sorted.end(), by_id);
+    return sorted.data();
+  }
+
+  template <typename Out>
+  void Encode(int64_t n, const DestID_ *neighs, Out &out) const {
+    int64_t degree = offsets_[n+1] - offsets_[n];
+    NodeID_ prev = static_cast<NodeID_>(n);
+    for (int64_t i=0; i < degree; i++) {
+      NodeID_ id = Codec::Id(neighs[i]);
+      if (i == 0)
+        out.PutVarint(ZigZag(static_cast<int64_t>(id) - prev));
+      else
+        out.PutVarint(static_cast<uint64_t>(id - prev));
+      Codec::PutWeight(out, neighs[i]);
+      prev = id;
+    }
+  }
+
+  int64_t num_nodes_;
+  const int64_t *offsets_;
+  pvector<int64_t> byte_offsets_;
+  pvector<uint8_t> bytes_;
+};
+
+#endif  // COMPRESSED_GRAPH_H_
@@ -0,0 +1,564 @@
+#ifndef DYN_GRAPH_H_
+#define DYN_GRAPH_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "graph.h"
+#include "pvector.h"
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+
+/*
+Class:  DynamicGraph
+
+A CSRGraph that takes batches of edge insertions and deletions
+ - The CSRGraph is the base, changes to a vertex's neighbors are kept in a
+   delta block of that vertex (neighbors inserted and base neighbors deleted)
+ - A batch is grouped by source vertex in parallel, every vertex's updates
+   are then applied by one thread, so no locks are needed
+ - out_neigh/in_neigh iterate the base neighbors minus the deleted ones and
+   then the inserted ones
+ - Compact folds the deltas back into a new CSRGraph with a parallel merge,
+   it runs by itself once the deltas hold compact_fraction of the edges
+ - Edges are a set: inserting a present edge or deleting a missing one does
+   nothing, self-loops are not inserted (as in BuilderBase)
+ - Base neighborhoods must be sorted, as they are for graphs from a Builder
+ - The vertices are fixed, updates have to be between existing vertices
+ - Directed graphs loaded without their inverse only track out-edge changes,
+   buildInverse() compacts and inverts the base before in-edges are used
+ - Edgesets updated with insertEdges/deleteEdges in a program are declared
+   as a DynamicGraph, the generated edgeset apply functions then traverse
+   base and deltas directly. graph() gives a compacted CSRGraph to code that
+   needs the arrays (segments, compressed or streamed edges)
+*/
+
+
+template <class NodeID_, class DestID_ = NodeID_>
+class DynamicGraph {
+  typedef CSRGraph<NodeID_, DestID_> BaseGraph;
+  typedef EdgePair<NodeID_, DestID_> Edge;
+  typedef pvector<Edge> EdgeList;
+
+  // Changes of one vertex's neighbors, both sorted by neighbor ID
+  struct Delta {
+    std::vector<DestID_> inserted;
+    std::vector<NodeID_> deleted;
+  };
+  typedef std::vector<std::unique_ptr<Delta>> Deltas;
+
+ public:
+  class Neighborhood {
+   public:
+    class iterator {
+     public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef DestID_ value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const DestID_* pointer;
+      typedef const DestID_& reference;
+
+      iterator(const DestID_ *base, const DestID_ *base_end,
+               const NodeID_ *deleted, const NodeID_ *deleted_end,
+               const DestID_ *inserted) :
+          base_(base), base_end_(base_end), deleted_(deleted),
+          deleted_end_(deleted_end), inserted_(inserted) {
+        SkipDeleted();
+      }
+
+      const DestID_& operator*() const {
+        return base_ != base_end_ ? *base_ : *inserted_;
+      }
+
+      iterator& operator++() {
+        if (base_ != base_end_) {
+          ++base_;
+          SkipDeleted();
+        } else {
+          ++inserted_;
+        }
+        return *this;
+      }
+
+      iterator operator++(int) {
+        iterator old = *this;
+        ++(*this);
+        return old;
+      }
+
+      bool operator==(const iterator &other) const {
+        return base_ == other.base_ && inserted_ == other.inserted_;
+      }
+
+      bool operator!=(const iterator &other) const {
+        return !(*this == other);
+      }
+
+     private:
+      void SkipDeleted() {
+        while (base_ != base_end_ && deleted_ != deleted_end_) {
+          NodeID_ id = IDOf(*base_);
+          while (deleted_ != deleted_end_ && *deleted_ < id)
+            ++deleted_;
+          if (deleted_ == deleted_end_ || *deleted_ != id)
+            break;
+          ++base_;
+          ++deleted_;
+        }
+      }
+
+      const DestID_ *base_, *base_end_;
+      const NodeID_ *deleted_, *deleted_end_;
+      const DestID_ *inserted_;
+    };
+
+    Neighborhood(const DestID_ *base, const DestID_ *base_end,
+                 const Delta *delta) :
+        base_(base), base_end_(base_end), delta_(delta) {}
+
+    iterator begin() const {
+      if (delta_ == nullptr)
+        return iterator(base_, base_end_, nullptr, nullptr, nullptr);
+      return iterator(base_, base_end_, delta_->deleted.data(),
+                      delta_->deleted.data() + delta_->deleted.size(),
+                      delta_->inserted.data());
+    }
+
+    iterator end() const {
+      if (delta_ == nullptr)
+        return iterator(base_end_, base_end_, nullptr, nullptr, nullptr);
+      return iterator(base_end_, base_end_, nullptr, nullptr,
+                      delta_->inserted.data() + delta_->inserted.size());
+    }
+
+   private:
+    const DestID_ *base_, *base_end_;
+    const Delta *delta_;
+  };
+
+  DynamicGraph() {}
+
+  explicit DynamicGraph(BaseGraph &&base,
+                        double compact_fraction = 0.1) :
+      compact_fraction_(compact_fraction) {
+    *this = std::move(base);
+  }
+
+  DynamicGraph(const DynamicGraph&) = delete;
+  DynamicGraph& operator=(const DynamicGraph&) = delete;
+
+  // Starts over from a new base without pending updates (e.g. a loaded graph)
+  DynamicGraph& operator=(BaseGraph &&base) {
+    base_ = std::move(base);
+    int64_t n = std::max(base_.num_nodes(), static_cast<int64_t>(0));
+    out_deltas_ = Deltas(n);
+    in_deltas_ = Deltas(TracksInEdges() ? n : 0);
+    num_edges_directed_ = n == 0 ? 0 : base_.num_edges_directed();
+    pending_updates_ = 0;
+    return *this;
+  }
+
+  bool directed() const {
+    return base_.directed();
+  }
+
+  int64_t num_nodes() const {
+    return base_.num_nodes();
+  }
+
+  int64_t num_edges() const {
+    return directed() ? num_edges_directed_ : num_edges_directed_ / 2;
+  }
+
+  int64_t num_edges_directed() const {
+    return num_edges_directed_;
+  }
+
+  // Number of neighbor changes (in both directions) not folded into the base
+  int64_t pending_updates() const {
+    return pending_updates_;
+  }
+
+  int64_t out_degree(NodeID_ n) const {
+    return Degree(base_.out_degree(n), out_deltas_[n].get());
+  }
+
+  int64_t in_degree(NodeID_ n) const {
+    if (!directed())
+      return out_degree(n);
+    return Degree(base_.in_degree(n), in_deltas_[n].get());
+  }
+
+  Neighborhood out_neigh(NodeID_ n) const {
+    return Neighborhood(base_.out_neigh(n).begin(), base_.out_neigh(n).end(),
+                        out_deltas_[n].get());
+  }
+
+  Neighborhood in_neigh(NodeID_ n) const {
+    if (!directed())
+      return out_neigh(n);
+    return Neighborhood(base_.in_neigh(n).begin(), base_.in_neigh(n).end(),
+                        in_deltas_[n].get());
+  }
+
+  void InsertEdges(const EdgeList &edges) {
+    Update(edges, true);
+  }
+
+  void DeleteEdges(const EdgeList &edges) {
+    Update(edges, false);
+  }
+
+  // CSRGraph with all the updates so far
+  BaseGraph& graph() {
+    if (pending_updates_ > 0)
+      Compact();
+    return base_;
+  }
+
+  // Adds the in-edges of a directed graph loaded without them, has to be
+  // called outside of parallel regions before the in-edges are first used
+  void buildInverse() {
+    if (base_.has_inverse())
+      return;
+    Compact();
+    base_.buildInverse();
+    in_deltas_ = Deltas(num_nodes());
+  }
+
+  std::shared_ptr<Permutation<NodeID_>> permutation() const {
+    return base_.permutation();
+  }
+
+  // The traversals lease their deduplication flags from the base
+  DeduplicationFlags* get_flags_atomic_() {
+    return base_.get_flags_atomic_();
+  }
+
+  void return_flags_atomic_(DeduplicationFlags *flags) {
+    base_.return_flags_atomic_(flags);
+  }
+
+  void Compact() {
+    if (pending_updates_ == 0)
+      return;
+    int64_t n = num_nodes();
+    pvector<SGOffset> out_offsets = CompactedOffsets(base_.get_out_offsets_(),
+                                                     out_deltas_);
+    DestID_* out_neighs = CompactedNeighs(base_.get_out_neighbors_(),
+                                          base_.get_out_offsets_(),
+                                          out_deltas_, out_offsets);
+    std::shared_ptr<Permutation<NodeID_>> permutation = base_.permutation();
+    if (TracksInEdges()) {
+      pvector<SGOffset> in_offsets = CompactedOffsets(base_.get_in_offsets_(),
+                                                      in_deltas_);
+      DestID_* in_neighs = CompactedNeighs(base_.get_in_neighbors_(),
+                                           base_.get_in_offsets_(),
+                                           in_deltas_, in_offsets);
+      base_ = BaseGraph(n, BaseGraph::GenIndex(out_offsets), out_neighs,
+                        BaseGraph::GenIndex(in_offsets), in_neighs);
+    } else if (directed()) {
+      // the inverse is left to buildInverse
+      base_ = BaseGraph(n, BaseGraph::GenIndex(out_offsets), out_neighs,
+                        nullptr, nullptr);
+    } else {
+      base_ = BaseGraph(n, BaseGraph::GenIndex(out_offsets), out_neighs);
+    }
+    base_.set_permutation(permutation);
+    #pragma omp parallel for
+    for (int64_t v=0; v < n; v++) {
+      out_deltas_[v].reset();
+      if (TracksInEdges())
+        in_deltas_[v].reset();
+    }
+    pending_updates_ = 0;
+  }
+
+ private:
+  // directed graphs keep separate in-edges once their base has the inverse
+  bool TracksInEdges() const {
+    return base_.directed() && base_.has_inverse();
+  }
+
+  static NodeID_ IDOf(NodeID_ n) {
+    return n;
+  }
+
+  template <typename WeightT_>
+  static NodeID_ IDOf(const NodeWeight<NodeID_, WeightT_> &n) {
+    return n.v;
+  }
+
+  // Neighbor u of v for the edge (u, v) with the weight of v
+  static NodeID_ WithSource(NodeID_ u, NodeID_ v) {
+    return u;
+  }
+
+  template <typename WeightT_>
+  static NodeWeight<NodeID_, WeightT_> WithSource(
+      NodeID_ u, const NodeWeight<NodeID_, WeightT_> &v) {
+    return NodeWeight<NodeID_, WeightT_>(u, v.w);
+  }
+
+  static bool BySourceThenID(const Edge &a, const Edge &b) {
+    return a.u == b.u ? IDOf(a.v) < IDOf(b.v) : a.u < b.u;
+  }
+
+  static int64_t Degree(int64_t base_degree, const Delta *delta) {
+    if (delta == nullptr)
+      return base_degree;
+    return base_degree - delta->deleted.size() + delta->inserted.size();
+  }
+
+  void Update(const EdgeList &edges, bool insert) {
+    int64_t n = num_nodes();
+    bool valid = true;
+    #pragma omp parallel for reduction(&& : valid)
+    for (size_t i=0; i < edges.size(); i++) {
+      valid = valid && edges[i].u >= 0 && edges[i].u < n &&
+              IDOf(edges[i].v) >= 0 && IDOf(edges[i].v) < n;
+    }
+    if (!valid) {
+      std::cout << "Updated edges have to be between the " << n
+                << " vertices of the graph" << std::endl;
+      std::exit(-32);
+    }
+    int64_t changed = 0;
+    if (TracksInEdges()) {
+      EdgeList in_edges(edges.size());
+      #pragma omp parallel for
+      for (size_t i=0; i < edges.size(); i++)
+        in_edges[i] = Edge(IDOf(edges[i].v), WithSource(edges[i].u, edges[i].v));
+      changed = UpdateDirection(edges, base_.get_out_neighbors_(),
+                                base_.get_out_offsets_(), out_deltas_, insert);
+      UpdateDirection(in_edges, base_.get_in_neighbors_(),
+                      base_.get_in_offsets_(), in_deltas_, insert);
+      pending_updates_ += 2 * changed;
+    } else if (directed()) {
+      changed = UpdateDirection(edges, base_.get_out_neighbors_(),
+                                base_.get_out_offsets_(), out_deltas_, insert);
+      pending_updates_ += changed;
+    } else {
+      EdgeList both_edges(2 * edges.size());
+      #pragma omp parallel for
+      for (size_t i=0; i < edges.size(); i++) {
+        both_edges[2*i] = edges[i];
+        both_edges[2*i+1] = Edge(IDOf(edges[i].v),
+                                 WithSource(edges[i].u, edges[i].v));
+      }
+      changed = UpdateDirection(both_edges, base_.get_out_neighbors_(),
+                                base_.get_out_offsets_(), out_deltas_, insert);
+      pending_updates_ += changed;
+    }
+    num_edges_directed_ += insert ? changed : -changed;
+    // pending_updates_ counts both directions of directed graphs with inverse
+    int64_t num_neighbors = TracksInEdges() ? 2 * num_edges_directed_
+                                            : num_edges_directed_;
+    if (pending_updates_ > compact_fraction_ * num_neighbors)
+      Compact();
+  }
+
+  // Sorts the edges by source, in buckets of source ranges so that the
+  // buckets can be sorted and applied in parallel. The edges are scattered
+  // into the buckets by chunks, every chunk counts its edges per bucket and
+  // then writes them to its own range of each bucket. Returns the number of
+  // neighbors inserted or deleted
+  int64_t UpdateDirection(const EdgeList &edges, const DestID_ *neighs,
+                          const SGOffset *offsets, Deltas &deltas,
+                          bool insert) {
+    int64_t n = num_nodes();
+    int64_t num_buckets = 1;
+#ifdef OPENMP
+    num_buckets = 8 * omp_get_max_threads();
+#endif
+    num_buckets = std::max(static_cast<int64_t>(1), std::min(num_buckets, n));
+    auto BucketOf = [n, num_buckets] (NodeID_ u) {
+      return static_cast<int64_t>(u) * num_buckets / n;
+    };
+    int64_t num_edges = edges.size();
+    int64_t num_chunks = std::max(static_cast<int64_t>(1),
+                                  std::min(num_buckets, num_edges / 4096));
+    auto ChunkStart = [num_edges, num_chunks] (int64_t c) {
+      return c * num_edges / num_chunks;
+    };
+    // counts[c * num_buckets + b] becomes the position of chunk c in bucket b
+    pvector<SGOffset> counts(num_chunks * num_buckets, 0);
+    #pragma omp parallel for
+    for (int64_t c=0; c < num_chunks; c++) {
+      for (int64_t i=ChunkStart(c); i < ChunkStart(c+1); i++)
+        counts[c * num_buckets + BucketOf(edges[i].u)]++;
+    }
+    pvector<SGOffset> bucket_starts(num_buckets + 1);
+    SGOffset total = 0;
+    for (int64_t b=0; b < num_buckets; b++) {
+      bucket_starts[b] = total;
+      for (int64_t c=0; c < num_chunks; c++) {
+        SGOffset count = counts[c * num_buckets + b];
+        counts[c * num_buckets + b] = total;
+        total += count;
+      }
+    }
+    bucket_starts[num_buckets] = total;
+    EdgeList sorted(edges.size());
+    #pragma omp parallel for
+    for (int64_t c=0; c < num_chunks; c++) {
+      SGOffset *fill = counts.data() + c * num_buckets;
+      for (int64_t i=ChunkStart(c); i < ChunkStart(c+1); i++)
+        sorted[fill[BucketOf(edges[i].u)]++] = edges[i];
+    }
+
+    int64_t changed = 0;
+    #pragma omp parallel reduction(+ : changed)
+    {
+      std::vector<DestID_> run;
+      Delta scratch;
+      #pragma omp for schedule(dynamic, 1)
+      for (int64_t b=0; b < num_buckets; b++) {
+        Edge *first = sorted.begin() + bucket_starts[b];
+        Edge *last = sorted.begin() + bucket_starts[b+1];
+        std::sort(first, last, BySourceThenID);
+        while (first != last) {
+          NodeID_ u = first->u;
+          run.clear();
+          for (; first != last && first->u == u; first++) {
+            if (IDOf(first->v) != u &&
+                (run.empty() || IDOf(run.back()) != IDOf(first->v)))
+              run.push_back(first->v);
+          }
+          changed += UpdateVertex(run, neighs + offsets[u],
+                                  neighs + offsets[u+1], deltas[u], insert,
+                                  scratch);
+        }
+      }
+    }
+    return changed;
+  }
+
+  static bool IDLess(const DestID_ &a, const DestID_ &b) {
+    return IDOf(a) < IDOf(b);
+  }
+
+  // Merges the vertex's updates (sorted by ID without duplicates) into its
+  // delta, scratch is reused across vertices to avoid allocations
+  static int64_t UpdateVertex(const std::vector<DestID_> &run,
+                              const DestID_ *base, const DestID_ *base_end,
+                              std::unique_ptr<Delta> &delta, bool insert,
+                              Delta &scratch) {
+    if (run.empty() || (delta == nullptr && !insert && base == base_end))
+      return 0;
+    if (delta == nullptr)
+      delta.reset(new Delta());
+    scratch.inserted.clear();
+    scratch.deleted.clear();
+    auto ins = delta->inserted.begin(), ins_end = delta->inserted.end();
+    auto del = delta->deleted.begin(), del_end = delta->deleted.end();
+    int64_t changed = 0;
+    for (const DestID_ &v : run) {
+      NodeID_ id = IDOf(v);
+      while (ins != ins_end && IDOf(*ins) < id)
+        scratch.inserted.push_back(*ins++);
+      while (del != del_end && *del < id)
+        scratch.deleted.push_back(*del++);
+      base = std::lower_bound(base, base_end, v, IDLess);
+      bool in_base = base != base_end && IDOf(*base) == id;
+      bool was_inserted = ins != ins_end && IDOf(*ins) == id;
+      bool was_deleted = del != del_end && *del == id;
+      if (insert) {
+        // a base neighbor inserted again is no longer deleted
+        if (in_base && was_deleted) {
+          changed++;
+        } else if (was_inserted) {
+          scratch.inserted.push_back(*ins);
+        } else if (!in_base) {
+          scratch.inserted.push_back(v);
+          changed++;
+        }
+      } else {
+        if (in_base) {
+          scratch.deleted.push_back(id);
+          changed += was_deleted ? 0 : 1;
+        } else if (was_inserted) {
+          changed++;
+        }
+      }
+      if (was_inserted)
+        ins++;
+      if (was_deleted)
+        del++;
+    }
+    scratch.inserted.insert(scratch.inserted.end(), ins, ins_end);
+    scratch.deleted.insert(scratch.deleted.end(), del, del_end);
+    delta->inserted.swap(scratch.inserted);
+    delta->deleted.swap(scratch.deleted);
+    if (delta->inserted.empty() && delta->deleted.empty())
+      delta.reset();
+    return changed;
+  }
+
+  pvector<SGOffset> CompactedOffsets(const SGOffset *offsets,
+                                     const Deltas &deltas) const {
+    int64_t n = num_nodes();
+    pvector<SGOffset> new_offsets(n + 1);
+    #pragma omp parallel for
+    for (int64_t v=0; v < n; v++)
+      new_offsets[v] = Degree(offsets[v+1] - offsets[v], deltas[v].get());
+    SGOffset total = 0;
+    for (int64_t v=0; v < n; v++) {
+      SGOffset degree = new_offsets[v];
+      new_offsets[v] = total;
+      total += degree;
+    }
+    new_offsets[n] = total;
+    return new_offsets;
+  }
+
+  DestID_* CompactedNeighs(const DestID_ *neighs, const SGOffset *offsets,
+                           const Deltas &deltas,
+                           const pvector<SGOffset> &new_offsets) const {
+    int64_t n = num_nodes();
+    DestID_ *new_neighs = NewNeighborArray<DestID_>(new_offsets, n);
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int64_t v=0; v < n; v++) {
+      DestID_ *out = new_neighs + new_offsets[v];
+      if (deltas[v] == nullptr) {
+        out = std::copy(neighs + offsets[v], neighs + offsets[v+1], out);
+        continue;
+      }
+      // base and inserted neighbors are disjoint, merging keeps them sorted
+      auto deleted = deltas[v]->deleted.begin();
+      auto deleted_end = deltas[v]->deleted.end();
+      auto inserted = deltas[v]->inserted.begin();
+      auto inserted_end = deltas[v]->inserted.end();
+      for (const DestID_ *u = neighs + offsets[v]; u != neighs + offsets[v+1];
+           u++) {
+        NodeID_ id = IDOf(*u);
+        while (deleted != deleted_end && *deleted < id)
+          deleted++;
+        if (deleted != deleted_end && *deleted == id)
+          continue;
+        while (inserted != inserted_end && IDOf(*inserted) < id)
+          *out++ = *inserted++;
+        *out++ = *u;
+      }
+      std::copy(inserted, inserted_end, out);
+    }
+    return new_neighs;
+  }
+
+  BaseGraph base_;
+  double compact_fraction_ = 0.1;
+  Deltas out_deltas_;
+  Deltas in_deltas_;
+  int64_t num_edges_directed_ = 0;
+  int64_t pending_updates_ = 0;
+};
+
+#endif  // DYN_GRAPH_H_
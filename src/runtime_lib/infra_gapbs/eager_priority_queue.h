@@ -12,6 +12,7 @@
  * Phase-synchronous priority queue with dual representation
  * Representation 1: When using thread-local buckets, there is nothing stored in the data strucutre. It merely holds the current bucket index, next bucket index and other metadata. The real priority queue is distributed across threads. 
  * Representation 2: When using lazy buckets, the priority queue actually stores all the nodes with their buckets (the buckets are not distributed)
+ * Priorities can be integral or floating point, a priority p is in bin floor(p/delta)
  **/
 template<typename PriorityT_>
 class EagerPriorityQueue {
@@ -48,7 +49,12 @@ public:
   }
 
   bool finishedNode(NodeID v){
-    return priorities_[v]/delta_ < get_current_priority();
+    return get_bin(priorities_[v]) < get_current_priority();
+  }
+
+  // bin of a (non-negative) priority
+  size_t get_bin(PriorityT_ priority){
+    return static_cast<size_t>(priority / delta_);
   }
 
   PriorityT_* priorities_;
@@ -5,19 +5,28 @@
 #define GRAPH_H_
 
 #include <stdio.h>
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <iostream>
 #include <type_traits>
 #include <map>
 #include <thread>
 #include <mutex>
 
+#include "huge_pages.h"
+#include "platform_atomics.h"
 #include "pvector.h"
 #include "util.h"
 
 #include "infra_ligra/ligra/parallel.h"
 
 #include "segmentgraph.h"
+#include "compressedgraph.h"
+#include "replicatedgraph.h"
+#include "soagraph.h"
+#include "streamgraph.h"
+#include "permutation.h"
 #include <memory>
 #include <assert.h>
 
@@ -30,10 +39,61 @@ Simple container for graph in CSR format
  - Intended to be constructed by a Builder
  - To make weighted, set DestID_ template type to NodeWeight
  - MakeInverse parameter controls whether graph stores its inverse
+ - A directed graph can also be built without its inverse (push-only
+   programs), buildInverse() adds it when it is first needed
 */
 
-//static lock for deduplication flags (only created once)
-static std::mutex thread_mutex;
+// Deduplication flags of a push traversal, a 16-bit round stamp per vertex
+// instead of a 0/1 flag that has to be reset after every round
+//  - each round takes a new epoch and claims a vertex by swapping its stamp
+//    from an older epoch to the current one
+//  - the stamps are only cleared when the epoch wraps around, once every
+//    65535 rounds
+//  - traversals lease their own flags from the graph (get_flags_atomic_), so
+//    concurrent traversals of one graph don't share stamps
+class DeduplicationFlags {
+ public:
+  typedef uint16_t Epoch;
+
+  explicit DeduplicationFlags(int64_t num_nodes)
+      : num_nodes_(num_nodes), stamps_(new Epoch[num_nodes]) {
+    clear();
+  }
+
+  DeduplicationFlags(const DeduplicationFlags&) = delete;
+  DeduplicationFlags& operator=(const DeduplicationFlags&) = delete;
+
+  ~DeduplicationFlags() {
+    delete[] stamps_;
+  }
+
+  // starts a round, vertices claimed in earlier rounds can be claimed again
+  void nextEpoch() {
+    if (++epoch_ == 0) {
+      clear();
+      epoch_ = 1;
+    }
+  }
+
+  // true only for the first claim of v in the round
+  bool claim(int64_t v) {
+    Epoch stamp = stamps_[v];
+    return stamp != epoch_ && compare_and_swap(stamps_[v], stamp, epoch_);
+  }
+
+  int64_t num_nodes() const {
+    return num_nodes_;
+  }
+
+ private:
+  void clear() {
+    ligra::parallel_for_lambda((int64_t)0, num_nodes_, [&] (int64_t i) { stamps_[i] = 0; });
+  }
+
+  int64_t num_nodes_;
+  Epoch *stamps_;
+  Epoch epoch_ = 0;
+};
 
 // Used to hold node & weight, with another node it makes a weighted edge
 template <typename NodeID_=int32_t, typename WeightT_=int32_t>
@@ -94,49 +154,122 @@ typedef int32_t SGID;
 typedef EdgePair<SGID> SGEdge;
 typedef int64_t SGOffset;
 
+// Mappable serialized layout (written by WriterBase::WriteMappableGraph)
+//  - Fixed-size SGHeader followed by the offset and neighbor sections, each
+//    starting on a kSGAlignment boundary so they can be used in place from a
+//    memory mapping of the file
+//  - The first magic byte is neither 0 nor 1, so readers can tell it apart
+//    from the original GAPBS layout, which starts with a bool
+//  - Inverse sections are only present if the graph is directed and was
+//    written with its inverse, their positions are 0 otherwise
+//  - source identifies the text input (and build options) a cached graph was
+//    built from, it is all zeros for graphs that aren't caches
+//  - The weight type is given by dest_bytes and kSGFloatWeights (e.g. int32_t
+//    and float weights have the same size)
+static const char kSGMagic[8] = {'G', 'I', 'T', 'S', 'G', 'R', 'P', 'H'};
+static const uint32_t kSGVersion = 2;
+static const uint64_t kSGAlignment = 4096;
+static const uint32_t kSGDirected = 1;
+static const uint32_t kSGWeighted = 2;
+static const uint32_t kSGFloatWeights = 4;
+
+struct SGSource {
+  uint64_t key;
+  uint64_t size;
+  int64_t mtime;
+};
+
+struct SGHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t flags;
+  int64_t num_nodes;
+  int64_t num_edges;          // entries in each neighbor section
+  uint32_t id_bytes;
+  uint32_t dest_bytes;
+  uint64_t out_offsets_pos;
+  uint64_t out_neighs_pos;
+  uint64_t in_offsets_pos;
+  uint64_t in_neighs_pos;
+  SGSource source;
+};
+
+inline uint64_t SGAlign(uint64_t pos) {
+  return (pos + kSGAlignment - 1) / kSGAlignment * kSGAlignment;
+}
+
+// Weight flags of the header for a neighbor type
+template <typename DestID_>
+struct SGWeightFlags {
+  static const uint32_t value = 0;
+};
+
+template <typename NodeID_, typename WeightT_>
+struct SGWeightFlags<NodeWeight<NodeID_, WeightT_>> {
+  static const uint32_t value = kSGWeighted |
+      (std::is_floating_point<WeightT_>::value ? kSGFloatWeights : 0);
+};
+
 
 
 template <class NodeID_, class DestID_ = NodeID_, bool MakeInverse = true>
 class CSRGraph {
   // Used to access neighbors of vertex, basically sugar for iterators
+  // The range of n is neighs[offsets[n]] up to neighs[offsets[n+1]]
   class Neighborhood {
     NodeID_ n_;
-    DestID_** g_index_;
+    const SGOffset* g_offsets_;
+    DestID_* g_neighs_;
    public:
-    Neighborhood(NodeID_ n, DestID_** g_index) : n_(n), g_index_(g_index) {}
+    Neighborhood(NodeID_ n, const SGOffset* g_offsets, DestID_* g_neighs) :
+        n_(n), g_offsets_(g_offsets), g_neighs_(g_neighs) {}
     typedef DestID_* iterator;
-    iterator begin() { return g_index_[n_]; }
-    iterator end()   { return g_index_[n_+1]; }
+    iterator begin() { return g_neighs_ + g_offsets_[n_]; }
+    iterator end()   { return g_neighs_ + g_offsets_[n_+1]; }
   };
 
+  // Takes ownership of an array allocated with NewArray (huge_pages.h)
+  template <typename T_>
+  static std::shared_ptr<T_> OwnArray(T_* array) {
+    return std::shared_ptr<T_>(array, DeleteArray<T_>);
+  }
+
   void ReleaseResources() {
     //added a second condition to prevent double free (transpose graphs)
 /*
-    if (out_index_ != nullptr)
-      delete[] out_index_;
+    if (out_offsets_ != nullptr)
+      delete[] out_offsets_;
     if (out_neighbors_ != nullptr)
       delete[] out_neighbors_;
     if (directed_) {
-      if (in_index_ != nullptr && in_index_ != out_index_)
-        delete[] in_index_;
+      if (in_offsets_ != nullptr && in_offsets_ != out_offsets_)
+        delete[] in_offsets_;
       if (in_neighbors_ != nullptr && in_neighbors_ != out_neighbors_)
         delete[] in_neighbors_;
     }
-    if (flags_ != nullptr)
-      delete[] flags_;
 */
-    out_index_shared_.reset();
+    out_offsets_shared_.reset();
     out_neighbors_shared_.reset();
-    in_index_shared_.reset();
+    in_offsets_shared_.reset();
     in_neighbors_shared_.reset();
-    flags_shared_.reset();
+    compressed_out_.reset();
+    compressed_in_.reset();
+    replicated_out_.reset();
+    replicated_in_.reset();
+    soa_out_.reset();
+    soa_in_.reset();
+    stream_out_.reset();
+    stream_in_.reset();
+    permutation_.reset();
     offsets_shared_.reset();
     for (auto iter = label_to_segment.begin(); iter != label_to_segment.end(); iter++) {
       delete ((*iter).second);
     }
 
     // when we clear all the resources, we want to clear deduplication flags owned by threads too.
-    std::lock_guard<std::mutex> lock(thread_mutex);
+    std::lock_guard<std::mutex> lock(deduplication_mutex_);
+    for (DeduplicationFlags* flags : deduplication_flags)
+      delete flags;
     deduplication_flags.clear();
 
   }
@@ -146,78 +279,52 @@ class CSRGraph {
   julienne::graph<julienne::symmetricVertex> julienne_graph = __julienne_null_graph;
   //julienne::EdgeMap<julienne::uintE, julienne::symmetricVertex> *em;
   CSRGraph() : directed_(false), num_nodes_(-1), num_edges_(-1),
-    out_index_(nullptr), out_neighbors_(nullptr),
-  in_index_(nullptr), in_neighbors_(nullptr), flags_(nullptr), is_transpose_(false) {}
-
-  CSRGraph(int64_t num_nodes, DestID_** index, DestID_* neighs) :
+    out_offsets_(nullptr), out_neighbors_(nullptr),
+  in_offsets_(nullptr), in_neighbors_(nullptr),
+  offsets_(nullptr), is_transpose_(false) {}
+
+  // Takes ownership of arrays allocated with NewArray
+  CSRGraph(int64_t num_nodes, SGOffset* offsets, DestID_* neighs) :
+    CSRGraph(num_nodes, OwnArray(offsets), OwnArray(neighs)) {}
+
+  CSRGraph(int64_t num_nodes, SGOffset* out_offsets, DestID_* out_neighs,
+        SGOffset* in_offsets, DestID_* in_neighs) :
+    CSRGraph(num_nodes, OwnArray(out_offsets), OwnArray(out_neighs),
+             OwnArray(in_offsets), OwnArray(in_neighs), false) {}
+
+    CSRGraph(int64_t num_nodes, SGOffset* out_offsets, DestID_* out_neighs,
+        SGOffset* in_offsets, DestID_* in_neighs, bool is_transpose) :
+    CSRGraph(num_nodes, OwnArray(out_offsets), OwnArray(out_neighs),
+             OwnArray(in_offsets), OwnArray(in_neighs), is_transpose) {}
+
+  // Used when the arrays have owners other than NewArray (e.g. a file mapping)
+  CSRGraph(int64_t num_nodes, std::shared_ptr<SGOffset> offsets,
+           std::shared_ptr<DestID_> neighs) :
     directed_(false), num_nodes_(num_nodes),
-    out_index_(index), out_neighbors_(neighs),
-    in_index_(index), in_neighbors_(neighs){
-      out_index_shared_.reset(index);
-      out_neighbors_shared_.reset(neighs);
-      in_index_shared_ = out_index_shared_;
+    out_offsets_(offsets.get()), out_neighbors_(neighs.get()),
+    in_offsets_(offsets.get()), in_neighbors_(neighs.get()), is_transpose_(false) {
+      out_offsets_shared_ = offsets;
+      out_neighbors_shared_ = neighs;
+      in_offsets_shared_ = out_offsets_shared_;
       in_neighbors_shared_ = out_neighbors_shared_;
-      
-      num_edges_ = (out_index_[num_nodes_] - out_index_[0]) / 2;
-      //adding flags used for deduplication
-      flags_ = new int[num_nodes_];
-      flags_shared_.reset(flags_);
-    //adding offsets for load balacne scheme
-    SetUpOffsets(true);
-    //Set this up for getting random neighbors
-      srand(time(NULL));
-    }
-
-  CSRGraph(int64_t num_nodes, DestID_** out_index, DestID_* out_neighs,
-        DestID_** in_index, DestID_* in_neighs) :
-    directed_(true), num_nodes_(num_nodes),
-    out_index_(out_index), out_neighbors_(out_neighs),
-    in_index_(in_index), in_neighbors_(in_neighs), is_transpose_(false){
-      num_edges_ = out_index_[num_nodes_] - out_index_[0];
-      out_index_shared_.reset(out_index);
-      out_neighbors_shared_.reset(out_neighs);
-      in_index_shared_.reset(in_index);
-      in_neighbors_shared_.reset(in_neighs);
-      flags_ = new int[num_nodes_];
-      flags_shared_.reset(flags_);
-        SetUpOffsets(true);
-
+      num_edges_ = (out_offsets_[num_nodes_] - out_offsets_[0]) / 2;
+      //adding offsets for load balacne scheme
+      SetUpOffsets(true);
       //Set this up for getting random neighbors
       srand(time(NULL));
     }
 
-    CSRGraph(int64_t num_nodes, DestID_** out_index, DestID_* out_neighs,
-        DestID_** in_index, DestID_* in_neighs, bool is_transpose) :
-    directed_(true), num_nodes_(num_nodes),
-    out_index_(out_index), out_neighbors_(out_neighs),
-    in_index_(in_index), in_neighbors_(in_neighs) , is_transpose_(is_transpose){
-      num_edges_ = out_index_[num_nodes_] - out_index_[0];
-
-      out_index_shared_.reset(out_index);
-      out_neighbors_shared_.reset(out_neighs);
-      in_index_shared_.reset(in_index);
-      in_neighbors_shared_.reset(in_neighs);
-      flags_ = new int[num_nodes_];
-      flags_shared_.reset(flags_);
-      SetUpOffsets(true);
-
-        //Set this up for getting random neighbors
-        srand(time(NULL));
-    }
-
-    CSRGraph(int64_t num_nodes, std::shared_ptr<DestID_*> out_index, std::shared_ptr<DestID_> out_neighs,
-        shared_ptr<DestID_*> in_index, shared_ptr<DestID_> in_neighs, bool is_transpose) :
+    CSRGraph(int64_t num_nodes, std::shared_ptr<SGOffset> out_offsets, std::shared_ptr<DestID_> out_neighs,
+        shared_ptr<SGOffset> in_offsets, shared_ptr<DestID_> in_neighs, bool is_transpose) :
     directed_(true), num_nodes_(num_nodes),
-    out_index_(out_index.get()), out_neighbors_(out_neighs.get()),
-    in_index_(in_index.get()), in_neighbors_(in_neighs.get()) , is_transpose_(is_transpose){
-      num_edges_ = out_index_[num_nodes_] - out_index_[0];
+    out_offsets_(out_offsets.get()), out_neighbors_(out_neighs.get()),
+    in_offsets_(in_offsets.get()), in_neighbors_(in_neighs.get()) , is_transpose_(is_transpose){
+      num_edges_ = out_offsets_[num_nodes_] - out_offsets_[0];
 
-      out_index_shared_ = (out_index);
+      out_offsets_shared_ = (out_offsets);
       out_neighbors_shared_ = (out_neighs);
-      in_index_shared_ = (in_index);
+      in_offsets_shared_ = (in_offsets);
       in_neighbors_shared_ = (in_neighs);
-      flags_ = new int[num_nodes_];
-      flags_shared_.reset(flags_);
     SetUpOffsets(true);
         //Set this up for getting random neighbors
         srand(time(NULL));
@@ -226,22 +333,33 @@ class CSRGraph {
   
     CSRGraph(CSRGraph& other) : directed_(other.directed_),
                                  num_nodes_(other.num_nodes_), num_edges_(other.num_edges_),
-                                 out_index_(other.out_index_), out_neighbors_(other.out_neighbors_),
-                                 in_index_(other.in_index_), in_neighbors_(other.in_neighbors_), is_transpose_(false){
+                                 out_offsets_(other.out_offsets_), out_neighbors_(other.out_neighbors_),
+                                 in_offsets_(other.in_offsets_), in_neighbors_(other.in_neighbors_), is_transpose_(false),
+                                 offsets_(other.offsets_) {
    /* Commenting this because object is not taking owner ship of the elements, notice destructor_free is set to false
         other.num_edges_ = -1;
         other.num_nodes_ = -1;
-        other.out_index_ = nullptr;
+        other.out_offsets_ = nullptr;
         other.out_neighbors_ = nullptr;
-        other.in_index_ = nullptr;
+        other.in_offsets_ = nullptr;
         other.in_neighbors_ = nullptr;
-        other.flags_ = nullptr;
         other.offsets_ = nullptr;
   */
-        out_index_shared_ = other.out_index_shared_;
+        out_offsets_shared_ = other.out_offsets_shared_;
         out_neighbors_shared_ = other.out_neighbors_shared_;
-        in_index_shared_ = other.in_index_shared_;
+        in_offsets_shared_ = other.in_offsets_shared_;
         in_neighbors_shared_ = other.in_neighbors_shared_;
+        compressed_out_ = other.compressed_out_;
+        compressed_in_ = other.compressed_in_;
+        replicated_out_ = other.replicated_out_;
+        replicated_in_ = other.replicated_in_;
+        soa_out_ = other.soa_out_;
+        soa_in_ = other.soa_in_;
+        stream_out_ = other.stream_out_;
+        stream_in_ = other.stream_in_;
+        permutation_ = other.permutation_;
+        source_ = other.source_;
+        offsets_shared_ = other.offsets_shared_;
         //Set this up for getting random neighbors
         srand(time(NULL));
 	
@@ -250,28 +368,47 @@ class CSRGraph {
 
   CSRGraph(CSRGraph&& other) : directed_(other.directed_),
     num_nodes_(other.num_nodes_), num_edges_(other.num_edges_),
-    out_index_(other.out_index_), out_neighbors_(other.out_neighbors_),
-    in_index_(other.in_index_), in_neighbors_(other.in_neighbors_), is_transpose_(false){
+    out_offsets_(other.out_offsets_), out_neighbors_(other.out_neighbors_),
+    in_offsets_(other.in_offsets_), in_neighbors_(other.in_neighbors_), is_transpose_(false),
+    offsets_(other.offsets_) {
       other.num_edges_ = -1;
       other.num_nodes_ = -1;
-      other.out_index_ = nullptr;
+      other.out_offsets_ = nullptr;
       other.out_neighbors_ = nullptr;
-      other.in_index_ = nullptr;
+      other.in_offsets_ = nullptr;
       other.in_neighbors_ = nullptr;
-      other.flags_ = nullptr;
     other.offsets_ = nullptr;
        
-        out_index_shared_ = other.out_index_shared_;
+        out_offsets_shared_ = other.out_offsets_shared_;
         out_neighbors_shared_ = other.out_neighbors_shared_;
-        in_index_shared_ = other.in_index_shared_;
+        in_offsets_shared_ = other.in_offsets_shared_;
         in_neighbors_shared_ = other.in_neighbors_shared_;
+        compressed_out_ = other.compressed_out_;
+        compressed_in_ = other.compressed_in_;
+        replicated_out_ = other.replicated_out_;
+        replicated_in_ = other.replicated_in_;
+        soa_out_ = other.soa_out_;
+        soa_in_ = other.soa_in_;
+        stream_out_ = other.stream_out_;
+        stream_in_ = other.stream_in_;
+        permutation_ = other.permutation_;
+        source_ = other.source_;
+        offsets_shared_ = other.offsets_shared_;
        
-        other.out_index_shared_.reset(); 
+        other.out_offsets_shared_.reset(); 
         other.out_neighbors_shared_.reset();
-        other.in_index_shared_.reset(); 
+        other.in_offsets_shared_.reset(); 
         other.in_neighbors_shared_.reset();
+        other.compressed_out_.reset();
+        other.compressed_in_.reset();
+        other.replicated_out_.reset();
+        other.replicated_in_.reset();
+        other.soa_out_.reset();
+        other.soa_in_.reset();
+        other.stream_out_.reset();
+        other.stream_in_.reset();
+        other.permutation_.reset();
        
-        other.flags_shared_.reset(); 
         other.offsets_shared_.reset();
       //Set this up for getting random neighbors
       srand(time(NULL));
@@ -291,23 +428,34 @@ class CSRGraph {
             directed_ = other.directed_;
             num_edges_ = other.num_edges_;
             num_nodes_ = other.num_nodes_;
-            out_index_ = other.out_index_;
+            out_offsets_ = other.out_offsets_;
             out_neighbors_ = other.out_neighbors_;
-            in_index_ = other.in_index_;
+            in_offsets_ = other.in_offsets_;
             in_neighbors_ = other.in_neighbors_;
-        out_index_shared_ = other.out_index_shared_;
+        out_offsets_shared_ = other.out_offsets_shared_;
         out_neighbors_shared_ = other.out_neighbors_shared_;
-        in_index_shared_ = other.in_index_shared_;
+        in_offsets_shared_ = other.in_offsets_shared_;
         in_neighbors_shared_ = other.in_neighbors_shared_;
+        compressed_out_ = other.compressed_out_;
+        compressed_in_ = other.compressed_in_;
+        replicated_out_ = other.replicated_out_;
+        replicated_in_ = other.replicated_in_;
+        soa_out_ = other.soa_out_;
+        soa_in_ = other.soa_in_;
+        stream_out_ = other.stream_out_;
+        stream_in_ = other.stream_in_;
+        permutation_ = other.permutation_;
+        source_ = other.source_;
+        offsets_ = other.offsets_;
+        offsets_shared_ = other.offsets_shared_;
             //need the following, otherwise would get double free errors
 /*
           other.num_edges_ = -1;
           other.num_nodes_ = -1;
-          other.out_index_ = nullptr;
+          other.out_offsets_ = nullptr;
           other.out_neighbors_ = nullptr;
-          other.in_index_ = nullptr;
+          other.in_offsets_ = nullptr;
           other.in_neighbors_ = nullptr;
-          other.flags_ = nullptr;
           other.offsets_ = nullptr;
 */
         }
@@ -321,28 +469,47 @@ class CSRGraph {
       directed_ = other.directed_;
       num_edges_ = other.num_edges_;
       num_nodes_ = other.num_nodes_;
-      out_index_ = other.out_index_;
+      out_offsets_ = other.out_offsets_;
       out_neighbors_ = other.out_neighbors_;
-      in_index_ = other.in_index_;
+      in_offsets_ = other.in_offsets_;
       in_neighbors_ = other.in_neighbors_;
-        out_index_shared_ = other.out_index_shared_;
+        out_offsets_shared_ = other.out_offsets_shared_;
         out_neighbors_shared_ = other.out_neighbors_shared_;
-        in_index_shared_ = other.in_index_shared_;
+        in_offsets_shared_ = other.in_offsets_shared_;
         in_neighbors_shared_ = other.in_neighbors_shared_;
+        compressed_out_ = other.compressed_out_;
+        compressed_in_ = other.compressed_in_;
+        replicated_out_ = other.replicated_out_;
+        replicated_in_ = other.replicated_in_;
+        soa_out_ = other.soa_out_;
+        soa_in_ = other.soa_in_;
+        stream_out_ = other.stream_out_;
+        stream_in_ = other.stream_in_;
+        permutation_ = other.permutation_;
+        source_ = other.source_;
+        offsets_ = other.offsets_;
+        offsets_shared_ = other.offsets_shared_;
       other.num_edges_ = -1;
       other.num_nodes_ = -1;
-      other.out_index_ = nullptr;
+      other.out_offsets_ = nullptr;
       other.out_neighbors_ = nullptr;
-      other.in_index_ = nullptr;
+      other.in_offsets_ = nullptr;
       other.in_neighbors_ = nullptr;
-      other.flags_ = nullptr;
       other.offsets_ = nullptr;
-        other.out_index_shared_.reset(); 
+        other.out_offsets_shared_.reset(); 
         other.out_neighbors_shared_.reset();
-        other.in_index_shared_.reset(); 
+        other.in_offsets_shared_.reset(); 
         other.in_neighbors_shared_.reset();
+        other.compressed_out_.reset();
+        other.compressed_in_.reset();
+        other.replicated_out_.reset();
+        other.replicated_in_.reset();
+        other.soa_out_.reset();
+        other.soa_in_.reset();
+        other.stream_out_.reset();
+        other.stream_in_.reset();
+        other.permutation_.reset();
        
-        other.flags_shared_.reset(); 
         other.offsets_shared_.reset();
     }
     return *this;
@@ -364,36 +531,265 @@ class CSRGraph {
     return directed_ ? num_edges_ : 2*num_edges_;
   }
 
+  // false for directed graphs built without their inverse
+  bool has_inverse() const {
+    return !directed_ || in_offsets_ != nullptr;
+  }
+
+  // Builds the inverse of a directed graph loaded without it in parallel
+  // from the out-edges, the in-neighbors end up sorted like a squished
+  // graph's. Has to be called outside of parallel regions before the
+  // in-edges are first used (e.g. by builtin_transpose).
+  void buildInverse() {
+    if (has_inverse())
+      return;
+    if (out_neighbors_ == nullptr) {
+      std::cout << "Building the inverse needs the out-edges in memory"
+                << std::endl;
+      std::exit(-29);
+    }
+    typedef SoASplit<NodeID_, DestID_> Split;
+    pvector<SGOffset> next(num_nodes_, 0);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (NodeID_ u=0; u < num_nodes_; u++) {
+      for (DestID_ d : out_neigh(u))
+        fetch_and_add(next[Split::Id(d)], 1);
+    }
+    SGOffset *index = NewArray<SGOffset>(num_nodes_+1);
+    SGOffset total = 0;
+    for (NodeID_ n=0; n < num_nodes_; n++) {
+      index[n] = total;
+      total += next[n];
+      next[n] = index[n];
+    }
+    index[num_nodes_] = total;
+    DestID_ *neighs = NewNeighborArray<DestID_>(index, num_nodes_);
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (NodeID_ u=0; u < num_nodes_; u++) {
+      for (DestID_ d : out_neigh(u))
+        neighs[fetch_and_add(next[Split::Id(d)], 1)] =
+            Split::Join(u, Split::Weight(d));
+    }
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (NodeID_ n=0; n < num_nodes_; n++)
+      std::sort(neighs + index[n], neighs + index[n+1]);
+    in_offsets_shared_ = OwnArray(index);
+    in_neighbors_shared_ = OwnArray(neighs);
+    in_offsets_ = index;
+    in_neighbors_ = neighs;
+    SetUpOffsets(true);
+    // copies of the topology built before get their in-edges too
+    if (compressed_out_ != nullptr)
+      compressed_in_ = std::make_shared<CompressedCSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_);
+    if (soa_out_ != nullptr)
+      soa_in_ = std::make_shared<SoACSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_);
+    if (replicated_out_ != nullptr)
+      replicated_in_ = std::make_shared<ReplicatedCSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_);
+  }
+
   int64_t out_degree(NodeID_ v) const {
-    return out_index_[v+1] - out_index_[v];
+    return out_offsets_[v+1] - out_offsets_[v];
   }
 
   int64_t in_degree(NodeID_ v) const {
     static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
-    return in_index_[v+1] - in_index_[v];
+    return in_offsets_[v+1] - in_offsets_[v];
   }
 
   Neighborhood out_neigh(NodeID_ n) const {
-    return Neighborhood(n, out_index_);
+    return Neighborhood(n, out_offsets_, out_neighbors_);
   }
 
   Neighborhood in_neigh(NodeID_ n) const {
     static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
-    return Neighborhood(n, in_index_);
+    return Neighborhood(n, in_offsets_, in_neighbors_);
+  }
+
+  // Neighbors in the copy of the node the calling thread is pinned to
+  // (buildReplicatedGraph), in the shared arrays for unpinned threads. Only
+  // the apply functions of replicated edgesets use them, the accessors above
+  // don't look for copies
+  Neighborhood out_neigh_replicated(NodeID_ n) const {
+    const SGOffset *offsets = out_offsets_;
+    DestID_ *neighs = out_neighbors_;
+    if (replicated_out_ != nullptr)
+      LocalReplica(*replicated_out_, &offsets, &neighs);
+    return Neighborhood(n, offsets, neighs);
+  }
+
+  Neighborhood in_neigh_replicated(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    const SGOffset *offsets = in_offsets_;
+    DestID_ *neighs = in_neighbors_;
+    if (replicated_in_ != nullptr)
+      LocalReplica(*replicated_in_, &offsets, &neighs);
+    return Neighborhood(n, offsets, neighs);
+  }
+
+  // Only valid after buildCompressedGraph
+  typename CompressedCSR<NodeID_, DestID_>::Neighborhood
+  out_neigh_compressed(NodeID_ n) const {
+    return compressed_out_->neigh(n);
+  }
+
+  typename CompressedCSR<NodeID_, DestID_>::Neighborhood
+  in_neigh_compressed(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return compressed_in_->neigh(n);
+  }
+
+  // Builds the delta + varint coded neighbor lists used by edgeset apply
+  // functions scheduled with compressed edges. Compiled with
+  // -DCOMPRESSED_ONLY, release_plain frees the uncompressed neighbor arrays
+  // while they are compressed, leaving out_neigh/in_neigh unusable but
+  // saving their memory. The generated code only asks for it for edgesets
+  // that every apply traverses compressed.
+  void buildCompressedGraph(bool release_plain = false) {
+    if (compressed_out_ != nullptr)
+      return;
+#ifndef COMPRESSED_ONLY
+    release_plain = false;
+#endif
+    // copies of the graph still read the plain arrays
+    bool release_out = release_plain &&
+        out_neighbors_shared_.use_count() == (directed_ ? 1 : 2);
+    bool release_in = release_plain && in_neighbors_shared_.use_count() == 1;
+    compressed_out_ = std::make_shared<CompressedCSR<NodeID_, DestID_>>(
+        num_nodes_, out_offsets_, out_neighbors_, release_out);
+    if (!directed_)
+      compressed_in_ = compressed_out_;
+    else if (has_inverse())
+      compressed_in_ = std::make_shared<CompressedCSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_, release_in);
+    if (release_plain) {
+      out_neighbors_shared_.reset();
+      in_neighbors_shared_.reset();
+      out_neighbors_ = nullptr;
+      in_neighbors_ = nullptr;
+    }
+  }
+
+  // Only valid after buildSoAWeights, the _ids versions leave the weights of
+  // the neighbors default constructed without reading them
+  typename SoACSR<NodeID_, DestID_>::template Neighborhood<true>
+  out_neigh_soa(NodeID_ n) const {
+    return soa_out_->neigh(n);
+  }
+
+  typename SoACSR<NodeID_, DestID_>::template Neighborhood<false>
+  out_neigh_soa_ids(NodeID_ n) const {
+    return soa_out_->ids(n);
+  }
+
+  typename SoACSR<NodeID_, DestID_>::template Neighborhood<true>
+  in_neigh_soa(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return soa_in_->neigh(n);
+  }
+
+  typename SoACSR<NodeID_, DestID_>::template Neighborhood<false>
+  in_neigh_soa_ids(NodeID_ n) const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return soa_in_->ids(n);
+  }
+
+  // Builds the copies with separate neighbor ID and weight arrays used by
+  // edgeset apply functions scheduled with the soa weight layout. With
+  // release_aos the array of structs neighbors are freed afterwards, the
+  // compiler only asks for it when every apply reads the copies
+  void buildSoAWeights(bool release_aos = false) {
+    if (soa_out_ != nullptr)
+      return;
+    soa_out_ = std::make_shared<SoACSR<NodeID_, DestID_>>(
+        num_nodes_, out_offsets_, out_neighbors_);
+    if (!directed_)
+      soa_in_ = soa_out_;
+    else if (has_inverse())
+      soa_in_ = std::make_shared<SoACSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_);
+    // copies of the graph still read the neighbors, graphs mapped from a
+    // cache share one owner with their offsets and keep the mapping
+    if (release_aos &&
+        out_neighbors_shared_.use_count() == (directed_ ? 1 : 2) &&
+        (!directed_ || in_neighbors_shared_.use_count() <= 1)) {
+      out_neighbors_shared_.reset();
+      in_neighbors_shared_.reset();
+      out_neighbors_ = nullptr;
+      in_neighbors_ = nullptr;
+    }
+  }
+
+  // Copies the offsets and neighbors to every NUMA node, after which
+  // out_neigh_replicated/in_neigh_replicated read the copy of the node the
+  // calling thread is pinned to (see replicatedgraph.h). The threads are only
+  // pinned by a NUMA placement mode (SetNUMAPlacement), so the copies are
+  // only built once every thread is pinned, the others would never read
+  // them. A single node keeps the one copy.
+  void buildReplicatedGraph() {
+    if (replicated_out_ != nullptr)
+      return;
+    if (numa_placement::NodeCPUs().size() < 2)
+      return;
+    if (!numa_placement::AllThreadsPinned()) {
+      std::cerr << "Topology replication needs every thread pinned to a node "
+                << "(NUMA placement with -DOPENMP), reading the shared arrays"
+                << std::endl;
+      return;
+    }
+    replicated_out_ = std::make_shared<ReplicatedCSR<NodeID_, DestID_>>(
+        num_nodes_, out_offsets_, out_neighbors_);
+    if (!directed_)
+      replicated_in_ = replicated_out_;
+    else if (has_inverse())
+      replicated_in_ = std::make_shared<ReplicatedCSR<NodeID_, DestID_>>(
+          num_nodes_, in_offsets_, in_neighbors_);
+  }
+
+  // nullptr unless the graph was reordered (see reorder.h)
+  std::shared_ptr<Permutation<NodeID_>> permutation() const {
+    return permutation_;
+  }
+
+  void set_permutation(std::shared_ptr<Permutation<NodeID_>> permutation) {
+    permutation_ = permutation;
+  }
+
+  // Identifies the input file the graph was loaded from (set by the Builder),
+  // all zeros for graphs built any other way
+  const SGSource& source() const {
+    return source_;
+  }
+
+  void set_source(const SGSource &source) {
+    source_ = source;
+  }
+
+  // Only valid for semi-external graphs (see MakeSemiExternalGraph), whose
+  // neighbors are read from disk one partition at a time
+  EdgeStream<NodeID_, DestID_>& out_stream() const {
+    return *stream_out_;
+  }
+
+  EdgeStream<NodeID_, DestID_>& in_stream() const {
+    static_assert(MakeInverse, "Graph inversion disabled but reading inverse");
+    return *stream_in_;
   }
 
   NodeID_ get_random_out_neigh(NodeID_ n)  {
-      int num_nghs = out_degree(n);
+      int64_t num_nghs = out_degree(n);
       assert(num_nghs!=0);
-      int rand_index = rand() % num_nghs;
-      return out_index_[n][rand_index];
+      int64_t rand_index = rand() % num_nghs;
+      return out_neighbors_[out_offsets_[n] + rand_index];
   }
 
   NodeID_ get_random_in_neigh(NodeID_ n)  {
-      int num_nghs = in_degree(n);
+      int64_t num_nghs = in_degree(n);
       assert(num_nghs!=0);
-      int rand_index = rand() % num_nghs;
-      return in_index_[n][rand_index];
+      int64_t rand_index = rand() % num_nghs;
+      return in_neighbors_[in_offsets_[n] + rand_index];
   }
 
   void PrintStats() const {
@@ -415,33 +811,30 @@ class CSRGraph {
     }
   }
 
-  static DestID_** GenIndex(const pvector<SGOffset> &offsets, DestID_* neighs) {
-    NodeID_ length = offsets.size();
-    DestID_** index = new DestID_*[length];
+  // The index is the offsets array itself, copied out of a builder's
+  // (possibly still in use) pvector
+  static SGOffset* GenIndex(const pvector<SGOffset> &offsets) {
+    SGOffset* index = NewArray<SGOffset>(offsets.size());
     #pragma omp parallel for
-    for (NodeID_ n=0; n < length; n++)
-      index[n] = neighs + offsets[n];
+    for (int64_t n=0; n < static_cast<int64_t>(offsets.size()); n++)
+      index[n] = offsets[n];
     return index;
   }
 
   pvector<SGOffset> VertexOffsets(bool in_graph = false) const {
     pvector<SGOffset> offsets(num_nodes_+1);
-    for (NodeID_ n=0; n < num_nodes_+1; n++)
-      if (in_graph)
-        offsets[n] = in_index_[n] - in_index_[0];
-      else
-        offsets[n] = out_index_[n] - out_index_[0];
+    const SGOffset* index = in_graph ? in_offsets_ : out_offsets_;
+    #pragma omp parallel for
+    for (int64_t n=0; n < num_nodes_+1; n++)
+      offsets[n] = index[n] - index[0];
     return offsets;
   }
 
+  // Offsets used by the edge-aware load balancing schemes, aliases the
+  // graph's own index instead of keeping another copy
   void SetUpOffsets(bool in_graph = false)  {
-      offsets_ = new SGOffset[num_nodes_+1];
-      offsets_shared_.reset(offsets_);
-      for (NodeID_ n=0; n < num_nodes_+1; n++)
-        if (in_graph)
-          offsets_[n] = in_index_[n] - in_index_[0];
-        else
-          offsets_[n] = out_index_[n] - out_index_[0];
+      offsets_shared_ = in_graph ? in_offsets_shared_ : out_offsets_shared_;
+      offsets_ = offsets_shared_.get();
     }
 
   Range<NodeID_> vertices() const {
@@ -457,157 +850,258 @@ class CSRGraph {
     return label_to_segment[label]->numSegments;      
   }
   
+  // With a cache directory (path, usually emitted from configApplySegmentCache,
+  // or -DSEGMENT_CACHE_DIR=\"dir\" if path is empty) the segments of graphs
+  // loaded from a file are mapped from a segment cache built for the same
+  // input and number of segments, or built and written there for the next run
   void buildPullSegmentedGraphs(std::string label, int numSegments, bool numa_aware=false, std::string path="") {
+    buildInverse();
     auto graphSegments = new GraphSegments<DestID_,NodeID_>(numSegments, numa_aware);
     label_to_segment[label] = graphSegments;
 
-#ifdef LOADSEG
-    cout << "loading segmented graph from " << path << endl;
-#pragma omp parallel for num_threads(numSegments)
-    for (int i = 0; i < numSegments; i++) {
-      FILE *in;
-      in = fopen((path + "/" + std::to_string(i)).c_str(), "r");
-      auto sg = graphSegments->getSegmentedGraph(i);
-      fread((void *) &sg->numVertices, sizeof(sg->numVertices), 1, in);
-      fread((void *) &sg->numEdges, sizeof(sg->numEdges), 1, in);
-      sg->allocate(i);
-      fread((void *) sg->graphId, sizeof(*sg->graphId), sg->numVertices, in);
-      fread((void *) sg->edgeArray, sizeof(*sg->edgeArray), sg->numEdges, in);
-      fread((void *) sg->vertexArray, sizeof(*sg->vertexArray), sg->numVertices + 1, in);
-      fclose(in);
-    }
-    return;
+#ifdef SEGMENT_CACHE_DIR
+    if (path == "")
+      path = SEGMENT_CACHE_DIR;
 #endif
+    if (path == "" || InFingerprint() == 0) {
+      BuildPullSegments(graphSegments);
+      return;
+    }
+    SegHeader header = SegmentCacheHeader(numSegments, kSegPull);
+    std::string filename = path + "/" + SegmentCacheName(header);
+    if (graphSegments->open(filename, header))
+      return;
+    BuildPullSegments(graphSegments);
+    graphSegments->write(filename, header);
+  }
+
+  // Identifies the graph a segment cache was built for from the input file
+  // (its path, size and mtime and the build options, see source()) and the
+  // graph's size, without reading the edges. 0 for graphs that weren't
+  // loaded from a file, which can't use a segment cache.
+  uint64_t InFingerprint() const {
+    if (source_.key == 0)
+      return 0;
+    const uint64_t words[] = {source_.key, source_.size,
+                              static_cast<uint64_t>(source_.mtime),
+                              static_cast<uint64_t>(num_nodes_),
+                              static_cast<uint64_t>(num_edges_directed()),
+                              directed_, sizeof(NodeID_), sizeof(DestID_)};
+    uint64_t hash = kFNVOffset;
+    for (uint64_t word : words)
+      hash = (hash ^ word) * kFNVPrime;
+    return hash == 0 ? 1 : hash;
+  }
+
+private:
+  // Points offsets (and neighs) at the calling thread's copy, if it has one
+  static void LocalReplica(const ReplicatedCSR<NodeID_, DestID_> &replicated,
+                           const SGOffset **offsets, DestID_ **neighs) {
+    const typename ReplicatedCSR<NodeID_, DestID_>::Replica *local =
+        replicated.local();
+    if (local == nullptr)
+      return;
+    *offsets = local->offsets;
+    if (neighs != nullptr)
+      *neighs = local->neighs;
+  }
+
+  static const uint64_t kFNVOffset = 14695981039346656037ULL;
+  static const uint64_t kFNVPrime = 1099511628211ULL;
+
+  SegHeader SegmentCacheHeader(int numSegments, uint32_t direction) const {
+    SegHeader header;
+    std::memset(&header, 0, sizeof(SegHeader));
+    std::memcpy(header.magic, kSegMagic, sizeof(kSegMagic));
+    header.version = kSegVersion;
+    header.direction = direction;
+    header.fingerprint = InFingerprint();
+    header.num_nodes = num_nodes_;
+    header.num_edges = num_edges_directed();
+    header.num_segments = numSegments;
+    header.id_bytes = sizeof(NodeID_);
+    header.data_bytes = sizeof(DestID_);
+    return header;
+  }
+
+  static std::string SegmentCacheName(const SegHeader &header) {
+    char name[64];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".%d.%s.seg", header.fingerprint,
+             header.num_segments, header.direction == kSegPull ? "pull" : "push");
+    return name;
+  }
+
+  void BuildPullSegments(GraphSegments<DestID_,NodeID_> *graphSegments) {
+    int numSegments = graphSegments->numSegments;
     int segmentRange = (num_nodes() + numSegments - 1) / numSegments;
+    // Destinations are split into blocks that count and then fill their
+    // part of every segment independently, in the same order as a serial
+    // pass over the destinations would
+    const int64_t block_size = std::max<int64_t>(1 << 12, (num_nodes() + 4095) / 4096);
+    const int64_t num_blocks = (num_nodes() + block_size - 1) / block_size;
+    pvector<int64_t> vertex_counts((num_blocks + 1) * numSegments, 0);
+    pvector<int64_t> edge_counts((num_blocks + 1) * numSegments, 0);
+
     //Go through the original graph and count the number of target vertices and edges for each segment
-    for (auto d : vertices()){
-      for (auto s : in_neigh(d)){
-	int segment_id;
-	if (std::is_same<DestID_, NodeWeight<>>::value)
-	  segment_id = static_cast<NodeWeight<>>(s).v/segmentRange;
-	else
-	  segment_id = s/segmentRange;
-	graphSegments->getSegmentedGraph(segment_id)->countEdge(d);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block = 0; block < num_blocks; block++) {
+      int64_t *block_vertices = vertex_counts.data() + block * numSegments;
+      int64_t *block_edges = edge_counts.data() + block * numSegments;
+      std::vector<NodeID_> last_vertex(numSegments, -1);
+      NodeID_ block_end = std::min(num_nodes(), (block + 1) * block_size);
+      for (NodeID_ d = block * block_size; d < block_end; d++) {
+        for (auto s : in_neigh(d)) {
+          int segment_id = SegmentOf(s, segmentRange);
+          if (last_vertex[segment_id] != d) {
+            last_vertex[segment_id] = d;
+            block_vertices[segment_id]++;
+          }
+          block_edges[segment_id]++;
+        }
       }
     }
 
+    //Turn the counts into each block's starting position within every segment
+#pragma omp parallel for
+    for (int segment_id = 0; segment_id < numSegments; segment_id++) {
+      int64_t vertex_total = 0;
+      int64_t edge_total = 0;
+      for (int64_t block = 0; block <= num_blocks; block++) {
+        int64_t index = block * numSegments + segment_id;
+        int64_t block_vertices = vertex_counts[index];
+        int64_t block_edges = edge_counts[index];
+        vertex_counts[index] = vertex_total;
+        edge_counts[index] = edge_total;
+        vertex_total += block_vertices;
+        edge_total += block_edges;
+      }
+      auto sg = graphSegments->getSegmentedGraph(segment_id);
+      sg->numVertices = vertex_counts[num_blocks * numSegments + segment_id];
+      sg->numEdges = edge_counts[num_blocks * numSegments + segment_id];
+    }
+
     //Allocate each segment
     graphSegments->allocate();
 
     //Add the edges for each segment
-    for (auto d : vertices()){
-      for (auto s : in_neigh(d)){
-	int segment_id;
-	if (std::is_same<DestID_, NodeWeight<>>::value)
-	  segment_id = static_cast<NodeWeight<>>(s).v/segmentRange;
-	else
-	  segment_id = s/segmentRange;
-	graphSegments->getSegmentedGraph(segment_id)->addEdge(d, s);
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int64_t block = 0; block < num_blocks; block++) {
+      int64_t *next_vertex = vertex_counts.data() + block * numSegments;
+      int64_t *next_edge = edge_counts.data() + block * numSegments;
+      std::vector<NodeID_> last_vertex(numSegments, -1);
+      NodeID_ block_end = std::min(num_nodes(), (block + 1) * block_size);
+      for (NodeID_ d = block * block_size; d < block_end; d++) {
+        for (auto s : in_neigh(d)) {
+          int segment_id = SegmentOf(s, segmentRange);
+          auto sg = graphSegments->getSegmentedGraph(segment_id);
+          if (last_vertex[segment_id] != d) {
+            last_vertex[segment_id] = d;
+            sg->graphId[next_vertex[segment_id]] = d;
+            sg->vertexArray[next_vertex[segment_id]++] = next_edge[segment_id];
+          }
+          sg->edgeArray[next_edge[segment_id]++] = s;
+        }
       }
     }
+  }
 
-#ifdef STORESEG
-    cout << "output serialized graph segments to " << path << endl;
-#pragma omp parallel for num_threads(numSegments)
-    for(int i = 0; i < numSegments; i++) {
-      FILE *out = fopen((path + "/" + std::to_string(i)).c_str(), "w");
-      auto sg = graphSegments->getSegmentedGraph(i);
-      fwrite((void *) &sg->numVertices, sizeof(sg->numVertices), 1, out);
-      fwrite((void *) &sg->numEdges, sizeof(sg->numEdges), 1, out);
-      fwrite((void *) sg->graphId, sizeof(*sg->graphId), sg->numVertices, out);
-      fwrite((void *) sg->edgeArray, sizeof(*sg->edgeArray), sg->numEdges, out);
-      fwrite((void *) sg->vertexArray, sizeof(*sg->vertexArray), sg->numVertices + 1, out);
-      fclose(out);
-    }
-#endif
+  static int SegmentOf(DestID_ s, int segmentRange) {
+    return s/segmentRange;
   }
 
-private:
   // Making private so cannot be modified from outside
-  //useful for deduplication
-  int* flags_;
   SGOffset * offsets_;
 
   bool is_transpose_;
   bool directed_;
   int64_t num_nodes_;
   int64_t num_edges_;
-  DestID_** out_index_;
+  SGOffset* out_offsets_;
   DestID_*  out_neighbors_;
-  DestID_** in_index_;
+  SGOffset* in_offsets_;
   DestID_*  in_neighbors_;
 
 public:
-  std::shared_ptr<int> flags_shared_;
   std::shared_ptr<SGOffset> offsets_shared_;
 
-  std::shared_ptr<DestID_*> out_index_shared_;
+  std::shared_ptr<SGOffset> out_offsets_shared_;
   std::shared_ptr<DestID_> out_neighbors_shared_;
 
-  std::shared_ptr<DestID_*> in_index_shared_;
+  std::shared_ptr<SGOffset> in_offsets_shared_;
   std::shared_ptr<DestID_> in_neighbors_shared_;
 
+  std::shared_ptr<CompressedCSR<NodeID_, DestID_>> compressed_out_;
+  std::shared_ptr<CompressedCSR<NodeID_, DestID_>> compressed_in_;
+
+  std::shared_ptr<ReplicatedCSR<NodeID_, DestID_>> replicated_out_;
+  std::shared_ptr<ReplicatedCSR<NodeID_, DestID_>> replicated_in_;
+
+  std::shared_ptr<SoACSR<NodeID_, DestID_>> soa_out_;
+  std::shared_ptr<SoACSR<NodeID_, DestID_>> soa_in_;
+
+  std::shared_ptr<EdgeStream<NodeID_, DestID_>> stream_out_;
+  std::shared_ptr<EdgeStream<NodeID_, DestID_>> stream_in_;
+
+  // Set if the graph was reordered, maps the IDs of the input graph to ours
+  std::shared_ptr<Permutation<NodeID_>> permutation_;
+
+  SGSource source_ = SGSource();
+
   std::map<std::string, GraphSegments<DestID_,NodeID_>*> label_to_segment;
 
-  // thread safe deduplication vectors
-  // It is used to maintain different deduplication flags for different threads
-  // 1. Each thread asks for deduplication flag array whenever it needs one
-  // 2. Each thread gets the deduplication flag from the deduplication flags vector
-  //    (if we are using 4 threads in parallel, there can be 4 deduplication flags at most)
-  // 3. Each thread appends to deduplication_flags vector after they are done.
-  //    Since we only care for a binary update, we don't care about other
-  //    threads' work beforehand.
-  std::vector<int*> deduplication_flags;
+  // thread safe deduplication flags
+  // It is used to maintain different deduplication flags for different traversals
+  // 1. Each traversal asks for deduplication flags for every round it deduplicates
+  // 2. It gets flags that are not in use from the deduplication flags vector
+  //    (if 4 traversals run in parallel, there are 4 deduplication flags at most)
+  //    and starts a new epoch on them
+  // 3. It appends them back to the deduplication flags vector after the round.
+  //    The stamps of the round are left as they are, the next epoch ignores them.
+  std::vector<DeduplicationFlags*> deduplication_flags;
+  // guards deduplication_flags, copies of the graph lease from their own vector
+  std::mutex deduplication_mutex_;
  
-  DestID_** get_out_index_(void) {
-      return out_index_;
+  SGOffset* get_out_offsets_(void) {
+      return out_offsets_;
   } 
   DestID_* get_out_neighbors_(void) {
       return out_neighbors_;
   }
-  DestID_** get_in_index_(void) {
-      return in_index_;
+  SGOffset* get_in_offsets_(void) {
+      return in_offsets_;
   } 
   DestID_* get_in_neighbors_(void) {
       return in_neighbors_;
   }
 
-  // Atomically returns deduplication flag whenever a thread needs one.
-  inline int* get_flags_atomic_() {
-
-      // we guarantee correctness by locking the deduplication_flags vector.
-      std::lock_guard<std::mutex> lock(thread_mutex);
-
-      if (deduplication_flags.size() == 0) {
-
-          deduplication_flags.push_back(new int[num_nodes_]);
-          ligra::parallel_for_lambda(0, (int)num_nodes_, [&] (int i) { deduplication_flags.back()[i]=0; });
+  // Atomically returns deduplication flags whenever a traversal needs them, starting a new round on them.
+  inline DeduplicationFlags* get_flags_atomic_() {
+      DeduplicationFlags * to_return = nullptr;
+      {
+          // we guarantee correctness by locking the deduplication_flags vector.
+          std::lock_guard<std::mutex> lock(deduplication_mutex_);
+          if (deduplication_flags.size() != 0) {
+              to_return = deduplication_flags.back();
+              deduplication_flags.pop_back();
+          }
       }
 
-      int * to_return = deduplication_flags.back();
-
-      deduplication_flags.pop_back();
-
+      if (to_return == nullptr)
+          to_return = new DeduplicationFlags(num_nodes_);
+      to_return->nextEpoch();
       return to_return;
 
   }
-  // whenever a thread finishes processing deduplication logic, it immediately returns to flag
+  // whenever a traversal finishes a round, it immediately returns the flags
   // into the deduplication flags pool.
-  inline void return_flags_atomic_(int * flags) {
+  inline void return_flags_atomic_(DeduplicationFlags * flags) {
 
       // we guarantee correctness by locking the deduplication_flags vector.
-      std::lock_guard<std::mutex> lock(thread_mutex);
+      std::lock_guard<std::mutex> lock(deduplication_mutex_);
       deduplication_flags.push_back(flags);
 
   }
 
-  inline int* get_flags_() {
-      return flags_;
-  }
-  inline void set_flags_(int *flags) {
-      flags_ = flags;
-      flags_shared_.reset(flags);
-  }
   inline SGOffset * get_offsets_(void) {
       return offsets_;
   }
@@ -0,0 +1,207 @@
+#ifndef GRAPH_STORE_H_
+#define GRAPH_STORE_H_
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "graph.h"
+#include "reader.h"
+#include "writer.h"
+
+
+/*
+Graph store shared by the processes of a machine
+
+A graph is published once under a name and every later program attaches to
+it read-only, instead of building its own copy
+ - Published graphs are segments in the mappable serialized layout (SGHeader
+   in graph.h) in the store directory, by default /dev/shm, where they live
+   in shared memory (POSIX shared memory objects on Linux). The directory
+   comes from the GRAPHIT_GRAPH_STORE environment variable, -DGRAPH_STORE_DIR
+   or the default, in that order.
+ - Attaching maps the segment, so all processes share one physical copy and
+   startup doesn't depend on the graph size
+ - A registry file (graphit.registry) lists the published graphs, one line
+   with name, segment file, vertices and edges per graph. It is rewritten
+   under a lock, segments are written to a temporary file and renamed into
+   place, so programs attached to a replaced graph keep the old copy.
+ - Loading "store:<name>" (e.g. load("store:roads")) attaches to the graph,
+   edges.publish("roads") in a program publishes one
+*/
+
+
+namespace graph_store {
+
+static const char kPrefix[] = "store:";
+
+struct Entry {
+  std::string name;
+  std::string segment;
+  int64_t num_nodes;
+  int64_t num_edges;
+};
+
+inline std::string Dir() {
+  const char *dir = getenv("GRAPHIT_GRAPH_STORE");
+  if (dir != nullptr && dir[0] != '\0')
+    return dir;
+#ifdef GRAPH_STORE_DIR
+  return GRAPH_STORE_DIR;
+#else
+  return "/dev/shm";
+#endif
+}
+
+inline std::string RegistryFilename() {
+  return Dir() + "/graphit.registry";
+}
+
+// Names end up in file names, so they are restricted to [A-Za-z0-9_.-]
+inline void CheckName(const std::string &name) {
+  bool valid = !name.empty() && name[0] != '.';
+  for (char c : name) {
+    if (!isalnum(static_cast<unsigned char>(c)) && c != '_' && c != '.' &&
+        c != '-')
+      valid = false;
+  }
+  if (!valid) {
+    std::cout << "Invalid graph store name: " << name << std::endl;
+    std::exit(-30);
+  }
+}
+
+inline std::vector<Entry> ReadRegistry() {
+  std::vector<Entry> entries;
+  std::ifstream file(RegistryFilename());
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    Entry entry;
+    if (fields >> entry.name >> entry.segment >> entry.num_nodes >>
+        entry.num_edges)
+      entries.push_back(entry);
+  }
+  return entries;
+}
+
+// Holds the registry lock for its lifetime (a separate file, since the
+// registry itself is replaced on every update)
+class RegistryLock {
+ public:
+  RegistryLock() {
+    fd_ = open((RegistryFilename() + ".lock").c_str(), O_RDWR | O_CREAT, 0666);
+    if (fd_ == -1 || flock(fd_, LOCK_EX) != 0) {
+      std::cout << "Couldn't lock the graph store registry in " << Dir()
+                << std::endl;
+      std::exit(-30);
+    }
+  }
+
+  ~RegistryLock() {
+    flock(fd_, LOCK_UN);
+    close(fd_);
+  }
+
+ private:
+  int fd_;
+};
+
+// Replaces the entry for name (removes it if entry is nullptr), has to be
+// called with the registry lock held
+inline void UpdateRegistry(const std::string &name, const Entry *entry) {
+  std::vector<Entry> entries = ReadRegistry();
+  std::string tmp_name = RegistryFilename() + ".tmp" + std::to_string(getpid());
+  std::ofstream file(tmp_name);
+  for (const Entry &e : entries) {
+    if (e.name != name)
+      file << e.name << " " << e.segment << " " << e.num_nodes << " "
+           << e.num_edges << std::endl;
+  }
+  if (entry != nullptr)
+    file << entry->name << " " << entry->segment << " " << entry->num_nodes
+         << " " << entry->num_edges << std::endl;
+  file.close();
+  if (!file || std::rename(tmp_name.c_str(), RegistryFilename().c_str()) != 0) {
+    std::remove(tmp_name.c_str());
+    std::cout << "Couldn't update the graph store registry in " << Dir()
+              << std::endl;
+    std::exit(-30);
+  }
+}
+
+}  // namespace graph_store
+
+
+inline bool IsGraphStoreName(const std::string &filename) {
+  return filename.compare(0, sizeof(graph_store::kPrefix) - 1,
+                          graph_store::kPrefix) == 0;
+}
+
+inline std::vector<graph_store::Entry> ListStoredGraphs() {
+  return graph_store::ReadRegistry();
+}
+
+// Writes g to the store under name, replacing a graph published before
+template <typename NodeID_, typename DestID_>
+void PublishGraph(CSRGraph<NodeID_, DestID_> &g, const std::string &name) {
+  graph_store::CheckName(name);
+  // published with the inverse, so pull programs can share the copy as well
+  g.buildInverse();
+  std::string suffix = std::is_same<NodeID_, DestID_>::value ? ".sg" : ".wsg";
+  std::string segment = graph_store::Dir() + "/graphit." + name + suffix;
+  std::string tmp_name = segment + ".tmp" + std::to_string(getpid());
+  std::fstream file(tmp_name, std::ios::out | std::ios::binary);
+  if (file)
+    WriterBase<NodeID_, DestID_>(g).WriteMappableGraph(file);
+  file.close();
+  if (!file || std::rename(tmp_name.c_str(), segment.c_str()) != 0) {
+    std::remove(tmp_name.c_str());
+    std::cout << "Couldn't write " << segment << std::endl;
+    std::exit(-30);
+  }
+  graph_store::Entry entry = {name, segment, g.num_nodes(),
+                              g.num_edges_directed()};
+  graph_store::RegistryLock lock;
+  graph_store::UpdateRegistry(name, &entry);
+}
+
+// Maps the graph published under name (without the "store:" prefix)
+template <typename NodeID_, typename DestID_, typename WeightT_, bool invert>
+CSRGraph<NodeID_, DestID_, invert> AttachGraph(const std::string &name,
+                                               bool read_inverse = true) {
+  for (const graph_store::Entry &entry : graph_store::ReadRegistry()) {
+    if (entry.name == name) {
+      Reader<NodeID_, DestID_, WeightT_, invert> r(entry.segment);
+      return r.ReadSerializedGraph(false, read_inverse);
+    }
+  }
+  std::cout << "No graph " << name << " in the graph store "
+            << graph_store::Dir() << std::endl;
+  std::exit(-30);
+}
+
+// Processes attached to the graph keep their mapping until they exit
+inline bool UnpublishGraph(const std::string &name) {
+  graph_store::RegistryLock lock;
+  for (const graph_store::Entry &entry : graph_store::ReadRegistry()) {
+    if (entry.name == name) {
+      graph_store::UpdateRegistry(name, nullptr);
+      std::remove(entry.segment.c_str());
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif  // GRAPH_STORE_H_
@@ -0,0 +1,279 @@
+#ifndef HUGE_PAGES_H_
+#define HUGE_PAGES_H_
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "numa_placement.h"
+
+
+/*
+Allocation of large arrays (graph topology, properties and frontiers)
+
+Every array is aligned to a cache line. Arrays of at least a huge page
+(2MB) can be placed on huge pages, depending on the mode
+ - off:     plain aligned allocation
+ - thp:     2MB aligned and madvise(MADV_HUGEPAGE), so transparent huge pages
+            back them even when THP is only enabled for madvise regions
+ - hugetlb: mmap with MAP_HUGETLB from the reserved hugetlbfs pool, falling
+            back to thp when the pool is empty
+The mode comes from the compile flags (-DHUGE_PAGES for thp,
+-DHUGETLB_PAGES for hugetlb), the GRAPHIT_HUGE_PAGES environment variable or
+SetHugePages (configHugePages in a schedule). AlignedMalloc memory is
+released with free() so it can replace malloc (newA), NewArray memory has to
+be released with DeleteArray since it can come from hugetlbfs.
+PrintHugePageReport shows how much was requested and how much of it the
+kernel actually backs with huge pages. With a NUMA placement mode
+(numa_placement.h) large arrays are first touched in parallel right away,
+NewNeighborArray touches a neighbor array by the vertices owning it.
+*/
+
+
+enum class HugePageMode { kOff, kTHP, kHugeTLB };
+
+const size_t kCacheLineSize = 64;
+const size_t kHugePageSize = 2 << 20;
+
+
+namespace huge_pages {
+
+struct Stats {
+  std::atomic<int64_t> thp_bytes;
+  std::atomic<int64_t> hugetlb_bytes;
+  std::atomic<int64_t> hugetlb_fallbacks;
+};
+
+inline Stats& GetStats() {
+  static Stats stats = {{0}, {0}, {0}};
+  return stats;
+}
+
+inline bool ParseMode(const std::string &config, HugePageMode *mode) {
+  if (config == "off" || config == "0")
+    *mode = HugePageMode::kOff;
+  else if (config == "thp" || config == "1")
+    *mode = HugePageMode::kTHP;
+  else if (config == "hugetlb")
+    *mode = HugePageMode::kHugeTLB;
+  else
+    return false;
+  return true;
+}
+
+inline HugePageMode& Mode() {
+  static HugePageMode mode = [] {
+#if defined(HUGETLB_PAGES)
+    HugePageMode m = HugePageMode::kHugeTLB;
+#elif defined(HUGE_PAGES)
+    HugePageMode m = HugePageMode::kTHP;
+#else
+    HugePageMode m = HugePageMode::kOff;
+#endif
+    const char *env = std::getenv("GRAPHIT_HUGE_PAGES");
+    if (env != nullptr && !ParseMode(env, &m))
+      std::cout << "Unknown GRAPHIT_HUGE_PAGES: " << env << std::endl;
+    return m;
+  }();
+  return mode;
+}
+
+// Sizes of the live hugetlbfs mappings, anything else came from malloc
+inline std::map<void*, size_t>& HugeTLBMappings() {
+  static std::map<void*, size_t> mappings;
+  return mappings;
+}
+
+inline std::mutex& HugeTLBMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+inline size_t RoundUp(size_t bytes, size_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+inline void* MapHugeTLB(size_t bytes) {
+#ifdef MAP_HUGETLB
+  size_t length = RoundUp(bytes, kHugePageSize);
+  void *ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+  std::lock_guard<std::mutex> lock(HugeTLBMutex());
+  HugeTLBMappings()[ptr] = length;
+  GetStats().hugetlb_bytes += length;
+  return ptr;
+#else
+  return nullptr;
+#endif
+}
+
+// Unmaps ptr if it is a hugetlbfs mapping
+inline bool UnmapHugeTLB(void *ptr) {
+  if (GetStats().hugetlb_bytes == 0)
+    return false;
+  std::lock_guard<std::mutex> lock(HugeTLBMutex());
+  auto it = HugeTLBMappings().find(ptr);
+  if (it == HugeTLBMappings().end())
+    return false;
+  munmap(ptr, it->second);
+  GetStats().hugetlb_bytes -= it->second;
+  HugeTLBMappings().erase(it);
+  return true;
+}
+
+// Kilobytes of a field of a /proc file (e.g. AnonHugePages), -1 if missing
+inline int64_t ReadProcKB(const std::string &path, const std::string &field) {
+  std::ifstream file(path);
+  std::string name;
+  int64_t total = -1;
+  while (file >> name) {
+    if (name == field + ":") {
+      int64_t kb;
+      file >> kb;
+      total = (total < 0 ? 0 : total) + kb;
+    }
+    file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return total;
+}
+
+}  // namespace huge_pages
+
+
+inline void SetHugePages(const std::string &config) {
+  if (!huge_pages::ParseMode(config, &huge_pages::Mode())) {
+    std::cout << "Unknown huge page mode: " << config << std::endl;
+    std::exit(-27);
+  }
+}
+
+inline HugePageMode GetHugePages() {
+  return huge_pages::Mode();
+}
+
+// Cache line aligned, huge page aligned and advised when large enough
+inline void* AlignedMalloc(size_t bytes) {
+  bool huge = bytes >= kHugePageSize && GetHugePages() != HugePageMode::kOff;
+  void *ptr = nullptr;
+  if (posix_memalign(&ptr, huge ? kHugePageSize : kCacheLineSize,
+                     bytes == 0 ? kCacheLineSize : bytes) != 0)
+    return nullptr;
+#ifdef MADV_HUGEPAGE
+  // advised before the first touch, so the pages are faulted in as huge
+  if (huge && madvise(ptr, huge_pages::RoundUp(bytes, kHugePageSize),
+                      MADV_HUGEPAGE) == 0)
+    huge_pages::GetStats().thp_bytes += bytes;
+#endif
+  return ptr;
+}
+
+namespace huge_pages {
+
+template <typename T_>
+T_* Allocate(size_t num_elements) {
+  static_assert(std::is_trivially_destructible<T_>::value,
+                "NewArray does not run destructors");
+  size_t bytes = num_elements * sizeof(T_);
+  void *ptr = nullptr;
+  if (GetHugePages() == HugePageMode::kHugeTLB && bytes >= kHugePageSize) {
+    ptr = MapHugeTLB(bytes);
+    if (ptr == nullptr)
+      GetStats().hugetlb_fallbacks++;
+  }
+  if (ptr == nullptr)
+    ptr = AlignedMalloc(bytes);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return static_cast<T_*>(ptr);
+}
+
+template <typename T_>
+void Construct(T_ *array, size_t num_elements) {
+  if (!std::is_trivially_default_constructible<T_>::value) {
+    for (size_t i=0; i < num_elements; i++)
+      new (array + i) T_;
+  }
+}
+
+inline bool PlaceOnTouch(size_t bytes) {
+  return bytes >= kHugePageSize && GetNUMAPlacement() != NUMAPlacement::kOff;
+}
+
+}  // namespace huge_pages
+
+template <typename T_>
+T_* NewArray(size_t num_elements) {
+  T_ *array = huge_pages::Allocate<T_>(num_elements);
+  if (huge_pages::PlaceOnTouch(num_elements * sizeof(T_)))
+    FirstTouch(array, num_elements);
+  huge_pages::Construct(array, num_elements);
+  return array;
+}
+
+// Neighbor array of a CSR with the given offsets
+template <typename DestID_, typename OffsetsT_>
+DestID_* NewNeighborArray(const OffsetsT_ &offsets, int64_t num_nodes) {
+  DestID_ *neighs = huge_pages::Allocate<DestID_>(offsets[num_nodes]);
+  if (huge_pages::PlaceOnTouch(offsets[num_nodes] * sizeof(DestID_)))
+    FirstTouchNeighbors(neighs, offsets, num_nodes);
+  huge_pages::Construct(neighs, offsets[num_nodes]);
+  return neighs;
+}
+
+template <typename T_>
+void DeleteArray(T_ *array) {
+  if (array == nullptr)
+    return;
+  numa_placement::Forget(array);
+  if (!huge_pages::UnmapHugeTLB(array))
+    free(array);
+}
+
+// Gives the whole pages in [begin, end) of an array back to the OS, the
+// array stays allocated but the contents of the range are lost. Used to
+// shrink an array that is consumed front to back before it is freed.
+// Returns where the next range should start, the partial page at the end
+// isn't released yet.
+inline const void* ReleasePages(const void *begin, const void *end) {
+  size_t page = GetHugePages() == HugePageMode::kOff ?
+      static_cast<size_t>(sysconf(_SC_PAGESIZE)) : kHugePageSize;
+  uintptr_t first = huge_pages::RoundUp(reinterpret_cast<uintptr_t>(begin), page);
+  uintptr_t last = reinterpret_cast<uintptr_t>(end) / page * page;
+  if (first >= last)
+    return begin;
+  madvise(reinterpret_cast<void*>(first), last - first, MADV_DONTNEED);
+  return reinterpret_cast<const void*>(last);
+}
+
+inline void PrintHugePageReport(std::ostream &out = std::cout) {
+  const char *modes[] = {"off", "thp", "hugetlb"};
+  huge_pages::Stats &stats = huge_pages::GetStats();
+  out << "Huge pages: " << modes[static_cast<int>(GetHugePages())]
+      << std::endl;
+  out << "  THP advised:       " << (stats.thp_bytes >> 10) << " kB"
+      << std::endl;
+  int64_t thp_kb = huge_pages::ReadProcKB("/proc/self/smaps_rollup",
+                                          "AnonHugePages");
+  if (thp_kb < 0)
+    thp_kb = huge_pages::ReadProcKB("/proc/self/smaps", "AnonHugePages");
+  out << "  THP obtained:      " << thp_kb << " kB" << std::endl;
+  out << "  hugetlbfs mapped:  " << (stats.hugetlb_bytes >> 10) << " kB";
+  if (stats.hugetlb_fallbacks > 0)
+    out << " (" << stats.hugetlb_fallbacks << " fell back to THP)";
+  out << std::endl;
+}
+
+#endif  // HUGE_PAGES_H_
@@ -0,0 +1,308 @@
+#ifndef INCREMENTAL_H_
+#define INCREMENTAL_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "graph.h"
+#include "platform_atomics.h"
+#include "pvector.h"
+
+
+/*
+Incremental repair of algorithm results after a batch of edge changes
+
+g already contains the changes (DynamicGraph::graph() or a rebuilt graph),
+added and removed list the changed edges and the previous results are
+repaired in place. The work starts from the endpoints of the changed edges
+and only spreads as far as the results change
+ - IncrementalPageRank: residual propagation as in pagerankdelta.gt, the
+   ranks converge to the fixed point of the pagerank.gt update up to
+   epsilon per vertex
+ - IncrementalSSSP: distances from source as in sssp.gt (unreached is the
+   max of WeightT_), on an unweighted graph these are BFS depths. Removals
+   first invalidate the vertices that lost all their shortest paths, so
+   weights have to be positive
+ - IncrementalCC: minimum vertex ID labels as in cc.gt on undirected
+   graphs, removals reset the components they touch and additions merge
+   components
+*/
+
+
+namespace incremental {
+
+template <typename NodeID_>
+NodeID_ EdgeDest(NodeID_ v) {
+  return v;
+}
+
+template <typename NodeID_, typename WeightT_>
+NodeID_ EdgeDest(const NodeWeight<NodeID_, WeightT_> &v) {
+  return v.v;
+}
+
+template <typename NodeID_>
+int EdgeWeight(NodeID_ v) {
+  return 1;
+}
+
+template <typename NodeID_, typename WeightT_>
+WeightT_ EdgeWeight(const NodeWeight<NodeID_, WeightT_> &v) {
+  return v.w;
+}
+
+// Sources and destinations of the changed edges in both directions of an
+// undirected graph, without duplicates
+template <typename NodeID_, typename DestID_>
+std::vector<NodeID_> ChangedEndpoints(
+    const CSRGraph<NodeID_, DestID_> &g,
+    const pvector<EdgePair<NodeID_, DestID_>> &edges, bool sources) {
+  std::vector<NodeID_> endpoints;
+  for (const EdgePair<NodeID_, DestID_> &e : edges) {
+    if (sources || !g.directed())
+      endpoints.push_back(e.u);
+    if (!sources || !g.directed())
+      endpoints.push_back(EdgeDest(e.v));
+  }
+  std::sort(endpoints.begin(), endpoints.end());
+  endpoints.erase(std::unique(endpoints.begin(), endpoints.end()),
+                  endpoints.end());
+  return endpoints;
+}
+
+// Runs visit(u, add) for the vertices u of frontier in parallel and returns
+// the vertices passed to add, each of them once
+template <typename NodeID_, typename VisitFunc>
+std::vector<NodeID_> ExpandFrontier(const std::vector<NodeID_> &frontier,
+                                    pvector<uint8_t> &in_next,
+                                    VisitFunc visit) {
+  std::vector<NodeID_> next;
+  #pragma omp parallel
+  {
+    std::vector<NodeID_> local;
+    auto add = [&in_next, &local] (NodeID_ v) {
+      if (in_next[v] == 0 && compare_and_swap(in_next[v], 0, 1))
+        local.push_back(v);
+    };
+    #pragma omp for schedule(dynamic, 64) nowait
+    for (int64_t i=0; i < static_cast<int64_t>(frontier.size()); i++)
+      visit(frontier[i], add);
+    #pragma omp critical
+    next.insert(next.end(), local.begin(), local.end());
+  }
+  #pragma omp parallel for
+  for (int64_t i=0; i < static_cast<int64_t>(next.size()); i++)
+    in_next[next[i]] = 0;
+  return next;
+}
+
+template <typename T_>
+T_ AtomicAdd(T_ &x, T_ inc) {
+  T_ old_val, new_val;
+  do {
+    old_val = x;
+    new_val = old_val + inc;
+  } while (!compare_and_swap(x, old_val, new_val));
+  return new_val;
+}
+
+template <typename T_>
+T_ AtomicExchange(T_ &x, T_ new_val) {
+  T_ old_val;
+  do {
+    old_val = x;
+  } while (!compare_and_swap(x, old_val, new_val));
+  return old_val;
+}
+
+template <typename T_>
+bool AtomicMin(T_ &x, T_ new_val) {
+  T_ old_val = x;
+  while (new_val < old_val) {
+    if (compare_and_swap(x, old_val, new_val))
+      return true;
+    old_val = x;
+  }
+  return false;
+}
+
+}  // namespace incremental
+
+
+template <typename NodeID_, typename DestID_, typename ScoreT_>
+void IncrementalPageRank(const CSRGraph<NodeID_, DestID_> &g, ScoreT_ *ranks,
+                         const pvector<EdgePair<NodeID_, DestID_>> &added,
+                         const pvector<EdgePair<NodeID_, DestID_>> &removed,
+                         double damp = 0.85, double epsilon = 1e-9) {
+  using namespace incremental;
+  const ScoreT_ base_score = (1.0 - damp) / g.num_nodes();
+  // the in-neighbors of a vertex or their out-degrees changed
+  std::vector<NodeID_> affected = ChangedEndpoints(g, removed, false);
+  std::vector<NodeID_> sources = ChangedEndpoints(g, added, true);
+  std::vector<NodeID_> removed_sources = ChangedEndpoints(g, removed, true);
+  sources.insert(sources.end(), removed_sources.begin(), removed_sources.end());
+  for (NodeID_ u : sources) {
+    for (DestID_ v : g.out_neigh(u))
+      affected.push_back(EdgeDest(v));
+  }
+  std::sort(affected.begin(), affected.end());
+  affected.erase(std::unique(affected.begin(), affected.end()),
+                 affected.end());
+
+  pvector<ScoreT_> residuals(g.num_nodes(), 0);
+  pvector<uint8_t> in_next(g.num_nodes(), 0);
+  std::vector<NodeID_> frontier;
+  #pragma omp parallel for
+  for (int64_t i=0; i < static_cast<int64_t>(affected.size()); i++) {
+    NodeID_ v = affected[i];
+    ScoreT_ incoming = 0;
+    for (DestID_ u : g.in_neigh(v))
+      incoming += ranks[EdgeDest(u)] / g.out_degree(EdgeDest(u));
+    residuals[v] = base_score + damp * incoming - ranks[v];
+  }
+  for (NodeID_ v : affected) {
+    if (std::fabs(residuals[v]) > epsilon)
+      frontier.push_back(v);
+  }
+
+  while (!frontier.empty()) {
+    frontier = ExpandFrontier(frontier, in_next, [&] (NodeID_ u, auto add) {
+      ScoreT_ residual = AtomicExchange(residuals[u], static_cast<ScoreT_>(0));
+      ranks[u] += residual;
+      if (g.out_degree(u) == 0)
+        return;
+      ScoreT_ share = damp * residual / g.out_degree(u);
+      for (DestID_ v : g.out_neigh(u)) {
+        if (std::fabs(AtomicAdd(residuals[EdgeDest(v)], share)) > epsilon)
+          add(EdgeDest(v));
+      }
+    });
+  }
+}
+
+
+template <typename NodeID_, typename DestID_, typename WeightT_>
+void IncrementalSSSP(const CSRGraph<NodeID_, DestID_> &g, NodeID_ source,
+                     WeightT_ *dist,
+                     const pvector<EdgePair<NodeID_, DestID_>> &added,
+                     const pvector<EdgePair<NodeID_, DestID_>> &removed) {
+  using namespace incremental;
+  const WeightT_ kInf = std::numeric_limits<WeightT_>::max();
+  pvector<uint8_t> in_next(g.num_nodes(), 0);
+
+  // a vertex is invalid once none of its in-neighbors lies on a shortest
+  // path to it, which can make the vertices it leads to invalid as well
+  std::vector<NodeID_> frontier = ChangedEndpoints(g, removed, false);
+  std::vector<NodeID_> invalidated;
+  while (!frontier.empty()) {
+    std::vector<NodeID_> lost = ExpandFrontier(frontier, in_next,
+                                               [&] (NodeID_ v, auto add) {
+      if (v == source || dist[v] == kInf)
+        return;
+      for (DestID_ u : g.in_neigh(v)) {
+        WeightT_ d = dist[EdgeDest(u)];
+        if (d != kInf && d + EdgeWeight(u) == dist[v])
+          return;
+      }
+      add(v);
+    });
+    frontier = ExpandFrontier(lost, in_next, [&] (NodeID_ v, auto add) {
+      WeightT_ old_dist = dist[v];
+      dist[v] = kInf;
+      for (DestID_ w : g.out_neigh(v)) {
+        if (dist[EdgeDest(w)] == old_dist + EdgeWeight(w))
+          add(EdgeDest(w));
+      }
+    });
+    invalidated.insert(invalidated.end(), lost.begin(), lost.end());
+  }
+
+  // invalidated vertices take their best remaining in-neighbor and added
+  // edges can shorten paths, the relaxation starts from both
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (int64_t i=0; i < static_cast<int64_t>(invalidated.size()); i++) {
+    NodeID_ v = invalidated[i];
+    for (DestID_ u : g.in_neigh(v)) {
+      WeightT_ d = dist[EdgeDest(u)];
+      if (d != kInf && d + EdgeWeight(u) < dist[v])
+        dist[v] = d + EdgeWeight(u);
+    }
+  }
+  for (NodeID_ v : invalidated) {
+    if (dist[v] != kInf)
+      frontier.push_back(v);
+  }
+  for (const EdgePair<NodeID_, DestID_> &e : added) {
+    for (int dir = 0; dir < (g.directed() ? 1 : 2); dir++) {
+      NodeID_ u = dir == 0 ? e.u : EdgeDest(e.v);
+      NodeID_ v = dir == 0 ? EdgeDest(e.v) : e.u;
+      if (dist[u] != kInf && dist[u] + EdgeWeight(e.v) < dist[v]) {
+        dist[v] = dist[u] + EdgeWeight(e.v);
+        frontier.push_back(v);
+      }
+    }
+  }
+  std::sort(frontier.begin(), frontier.end());
+  frontier.erase(std::unique(frontier.begin(), frontier.end()),
+                 frontier.end());
+
+  while (!frontier.empty()) {
+    frontier = ExpandFrontier(frontier, in_next, [&] (NodeID_ u, auto add) {
+      for (DestID_ v : g.out_neigh(u)) {
+        if (AtomicMin(dist[EdgeDest(v)],
+                      static_cast<WeightT_>(dist[u] + EdgeWeight(v))))
+          add(EdgeDest(v));
+      }
+    });
+  }
+}
+
+
+template <typename NodeID_, typename DestID_>
+void IncrementalCC(const CSRGraph<NodeID_, DestID_> &g, NodeID_ *labels,
+                   const pvector<EdgePair<NodeID_, DestID_>> &added,
+                   const pvector<EdgePair<NodeID_, DestID_>> &removed) {
+  using namespace incremental;
+  // a removed edge can split its component, so its vertices start over
+  std::vector<NodeID_> split;
+  for (const EdgePair<NodeID_, DestID_> &e : removed)
+    split.push_back(labels[e.u]);
+  std::sort(split.begin(), split.end());
+  split.erase(std::unique(split.begin(), split.end()), split.end());
+  std::vector<NodeID_> frontier;
+  if (!split.empty()) {
+    #pragma omp parallel
+    {
+      std::vector<NodeID_> local;
+      #pragma omp for nowait
+      for (int64_t v=0; v < g.num_nodes(); v++) {
+        if (std::binary_search(split.begin(), split.end(), labels[v])) {
+          labels[v] = v;
+          local.push_back(v);
+        }
+      }
+      #pragma omp critical
+      frontier.insert(frontier.end(), local.begin(), local.end());
+    }
+  }
+  std::vector<NodeID_> merged = ChangedEndpoints(g, added, true);
+  frontier.insert(frontier.end(), merged.begin(), merged.end());
+  std::sort(frontier.begin(), frontier.end());
+  frontier.erase(std::unique(frontier.begin(), frontier.end()),
+                 frontier.end());
+
+  pvector<uint8_t> in_next(g.num_nodes(), 0);
+  while (!frontier.empty()) {
+    frontier = ExpandFrontier(frontier, in_next, [&] (NodeID_ u, auto add) {
+      for (DestID_ v : g.out_neigh(u)) {
+        if (AtomicMin(labels[EdgeDest(v)], labels[u]))
+          add(EdgeDest(v));
+      }
+    });
+  }
+}
+
+#endif  // INCREMENTAL_H_
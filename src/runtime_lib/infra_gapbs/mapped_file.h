@@ -0,0 +1,97 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <string>
+
+
+/*
+Class:  MappedFile
+
+Read-only memory mapping of an entire file
+ - Mapped MAP_SHARED, so the pages live in the page cache and are shared by
+   every process that maps the same file (one physical copy per machine)
+ - Compile with -DMMAP_POPULATE to prefault the whole mapping at open time
+   instead of taking page faults during the first traversal
+ - Always handed out through a shared_ptr; arrays that point into the mapping
+   use the shared_ptr aliasing constructor so the mapping stays alive for as
+   long as any graph still references it
+*/
+
+
+class MappedFile {
+ public:
+  // Returns nullptr if the file can't be opened or mapped
+  static std::shared_ptr<MappedFile> Open(const std::string &filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+      return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+      close(fd);
+      return nullptr;
+    }
+    int flags = MAP_SHARED;
+#if defined(MMAP_POPULATE) && defined(MAP_POPULATE)
+    flags |= MAP_POPULATE;
+#endif
+    void *addr = mmap(nullptr, st.st_size, PROT_READ, flags, fd, 0);
+    // the mapping holds its own reference to the file
+    close(fd);
+    if (addr == MAP_FAILED)
+      return nullptr;
+    return std::shared_ptr<MappedFile>(
+        new MappedFile(static_cast<char*>(addr), st.st_size));
+  }
+
+  ~MappedFile() {
+    munmap(data_, size_);
+  }
+
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile& operator=(const MappedFile &other) = delete;
+
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  // Typed pointer at byte offset pos, only valid if suitably aligned for T_
+  template <typename T_>
+  T_* At(size_t pos) const {
+    return reinterpret_cast<T_*>(data_ + pos);
+  }
+
+  template <typename T_>
+  bool IsAligned(size_t pos) const {
+    return reinterpret_cast<uintptr_t>(data_ + pos) % alignof(T_) == 0;
+  }
+
+  // Copies bytes out of the mapping, safe for unaligned positions
+  void Read(size_t pos, void *dest, size_t num_bytes) const {
+    std::memcpy(dest, data_ + pos, num_bytes);
+  }
+
+  // madvise over [pos, pos+num_bytes), widened to page boundaries
+  void Advise(size_t pos, size_t num_bytes, int advice) const {
+    const size_t page = sysconf(_SC_PAGESIZE);
+    size_t start = pos - (pos % page);
+    size_t end = std::min(pos + num_bytes, size_);
+    if (end > start)
+      madvise(data_ + start, end - start, advice);
+  }
+
+ private:
+  MappedFile(char *data, size_t size) : data_(data), size_(size) {}
+
+  char *data_;
+  size_t size_;
+};
+
+#endif  // MAPPED_FILE_H_
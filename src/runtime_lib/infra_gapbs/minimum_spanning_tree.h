@@ -23,7 +23,7 @@ static NodeID * minimum_spanning_tree(WGraph g, NodeID start){
     // Serial Dijkstra implementation to get oracle distances
     //pvector<WeightT> oracle_dist(g.num_nodes(), kDistInf);
     //pvector<WeightT> oracle_dist(g.num_nodes(), 2147483647);
-    NodeID * parent = new NodeID[g.num_nodes()];
+    NodeID * parent = NewArray<NodeID>(g.num_nodes());
     for (int i = 0; i < g.num_nodes(); i++){
         parent[i] = -1;
     }
@@ -0,0 +1,380 @@
+#ifndef NUMA_PLACEMENT_H_
+#define NUMA_PLACEMENT_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef OPENMP
+#include <omp.h>
+#endif
+
+
+/*
+NUMA placement of the large arrays of a program
+
+With a placement mode the OpenMP threads are pinned and the large arrays
+(NewArray in huge_pages.h) are first touched in parallel, so their pages end
+up on the node of the thread that works on them
+ - cores:   thread t is pinned to the t-th allowed CPU, with the CPUs
+            ordered node by node
+ - sockets: thread t is pinned to all CPUs of node t * nodes / threads
+ - off:     threads may run on any CPU of the process again and the arrays
+            are touched by whoever writes first
+Arrays are touched in contiguous blocks, one per thread, which is the static
+partitioning parallel_for and static-vertex-parallel loops use. Neighbor
+arrays are touched by the blocks of vertices owning them
+(FirstTouchNeighbors). Threads remember the node they are pinned to
+(ThreadNode), which picks their copy of a replicated graph
+(replicatedgraph.h). The mode is set with SetNUMAPlacement
+(configNUMAPlacement in a schedule) or the GRAPHIT_NUMA_PLACEMENT environment
+variable. Only OpenMP threads are pinned, in other builds (-DCILK or serial)
+the mode stays off with a warning. PrintPagePlacement samples the pages of the touched arrays and
+shows the share of them on each node.
+*/
+
+
+enum class NUMAPlacement { kOff, kCores, kSockets };
+
+
+namespace numa_placement {
+
+// Expands a sysfs CPU list such as 0-3,8-11
+inline std::vector<int> ParseCPUList(const std::string &list) {
+  std::vector<int> cpus;
+  std::stringstream ss(list);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n")
+      continue;
+    size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last = dash == std::string::npos ? first :
+               std::atoi(range.substr(dash + 1).c_str());
+    for (int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+// CPUs the process was allowed to run on before any thread was pinned
+inline const cpu_set_t& ProcessCPUs() {
+  static cpu_set_t allowed = [] {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    sched_getaffinity(0, sizeof(set), &set);
+    return set;
+  }();
+  return allowed;
+}
+
+// CPUs of the process grouped by node (one group without sysfs), node_ids
+// receives the number of the node of each group
+inline std::vector<std::vector<int>> NodeCPUs(
+    std::vector<int> *node_ids = nullptr) {
+  const cpu_set_t &allowed = ProcessCPUs();
+  std::vector<std::vector<int>> nodes;
+  if (node_ids != nullptr)
+    node_ids->clear();
+  for (int node = 0; ; node++) {
+    std::ifstream file("/sys/devices/system/node/node" +
+                       std::to_string(node) + "/cpulist");
+    if (!file)
+      break;
+    std::string list;
+    std::getline(file, list);
+    std::vector<int> cpus;
+    for (int cpu : ParseCPUList(list)) {
+      if (CPU_ISSET(cpu, &allowed))
+        cpus.push_back(cpu);
+    }
+    if (!cpus.empty()) {
+      nodes.push_back(cpus);
+      if (node_ids != nullptr)
+        node_ids->push_back(node);
+    }
+  }
+  if (nodes.empty()) {
+    nodes.emplace_back();
+    if (node_ids != nullptr)
+      node_ids->push_back(0);
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &allowed))
+        nodes.back().push_back(cpu);
+    }
+  }
+  return nodes;
+}
+
+inline bool ParseMode(const std::string &config, NUMAPlacement *mode) {
+  if (config == "off")
+    *mode = NUMAPlacement::kOff;
+  else if (config == "cores")
+    *mode = NUMAPlacement::kCores;
+  else if (config == "sockets")
+    *mode = NUMAPlacement::kSockets;
+  else
+    return false;
+  return true;
+}
+
+inline const char* ModeName(NUMAPlacement mode) {
+  const char *modes[] = {"off", "cores", "sockets"};
+  return modes[static_cast<int>(mode)];
+}
+
+// Group of NodeCPUs the calling thread is pinned to, -1 if it is not pinned
+inline int& ThreadNode() {
+  static thread_local int node = -1;
+  return node;
+}
+
+// Turns a placement mode off outside OpenMP builds: pinning the calling
+// thread would confine the Cilk workers, which inherit its mask, to one CPU or
+// node, and the arrays are not touched by the workers that use them
+inline NUMAPlacement Supported(NUMAPlacement mode) {
+#ifndef OPENMP
+  if (mode != NUMAPlacement::kOff) {
+    std::cerr << "NUMA placement " << ModeName(mode) << " needs OpenMP "
+              << "threads (-DOPENMP), placement stays off" << std::endl;
+    return NUMAPlacement::kOff;
+  }
+#endif
+  return mode;
+}
+
+inline void PinThreads(NUMAPlacement mode) {
+  std::vector<std::vector<int>> nodes = NodeCPUs();
+  std::vector<int> all_cpus, cpu_nodes;
+  for (size_t node = 0; node < nodes.size(); node++) {
+    all_cpus.insert(all_cpus.end(), nodes[node].begin(), nodes[node].end());
+    cpu_nodes.insert(cpu_nodes.end(), nodes[node].size(), node);
+  }
+  #pragma omp parallel
+  {
+    int thread = 0, num_threads = 1;
+#ifdef OPENMP
+    thread = omp_get_thread_num();
+    num_threads = omp_get_num_threads();
+#endif
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (mode == NUMAPlacement::kOff) {
+      set = ProcessCPUs();
+      ThreadNode() = -1;
+    } else if (mode == NUMAPlacement::kCores) {
+      CPU_SET(all_cpus[thread % all_cpus.size()], &set);
+      ThreadNode() = cpu_nodes[thread % all_cpus.size()];
+    } else {
+      int64_t node = static_cast<int64_t>(thread) * nodes.size() / num_threads;
+      for (int cpu : nodes[node])
+        CPU_SET(cpu, &set);
+      ThreadNode() = node;
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  }
+}
+
+// Whether every thread of a parallel region is pinned to a node
+inline bool AllThreadsPinned() {
+  int unpinned = 0;
+  #pragma omp parallel reduction(+:unpinned)
+  unpinned += ThreadNode() < 0;
+  return unpinned == 0;
+}
+
+inline NUMAPlacement& Mode() {
+  static NUMAPlacement mode = [] {
+    NUMAPlacement m = NUMAPlacement::kOff;
+    const char *env = std::getenv("GRAPHIT_NUMA_PLACEMENT");
+    if (env != nullptr && !ParseMode(env, &m))
+      std::cout << "Unknown GRAPHIT_NUMA_PLACEMENT: " << env << std::endl;
+    m = Supported(m);
+    ProcessCPUs();
+    if (m != NUMAPlacement::kOff)
+      PinThreads(m);
+    return m;
+  }();
+  return mode;
+}
+
+// Sizes of the arrays touched in parallel, for the placement report
+inline std::map<const void*, size_t>& PlacedArrays() {
+  static std::map<const void*, size_t> arrays;
+  return arrays;
+}
+
+inline std::mutex& PlacedMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+inline void Track(const void *array, size_t bytes) {
+  std::lock_guard<std::mutex> lock(PlacedMutex());
+  PlacedArrays()[array] = bytes;
+}
+
+inline void Forget(const void *array) {
+  std::lock_guard<std::mutex> lock(PlacedMutex());
+  PlacedArrays().erase(array);
+}
+
+// Places the pages of the page aligned [start, start + bytes) on node_id when
+// they are first touched
+inline bool BindToNode(void *start, size_t bytes, int node_id) {
+#ifdef SYS_mbind
+  const int kMPolBind = 2;
+  std::vector<unsigned long> mask(node_id / (8 * sizeof(unsigned long)) + 1);
+  mask[node_id / (8 * sizeof(unsigned long))] |=
+      1UL << (node_id % (8 * sizeof(unsigned long)));
+  return syscall(SYS_mbind, start, bytes, kMPolBind, mask.data(),
+                 mask.size() * 8 * sizeof(unsigned long) + 1, 0) == 0;
+#else
+  return false;
+#endif
+}
+
+// Pages of [start, start + bytes) per node, sampling at most max_pages pages
+// (unmapped pages are not counted)
+inline std::vector<int64_t> PagesPerNode(const void *start, size_t bytes,
+                                         size_t max_pages = 4096) {
+  std::vector<int64_t> counts;
+#ifdef SYS_move_pages
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  uintptr_t first = reinterpret_cast<uintptr_t>(start) / page_size * page_size;
+  size_t num_pages = (reinterpret_cast<uintptr_t>(start) + bytes - first +
+                      page_size - 1) / page_size;
+  size_t stride = std::max<size_t>(1, num_pages / max_pages);
+  std::vector<void*> pages;
+  for (size_t p = 0; p < num_pages; p += stride)
+    pages.push_back(reinterpret_cast<void*>(first + p * page_size));
+  std::vector<int> status(pages.size());
+  if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr,
+              status.data(), 0) != 0)
+    return counts;
+  for (int node : status) {
+    if (node < 0)
+      continue;
+    if (node >= static_cast<int>(counts.size()))
+      counts.resize(node + 1, 0);
+    counts[node]++;
+  }
+#endif
+  return counts;
+}
+
+// Whether the kernel reports the node of a page (move_pages), without it
+// PagesPerNode finds no pages
+inline bool PagePlacementAvailable() {
+  static int page = 1;
+  return !PagesPerNode(&page, sizeof(page), 1).empty();
+}
+
+}  // namespace numa_placement
+
+
+inline void SetNUMAPlacement(const std::string &config) {
+  NUMAPlacement mode;
+  if (!numa_placement::ParseMode(config, &mode)) {
+    std::cout << "Unknown NUMA placement: " << config << std::endl;
+    std::exit(-28);
+  }
+  mode = numa_placement::Supported(mode);
+  numa_placement::Mode() = mode;
+  numa_placement::PinThreads(mode);
+}
+
+inline NUMAPlacement GetNUMAPlacement() {
+  return numa_placement::Mode();
+}
+
+// Zeroes array in one contiguous block per thread
+template <typename T_>
+void FirstTouch(T_ *array, size_t num_elements) {
+  #pragma omp parallel
+  {
+    size_t thread = 0, num_threads = 1;
+#ifdef OPENMP
+    thread = omp_get_thread_num();
+    num_threads = omp_get_num_threads();
+#endif
+    size_t begin = num_elements * thread / num_threads;
+    size_t end = num_elements * (thread + 1) / num_threads;
+    std::memset(static_cast<void*>(array + begin), 0,
+                (end - begin) * sizeof(T_));
+  }
+  numa_placement::Track(array, num_elements * sizeof(T_));
+}
+
+// Zeroes the neighbors of one contiguous block of vertices per thread (the
+// blocks are clamped to the array in case the offsets are not sorted)
+template <typename DestID_, typename OffsetsT_>
+void FirstTouchNeighbors(DestID_ *neighs, const OffsetsT_ &offsets,
+                         int64_t num_nodes) {
+  const int64_t num_edges = offsets[num_nodes];
+  #pragma omp parallel
+  {
+    int64_t thread = 0, num_threads = 1;
+#ifdef OPENMP
+    thread = omp_get_thread_num();
+    num_threads = omp_get_num_threads();
+#endif
+    int64_t begin = offsets[num_nodes * thread / num_threads];
+    int64_t end = offsets[num_nodes * (thread + 1) / num_threads];
+    begin = std::min(std::max<int64_t>(begin, 0), num_edges);
+    end = std::min(std::max(end, begin), num_edges);
+    std::memset(static_cast<void*>(neighs + begin), 0,
+                (end - begin) * sizeof(DestID_));
+  }
+  numa_placement::Track(neighs, num_edges * sizeof(DestID_));
+}
+
+inline void PrintPagePlacement(std::ostream &out = std::cout) {
+  out << "NUMA placement: " << numa_placement::ModeName(GetNUMAPlacement())
+      << std::endl;
+  std::lock_guard<std::mutex> lock(numa_placement::PlacedMutex());
+  std::vector<int64_t> total;
+  for (auto &array : numa_placement::PlacedArrays()) {
+    std::vector<int64_t> counts =
+        numa_placement::PagesPerNode(array.first, array.second);
+    int64_t sampled = 0;
+    for (size_t node = 0; node < counts.size(); node++) {
+      sampled += counts[node];
+      if (node >= total.size())
+        total.resize(node + 1, 0);
+      total[node] += counts[node];
+    }
+    out << "  " << (array.second >> 10) << " kB:";
+    for (size_t node = 0; node < counts.size(); node++) {
+      out << " node" << node << " "
+          << 100 * counts[node] / std::max<int64_t>(1, sampled) << "%";
+    }
+    out << std::endl;
+  }
+  int64_t sampled = 0;
+  for (int64_t count : total)
+    sampled += count;
+  out << "  all sampled pages:";
+  if (total.empty())
+    out << " none";
+  for (size_t node = 0; node < total.size(); node++) {
+    out << " node" << node << " "
+        << 100 * total[node] / std::max<int64_t>(1, sampled) << "%";
+  }
+  out << std::endl;
+}
+
+#endif  // NUMA_PLACEMENT_H_
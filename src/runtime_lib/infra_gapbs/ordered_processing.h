@@ -29,9 +29,7 @@ struct updatePriorityMin
       }
       if (changed_dist) {
       	// assume the priority is mapped to a bin using delta
-      	size_t dest_bin;
-      	if (pq->delta_ != 1) dest_bin = new_val/pq->delta_;
-      	else dest_bin = new_val;
+      	size_t dest_bin = pq->get_bin(new_val);
       	
         if (dest_bin >= local_bins.size()) {
 	  local_bins.resize(dest_bin+1);
@@ -43,8 +41,8 @@ struct updatePriorityMin
 };
 
 
-template< class Priority, class EdgeApplyFunc , class WhileCond>
-  void OrderedProcessingOperatorNoMerge(EagerPriorityQueue<Priority>* pq, const WGraph &g, WhileCond while_cond, EdgeApplyFunc edge_apply,  NodeID optional_source_node){
+template< class Priority, class GraphT, class EdgeApplyFunc , class WhileCond>
+  void OrderedProcessingOperatorNoMerge(EagerPriorityQueue<Priority>* pq, const GraphT &g, WhileCond while_cond, EdgeApplyFunc edge_apply,  NodeID optional_source_node){
 
   pvector<NodeID> frontier(g.num_edges_directed());
   // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
@@ -96,7 +94,7 @@ template< class Priority, class EdgeApplyFunc , class WhileCond>
 	//TODO: need to refactor to use user supplied filtering on the source node
         //if (src_filter(u)) { //hard code this into the library
 	if (pq->priorities_[u] >= pq->delta_*pq->get_current_priority()){
-          for (WNode wn : g.out_neigh(u)) {
+          for (auto wn : g.out_neigh(u)) {
              edge_apply(local_bins, u, wn.v, wn.w);
           }
  
@@ -143,8 +141,8 @@ template< class Priority, class EdgeApplyFunc , class WhileCond>
 
 
 
-template<class Priority,  class WhileCond, class EdgeApplyFunc >
-  void OrderedProcessingOperatorWithMerge(EagerPriorityQueue<Priority>* pq, const WGraph &g,  WhileCond while_cond, EdgeApplyFunc edge_apply, int bin_size_threshold = 1000, NodeID optional_source_node=-1){
+template<class Priority, class GraphT, class WhileCond, class EdgeApplyFunc >
+  void OrderedProcessingOperatorWithMerge(EagerPriorityQueue<Priority>* pq, const GraphT &g,  WhileCond while_cond, EdgeApplyFunc edge_apply, int bin_size_threshold = 1000, NodeID optional_source_node=-1){
 
   pvector<NodeID> frontier(g.num_edges_directed());
   // two element arrays for double buffering curr=iter&1, next=(iter+1)&1
@@ -183,7 +181,7 @@ template<class Priority,  class WhileCond, class EdgeApplyFunc >
 	//TODO: need to refactor to use user supplied filtering on the source node
         //if (src_filter(u)) {
 	if (pq->priorities_[u] >= pq->delta_*pq->get_current_priority()){
-          for (WNode wn : g.out_neigh(u)) {
+          for (auto wn : g.out_neigh(u)) {
              edge_apply(local_bins, u, wn.v, wn.w);
           }
  
@@ -202,7 +200,7 @@ template<class Priority,  class WhileCond, class EdgeApplyFunc >
           NodeID u = cur_bin_copy[i];
           //if (src_filter(u)) {
 	  if (pq->priorities_[u] >= pq->delta_*pq->get_current_priority()){
-              for (WNode wn : g.out_neigh(u)) {  
+              for (auto wn : g.out_neigh(u)) {  
                  edge_apply(local_bins, u, wn.v, wn.w);
               }
           }
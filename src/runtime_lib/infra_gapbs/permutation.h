@@ -0,0 +1,65 @@
+#ifndef PERMUTATION_H_
+#define PERMUTATION_H_
+
+#include <cinttypes>
+
+#include "pvector.h"
+
+
+/*
+Class:  Permutation
+
+Maps the vertex IDs of a graph to the IDs it has after reordering (reorder.h)
+ - new_ids[old] is the new ID of old, the inverse is kept for ToOld
+ - Results computed on the reordered graph are indexed by new IDs,
+   RestoreOrder copies such a property back into the original ID order
+*/
+
+
+template <typename NodeID_>
+class Permutation {
+ public:
+  explicit Permutation(pvector<NodeID_> &&new_ids) :
+      new_ids_(std::move(new_ids)), old_ids_(new_ids_.size()) {
+    #pragma omp parallel for
+    for (int64_t n=0; n < size(); n++)
+      old_ids_[new_ids_[n]] = n;
+  }
+
+  Permutation(const Permutation &other) = delete;
+  Permutation& operator=(const Permutation &other) = delete;
+
+  int64_t size() const {
+    return new_ids_.size();
+  }
+
+  NodeID_ ToNew(NodeID_ old_id) const {
+    return new_ids_[old_id];
+  }
+
+  NodeID_ ToOld(NodeID_ new_id) const {
+    return old_ids_[new_id];
+  }
+
+  // Permutation of applying this one and then next
+  Permutation* Then(const Permutation &next) const {
+    pvector<NodeID_> new_ids(size());
+    #pragma omp parallel for
+    for (int64_t n=0; n < size(); n++)
+      new_ids[n] = next.ToNew(new_ids_[n]);
+    return new Permutation(std::move(new_ids));
+  }
+
+  template <typename T_>
+  void RestoreOrder(const T_ *by_new_id, T_ *by_old_id) const {
+    #pragma omp parallel for
+    for (int64_t n=0; n < size(); n++)
+      by_old_id[n] = by_new_id[new_ids_[n]];
+  }
+
+ private:
+  pvector<NodeID_> new_ids_;
+  pvector<NodeID_> old_ids_;
+};
+
+#endif  // PERMUTATION_H_
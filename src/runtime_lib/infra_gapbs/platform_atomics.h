@@ -125,4 +125,14 @@ Wrappers for compiler intrinsics for atomic memory operations (AMOs)
 
 #endif  // else defined _OPENMP
 
+
+// Mixed argument types (e.g. the int literal -1 compared against a NodeID
+// property under -DEDGELONG) are converted to the type of the target. The
+// compiler stores properties that hold vertices as NodeIDs, so vertex IDs
+// are never narrowed here
+template<typename T, typename U, typename V>
+bool compare_and_swap(T &x, const U &old_val, const V &new_val) {
+  return compare_and_swap(x, static_cast<T>(old_val), static_cast<T>(new_val));
+}
+
 #endif  // PLATFORM_ATOMICS_H_
@@ -5,6 +5,7 @@
 #define PVECTOR_H_
 
 #include <algorithm>
+#include <cinttypes>
 
 
 /*
@@ -155,4 +156,41 @@ class pvector {
   static const size_t growth_factor = 2;
 };
 
+
+// Exclusive prefix sum with the total appended, computed in parallel over
+// blocks of counts (vertex degrees, neighborhood sizes in bytes)
+template <typename T_>
+pvector<int64_t> ParallelPrefixSum(const pvector<T_> &counts) {
+  const size_t block_size = 1<<20;
+  const size_t num_blocks = (counts.size() + block_size - 1) / block_size;
+  pvector<int64_t> local_sums(num_blocks);
+  #pragma omp parallel for
+  for (size_t block=0; block < num_blocks; block++) {
+    int64_t lsum = 0;
+    size_t block_end = std::min((block + 1) * block_size, counts.size());
+    for (size_t i=block * block_size; i < block_end; i++)
+      lsum += counts[i];
+    local_sums[block] = lsum;
+  }
+  pvector<int64_t> bulk_prefix(num_blocks+1);
+  int64_t total = 0;
+  for (size_t block=0; block < num_blocks; block++) {
+    bulk_prefix[block] = total;
+    total += local_sums[block];
+  }
+  bulk_prefix[num_blocks] = total;
+  pvector<int64_t> prefix(counts.size() + 1);
+  #pragma omp parallel for
+  for (size_t block=0; block < num_blocks; block++) {
+    int64_t local_total = bulk_prefix[block];
+    size_t block_end = std::min((block + 1) * block_size, counts.size());
+    for (size_t i=block * block_size; i < block_end; i++) {
+      prefix[i] = local_total;
+      local_total += counts[i];
+    }
+  }
+  prefix[counts.size()] = bulk_prefix[num_blocks];
+  return prefix;
+}
+
 #endif  // PVECTOR_H_
@@ -8,9 +8,15 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
 #include <type_traits>
+#include <vector>
 
+#include "graph.h"
+#include "mapped_file.h"
 #include "pvector.h"
 #include "util.h"
 
@@ -25,7 +31,11 @@ Given filename, returns an edgelist or the entire graph (if serialized)
  - Determines file format from the filename's suffix
  - If the input graph is serialized (.sg or .wsg), reads the graph
    directly into the returned graph instance
+ - Serialized graphs are memory mapped (unless compiled with -DNO_MMAP); in
+   the aligned mappable layout the neighbor arrays are used in place
  - Otherwise, reads the file and returns an edgelist
+ - Text formats (.el, .wel, .gr, .mtx) are memory mapped, split into chunks
+   at line boundaries and parsed in parallel (unless compiled with -DNO_MMAP)
 */
 
 
@@ -282,6 +292,29 @@ class Reader {
     t.Start();
     EdgeList el;
     std::string suffix = GetSuffix();
+#ifndef NO_MMAP
+    if (suffix == ".el" || suffix == ".wel" || suffix == ".gr" ||
+        suffix == ".mtx") {
+      std::shared_ptr<MappedFile> mapping = MappedFile::Open(filename_);
+      if (mapping == nullptr) {
+        std::cout << "Couldn't open file " << filename_ << std::endl;
+        std::exit(-2);
+      }
+      if (suffix == ".el") {
+        el = ParseEL(*mapping, 0, mapping->size());
+      } else if (suffix == ".wel") {
+        needs_weights = false;
+        el = ParseWEL(*mapping, 0, mapping->size());
+      } else if (suffix == ".gr") {
+        needs_weights = false;
+        el = ParseGR(*mapping, 0, mapping->size());
+      } else {
+        el = ParseMTX(*mapping, needs_weights);
+      }
+      t.Stop();
+      return el;
+    }
+#endif
     std::ifstream file;
 
     if (suffix == ".bin") {
@@ -319,12 +352,52 @@ class Reader {
     return el;
   }
 
-  CSRGraph<NodeID_, DestID_, invert> ReadSerializedGraph() {
-    bool weighted = GetSuffix() == ".wsg";
-    if (!std::is_same<NodeID_, SGID>::value) {
-      std::cout << "serialized graphs only allowed for 32bit" << std::endl;
-      std::exit(-5);
+  // Hands the edges of a text input (.el, .wel, .gr, .mtx) to visit(el) one
+  // window of about window_bytes of text at a time, so the whole edge list is
+  // never in memory, returns false for inputs that can't be streamed
+  template <typename Visitor>
+  bool StreamEdges(Visitor visit, size_t window_bytes = 1 << 26) {
+#ifdef NO_MMAP
+    return false;
+#else
+    std::string suffix = GetSuffix();
+    if (suffix != ".el" && suffix != ".wel" && suffix != ".gr" &&
+        suffix != ".mtx")
+      return false;
+    std::shared_ptr<MappedFile> mapping = MappedFile::Open(filename_);
+    if (mapping == nullptr) {
+      std::cout << "Couldn't open file " << filename_ << std::endl;
+      std::exit(-2);
     }
+    bool mtx_weights = false, mtx_undirected = false;
+    size_t begin = 0;
+    if (suffix == ".mtx")
+      begin = ParseMTXHeader(*mapping, mtx_weights, mtx_undirected);
+    while (begin < mapping->size()) {
+      size_t end = LineBoundary(*mapping, begin + window_bytes);
+      visit(ParseText(*mapping, suffix, begin, end, mtx_weights,
+                      mtx_undirected));
+      // parsed text is only needed again on the next pass
+      mapping->Advise(begin, end - begin, MADV_DONTNEED);
+      begin = end;
+    }
+    return true;
+#endif
+  }
+
+  // Returns false if the file isn't readable or not in the mappable layout
+  bool ReadSerializedHeader(SGHeader &header) {
+    std::ifstream file(filename_, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(SGHeader)))
+      return false;
+    return std::memcmp(header.magic, kSGMagic, sizeof(kSGMagic)) == 0;
+  }
+
+  // print_time is off for graphs attached from the graph store (graph_store.h),
+  // without read_inverse directed graphs are returned without their inverse
+  CSRGraph<NodeID_, DestID_, invert> ReadSerializedGraph(
+      bool print_time = true, bool read_inverse = true) {
+    bool weighted = GetSuffix() == ".wsg";
     if (!weighted && !std::is_same<NodeID_, DestID_>::value) {
       std::cout << ".sg not allowed for weighted graphs" << std::endl;
       std::exit(-5);
@@ -333,46 +406,568 @@ class Reader {
       std::cout << ".wsg only allowed for weighted graphs" << std::endl;
       std::exit(-5);
     }
-    if (weighted && !std::is_same<WeightT_, SGID>::value) {
-      std::cout << ".wsg only allowed for int32_t weights" << std::endl;
-      std::exit(-5);
+#ifndef NO_MMAP
+    std::shared_ptr<MappedFile> mapping = MappedFile::Open(filename_);
+    if (mapping == nullptr) {
+      std::cout << "Couldn't open file " << filename_ << std::endl;
+      std::exit(-6);
     }
+    if (mapping->data()[0] != 0 && mapping->data()[0] != 1)
+      return ReadMappableGraph(mapping, weighted, print_time, read_inverse);
+    CheckGAPBSLayoutTypes(weighted);
+    return ReadMappedGAPBSGraph(mapping, print_time, read_inverse);
+#endif
+    CheckGAPBSLayoutTypes(weighted);
     std::ifstream file(filename_);
     if (!file.is_open()) {
       std::cout << "Couldn't open file " << filename_ << std::endl;
       std::exit(-6);
     }
+    if (file.peek() != 0 && file.peek() != 1) {
+      std::cout << "Mappable serialized graphs need a build without -DNO_MMAP"
+                << std::endl;
+      std::exit(-5);
+    }
     Timer t;
     t.Start();
     bool directed;
     SGOffset num_nodes, num_edges;
-    DestID_ **index = nullptr, **inv_index = nullptr;
+    SGOffset *index = nullptr, *inv_index = nullptr;
     DestID_ *neighs = nullptr, *inv_neighs = nullptr;
     file.read(reinterpret_cast<char*>(&directed), sizeof(bool));
     file.read(reinterpret_cast<char*>(&num_edges), sizeof(SGOffset));
     file.read(reinterpret_cast<char*>(&num_nodes), sizeof(SGOffset));
-    pvector<SGOffset> offsets(num_nodes+1);
-    neighs = new DestID_[num_edges];
     std::streamsize num_index_bytes = (num_nodes+1) * sizeof(SGOffset);
     std::streamsize num_neigh_bytes = num_edges * sizeof(DestID_);
-    file.read(reinterpret_cast<char*>(offsets.data()), num_index_bytes);
+    index = NewArray<SGOffset>(num_nodes+1);
+    file.read(reinterpret_cast<char*>(index), num_index_bytes);
+    CheckMappedOffsets(index, num_nodes, num_edges, filename_);
+    neighs = NewNeighborArray<DestID_>(index, num_nodes);
     file.read(reinterpret_cast<char*>(neighs), num_neigh_bytes);
-    index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, neighs);
-    if (directed && invert) {
-      inv_neighs = new DestID_[num_edges];
-      file.read(reinterpret_cast<char*>(offsets.data()), num_index_bytes);
+    if (directed && invert && read_inverse) {
+      inv_index = NewArray<SGOffset>(num_nodes+1);
+      file.read(reinterpret_cast<char*>(inv_index), num_index_bytes);
+      CheckMappedOffsets(inv_index, num_nodes, num_edges, filename_);
+      inv_neighs = NewNeighborArray<DestID_>(inv_index, num_nodes);
       file.read(reinterpret_cast<char*>(inv_neighs), num_neigh_bytes);
-      inv_index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets, inv_neighs);
     }
     file.close();
     t.Stop();
-    PrintTime("Read Time", t.Seconds());
+    if (print_time)
+      PrintTime("Read Time", t.Seconds());
+    if (directed)
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs,
+                                                inv_index, inv_neighs);
+    else
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs);
+  }
+
+  // Semi-external graph: only the offsets are read into memory, edgeset
+  // apply functions stream the neighbors from the file (see EdgeStream)
+  CSRGraph<NodeID_, DestID_, invert> ReadSemiExternalGraph(
+      int64_t buffer_edges, bool print_time = true) {
+    bool weighted = GetSuffix() == ".wsg";
+    std::ifstream file(filename_, std::ios::binary);
+    if (!file.is_open()) {
+      std::cout << "Couldn't open file " << filename_ << std::endl;
+      std::exit(-6);
+    }
+    Timer t;
+    t.Start();
+    bool directed;
+    int64_t num_nodes, num_edges;
+    uint64_t out_offsets_pos, out_neighs_pos, in_offsets_pos, in_neighs_pos;
+    SGHeader header;
+    if (ReadSerializedHeader(header)) {
+      CheckHeaderTypes(header, weighted);
+      directed = header.flags & kSGDirected;
+      num_nodes = header.num_nodes;
+      num_edges = header.num_edges;
+      out_offsets_pos = header.out_offsets_pos;
+      out_neighs_pos = header.out_neighs_pos;
+      in_offsets_pos = header.in_offsets_pos;
+      in_neighs_pos = header.in_neighs_pos;
+    } else {
+      CheckGAPBSLayoutTypes(weighted);
+      file.read(reinterpret_cast<char*>(&directed), sizeof(bool));
+      file.read(reinterpret_cast<char*>(&num_edges), sizeof(SGOffset));
+      file.read(reinterpret_cast<char*>(&num_nodes), sizeof(SGOffset));
+      out_offsets_pos = sizeof(bool) + 2*sizeof(SGOffset);
+      out_neighs_pos = out_offsets_pos + (num_nodes+1) * sizeof(SGOffset);
+      in_offsets_pos = out_neighs_pos + num_edges * sizeof(DestID_);
+      in_neighs_pos = in_offsets_pos + (num_nodes+1) * sizeof(SGOffset);
+    }
+    typedef EdgeStream<NodeID_, DestID_> Stream;
+    SGOffset *index = ReadOffsets(file, out_offsets_pos, num_nodes, num_edges);
+    CSRGraph<NodeID_, DestID_, invert> g;
+    if (directed) {
+      SGOffset *inv_index = nullptr;
+      bool inverse = invert && in_offsets_pos != 0;
+      if (inverse)
+        inv_index = ReadOffsets(file, in_offsets_pos, num_nodes, num_edges);
+      g = CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, nullptr,
+                                             inv_index, nullptr);
+      if (inverse)
+        g.stream_in_ = std::make_shared<Stream>(filename_, in_neighs_pos,
+                                                num_nodes, inv_index,
+                                                buffer_edges);
+      g.stream_out_ = std::make_shared<Stream>(filename_, out_neighs_pos,
+                                               num_nodes, index, buffer_edges);
+    } else {
+      g = CSRGraph<NodeID_, DestID_, invert>(
+          num_nodes, index, static_cast<DestID_*>(nullptr));
+      g.stream_out_ = std::make_shared<Stream>(filename_, out_neighs_pos,
+                                               num_nodes, index, buffer_edges);
+      g.stream_in_ = g.stream_out_;
+    }
+    t.Stop();
+    if (print_time)
+      PrintTime("Read Time", t.Seconds());
+    return g;
+  }
+
+ private:
+  void CheckHeaderTypes(const SGHeader &header, bool weighted) {
+    if (header.version != kSGVersion) {
+      std::cout << "Unsupported serialized graph version " << header.version
+                << std::endl;
+      std::exit(-5);
+    }
+    if (header.id_bytes != sizeof(NodeID_) ||
+        header.dest_bytes != sizeof(DestID_) ||
+        weighted != static_cast<bool>(header.flags & kSGWeighted) ||
+        (header.flags & (kSGWeighted | kSGFloatWeights)) !=
+            SGWeightFlags<DestID_>::value) {
+      std::cout << "Serialized graph types don't match the requested graph"
+                << std::endl;
+      std::exit(-5);
+    }
+  }
+
+  SGOffset* ReadOffsets(std::ifstream &file, uint64_t pos, int64_t num_nodes,
+                        int64_t num_edges) {
+    SGOffset *offsets = NewArray<SGOffset>(num_nodes+1);
+    file.seekg(pos);
+    file.read(reinterpret_cast<char*>(offsets),
+              (num_nodes+1) * sizeof(SGOffset));
+    if (!file) {
+      std::cout << "Serialized graph " << filename_ << " is truncated"
+                << std::endl;
+      std::exit(-6);
+    }
+    CheckMappedOffsets(offsets, num_nodes, num_edges, filename_);
+    return offsets;
+  }
+
+  // The original GAPBS layout has no type information, only 32bit IDs and
+  // weights are allowed in it (the mappable layout records its types)
+  void CheckGAPBSLayoutTypes(bool weighted) {
+    if (!std::is_same<NodeID_, SGID>::value) {
+      std::cout << "serialized graphs only allowed for 32bit" << std::endl;
+      std::exit(-5);
+    }
+    if (weighted && !std::is_same<WeightT_, SGID>::value) {
+      std::cout << ".wsg only allowed for int32_t weights" << std::endl;
+      std::exit(-5);
+    }
+  }
+
+  // Hand-rolled number parsing for the text formats, skips leading blanks
+  // and returns false (leaving p in place) if there is no number before eol
+  template <typename T_>
+  static bool ParseNumber(const char *&p, const char *eol, T_ &value) {
+    while (p < eol && (*p == ' ' || *p == '\t' || *p == '\r'))
+      p++;
+    return ParseNumber(p, eol, value, std::is_integral<T_>());
+  }
+
+  template <typename T_>
+  static bool ParseNumber(const char *&p, const char *eol, T_ &value,
+                          std::true_type) {
+    const char *q = p;
+    bool negative = false;
+    if (q < eol && (*q == '-' || *q == '+'))
+      negative = *q++ == '-';
+    if (q == eol || *q < '0' || *q > '9')
+      return false;
+    T_ result = 0;
+    while (q < eol && *q >= '0' && *q <= '9')
+      result = result * 10 + (*q++ - '0');
+    // integer types truncate real-valued fields, like operator>> does
+    while (q < eol && *q != ' ' && *q != '\t' && *q != '\r')
+      q++;
+    value = negative ? -result : result;
+    p = q;
+    return true;
+  }
+
+  template <typename T_>
+  static bool ParseNumber(const char *&p, const char *eol, T_ &value,
+                          std::false_type) {
+    // the mapping isn't null terminated, so copy the token out for strtod
+    char token[64];
+    size_t len = 0;
+    while (p + len < eol && len < sizeof(token) - 1 && p[len] != ' ' &&
+           p[len] != '\t' && p[len] != '\r') {
+      token[len] = p[len];
+      len++;
+    }
+    token[len] = '\0';
+    char *token_end;
+    double result = std::strtod(token, &token_end);
+    if (token_end == token)
+      return false;
+    value = static_cast<T_>(result);
+    p += len;
+    return true;
+  }
+
+  // Splits [mapping + begin, mapping + end) into chunks that start at line
+  // boundaries, runs parse_line(line, eol, chunk_el) on every line of each
+  // chunk in parallel, then concatenates the per-chunk edge lists in order,
+  // end must itself be a line boundary
+  template <typename LineParser>
+  static EdgeList ParseLines(const MappedFile &mapping, size_t begin,
+                             size_t end_pos, LineParser parse_line) {
+    const char *start = mapping.data() + begin;
+    const char *end = mapping.data() + end_pos;
+    const int64_t kMinChunkBytes = 1 << 16;
+    int64_t num_chunks = std::min<int64_t>(8 * getWorkers(),
+                                           (end - start) / kMinChunkBytes);
+    num_chunks = std::max<int64_t>(num_chunks, 1);
+    mapping.Advise(begin, end_pos - begin, MADV_SEQUENTIAL);
+    std::vector<const char*> bounds(num_chunks + 1);
+    bounds[0] = start;
+    bounds[num_chunks] = end;
+    for (int64_t c = 1; c < num_chunks; c++) {
+      const char *p = std::max(start + (end - start) * c / num_chunks,
+                               bounds[c-1]);
+      if (p > start && p[-1] != '\n') {
+        const char *eol = static_cast<const char*>(
+            std::memchr(p, '\n', end - p));
+        p = eol == nullptr ? end : eol + 1;
+      }
+      bounds[c] = p;
+    }
+    std::vector<EdgeList> chunk_els(num_chunks);
+    ligra::parallel_for_lambda((int64_t) 0, num_chunks, [&] (int64_t c) {
+      EdgeList &chunk_el = chunk_els[c];
+      const char *line = bounds[c];
+      while (line < bounds[c+1]) {
+        const char *eol = static_cast<const char*>(
+            std::memchr(line, '\n', end - line));
+        if (eol == nullptr)
+          eol = end;
+        parse_line(line, eol, chunk_el);
+        line = eol + 1;
+      }
+    });
+    pvector<size_t> chunk_offsets(num_chunks + 1);
+    chunk_offsets[0] = 0;
+    for (int64_t c = 0; c < num_chunks; c++)
+      chunk_offsets[c+1] = chunk_offsets[c] + chunk_els[c].size();
+    EdgeList el(chunk_offsets[num_chunks]);
+    ligra::parallel_for_lambda((int64_t) 0, num_chunks, [&] (int64_t c) {
+      std::copy(chunk_els[c].begin(), chunk_els[c].end(),
+                el.begin() + chunk_offsets[c]);
+    });
+    return el;
+  }
+
+  // First line boundary at or after pos
+  static size_t LineBoundary(const MappedFile &mapping, size_t pos) {
+    if (pos == 0 || pos >= mapping.size() || mapping.data()[pos-1] == '\n')
+      return std::min(pos, mapping.size());
+    const char *eol = static_cast<const char*>(
+        std::memchr(mapping.data() + pos, '\n', mapping.size() - pos));
+    return eol == nullptr ? mapping.size() : eol + 1 - mapping.data();
+  }
+
+  // Parses the lines of [begin, end) in any of the text formats, mtx_weights
+  // and mtx_undirected come from ParseMTXHeader
+  EdgeList ParseText(const MappedFile &mapping, const std::string &suffix,
+                     size_t begin, size_t end, bool mtx_weights = false,
+                     bool mtx_undirected = false) {
+    if (suffix == ".el")
+      return ParseEL(mapping, begin, end);
+    if (suffix == ".wel")
+      return ParseWEL(mapping, begin, end);
+    if (suffix == ".gr")
+      return ParseGR(mapping, begin, end);
+    return ParseMTXLines(mapping, begin, end, mtx_weights, mtx_undirected);
+  }
+
+  // Lines that don't start with an edge (comments, blanks) are skipped
+  EdgeList ParseEL(const MappedFile &mapping, size_t begin, size_t end) {
+    return ParseLines(mapping, begin, end,
+        [] (const char *p, const char *eol, EdgeList &el) {
+      NodeID_ u, v;
+      if (ParseNumber(p, eol, u) && ParseNumber(p, eol, v))
+        el.push_back(Edge(u, v));
+    });
+  }
+
+  EdgeList ParseWEL(const MappedFile &mapping, size_t begin, size_t end) {
+    return ParseLines(mapping, begin, end,
+        [] (const char *p, const char *eol, EdgeList &el) {
+      NodeID_ u;
+      NodeWeight<NodeID_, WeightT_> v;
+      if (ParseNumber(p, eol, u) && ParseNumber(p, eol, v.v) &&
+          ParseNumber(p, eol, v.w))
+        el.push_back(Edge(u, v));
+    });
+  }
+
+  EdgeList ParseGR(const MappedFile &mapping, size_t begin, size_t end) {
+    return ParseLines(mapping, begin, end,
+        [] (const char *p, const char *eol, EdgeList &el) {
+      if (p == eol || *p != 'a')
+        return;
+      p++;
+      NodeID_ u;
+      NodeWeight<NodeID_, WeightT_> v;
+      if (ParseNumber(p, eol, u) && ParseNumber(p, eol, v.v) &&
+          ParseNumber(p, eol, v.w))
+        el.push_back(Edge(u, v));
+    });
+  }
+
+  // Header is parsed serially with the same checks as ReadInMTX, the
+  // coordinate lines after it in parallel
+  EdgeList ParseMTX(const MappedFile &mapping, bool &needs_weights) {
+    bool read_weights, undirected;
+    size_t body = ParseMTXHeader(mapping, read_weights, undirected);
+    needs_weights = !read_weights;
+    return ParseMTXLines(mapping, body, mapping.size(), read_weights,
+                         undirected);
+  }
+
+  // Returns the position of the first coordinate line
+  size_t ParseMTXHeader(const MappedFile &mapping, bool &read_weights,
+                        bool &undirected) {
+    const char *data = mapping.data();
+    const char *end = data + mapping.size();
+    auto next_line = [&] (const char *p) {
+      const char *eol = static_cast<const char*>(
+          std::memchr(p, '\n', end - p));
+      return eol == nullptr ? end : eol + 1;
+    };
+    const char *body = next_line(data);
+    std::istringstream banner(std::string(data, body - data));
+    std::string start, object, format, field, symmetry;
+    banner >> start >> object >> format >> field >> symmetry;
+    if (start != "%%MatrixMarket") {
+      std::cout << ".mtx file did not start with %%MatrixMarket" << std::endl;
+      std::exit(-21);
+    }
+    if ((object != "matrix") || (format != "coordinate")) {
+      std::cout << "only allow matrix coordinate format for .mtx" << std::endl;
+      std::exit(-22);
+    }
+    if (field == "complex") {
+      std::cout << "do not support complex weights for .mtx" << std::endl;
+      std::exit(-23);
+    }
+    if (field == "pattern") {
+      read_weights = false;
+    } else if ((field == "real") || (field == "double") ||
+               (field == "integer")) {
+      read_weights = true;
+    } else {
+      std::cout << "unrecognized field type for .mtx" << std::endl;
+      std::exit(-24);
+    }
+    if (symmetry == "symmetric") {
+      undirected = true;
+    } else if ((symmetry == "general") || (symmetry == "skew-symmetric")) {
+      undirected = false;
+    } else {
+      std::cout << "unsupported symmetry type for .mtx" << std::endl;
+      std::exit(-25);
+    }
+    int64_t m = 0, n = 0, nonzeros = 0;
+    while (body < end) {
+      const char *eol = next_line(body);
+      const char *p = body;
+      body = eol;
+      if (*p == '%')
+        continue;
+      if (ParseNumber(p, eol, m) && ParseNumber(p, eol, n) &&
+          ParseNumber(p, eol, nonzeros))
+        break;
+    }
+    if (m != n) {
+      std::cout << m << " " << n << " " << nonzeros << std::endl;
+      std::cout << "matrix must be square for .mtx" << std::endl;
+      std::exit(-26);
+    }
+    return body - data;
+  }
+
+  EdgeList ParseMTXLines(const MappedFile &mapping, size_t begin, size_t end,
+                         bool read_weights, bool undirected) {
+    return ParseLines(mapping, begin, end,
+        [read_weights, undirected] (const char *p, const char *eol,
+                                    EdgeList &el) {
+      NodeID_ u;
+      NodeWeight<NodeID_, WeightT_> v;
+      if (!ParseNumber(p, eol, u) || !ParseNumber(p, eol, v.v))
+        return;
+      u -= 1;
+      v.v -= 1;
+      if (read_weights) {
+        if (!ParseNumber(p, eol, v.w))
+          return;
+        el.push_back(Edge(u, v));
+        if (undirected)
+          el.push_back(Edge(v.v, NodeWeight<NodeID_, WeightT_>(u, v.w)));
+      } else {
+        el.push_back(Edge(u, v.v));
+        if (undirected)
+          el.push_back(Edge(v.v, u));
+      }
+    });
+  }
+
+  // Parallel copy out of a mapping, used where sections aren't aligned
+  static void CopyFromMapping(const MappedFile &mapping, size_t pos,
+                              void *dest, size_t num_bytes) {
+    const size_t kBlockBytes = 1 << 22;
+    int64_t num_blocks = (num_bytes + kBlockBytes - 1) / kBlockBytes;
+    #pragma omp parallel for
+    for (int64_t b=0; b < num_blocks; b++) {
+      size_t start = b * kBlockBytes;
+      size_t len = std::min(kBlockBytes, num_bytes - start);
+      mapping.Read(pos + start, static_cast<char*>(dest) + start, len);
+    }
+  }
+
+  static void CheckMappingSize(const MappedFile &mapping, uint64_t end,
+                               const std::string &filename) {
+    if (end > mapping.size()) {
+      std::cout << "Serialized graph " << filename << " is truncated"
+                << std::endl;
+      std::exit(-6);
+    }
+  }
+
+  // Mapped offsets are used as the graph's index without a copy, so at least
+  // their end points have to stay inside the neighbor section
+  static void CheckMappedOffsets(const SGOffset *offsets, int64_t num_nodes,
+                                 int64_t num_edges,
+                                 const std::string &filename) {
+    if (offsets[0] != 0 || offsets[num_nodes] != num_edges) {
+      std::cout << "Serialized graph " << filename << " has corrupt offsets"
+                << std::endl;
+      std::exit(-6);
+    }
+  }
+
+  // Original GAPBS layout: the bool at the front leaves every array
+  // misaligned, so each section is copied once out of the page cache
+  CSRGraph<NodeID_, DestID_, invert> ReadMappedGAPBSGraph(
+      std::shared_ptr<MappedFile> mapping, bool print_time,
+      bool read_inverse) {
+    Timer t;
+    t.Start();
+    bool directed;
+    SGOffset num_nodes, num_edges;
+    size_t pos = 0;
+    CheckMappingSize(*mapping, sizeof(bool) + 2*sizeof(SGOffset), filename_);
+    mapping->Read(pos, &directed, sizeof(bool));
+    pos += sizeof(bool);
+    mapping->Read(pos, &num_edges, sizeof(SGOffset));
+    pos += sizeof(SGOffset);
+    mapping->Read(pos, &num_nodes, sizeof(SGOffset));
+    pos += sizeof(SGOffset);
+    size_t num_index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    size_t num_neigh_bytes = num_edges * sizeof(DestID_);
+    size_t section_bytes = num_index_bytes + num_neigh_bytes;
+    CheckMappingSize(*mapping, pos + (directed ? 2 : 1) * section_bytes,
+                     filename_);
+    mapping->Advise(pos, mapping->size() - pos, MADV_SEQUENTIAL);
+    SGOffset *index = nullptr, *inv_index = nullptr;
+    DestID_ *neighs = nullptr, *inv_neighs = nullptr;
+    index = NewArray<SGOffset>(num_nodes+1);
+    CopyFromMapping(*mapping, pos, index, num_index_bytes);
+    CheckMappedOffsets(index, num_nodes, num_edges, filename_);
+    neighs = NewNeighborArray<DestID_>(index, num_nodes);
+    CopyFromMapping(*mapping, pos + num_index_bytes, neighs, num_neigh_bytes);
+    if (directed && invert && read_inverse) {
+      pos += section_bytes;
+      inv_index = NewArray<SGOffset>(num_nodes+1);
+      CopyFromMapping(*mapping, pos, inv_index, num_index_bytes);
+      CheckMappedOffsets(inv_index, num_nodes, num_edges, filename_);
+      inv_neighs = NewNeighborArray<DestID_>(inv_index, num_nodes);
+      CopyFromMapping(*mapping, pos + num_index_bytes, inv_neighs,
+                      num_neigh_bytes);
+    }
+    t.Stop();
+    if (print_time)
+      PrintTime("Read Time", t.Seconds());
     if (directed)
       return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs,
                                                 inv_index, inv_neighs);
     else
       return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs);
   }
+
+  // Mappable layout: offset and neighbor arrays alias the read-only mapping,
+  // which is released once the last graph referencing it is destroyed
+  CSRGraph<NodeID_, DestID_, invert> ReadMappableGraph(
+      std::shared_ptr<MappedFile> mapping, bool weighted, bool print_time,
+      bool read_inverse) {
+    Timer t;
+    t.Start();
+    SGHeader header;
+    CheckMappingSize(*mapping, sizeof(SGHeader), filename_);
+    mapping->Read(0, &header, sizeof(SGHeader));
+    if (std::memcmp(header.magic, kSGMagic, sizeof(kSGMagic)) != 0) {
+      std::cout << filename_ << " is not a serialized graph" << std::endl;
+      std::exit(-5);
+    }
+    CheckHeaderTypes(header, weighted);
+    bool directed = header.flags & kSGDirected;
+    bool inverse = directed && header.in_offsets_pos != 0;
+    int64_t num_nodes = header.num_nodes;
+    uint64_t num_index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    uint64_t num_neigh_bytes = header.num_edges * sizeof(DestID_);
+    CheckMappingSize(*mapping, header.out_offsets_pos + num_index_bytes,
+                     filename_);
+    CheckMappingSize(*mapping, header.out_neighs_pos + num_neigh_bytes,
+                     filename_);
+    if (inverse) {
+      CheckMappingSize(*mapping, header.in_offsets_pos + num_index_bytes,
+                       filename_);
+      CheckMappingSize(*mapping, header.in_neighs_pos + num_neigh_bytes,
+                       filename_);
+    }
+    mapping->Advise(header.out_neighs_pos, num_neigh_bytes, MADV_WILLNEED);
+    std::shared_ptr<SGOffset> index(
+        mapping, mapping->At<SGOffset>(header.out_offsets_pos));
+    CheckMappedOffsets(index.get(), num_nodes, header.num_edges, filename_);
+    std::shared_ptr<DestID_> neighs(
+        mapping, mapping->At<DestID_>(header.out_neighs_pos));
+    std::shared_ptr<DestID_> inv_neighs;
+    std::shared_ptr<SGOffset> inv_index;
+    if (inverse && invert && read_inverse) {
+      mapping->Advise(header.in_neighs_pos, num_neigh_bytes, MADV_WILLNEED);
+      inv_index = std::shared_ptr<SGOffset>(
+          mapping, mapping->At<SGOffset>(header.in_offsets_pos));
+      CheckMappedOffsets(inv_index.get(), num_nodes, header.num_edges,
+                         filename_);
+      inv_neighs = std::shared_ptr<DestID_>(
+          mapping, mapping->At<DestID_>(header.in_neighs_pos));
+    }
+    t.Stop();
+    if (print_time)
+      PrintTime("Read Time", t.Seconds());
+    if (directed)
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs,
+                                                inv_index, inv_neighs, false);
+    else
+      return CSRGraph<NodeID_, DestID_, invert>(num_nodes, index, neighs);
+  }
 };
 
 #endif  // READER_H_
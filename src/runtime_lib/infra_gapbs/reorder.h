@@ -0,0 +1,366 @@
+#ifndef REORDER_H_
+#define REORDER_H_
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "builder.h"
+#include "graph.h"
+#include "permutation.h"
+#include "pvector.h"
+
+
+/*
+Vertex reordering for locality
+
+Each ordering returns new_ids (new_ids[old] is the new ID of old) and
+ReorderGraph builds the relabeled graph from it, for directed and weighted
+graphs alike. The reordered graph keeps its Permutation, so IDs from outside
+the program (e.g. source vertices from argv) can be translated to the new
+IDs and results translated back.
+ - degree: all vertices by decreasing degree
+ - hub-sort: vertices with above average degree (hubs) by decreasing
+   degree, followed by all other vertices in their original order
+ - hub-cluster: hubs followed by all other vertices, both in their
+   original order
+ - rcm: reverse Cuthill-McKee, a BFS that visits lower degree neighbors
+   first, started from a lowest degree vertex of every component
+ - gorder: greedily places next the vertex with the most in-neighbors in
+   common with and edges to the last few placed vertices (Gorder)
+For directed graphs the degree is the in-degree plus the out-degree, and
+rcm and gorder follow edges in both directions.
+*/
+
+
+template <typename NodeID_>
+NodeID_ ReorderID(NodeID_ n) {
+  return n;
+}
+
+template <typename NodeID_, typename WeightT_>
+NodeID_ ReorderID(NodeWeight<NodeID_, WeightT_> n) {
+  return n.v;
+}
+
+template <typename NodeID_>
+NodeID_ WithID(NodeID_ n, NodeID_ id) {
+  return id;
+}
+
+template <typename NodeID_, typename WeightT_>
+NodeWeight<NodeID_, WeightT_> WithID(NodeWeight<NodeID_, WeightT_> n,
+                                     NodeID_ id) {
+  return NodeWeight<NodeID_, WeightT_>(id, n.w);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+int64_t ReorderDegree(const CSRGraph<NodeID_, DestID_, invert> &g,
+                      NodeID_ n) {
+  if (g.directed())
+    return g.out_degree(n) + g.in_degree(n);
+  return g.out_degree(n);
+}
+
+// Calls f on the IDs of every neighbor of n (both directions if directed)
+template <typename NodeID_, typename DestID_, bool invert, typename F_>
+void ForEachReorderNeighbor(const CSRGraph<NodeID_, DestID_, invert> &g,
+                            NodeID_ n, F_ f) {
+  for (DestID_ d : g.out_neigh(n))
+    f(ReorderID(d));
+  if (g.directed()) {
+    for (DestID_ d : g.in_neigh(n))
+      f(ReorderID(d));
+  }
+}
+
+template <typename NodeID_>
+pvector<NodeID_> IDsFromOrder(const pvector<NodeID_> &order) {
+  pvector<NodeID_> new_ids(order.size());
+  #pragma omp parallel for
+  for (int64_t i=0; i < static_cast<int64_t>(order.size()); i++)
+    new_ids[order[i]] = i;
+  return new_ids;
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> DegreeOrder(const CSRGraph<NodeID_, DestID_, invert> &g) {
+  typedef std::pair<int64_t, NodeID_> degree_node_p;
+  pvector<degree_node_p> degree_id_pairs(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID_ n=0; n < g.num_nodes(); n++)
+    degree_id_pairs[n] = std::make_pair(-ReorderDegree(g, n), n);
+  std::sort(degree_id_pairs.begin(), degree_id_pairs.end());
+  pvector<NodeID_> order(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID_ n=0; n < g.num_nodes(); n++)
+    order[n] = degree_id_pairs[n].second;
+  return IDsFromOrder(order);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> HubOrder(const CSRGraph<NodeID_, DestID_, invert> &g,
+                          bool sort_hubs) {
+  int64_t total = g.directed() ? 2 * g.num_edges() : g.num_edges_directed();
+  double average = static_cast<double>(total) / std::max<int64_t>(1, g.num_nodes());
+  std::vector<std::pair<int64_t, NodeID_>> hubs;
+  std::vector<NodeID_> others;
+  for (NodeID_ n=0; n < g.num_nodes(); n++) {
+    int64_t degree = ReorderDegree(g, n);
+    if (degree > average)
+      hubs.push_back(std::make_pair(sort_hubs ? -degree : 0, n));
+    else
+      others.push_back(n);
+  }
+  std::sort(hubs.begin(), hubs.end());
+  pvector<NodeID_> order(g.num_nodes());
+  for (size_t i=0; i < hubs.size(); i++)
+    order[i] = hubs[i].second;
+  std::copy(others.begin(), others.end(), order.begin() + hubs.size());
+  return IDsFromOrder(order);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> HubSortOrder(const CSRGraph<NodeID_, DestID_, invert> &g) {
+  return HubOrder(g, true);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> HubClusterOrder(const CSRGraph<NodeID_, DestID_, invert> &g) {
+  return HubOrder(g, false);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> RCMOrder(const CSRGraph<NodeID_, DestID_, invert> &g) {
+  const int64_t num_nodes = g.num_nodes();
+  pvector<int64_t> degrees(num_nodes);
+  #pragma omp parallel for
+  for (NodeID_ n=0; n < num_nodes; n++)
+    degrees[n] = ReorderDegree(g, n);
+  auto by_degree = [&](NodeID_ a, NodeID_ b) {
+    return degrees[a] == degrees[b] ? a < b : degrees[a] < degrees[b];
+  };
+  pvector<NodeID_> starts(num_nodes);
+  for (NodeID_ n=0; n < num_nodes; n++)
+    starts[n] = n;
+  std::sort(starts.begin(), starts.end(), by_degree);
+  pvector<NodeID_> order(num_nodes);
+  std::vector<bool> visited(num_nodes, false);
+  std::vector<NodeID_> unvisited;
+  int64_t tail = 0;
+  for (NodeID_ start : starts) {
+    if (visited[start])
+      continue;
+    visited[start] = true;
+    int64_t head = tail;
+    order[tail++] = start;
+    while (head < tail) {
+      NodeID_ u = order[head++];
+      unvisited.clear();
+      ForEachReorderNeighbor(g, u, [&](NodeID_ v) {
+        if (!visited[v]) {
+          visited[v] = true;
+          unvisited.push_back(v);
+        }
+      });
+      std::sort(unvisited.begin(), unvisited.end(), by_degree);
+      for (NodeID_ v : unvisited)
+        order[tail++] = v;
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return IDsFromOrder(order);
+}
+
+// Max-priority queue of vertices with small integer scores that are only
+// ever incremented or decremented (the unit heap of Gorder)
+template <typename NodeID_>
+class ScoreBuckets {
+ public:
+  explicit ScoreBuckets(int64_t num_nodes) :
+      score_(num_nodes, 0), prev_(num_nodes), next_(num_nodes),
+      removed_(num_nodes, false), heads_(1, -1), top_(0) {
+    for (NodeID_ n=num_nodes-1; n >= 0; n--)
+      Insert(n);
+  }
+
+  void Increment(NodeID_ n) {
+    if (removed_[n])
+      return;
+    Unlink(n);
+    score_[n]++;
+    Insert(n);
+  }
+
+  void Decrement(NodeID_ n) {
+    if (removed_[n])
+      return;
+    Unlink(n);
+    score_[n]--;
+    Insert(n);
+  }
+
+  void Remove(NodeID_ n) {
+    Unlink(n);
+    removed_[n] = true;
+  }
+
+  // Removes and returns a vertex with the highest score, -1 if none is left
+  NodeID_ PopMax() {
+    while (top_ > 0 && heads_[top_] == -1)
+      top_--;
+    NodeID_ n = heads_[top_];
+    if (n != -1)
+      Remove(n);
+    return n;
+  }
+
+ private:
+  void Insert(NodeID_ n) {
+    int64_t s = score_[n];
+    if (s >= static_cast<int64_t>(heads_.size()))
+      heads_.resize(s + 1, -1);
+    prev_[n] = -1;
+    next_[n] = heads_[s];
+    if (heads_[s] != -1)
+      prev_[heads_[s]] = n;
+    heads_[s] = n;
+    top_ = std::max(top_, s);
+  }
+
+  void Unlink(NodeID_ n) {
+    if (prev_[n] != -1)
+      next_[prev_[n]] = next_[n];
+    else
+      heads_[score_[n]] = next_[n];
+    if (next_[n] != -1)
+      prev_[next_[n]] = prev_[n];
+  }
+
+  std::vector<int64_t> score_;
+  std::vector<NodeID_> prev_;
+  std::vector<NodeID_> next_;
+  std::vector<bool> removed_;
+  std::vector<NodeID_> heads_;
+  int64_t top_;
+};
+
+template <typename NodeID_, typename DestID_, bool invert>
+pvector<NodeID_> GorderOrder(const CSRGraph<NodeID_, DestID_, invert> &g,
+                             int window = 5) {
+  const int64_t num_nodes = g.num_nodes();
+  pvector<NodeID_> order(num_nodes);
+  if (num_nodes == 0)
+    return order;
+  // common in-neighbors with more out-neighbors than this are skipped, they
+  // would make placing a vertex cost as much as their whole neighborhoods
+  const int64_t max_parent_degree = std::max<int64_t>(16, std::sqrt(num_nodes));
+  ScoreBuckets<NodeID_> buckets(num_nodes);
+  auto update = [&](NodeID_ u, bool add) {
+    auto change = [&](NodeID_ v) {
+      if (add)
+        buckets.Increment(v);
+      else
+        buckets.Decrement(v);
+    };
+    for (DestID_ d : g.out_neigh(u))
+      change(ReorderID(d));
+    for (DestID_ d : g.in_neigh(u)) {
+      NodeID_ parent = ReorderID(d);
+      if (g.directed())
+        change(parent);
+      if (g.out_degree(parent) <= max_parent_degree) {
+        for (DestID_ sibling : g.out_neigh(parent)) {
+          if (ReorderID(sibling) != u)
+            change(ReorderID(sibling));
+        }
+      }
+    }
+  };
+  NodeID_ start = 0;
+  for (NodeID_ n=1; n < num_nodes; n++) {
+    if (g.in_degree(n) > g.in_degree(start))
+      start = n;
+  }
+  buckets.Remove(start);
+  order[0] = start;
+  update(start, true);
+  for (int64_t i=1; i < num_nodes; i++) {
+    if (i > window)
+      update(order[i - window - 1], false);
+    order[i] = buckets.PopMax();
+    update(order[i], true);
+  }
+  return IDsFromOrder(order);
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+void PermuteCSR(const CSRGraph<NodeID_, DestID_, invert> &g,
+                const Permutation<NodeID_> &perm, bool transpose,
+                SGOffset **index, DestID_ **neighs) {
+  pvector<NodeID_> degrees(g.num_nodes());
+  #pragma omp parallel for
+  for (NodeID_ n=0; n < g.num_nodes(); n++)
+    degrees[perm.ToNew(n)] = transpose ? g.in_degree(n) : g.out_degree(n);
+  pvector<SGOffset> offsets = BuilderBase<NodeID_>::ParallelPrefixSum(degrees);
+  *neighs = NewNeighborArray<DestID_>(offsets, g.num_nodes());
+  *index = CSRGraph<NodeID_, DestID_>::GenIndex(offsets);
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (NodeID_ n=0; n < g.num_nodes(); n++) {
+    DestID_ *start = *neighs + offsets[perm.ToNew(n)];
+    DestID_ *pos = start;
+    for (DestID_ d : (transpose ? g.in_neigh(n) : g.out_neigh(n)))
+      *pos++ = WithID(d, perm.ToNew(ReorderID(d)));
+    std::sort(start, pos);
+  }
+}
+
+// Relabels g with new_ids, the result remembers the permutation from the
+// IDs of the graph g was built from
+template <typename NodeID_, typename DestID_, bool invert>
+CSRGraph<NodeID_, DestID_, invert> ReorderGraph(
+    const CSRGraph<NodeID_, DestID_, invert> &g, pvector<NodeID_> &&new_ids) {
+  std::shared_ptr<Permutation<NodeID_>> perm =
+      std::make_shared<Permutation<NodeID_>>(std::move(new_ids));
+  SGOffset *index, *inv_index = nullptr;
+  DestID_ *neighs, *inv_neighs = nullptr;
+  PermuteCSR(g, *perm, false, &index, &neighs);
+  CSRGraph<NodeID_, DestID_, invert> reordered;
+  if (g.directed()) {
+    PermuteCSR(g, *perm, true, &inv_index, &inv_neighs);
+    reordered = CSRGraph<NodeID_, DestID_, invert>(g.num_nodes(), index,
+                                                   neighs, inv_index,
+                                                   inv_neighs);
+  } else {
+    reordered = CSRGraph<NodeID_, DestID_, invert>(g.num_nodes(), index,
+                                                   neighs);
+  }
+  if (g.permutation() != nullptr)
+    perm.reset(g.permutation()->Then(*perm));
+  reordered.set_permutation(perm);
+  return reordered;
+}
+
+template <typename NodeID_, typename DestID_, bool invert>
+CSRGraph<NodeID_, DestID_, invert> Reorder(
+    const CSRGraph<NodeID_, DestID_, invert> &g, const std::string &method) {
+  if (method == "degree")
+    return ReorderGraph(g, DegreeOrder(g));
+  if (method == "hub-sort")
+    return ReorderGraph(g, HubSortOrder(g));
+  if (method == "hub-cluster")
+    return ReorderGraph(g, HubClusterOrder(g));
+  if (method == "rcm")
+    return ReorderGraph(g, RCMOrder(g));
+  if (method == "gorder")
+    return ReorderGraph(g, GorderOrder(g));
+  std::cout << "Unknown vertex reordering: " << method << std::endl;
+  std::exit(-14);
+}
+
+#endif  // REORDER_H_
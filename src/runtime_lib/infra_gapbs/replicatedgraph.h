@@ -0,0 +1,117 @@
+#ifndef REPLICATED_GRAPH_H_
+#define REPLICATED_GRAPH_H_
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "huge_pages.h"
+#include "numa_placement.h"
+
+
+/*
+Class:  ReplicatedCSR
+
+Copies of one direction of a CSRGraph (offsets and neighbors) on every NUMA
+node, so threads read the topology from their own node's memory
+ - One copy per node with CPUs of the process, each in its own mapping that
+   is bound to the node (mbind) before it is written
+ - Weights are stored next to their neighbor (NodeWeight), so weighted
+   graphs get their weights replicated along with the neighbors
+ - local() is the copy of the node the calling thread was pinned to by a
+   NUMA placement mode, or nullptr for threads that are not pinned
+ - The copies are read only, a graph whose topology changes has to be
+   replicated again
+*/
+
+
+template <class NodeID_, class DestID_>
+class ReplicatedCSR {
+ public:
+  struct Replica {
+    const int64_t *offsets;
+    DestID_ *neighs;
+  };
+
+  // offsets and neighs are a CSR direction as kept by CSRGraph
+  ReplicatedCSR(int64_t num_nodes, const int64_t *offsets,
+                const DestID_ *neighs) {
+    std::vector<int> node_ids;
+    numa_placement::NodeCPUs(&node_ids);
+    size_t offsets_bytes = huge_pages::RoundUp((num_nodes + 1) *
+                                               sizeof(int64_t), kCacheLineSize);
+    size_t neighs_bytes = offsets[num_nodes] * sizeof(DestID_);
+    bytes_ = offsets_bytes + neighs_bytes;
+    for (int node_id : node_ids) {
+      void *mapping = mmap(nullptr, bytes_, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (mapping == MAP_FAILED)
+        throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+      if (bytes_ >= kHugePageSize && GetHugePages() != HugePageMode::kOff)
+        madvise(mapping, bytes_, MADV_HUGEPAGE);
+#endif
+      // binding before the first write places every page on node_id
+      numa_placement::BindToNode(mapping, bytes_, node_id);
+      int64_t *replica_offsets = static_cast<int64_t*>(mapping);
+      DestID_ *replica_neighs = reinterpret_cast<DestID_*>(
+          static_cast<char*>(mapping) + offsets_bytes);
+      ParallelCopy(replica_offsets, offsets, num_nodes + 1);
+      ParallelCopy(replica_neighs, neighs, offsets[num_nodes]);
+      numa_placement::Track(mapping, bytes_);
+      mappings_.push_back(mapping);
+      replicas_.push_back({replica_offsets, replica_neighs});
+    }
+  }
+
+  ~ReplicatedCSR() {
+    for (void *mapping : mappings_) {
+      numa_placement::Forget(mapping);
+      munmap(mapping, bytes_);
+    }
+  }
+
+  ReplicatedCSR(const ReplicatedCSR&) = delete;
+  ReplicatedCSR& operator=(const ReplicatedCSR&) = delete;
+
+  int num_replicas() const {
+    return replicas_.size();
+  }
+
+  const Replica& replica(int node) const {
+    return replicas_[node];
+  }
+
+  const Replica* local() const {
+    int node = numa_placement::ThreadNode();
+    if (node < 0 || node >= static_cast<int>(replicas_.size()))
+      return nullptr;
+    return &replicas_[node];
+  }
+
+  int64_t num_bytes() const {
+    return bytes_ * replicas_.size();
+  }
+
+ private:
+  template <typename T_>
+  static void ParallelCopy(T_ *dst, const T_ *src, int64_t n) {
+    const int64_t kBlock = 1 << 16;
+    #pragma omp parallel for schedule(static)
+    for (int64_t block=0; block < (n + kBlock - 1) / kBlock; block++) {
+      int64_t begin = block * kBlock;
+      std::memcpy(static_cast<void*>(dst + begin), src + begin,
+                  (std::min(n, begin + kBlock) - begin) * sizeof(T_));
+    }
+  }
+
+  size_t bytes_;
+  std::vector<void*> mappings_;
+  std::vector<Replica> replicas_;
+};
+
+#endif  // REPLICATED_GRAPH_H_
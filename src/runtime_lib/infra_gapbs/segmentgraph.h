@@ -1,6 +1,13 @@
 #include <math.h>
 #include <vector>
 #include <assert.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include "mapped_file.h"
 #ifdef NUMA
 #include <omp.h>
 #include <numa.h>
@@ -8,16 +15,54 @@
 
 using namespace std;
 
+// Segment cache layout (GraphSegments::Write and GraphSegments::Open)
+//  - SegHeader, then a SegEntry per segment, then the graphId, vertexArray
+//    and edgeArray sections of every segment, each starting on a
+//    kSegAlignment boundary so they can be used in place from a mapping
+//  - fingerprint, num_segments and direction identify the graph and the
+//    schedule the segments were built for, other files are rebuilt
+static const char kSegMagic[8] = {'G', 'I', 'T', 'S', 'E', 'G', 'M', 'T'};
+static const uint32_t kSegVersion = 1;
+static const uint64_t kSegAlignment = 4096;
+static const uint32_t kSegPull = 0;
+
+struct SegHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t direction;
+  uint64_t fingerprint;
+  int64_t num_nodes;
+  int64_t num_edges;
+  int32_t num_segments;
+  uint32_t id_bytes;
+  uint32_t data_bytes;
+  uint32_t reserved;
+};
+
+struct SegEntry {
+  int64_t num_vertices;
+  int64_t num_edges;
+  uint64_t graph_id_pos;
+  uint64_t vertex_array_pos;
+  uint64_t edge_array_pos;
+};
+
+inline uint64_t SegAlign(uint64_t pos) {
+  return (pos + kSegAlignment - 1) / kSegAlignment * kSegAlignment;
+}
+
 template <class DataT, class Vertex>
 struct SegmentedGraph 
 {
-  int *graphId;
+  Vertex *graphId;
   DataT *edgeArray;
   int64_t *vertexArray;
   int64_t numVertices;
   int64_t numEdges;
   bool allocated;
   bool numa_aware;
+  // Set if the arrays point into a segment cache instead of being owned
+  std::shared_ptr<MappedFile> mapping;
 
 private:
   int64_t lastLocalIndex;
@@ -37,10 +82,12 @@ public:
 
   ~SegmentedGraph()
   {
+    if (mapping)
+      return;
 #ifdef NUMA
     if (numa_aware) {
-      numa_free(graphId, sizeof(int) * numVertices);
-      numa_free(edgeArray, sizeof(int) * numEdges);
+      numa_free(graphId, sizeof(Vertex) * numVertices);
+      numa_free(edgeArray, sizeof(DataT) * numEdges);
       numa_free(vertexArray, sizeof(int64_t) * (numVertices + 1));
       return;
     }
@@ -58,7 +105,7 @@ public:
       int place_id = segment_id % omp_get_num_places();
       vertexArray = (int64_t *)numa_alloc_onnode(sizeof(int64_t) * (numVertices + 1), place_id);
       edgeArray = (DataT *)numa_alloc_onnode(sizeof(DataT) * numEdges, place_id);
-      graphId = (int *)numa_alloc_onnode(sizeof(int) * numVertices, place_id);
+      graphId = (Vertex *)numa_alloc_onnode(sizeof(Vertex) * numVertices, place_id);
       vertexArray[numVertices] = numEdges;
       allocated = true;
       lastVertex = -1; // reset lastVertex which is used to point to the dst vertex of the last edge added
@@ -67,7 +114,7 @@ public:
 #endif
     vertexArray = new int64_t[numVertices + 1]; // start,end of last              
     edgeArray = new DataT[numEdges];
-    graphId = new int[numVertices];
+    graphId = new Vertex[numVertices];
     vertexArray[numVertices] = numEdges;
     allocated = true;
     lastVertex = -1; // reset lastVertex which is used to point to the dst vertex of the last edge added
@@ -106,6 +153,18 @@ public:
     edgeArray[lastEdgeIndex++] = toEdgeArray;
   }
 
+  // Uses the arrays of a segment cache in place
+  void attach(std::shared_ptr<MappedFile> file, const SegEntry &entry)
+  {
+    mapping = file;
+    numVertices = entry.num_vertices;
+    numEdges = entry.num_edges;
+    graphId = file->At<Vertex>(entry.graph_id_pos);
+    vertexArray = file->At<int64_t>(entry.vertex_array_pos);
+    edgeArray = file->At<DataT>(entry.edge_array_pos);
+    allocated = true;
+  }
+
   void print(){
     assert(allocated == true);
     cout << "Segmented Graph numVertices: " << numVertices << " numEdges: " << numEdges  << endl;
@@ -150,7 +209,10 @@ GraphSegments(int _numSegments, bool numa_aware): numSegments(_numSegments)
    }
   }
 
+  // Segments are independent, so they are allocated (and with NUMA placed
+  // on their nodes) concurrently
   void allocate() {
+#pragma omp parallel for
     for (int i = 0; i<numSegments; i++){
       segments[i]->allocate(i);
     }
@@ -159,4 +221,109 @@ GraphSegments(int _numSegments, bool numa_aware): numSegments(_numSegments)
   SegmentedGraph<DataT, Vertex> * getSegmentedGraph(int id){
     return segments[id];
   }
+
+  // Maps the segments from a segment cache written for expected, returns
+  // false and leaves the segments untouched if there is no such file.
+  // NUMA aware segments are copied onto their nodes instead of mapped.
+  bool open(const std::string &filename, const SegHeader &expected)
+  {
+    std::shared_ptr<MappedFile> file = MappedFile::Open(filename);
+    uint64_t table_end = sizeof(SegHeader) + numSegments * sizeof(SegEntry);
+    if (!file || file->size() < table_end)
+      return false;
+    SegHeader header;
+    file->Read(0, &header, sizeof(SegHeader));
+    if (std::memcmp(header.magic, kSegMagic, sizeof(kSegMagic)) != 0 ||
+        header.version != kSegVersion ||
+        header.direction != expected.direction ||
+        header.fingerprint != expected.fingerprint ||
+        header.num_nodes != expected.num_nodes ||
+        header.num_edges != expected.num_edges ||
+        header.num_segments != numSegments ||
+        header.id_bytes != sizeof(Vertex) ||
+        header.data_bytes != sizeof(DataT))
+      return false;
+    std::vector<SegEntry> entries(numSegments);
+    file->Read(sizeof(SegHeader), entries.data(), numSegments * sizeof(SegEntry));
+    for (const SegEntry &entry : entries) {
+      if (entry.num_vertices < 0 || entry.num_edges < 0 ||
+          entry.num_vertices > static_cast<int64_t>(file->size()) ||
+          entry.num_edges > static_cast<int64_t>(file->size()) ||
+          entry.graph_id_pos % kSegAlignment != 0 ||
+          entry.vertex_array_pos % kSegAlignment != 0 ||
+          entry.edge_array_pos % kSegAlignment != 0 ||
+          entry.graph_id_pos + entry.num_vertices * sizeof(Vertex) > file->size() ||
+          entry.vertex_array_pos + (entry.num_vertices + 1) * sizeof(int64_t) > file->size() ||
+          entry.edge_array_pos + entry.num_edges * sizeof(DataT) > file->size() ||
+          file->At<int64_t>(entry.vertex_array_pos)[entry.num_vertices] != entry.num_edges)
+        return false;
+    }
+#pragma omp parallel for
+    for (int i = 0; i < numSegments; i++) {
+      SegmentedGraph<DataT, Vertex> *sg = segments[i];
+      if (!sg->numa_aware) {
+        sg->attach(file, entries[i]);
+        continue;
+      }
+      sg->numVertices = entries[i].num_vertices;
+      sg->numEdges = entries[i].num_edges;
+      sg->allocate(i);
+      std::memcpy(sg->graphId, file->At<Vertex>(entries[i].graph_id_pos),
+                  sg->numVertices * sizeof(Vertex));
+      std::memcpy(sg->vertexArray, file->At<int64_t>(entries[i].vertex_array_pos),
+                  (sg->numVertices + 1) * sizeof(int64_t));
+      std::memcpy(sg->edgeArray, file->At<DataT>(entries[i].edge_array_pos),
+                  sg->numEdges * sizeof(DataT));
+    }
+    return true;
+  }
+
+  // Written to a temporary file and renamed into place, so concurrent runs
+  // never see a partial cache. Failures (e.g. read-only directory) are
+  // ignored, the segments just aren't cached.
+  void write(const std::string &filename, const SegHeader &header) const
+  {
+    std::vector<SegEntry> entries(numSegments);
+    uint64_t pos = sizeof(SegHeader) + numSegments * sizeof(SegEntry);
+    for (int i = 0; i < numSegments; i++) {
+      entries[i].num_vertices = segments[i]->numVertices;
+      entries[i].num_edges = segments[i]->numEdges;
+      entries[i].graph_id_pos = SegAlign(pos);
+      entries[i].vertex_array_pos = SegAlign(entries[i].graph_id_pos +
+                                             segments[i]->numVertices * sizeof(Vertex));
+      entries[i].edge_array_pos = SegAlign(entries[i].vertex_array_pos +
+                                           (segments[i]->numVertices + 1) * sizeof(int64_t));
+      pos = entries[i].edge_array_pos + segments[i]->numEdges * sizeof(DataT);
+    }
+    std::string tmp_name = filename + ".tmp" + std::to_string(getpid());
+    std::fstream out(tmp_name, std::ios::out | std::ios::binary);
+    if (!out)
+      return;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(SegHeader));
+    out.write(reinterpret_cast<const char*>(entries.data()),
+              numSegments * sizeof(SegEntry));
+    for (int i = 0; i < numSegments; i++) {
+      padTo(out, entries[i].graph_id_pos);
+      out.write(reinterpret_cast<const char*>(segments[i]->graphId),
+                segments[i]->numVertices * sizeof(Vertex));
+      padTo(out, entries[i].vertex_array_pos);
+      out.write(reinterpret_cast<const char*>(segments[i]->vertexArray),
+                (segments[i]->numVertices + 1) * sizeof(int64_t));
+      padTo(out, entries[i].edge_array_pos);
+      out.write(reinterpret_cast<const char*>(segments[i]->edgeArray),
+                segments[i]->numEdges * sizeof(DataT));
+    }
+    out.close();
+    if (!out || std::rename(tmp_name.c_str(), filename.c_str()) != 0)
+      std::remove(tmp_name.c_str());
+  }
+
+private:
+  static void padTo(std::fstream &out, uint64_t pos)
+  {
+    static const char zeros[kSegAlignment] = {};
+    uint64_t current = out.tellp();
+    if (pos > current)
+      out.write(zeros, pos - current);
+  }
 };
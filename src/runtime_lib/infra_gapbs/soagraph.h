@@ -0,0 +1,138 @@
+#ifndef SOA_GRAPH_H_
+#define SOA_GRAPH_H_
+
+#include <cinttypes>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+#include "huge_pages.h"
+
+
+/*
+Class:  SoACSR
+
+One direction of a weighted CSRGraph with the neighbor IDs and the weights
+in separate arrays (structure of arrays) instead of NodeWeight pairs
+ - The arrays are indexed by the graph's offsets, degrees still come from
+   the graph
+ - neigh() hands out NodeWeight values read from both arrays, ids() only
+   reads the ID array and leaves the weights default constructed, so a
+   traversal whose apply function ignores the weight streams half the bytes
+ - Unweighted graphs have nothing to split, their IDs are copied as is and
+   the weights are empty
+*/
+
+
+template <typename NodeID_, typename WeightT_>
+struct NodeWeight;
+
+
+// Splits a neighbor into its ID and weight (unweighted neighbors have none)
+template <typename NodeID_, typename DestID_>
+struct SoASplit {
+  typedef uint8_t WeightT;
+  static const bool kWeighted = false;
+  static NodeID_ Id(const DestID_ &d) { return d; }
+  static WeightT Weight(const DestID_ &d) { return 0; }
+  static DestID_ Join(NodeID_ v, WeightT w) { return v; }
+};
+
+template <typename NodeID_, typename WeightT_>
+struct SoASplit<NodeID_, NodeWeight<NodeID_, WeightT_>> {
+  typedef WeightT_ WeightT;
+  static const bool kWeighted = true;
+  static NodeID_ Id(const NodeWeight<NodeID_, WeightT_> &d) { return d.v; }
+  static WeightT Weight(const NodeWeight<NodeID_, WeightT_> &d) { return d.w; }
+  static NodeWeight<NodeID_, WeightT_> Join(NodeID_ v, WeightT_ w) {
+    return NodeWeight<NodeID_, WeightT_>(v, w);
+  }
+};
+
+
+template <class NodeID_, class DestID_>
+class SoACSR {
+  typedef SoASplit<NodeID_, DestID_> Split;
+  typedef typename Split::WeightT WeightT_;
+
+ public:
+  template <bool ReadWeights>
+  class Neighborhood {
+   public:
+    class iterator {
+     public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef DestID_ value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const DestID_* pointer;
+      typedef DestID_ reference;
+
+      iterator(const NodeID_ *ids, const WeightT_ *weights, int64_t e) :
+          ids_(ids), weights_(weights), e_(e) {}
+      DestID_ operator*() const {
+        return Split::Join(ids_[e_], ReadWeights && Split::kWeighted ?
+                                     weights_[e_] : WeightT_());
+      }
+      iterator& operator++() {
+        e_++;
+        return *this;
+      }
+      bool operator!=(const iterator &other) const { return e_ != other.e_; }
+      bool operator==(const iterator &other) const { return e_ == other.e_; }
+
+     private:
+      const NodeID_ *ids_;
+      const WeightT_ *weights_;
+      int64_t e_;
+    };
+
+    Neighborhood(const NodeID_ *ids, const WeightT_ *weights, int64_t first,
+                 int64_t last) :
+        ids_(ids), weights_(weights), first_(first), last_(last) {}
+    iterator begin() const { return iterator(ids_, weights_, first_); }
+    iterator end() const { return iterator(ids_, weights_, last_); }
+
+   private:
+    const NodeID_ *ids_;
+    const WeightT_ *weights_;
+    int64_t first_;
+    int64_t last_;
+  };
+
+  // offsets and neighs are a CSR direction as kept by CSRGraph
+  SoACSR(int64_t num_nodes, const int64_t *offsets, const DestID_ *neighs) :
+      offsets_(offsets) {
+    int64_t num_edges = offsets[num_nodes];
+    ids_ = std::shared_ptr<NodeID_>(
+        NewNeighborArray<NodeID_>(offsets, num_nodes), DeleteArray<NodeID_>);
+    if (Split::kWeighted)
+      weights_ = std::shared_ptr<WeightT_>(
+          NewNeighborArray<WeightT_>(offsets, num_nodes),
+          DeleteArray<WeightT_>);
+    NodeID_ *ids = ids_.get();
+    WeightT_ *weights = weights_.get();
+    #pragma omp parallel for schedule(static)
+    for (int64_t e=0; e < num_edges; e++) {
+      ids[e] = Split::Id(neighs[e]);
+      if (Split::kWeighted)
+        weights[e] = Split::Weight(neighs[e]);
+    }
+  }
+
+  Neighborhood<true> neigh(NodeID_ n) const {
+    return Neighborhood<true>(ids_.get(), weights_.get(), offsets_[n],
+                              offsets_[n+1]);
+  }
+
+  Neighborhood<false> ids(NodeID_ n) const {
+    return Neighborhood<false>(ids_.get(), weights_.get(), offsets_[n],
+                               offsets_[n+1]);
+  }
+
+ private:
+  const int64_t *offsets_;
+  std::shared_ptr<NodeID_> ids_;
+  std::shared_ptr<WeightT_> weights_;
+};
+
+#endif  // SOA_GRAPH_H_
@@ -0,0 +1,171 @@
+#ifndef STREAM_GRAPH_H_
+#define STREAM_GRAPH_H_
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "pvector.h"
+
+
+/*
+Class:  EdgeStream
+
+One direction of a semi-external CSRGraph: the offsets are kept in memory
+while the neighbor array stays in a serialized graph file
+ - Vertices are split into contiguous partitions of at most buffer_edges
+   edges (a vertex with more edges gets a partition of its own)
+ - partition(i) returns partition i's neighbors from one of two buffers and
+   starts reading the next partition into the other one in the background,
+   so sweeping the partitions in order overlaps reading with computing
+ - After the last partition the first one is prefetched, since iterative
+   algorithms sweep the edges again in their next round
+ - A returned partition is only valid until partition() is called again
+ - neigh(n) reads a single vertex's neighbors instead, so sparse frontiers
+   only read the edges they push along. It is thread safe and the result is
+   valid until the calling thread's next neigh()
+*/
+
+
+template <class NodeID_, class DestID_>
+class EdgeStream {
+  // Bounds single reads, some systems fail reads of 2GB or more
+  static const size_t kMaxReadBytes = 1 << 30;
+
+ public:
+  class Neighborhood {
+    const DestID_ *begin_;
+    const DestID_ *end_;
+   public:
+    Neighborhood(const DestID_ *begin, const DestID_ *end) :
+        begin_(begin), end_(end) {}
+    typedef const DestID_* iterator;
+    iterator begin() const { return begin_; }
+    iterator end() const { return end_; }
+  };
+
+  // Vertices [first, last) and their neighbors
+  struct Partition {
+    NodeID_ first;
+    NodeID_ last;
+    const int64_t *offsets;
+    const DestID_ *neighs;
+
+    Neighborhood neigh(NodeID_ n) const {
+      return Neighborhood(neighs + (offsets[n] - offsets[first]),
+                          neighs + (offsets[n+1] - offsets[first]));
+    }
+  };
+
+  // neighs_pos is the position of the neighbor array within the file
+  EdgeStream(std::string filename, uint64_t neighs_pos, int64_t num_nodes,
+             const int64_t *offsets, int64_t buffer_edges) :
+      filename_(filename), neighs_pos_(neighs_pos), offsets_(offsets) {
+    fd_ = open(filename.c_str(), O_RDONLY);
+    if (fd_ == -1) {
+      std::cout << "Couldn't open file " << filename << std::endl;
+      std::exit(-6);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    buffer_edges = std::max(buffer_edges, static_cast<int64_t>(1));
+    int64_t max_edges = 0;
+    bounds_.push_back(0);
+    while (bounds_.back() < num_nodes) {
+      int64_t first = bounds_.back();
+      int64_t last = std::upper_bound(offsets + first + 1,
+                                      offsets + num_nodes + 1,
+                                      offsets[first] + buffer_edges) -
+                     offsets - 1;
+      last = std::max(last, first + 1);
+      max_edges = std::max(max_edges, offsets[last] - offsets[first]);
+      bounds_.push_back(last);
+    }
+    for (int b=0; b < 2; b++) {
+      buffers_[b].resize(max_edges);
+      loaded_[b] = -1;
+    }
+  }
+
+  EdgeStream(const EdgeStream&) = delete;
+  EdgeStream& operator=(const EdgeStream&) = delete;
+
+  ~EdgeStream() {
+    if (pending_.valid())
+      pending_.wait();
+    close(fd_);
+  }
+
+  int num_partitions() const {
+    return bounds_.size() - 1;
+  }
+
+  Neighborhood neigh(NodeID_ n) const {
+    static thread_local std::vector<DestID_> buffer;
+    int64_t begin = offsets_[n];
+    int64_t count = offsets_[n+1] - begin;
+    if (buffer.size() < static_cast<size_t>(count))
+      buffer.resize(count);
+    Read(begin, count, buffer.data());
+    return Neighborhood(buffer.data(), buffer.data() + count);
+  }
+
+  Partition partition(int id) {
+    if (pending_.valid())
+      pending_.get();
+    int b = loaded_[1] == id ? 1 : 0;
+    if (loaded_[b] != id)
+      Load(id, b);
+    int next = (id + 1) % num_partitions();
+    if (loaded_[1-b] != next && next != id)
+      pending_ = std::async(std::launch::async, [this, next, b] {
+        Load(next, 1-b);
+      });
+    return Partition{static_cast<NodeID_>(bounds_[id]),
+                     static_cast<NodeID_>(bounds_[id+1]), offsets_,
+                     buffers_[b].data()};
+  }
+
+ private:
+  void Load(int id, int b) {
+    int64_t begin = offsets_[bounds_[id]];
+    Read(begin, offsets_[bounds_[id+1]] - begin, buffers_[b].data());
+    loaded_[b] = id;
+  }
+
+  // Reads count neighbors starting at edge begin into neighs
+  void Read(int64_t begin, int64_t count, DestID_ *neighs) const {
+    char *dest = reinterpret_cast<char*>(neighs);
+    uint64_t pos = neighs_pos_ + begin * sizeof(DestID_);
+    size_t remaining = count * sizeof(DestID_);
+    while (remaining > 0) {
+      size_t len = remaining < kMaxReadBytes ? remaining : kMaxReadBytes;
+      ssize_t num_read = pread(fd_, dest, len, pos);
+      if (num_read <= 0) {
+        std::cout << "Couldn't read edges from " << filename_ << std::endl;
+        std::exit(-6);
+      }
+      dest += num_read;
+      pos += num_read;
+      remaining -= num_read;
+    }
+  }
+
+  std::string filename_;
+  int fd_;
+  uint64_t neighs_pos_;
+  const int64_t *offsets_;
+  std::vector<int64_t> bounds_;
+  pvector<DestID_> buffers_[2];
+  int loaded_[2];
+  std::future<void> pending_;
+};
+
+#endif  // STREAM_GRAPH_H_
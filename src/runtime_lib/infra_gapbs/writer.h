@@ -5,6 +5,7 @@
 #define WRITER_H_
 
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -19,8 +20,11 @@ Class:  Writer
 Author: Scott Beamer
 
 Given filename and graph, writes out the graph to storage
- - Should use WriteGraph(filename, serialized)
+ - Should use WriteGraph(filename, serialized, mappable)
  - If serialized, will write out as serialized graph, otherwise, as edgelist
+ - If also mappable, uses the aligned layout (SGHeader in graph.h) that the
+   Reader can use in place from a memory mapping, graphs with 64bit IDs or
+   weights other than int32_t are always written in this layout
 */
 
 
@@ -37,6 +41,8 @@ class WriterBase {
   }
 
   void WriteSerializedGraph(std::fstream &out) {
+    // the GAPBS layout always holds the inverse of directed graphs
+    g_.buildInverse();
     if (!std::is_same<NodeID_, SGID>::value) {
       std::cout << "serialized graphs only allowed for 32b IDs" << std::endl;
       std::exit(-4);
@@ -68,7 +74,45 @@ class WriterBase {
     }
   }
 
-  void WriteGraph(std::string filename, bool serialized = false) {
+  void WriteMappableGraph(std::fstream &out, SGSource source = SGSource()) {
+    bool directed = g_.directed();
+    bool inverse = directed && g_.has_inverse();
+    SGOffset num_nodes = g_.num_nodes();
+    uint64_t index_bytes = (num_nodes+1) * sizeof(SGOffset);
+    uint64_t neigh_bytes = g_.num_edges_directed() * sizeof(DestID_);
+    SGHeader header;
+    std::memset(&header, 0, sizeof(SGHeader));
+    std::memcpy(header.magic, kSGMagic, sizeof(kSGMagic));
+    header.version = kSGVersion;
+    header.flags = (directed ? kSGDirected : 0) | SGWeightFlags<DestID_>::value;
+    header.num_nodes = num_nodes;
+    header.num_edges = g_.num_edges_directed();
+    header.id_bytes = sizeof(NodeID_);
+    header.dest_bytes = sizeof(DestID_);
+    header.source = source;
+    header.out_offsets_pos = SGAlign(sizeof(SGHeader));
+    header.out_neighs_pos = SGAlign(header.out_offsets_pos + index_bytes);
+    if (inverse) {
+      header.in_offsets_pos = SGAlign(header.out_neighs_pos + neigh_bytes);
+      header.in_neighs_pos = SGAlign(header.in_offsets_pos + index_bytes);
+    }
+    out.write(reinterpret_cast<char*>(&header), sizeof(SGHeader));
+    PadTo(out, header.out_offsets_pos);
+    pvector<SGOffset> offsets = g_.VertexOffsets(false);
+    out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+    PadTo(out, header.out_neighs_pos);
+    out.write(reinterpret_cast<char*>(g_.out_neigh(0).begin()), neigh_bytes);
+    if (inverse) {
+      PadTo(out, header.in_offsets_pos);
+      offsets = g_.VertexOffsets(true);
+      out.write(reinterpret_cast<char*>(offsets.data()), index_bytes);
+      PadTo(out, header.in_neighs_pos);
+      out.write(reinterpret_cast<char*>(g_.in_neigh(0).begin()), neigh_bytes);
+    }
+  }
+
+  void WriteGraph(std::string filename, bool serialized = false,
+                  bool mappable = false) {
     if (filename == "") {
       std::cout << "No output filename given (Use -h for help)" << std::endl;
       std::exit(-8);
@@ -78,7 +122,13 @@ class WriterBase {
       std::cout << "Couldn't write to file " << filename << std::endl;
       std::exit(-5);
     }
-    if (serialized)
+    // the GAPBS layout can only hold 32bit IDs and weights
+    bool gapbs_types = std::is_same<NodeID_, SGID>::value &&
+                       (std::is_same<DestID_, NodeID_>::value ||
+                        std::is_same<DestID_, NodeWeight<NodeID_, SGID>>::value);
+    if (serialized && (mappable || !gapbs_types))
+      WriteMappableGraph(file);
+    else if (serialized)
       WriteSerializedGraph(file);
     else
       WriteEL(file);
@@ -86,6 +136,14 @@ class WriterBase {
   }
 
  private:
+  // Zero fills up to pos, used to align sections of the mappable layout
+  static void PadTo(std::fstream &out, uint64_t pos) {
+    static const char zeros[kSGAlignment] = {};
+    uint64_t current = out.tellp();
+    if (pos > current)
+      out.write(zeros, pos - current);
+  }
+
   CSRGraph<NodeID_, DestID_> &g_;
   std::string filename_;
 };
@@ -2,6 +2,7 @@
 
 #include <limits>
 #include <tuple>
+#include <type_traits>
 
 #include "dyn_arr.h"
 #include "maybe.h"
@@ -40,8 +41,15 @@ struct buckets {
   public:
     using id_dyn_arr = dyn_arr<uintE>;
 
-    const uintE null_bkt = std::numeric_limits<D>::max();
-    int delta_ = 1;
+    // Priorities (integral or floating point) are bucketed by
+    // floor(priority/delta_), the largest D is the priority of identifiers
+    // that are in no bucket
+    const D null_priority = std::numeric_limits<D>::max();
+    const uintE null_bkt = (std::is_integral<D>::value &&
+                            sizeof(D) <= sizeof(uintE)) ?
+        static_cast<uintE>(std::numeric_limits<D>::max()) :
+        std::numeric_limits<uintE>::max();
+    D delta_ = 1;
 
     // Create a bucketing structure.
     //   n : the number of identifiers
@@ -57,7 +65,7 @@ struct buckets {
             D* _d,
             bucket_order _bkt_order,
             priority_order _pri_order,
-            size_t _total_buckets, int delta=1) :
+            size_t _total_buckets, D delta=1) :
         n(_n), d(_d), bkt_order(_bkt_order), pri_order(_pri_order),
         open_buckets(_total_buckets-1), total_buckets(_total_buckets),
         cur_bkt(0), max_bkt(_total_buckets), num_elms(0), delta_(delta) {
@@ -67,13 +75,13 @@ struct buckets {
       // Set the current range being processed based on the order.
       if (bkt_order == increasing) {
 //        auto imap = make_in_imap<uintE>(n, [&] (size_t i) { return d[i]; });
-        auto imap = make_in_imap<uintE>(n, [&] (size_t i) { return (d[i] == null_bkt) ? null_bkt : d[i]/delta_; });
+        auto imap = make_in_imap<uintE>(n, [&] (size_t i) { return bucket_of(d[i]); });
         auto min = [] (uintE x, uintE y) { return std::min(x, y); };
         size_t min_b = pbbso::reduce(imap, min);
         cur_range = min_b / open_buckets;
       } else if (bkt_order == decreasing) {
         auto imap = make_in_imap<uintE>(n, [&] (size_t i) {
-            return (d[i] == null_bkt) ? 0 : d[i]/delta; });
+            return (d[i] == null_priority) ? 0 : bucket_of(d[i]); });
         auto max = [] (uintE x, uintE y) { return std::max(x,y); };
         size_t max_b = pbbso::reduce(imap, max);
         cur_range = (max_b + open_buckets) / open_buckets;
@@ -87,7 +95,7 @@ struct buckets {
       // null_bkt are ignored by update_buckets.
       auto get_id_and_bkt = [&] (uintE i) -> Maybe<tuple<uintE, uintE> > {
           //updated with delta
-        uintE bkt = (d[i] == null_bkt) ? null_bkt : d[i]/delta_;
+        uintE bkt = bucket_of(d[i]);
         if (bkt != null_bkt) {
           bkt = to_range(bkt);
         }
@@ -96,6 +104,13 @@ struct buckets {
       update_buckets(get_id_and_bkt, n);
     }
 
+    // Bucket of a priority (before mapping it to the materialized range)
+    inline uintE bucket_of(D priority) const {
+      if (priority == null_priority)
+        return null_bkt;
+      return static_cast<uintE>(priority / delta_);
+    }
+
     // Returns the next non-empty bucket from the bucket structure. The return
     // value's bkt_id is null_bkt when no further buckets remain.
     inline bucket next_bucket() {
@@ -300,8 +315,7 @@ struct buckets {
       auto g = [&] (uintE i) -> Maybe<tuple<uintE, uintE> > {
         uintE v = tmp[i];
         //uintE bkt = to_range(d[v]);
-        D priority = (d[v] == null_bkt)? null_bkt : d[v]/delta_;
-        uintE bkt = to_range(priority);
+        uintE bkt = to_range(bucket_of(d[v]));
           return Maybe<tuple<uintE, uintE> >(make_tuple(v, bkt));
       };
 
@@ -365,7 +379,7 @@ struct buckets {
       num_elms -= size;
       uintE* out = newA(uintE, size);
       size_t cur_bkt_num = get_cur_bucket_num();
-      auto p = [&] (size_t i) { return ((d[i] == null_bkt)? null_bkt : d[i]/delta_) == cur_bkt_num; };
+      auto p = [&] (size_t i) { return bucket_of(d[i]) == cur_bkt_num; };
       size_t m = pbbso::filterf(bkt.A, out, size, p);
       bkts[cur_bkt].size = 0;
       if (m == 0) {
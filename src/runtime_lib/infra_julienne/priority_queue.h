@@ -35,11 +35,13 @@ class PriorityQueue {
 
 public:
   D* tracking_variable;
+  // priority of the nodes that are in no bucket
   D null_bkt = std::numeric_limits<D>::max();
-  int delta_;
+  // bucket width, the priorities (integral or floating point) in [i*delta_, (i+1)*delta_) form bucket i
+  D delta_;
 
 
-  explicit PriorityQueue(size_t n, D* priority_array, bucket_order bkt_order, priority_order pri_order, size_t total_buckets=128, int delta = 1) {
+  explicit PriorityQueue(size_t n, D* priority_array, bucket_order bkt_order, priority_order pri_order, size_t total_buckets=128, D delta = 1) {
 
       //cout << "constructing a priority map from array" << endl;
       buckets_ = new buckets<D>(n, priority_array, bkt_order, pri_order, total_buckets, delta);
@@ -95,7 +97,12 @@ public:
   }
 
   inline bool finishedNode(uintE node){
-      return cur_priority_ >= tracking_variable[node]/delta_;
+      return cur_priority_ >= buckets_->bucket_of(tracking_variable[node]);
+  }
+
+  // bucket a priority belongs to
+  inline uintE get_bucket_id(D priority) const {
+      return buckets_->bucket_of(priority);
   }
 
   inline julienne::vertexSubset dequeue_ready_set() {
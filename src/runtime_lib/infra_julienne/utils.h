@@ -42,7 +42,7 @@ static int __jj =  mallopt(M_TRIM_THRESHOLD,-1);
 //typedef unsigned int uint;
 //typedef unsigned long ulong;
 
-#define newA(__E,__n) (__E*) malloc((__n)*sizeof(__E))
+#define newA(__E,__n) (__E*) AlignedMalloc((__n)*sizeof(__E))
 
 template <class E>
 struct identityF { E operator() (const E& x) {return x;}};
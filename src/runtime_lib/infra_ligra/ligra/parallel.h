@@ -80,6 +80,10 @@ void parallel_invoke(const Func0& func0, const Func1& func1) {
 static int getWorkers() {
   return __cilkrts_get_nworkers();
 }
+// index of the calling worker, less than getWorkers()
+static int getWorkerId() {
+  return __cilkrts_get_worker_number();
+}
 static void setWorkers(int n) {
   __cilkrts_end_cilk();
   //__cilkrts_init();
@@ -145,6 +149,10 @@ void parallel_invoke( const Func0& func0, const Func1& func1 ) {
 static int getWorkers() {
   return __cilkrts_get_nworkers();
 }
+// index of the calling worker, less than getWorkers()
+static int getWorkerId() {
+  return __cilkrts_get_worker_number();
+}
 static void setWorkers(int n) {
   __cilkrts_end_cilk();
   //__cilkrts_init();
@@ -196,6 +204,9 @@ static int s_nthreads;
 static int getWorkers() {
   return s_nthreads;
 }
+static int getWorkerId() {
+  return tbb::this_task_arena::current_thread_index();
+}
 static void setWorkers(int n) {
   tbb::task_scheduler_init init(n);
   s_nthreads = n;
@@ -259,6 +270,18 @@ void parallel_invoke(const Func0& func0, const Func1& func1) {
 //#define parallel_for _Pragma("omp parallel for ") for
 //#define parallel_for _Pragma("omp parallel for schedule (dynamic, 64)") for
 static int getWorkers() { return omp_get_max_threads(); }
+// the thread number in the one team of the nesting with more than one thread, -1 if
+// several nested teams are active (their thread numbers are not unique)
+static int getWorkerId() {
+  int id = 0, active_teams = 0;
+  for (int level = 1; level <= omp_get_level(); level++) {
+    if (omp_get_team_size(level) > 1) {
+      id = omp_get_ancestor_thread_num(level);
+      active_teams++;
+    }
+  }
+  return active_teams <= 1 ? id : -1;
+}
 static void setWorkers(int n) { omp_set_num_threads(n); }
 
 // c++
@@ -289,6 +312,7 @@ void parallel_invoke(const Func0& func0, const Func1& func1) {
 }
 #define cilk_for for
 static int getWorkers() { return 1; }
+static int getWorkerId() { return 0; }
 static void setWorkers(int n) { }
 
 #endif
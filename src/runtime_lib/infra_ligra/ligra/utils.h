@@ -27,6 +27,7 @@
 #include <fstream>
 #include <stdlib.h>
 #include "parallel.h"
+#include "infra_gapbs/huge_pages.h"
 using namespace std;
 
 // Needed to make frequent large allocations efficient with standard
@@ -47,7 +48,7 @@ static int __jj =  mallopt(M_TRIM_THRESHOLD,-1);
 #define ulong unsigned long
 #endif
 
-#define newA(__E,__n) (__E*) malloc((__n)*sizeof(__E))
+#define newA(__E,__n) (__E*) AlignedMalloc((__n)*sizeof(__E))
 
 template <class E>
 struct identityF { E operator() (const E& x) {return x;}};
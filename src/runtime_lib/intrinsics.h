@@ -51,6 +51,8 @@
 #include <type_traits>
 #include <unistd.h>
 
+// newA allocates with AlignedMalloc, julienne is included in its own namespace
+#include "infra_gapbs/huge_pages.h"
 
 #define ulong unsigned long
 namespace julienne {
@@ -77,6 +79,9 @@ static julienne::graph<julienne::symmetricVertex> __julienne_null_graph(NULL, 0,
 #include "infra_gapbs/intersections.h"
 #include "infra_gapbs/bitmap.h"
 #include "infra_gapbs/command_line.h"
+#include "infra_gapbs/reorder.h"
+#include "infra_gapbs/dyngraph.h"
+#include "infra_gapbs/incremental.h"
 #include "infra_gapbs/graph.h"
 #include "infra_gapbs/platform_atomics.h"
 #include "infra_gapbs/pvector.h"
@@ -140,28 +145,60 @@ static void atomicAdd(T * val_array, int index, T new_val){
     writeAdd(&val_array[index], new_val);
 }
 
-//For now, assume the weights are ints, this would be good enough for now
-// Later, we can change the parser, to supply type information to the library call
-static WGraph builtin_loadWeightedEdgesFromFile(std::string file_name){
+// The weights are ints unless the edgeset declares another weight type (float, double, int64),
+// the generated code then passes it as the template argument. Without needs_inverse directed
+// graphs only get their out-edges, the inverse is built when it is first needed (buildInverse).
+template <typename WeightT_ = WeightT>
+static WGraphT<WeightT_> builtin_loadWeightedEdgesFromFile(std::string file_name, bool needs_inverse = true){
     CLBase cli (file_name);
-    WeightedBuilder weighted_builder (cli);
-    WGraph g = weighted_builder.MakeGraph();
+    WeightedBuilderT<WeightT_> weighted_builder (cli);
+    weighted_builder.needs_inverse_ = needs_inverse;
+    WGraphT<WeightT_> g = weighted_builder.MakeGraph();
     return g;
 }
 
-static Graph builtin_loadEdgesFromFile(std::string file_name){
+static Graph builtin_loadEdgesFromFile(std::string file_name, bool needs_inverse = true){
     CLBase cli (file_name);
     Builder builder (cli);
+    builder.needs_inverse_ = needs_inverse;
     Graph g = builder.MakeGraph();
     return g;
 }
 
+// Publishes the edgeset in the shared graph store (graph_store.h), later programs load it
+// with "store:<name>" and map the published copy instead of building their own
+static void builtin_publish(Graph &edges, std::string name){
+    PublishGraph(edges, name);
+}
+
+template <typename WeightT_>
+static void builtin_publish(WGraphT<WeightT_> &edges, std::string name){
+    PublishGraph(edges, name);
+}
+
+// Semi-external loads keep only the offsets in memory, the neighbors are streamed
+// from disk in partitions of at most buffer_edges edges by the edgeset apply functions
+template <typename WeightT_ = WeightT>
+static WGraphT<WeightT_> builtin_loadWeightedEdgesSemiExternal(std::string file_name, int64_t buffer_edges){
+    CLBase cli (file_name);
+    WeightedBuilderT<WeightT_> weighted_builder (cli);
+    WGraphT<WeightT_> g = weighted_builder.MakeSemiExternalGraph(buffer_edges);
+    return g;
+}
+
+static Graph builtin_loadEdgesSemiExternal(std::string file_name, int64_t buffer_edges){
+    CLBase cli (file_name);
+    Builder builder (cli);
+    Graph g = builder.MakeSemiExternalGraph(buffer_edges);
+    return g;
+}
 
-static Graph builtin_loadEdgesFromCSR(const int32_t* indptr, const NodeID* indices, int num_nodes, int num_edges) {
+
+static Graph builtin_loadEdgesFromCSR(const SGOffset* indptr, const NodeID* indices, int64_t num_nodes, int64_t num_edges) {
 
     typedef EdgePair<NodeID, NodeID> Edge;
     typedef pvector<Edge> EdgeList;
-    typedef pvector<int32_t> DegreeList;
+    typedef pvector<NodeID> DegreeList;
     EdgeList el;
     el.resize(num_edges);
     DegreeList dl;
@@ -169,7 +206,7 @@ static Graph builtin_loadEdgesFromCSR(const int32_t* indptr, const NodeID* indic
 
     #pragma omp parallel for schedule(dynamic, 64)
     for (NodeID x = 0; x < num_nodes; x++) {
-        int32_t degree = indptr[x+1] - indptr[x];
+        NodeID degree = indptr[x+1] - indptr[x];
         dl[x] = degree;
     }
 
@@ -180,17 +217,17 @@ static Graph builtin_loadEdgesFromCSR(const int32_t* indptr, const NodeID* indic
     #pragma omp parallel for schedule(dynamic, 64)
     for (NodeID x = 0; x < num_nodes; x++) {
         auto startOffset = prefSum[x];
-        for(int32_t i = 0; i < dl[x]; i++) {
+        for(NodeID i = 0; i < dl[x]; i++) {
             el[startOffset+i] = Edge(x, indices[startOffset + i]);
         }
     }
 
     return bb.MakeGraphFromEL(el);
 }
-static WGraph builtin_loadWeightedEdgesFromCSR(const int32_t *data, const int32_t *indptr, const NodeID *indices, int num_nodes, int num_edges) {
+static WGraph builtin_loadWeightedEdgesFromCSR(const WeightT *data, const SGOffset *indptr, const NodeID *indices, int64_t num_nodes, int64_t num_edges) {
 	typedef EdgePair<NodeID, WNode> Edge;
 	typedef pvector<Edge> EdgeList;
-    typedef pvector<int32_t> DegreeList;
+    typedef pvector<NodeID> DegreeList;
 	EdgeList el;
 	el.resize(num_edges);
 	DegreeList dl;
@@ -198,7 +235,7 @@ static WGraph builtin_loadWeightedEdgesFromCSR(const int32_t *data, const int32_
 
     #pragma omp parallel for schedule(dynamic, 64)
     for (NodeID x = 0; x < num_nodes; x++) {
-        int32_t degree = indptr[x+1] - indptr[x];
+        NodeID degree = indptr[x+1] - indptr[x];
         dl[x] = degree;
     }
 
@@ -210,7 +247,7 @@ static WGraph builtin_loadWeightedEdgesFromCSR(const int32_t *data, const int32_
     #pragma omp parallel for schedule(dynamic, 64)
     for (NodeID x = 0; x < num_nodes; x++) {
         auto startOffset = prefSum[x];
-        for(int32_t i = 0; i < dl[x]; i++) {
+        for(NodeID i = 0; i < dl[x]; i++) {
             el[startOffset+i] = Edge(x, NodeWeight<NodeID, WeightT>(indices[startOffset + i], data[startOffset + i]));
         }
     }
@@ -218,11 +255,12 @@ static WGraph builtin_loadWeightedEdgesFromCSR(const int32_t *data, const int32_
 	return bb.MakeGraphFromEL(el);	
 }
 
-static int builtin_getVertices(Graph &edges){
+static int64_t builtin_getVertices(Graph &edges){
     return edges.num_nodes();
 }
 
-static int builtin_getVertices(WGraph &edges){
+template <typename WeightT_>
+static int64_t builtin_getVertices(WGraphT<WeightT_> &edges){
     return edges.num_nodes();
 }
 
@@ -230,10 +268,57 @@ static NodeID builtin_getOutDegree(Graph &edges, NodeID src){
     return edges.out_degree(src);
 }
 
-static NodeID builtin_getOutDegree(WGraph &edges, NodeID src){
+template <typename WeightT_>
+static NodeID builtin_getOutDegree(WGraphT<WeightT_> &edges, NodeID src){
     return edges.out_degree(src);
 }
 
+// Edgesets updated with insertEdges/deleteEdges are DynamicGraphs (dyngraph.h)
+template <typename DestID_>
+static int64_t builtin_getVertices(DynamicGraph<NodeID, DestID_> &edges){
+    return edges.num_nodes();
+}
+
+template <typename DestID_>
+static NodeID builtin_getOutDegree(DynamicGraph<NodeID, DestID_> &edges, NodeID src){
+    return edges.out_degree(src);
+}
+
+template <typename DestID_>
+static int * builtin_getOutDegrees(DynamicGraph<NodeID, DestID_> &edges){
+    int * out_degrees  = NewArray<int>(edges.num_nodes());
+    ligra::parallel_for_lambda((NodeID)0, (NodeID)edges.num_nodes(), [&] (NodeID n) {
+        out_degrees[n] = edges.out_degree(n);
+    });
+    return out_degrees;
+}
+
+// A batch of updates is an edge list file (.el, or .wel for weighted edgesets)
+template <typename DestID_, typename WeightT_>
+static pvector<EdgePair<NodeID, DestID_>> readEdgeUpdates(std::string file_name){
+    Reader<NodeID, DestID_, WeightT_> reader(file_name);
+    bool needs_weights = false;
+    return reader.ReadFile(needs_weights);
+}
+
+static void builtin_insertEdges(DynamicGraph<NodeID> &edges, std::string file_name){
+    edges.InsertEdges(readEdgeUpdates<NodeID, WeightT>(file_name));
+}
+
+template <typename WeightT_>
+static void builtin_insertEdges(DynamicGraph<NodeID, WNodeT<WeightT_>> &edges, std::string file_name){
+    edges.InsertEdges(readEdgeUpdates<WNodeT<WeightT_>, WeightT_>(file_name));
+}
+
+static void builtin_deleteEdges(DynamicGraph<NodeID> &edges, std::string file_name){
+    edges.DeleteEdges(readEdgeUpdates<NodeID, WeightT>(file_name));
+}
+
+template <typename WeightT_>
+static void builtin_deleteEdges(DynamicGraph<NodeID, WNodeT<WeightT_>> &edges, std::string file_name){
+    edges.DeleteEdges(readEdgeUpdates<WNodeT<WeightT_>, WeightT_>(file_name));
+}
+
 static Graph builtin_relabel(Graph &edges) {
 
     // GAPBS way to figure out if the graph is worth relabelling
@@ -256,22 +341,97 @@ static Graph builtin_relabel(Graph &edges) {
     };
 
     if (worthLabelling(edges)) {
-        Graph relabeledGraph = Builder::RelabelByDegree(edges);
+        Graph relabeledGraph = Reorder(edges, "degree");
         return relabeledGraph;
     }
 
     return edges;
 }
 
+// Reorders the vertices for locality with one of the methods in reorder.h. The returned graph
+// keeps the permutation, so vertex IDs from outside the program can be translated to its IDs.
+static Graph builtin_reorder(const Graph &edges, std::string method) {
+    return Reorder(edges, method);
+}
+
+template <typename WeightT_>
+static WGraphT<WeightT_> builtin_reorder(const WGraphT<WeightT_> &edges, std::string method) {
+    return Reorder(edges, method);
+}
+
+// Translates the ID a vertex had in the input graph to its ID in the (reordered) edges
+static NodeID builtin_toNewID(Graph &edges, NodeID v) {
+    return edges.permutation() == nullptr ? v : edges.permutation()->ToNew(v);
+}
+
+template <typename WeightT_>
+static NodeID builtin_toNewID(WGraphT<WeightT_> &edges, NodeID v) {
+    return edges.permutation() == nullptr ? v : edges.permutation()->ToNew(v);
+}
+
+// Translates a vertex of the (reordered) edges back to its ID in the input graph, values that
+// are not vertices (e.g. -1 for no parent) are returned unchanged
+static NodeID builtin_toOldID(Graph &edges, NodeID v) {
+    if (edges.permutation() == nullptr || v < 0 || v >= edges.permutation()->size())
+        return v;
+    return edges.permutation()->ToOld(v);
+}
+
+template <typename WeightT_>
+static NodeID builtin_toOldID(WGraphT<WeightT_> &edges, NodeID v) {
+    if (edges.permutation() == nullptr || v < 0 || v >= edges.permutation()->size())
+        return v;
+    return edges.permutation()->ToOld(v);
+}
+
+// Reorders a vertex property of the (reordered) edges into the vertex order of the input graph,
+// the values are translated to input IDs as well if they are vertices
+template <typename GraphT_, typename T>
+static void builtin_toInputOrder(GraphT_ &edges, T* values, bool vertex_values) {
+    auto permutation = edges.permutation();
+    if (permutation == nullptr)
+        return;
+    int64_t n = permutation->size();
+    T* by_old_id = new T[n];
+    permutation->RestoreOrder(values, by_old_id);
+    #pragma omp parallel for
+    for (int64_t v = 0; v < n; v++) {
+        values[v] = by_old_id[v];
+        if (vertex_values)
+            values[v] = builtin_toOldID(edges, values[v]);
+    }
+    delete[] by_old_id;
+}
+
+// Selects where the graph, property and frontier arrays allocated from now on are placed
+// ("off", "thp" or "hugetlb", see huge_pages.h)
+static void builtin_setHugePages(std::string config) {
+    SetHugePages(config);
+}
+
+static void builtin_printHugePageReport() {
+    PrintHugePageReport();
+}
+
+// Pins the threads ("cores" or "sockets") and first touches the large arrays allocated from now on
+// in parallel, so they are spread over the NUMA nodes like the work on them (see numa_placement.h)
+static void builtin_setNUMAPlacement(std::string config) {
+    SetNUMAPlacement(config);
+}
+
+static void builtin_printPagePlacement() {
+    PrintPagePlacement();
+}
+
 static VertexSubset<NodeID>* builtin_getNgh(Graph &edges, NodeID src){
     auto v =  new VertexSubset<NodeID>(edges.out_degree(src), edges.out_degree(src));
-    v->dense_vertex_set_ = (unsigned int*) edges.out_neigh(src).begin();
+    v->dense_vertex_set_ = (uintE*) edges.out_neigh(src).begin();
     return v;
 }
 
 static VertexSubset<NodeID>* builtin_getNgh(WGraph &edges, NodeID src){
     auto v =  new VertexSubset<NodeID>(edges.out_degree(src));
-    v->dense_vertex_set_ = (unsigned int*) edges.out_neigh(src).begin();
+    v->dense_vertex_set_ = (uintE*) edges.out_neigh(src).begin();
     return v;
 }
 
@@ -355,15 +515,15 @@ static int builtin_getVertices(julienne::graph<T> &edges) {
     return edges.n;
 }
 
-static VertexSubset<int>* serialSweepCut(Graph& graph,  VertexSubset<int> * vertices, double* val_array){
+static VertexSubset<NodeID>* serialSweepCut(Graph& graph,  VertexSubset<NodeID> * vertices, double* val_array){
     //create a copy of the vertex array
-    VertexSubset<int>* output_vertexset = new VertexSubset<int>(vertices);
+    VertexSubset<NodeID>* output_vertexset = new VertexSubset<NodeID>(vertices);
 
     //sort the vertex array based on the val_array
     output_vertexset->toSparse();
     auto dense_vertex_set = vertices->dense_vertex_set_;
     sort(dense_vertex_set, dense_vertex_set + vertices->num_vertices_,
-         [&val_array](const int & a, const int & b) -> bool
+         [&val_array](const uintE & a, const uintE & b) -> bool
          {
              return val_array[a] > val_array[b];
          });
@@ -375,11 +535,11 @@ static VertexSubset<int>* serialSweepCut(Graph& graph,  VertexSubset<int> * vert
     long edgesCrossing = 0;
 
     double best_conductance = DBL_MAX;
-    int best_cut = -1;
+    int64_t best_cut = -1;
     long best_vol = -1;
     long best_edge_cross = -1;
 
-    for (int i = 0; i < vertices->num_vertices_; i++){
+    for (int64_t i = 0; i < vertices->num_vertices_; i++){
         NodeID v = dense_vertex_set[i];
         S.insert(v);
         volS += graph.out_degree(v);
@@ -404,25 +564,26 @@ static VertexSubset<int>* serialSweepCut(Graph& graph,  VertexSubset<int> * vert
 
     //reset the size of the vertex array to the best cut, remove the boolean values
     output_vertexset->num_vertices_ = best_cut;
-    output_vertexset->bool_map_ = nullptr;
+    delete output_vertexset->bitmap_;
+    output_vertexset->bitmap_ = nullptr;
 
     return output_vertexset;
 }
 
-static int getRandomOutNgh(Graph &edges, NodeID v){
+static NodeID getRandomOutNgh(Graph &edges, NodeID v){
     return edges.get_random_out_neigh(v);
 }
 
-static int getRandomInNgh(Graph &edges, NodeID v){
+static NodeID getRandomInNgh(Graph &edges, NodeID v){
     return edges.get_random_in_neigh(v);
 }
 
-static int* serialMinimumSpanningTree(WGraph &edges, NodeID start){
+static NodeID* serialMinimumSpanningTree(WGraph &edges, NodeID start){
     return minimum_spanning_tree(edges, start);
 }
 
 static int * builtin_getOutDegrees(Graph &edges){
-    int * out_degrees  = new int [edges.num_nodes()];
+    int * out_degrees  = NewArray<int>(edges.num_nodes());
     for (NodeID n=0; n < edges.num_nodes(); n++){
         out_degrees[n] = edges.out_degree(n);
     }
@@ -430,7 +591,7 @@ static int * builtin_getOutDegrees(Graph &edges){
 }
 
 static uintE * builtin_getOutDegreesUint(Graph &edges){
-    uintE * out_degrees  = new uintE [edges.num_nodes()];
+    uintE * out_degrees  = NewArray<uintE>(edges.num_nodes());
     for (NodeID n=0; n < edges.num_nodes(); n++){
         out_degrees[n] = edges.out_degree(n);
     }
@@ -439,7 +600,7 @@ static uintE * builtin_getOutDegreesUint(Graph &edges){
 
 template <typename T>
 static int * builtin_getOutDegrees(julienne::graph<T> &edges) {
-    int * out_degrees = new int [edges.n];
+    int * out_degrees = NewArray<int>(edges.n);
     for (uintE n = 0; n < edges.n; n++) {
 	    out_degrees[n] = edges.V[n].degree;
     }
@@ -448,7 +609,7 @@ static int * builtin_getOutDegrees(julienne::graph<T> &edges) {
 
 template <typename T>
 static uintE * builtin_getOutDegreesUint(julienne::graph<T> &edges) {
-    uintE * out_degrees = new uintE [edges.n];
+    uintE * out_degrees = NewArray<uintE>(edges.n);
     for (uintE n = 0; n < edges.n; n++) {
         out_degrees[n] = edges.V[n].degree;
     }
@@ -463,7 +624,7 @@ static pvector<int> builtin_getOutDegreesPvec(Graph &edges){
     return out_degrees;
 }
 
-static int builtin_getVertexSetSize(VertexSubset<int>* vertex_subset){
+static int64_t builtin_getVertexSetSize(VertexSubset<NodeID>* vertex_subset){
     return vertex_subset->size();
 }
 
@@ -471,7 +632,7 @@ static int builtin_getVertexSetSize(julienne::vertexSubset vs) {
     return vs.size();
 }
 
-static void builtin_addVertex(VertexSubset<int>* vertexset, int vertex_id){
+static void builtin_addVertex(VertexSubset<NodeID>* vertexset, NodeID vertex_id){
     vertexset->addVertex(vertex_id);
 }
 
@@ -523,48 +684,67 @@ static char* argv_safe(int index, char** argv, int argc ){
 }
 
 static Graph builtin_transpose(Graph &graph){
+    // edgesets only read through their transpose are loaded without the inverse, it is built here
+    graph.buildInverse();
     // Changing this to use shared pointer instead
     //return CSRGraph<NodeID>(graph.num_nodes(), graph.get_in_index_(), graph.get_in_neighbors_(), graph.get_out_index_(), graph.get_out_neighbors_(), true);
-      return CSRGraph<NodeID>(graph.num_nodes(), graph.in_index_shared_, graph.in_neighbors_shared_, graph.out_index_shared_, graph.out_neighbors_shared_, true);
+      return CSRGraph<NodeID>(graph.num_nodes(), graph.in_offsets_shared_, graph.in_neighbors_shared_, graph.out_offsets_shared_, graph.out_neighbors_shared_, true);
 }
 
 
-template<typename APPLY_FUNC> static void builtin_vertexset_apply(VertexSubset<int>* vertex_subset, APPLY_FUNC apply_func){
+template<typename APPLY_FUNC> static void builtin_vertexset_apply(VertexSubset<NodeID>* vertex_subset, APPLY_FUNC apply_func){
+   vertex_subset->mergeInserts();
    if (vertex_subset->is_dense){
-       ligra::parallel_for_lambda((int)0, (int)vertex_subset->vertices_range_, [&] (int v) {
-               if(vertex_subset->bool_map_[v]){
-                   apply_func(v);
+       // skips the words of the bitvector without a vertex in the set
+       Bitmap * bitmap = vertex_subset->bitmap_;
+       ligra::parallel_for_lambda((int64_t)0, (int64_t)bitmap->num_words(), [&] (int64_t w) {
+               for (uint64_t word = bitmap->word(w); word != 0; word &= word - 1){
+                   apply_func((NodeID) (w * 64 + __builtin_ctzll(word)));
                }
            });
    } else {
        if(vertex_subset->dense_vertex_set_ == nullptr && vertex_subset->tmp.size() > 0) {
-            ligra::parallel_for_lambda((int)0, (int)vertex_subset->num_vertices_, [&] (int i){
+            ligra::parallel_for_lambda((int64_t)0, vertex_subset->num_vertices_, [&] (int64_t i){
                apply_func(vertex_subset->tmp[i]);
            });
        }else  {
-           ligra::parallel_for_lambda((int)0, (int)vertex_subset->num_vertices_, [&] (int i){
+           ligra::parallel_for_lambda((int64_t)0, vertex_subset->num_vertices_, [&] (int64_t i){
                apply_func(vertex_subset->dense_vertex_set_[i]);
            });
        }
    }
 }
 
+// vertex property arrays come from NewArray and are released with DeleteArray (emitted by the compiler)
 template<typename OBJECT_TYPE>
 static void deleteObject(OBJECT_TYPE* object) {
    if(object)
        delete object;
 }
+
+// frontiers returned by a pooled edgeset apply go back to its pool
+template<typename NodeID_>
+static void deleteObject(VertexSubset<NodeID_>* object) {
+   if(object && object->pool_)
+       object->pool_->release(object);
+   else if(object)
+       delete object;
+}
 template <typename T>
-static VertexSubset<int> * builtin_const_vertexset_filter(T func, int total_elements) {
-    VertexSubset<int> * output = new VertexSubset<NodeID>( total_elements, 0);
-    bool * next0 = newA(bool, total_elements);
-    parallel_for(int v = 0; v < total_elements; v++) {
-        next0[v] = 0;
-        if (func(v))
-            next0[v] = 1;
+static VertexSubset<NodeID> * builtin_const_vertexset_filter(T func, int64_t total_elements) {
+    VertexSubset<NodeID> * output = new VertexSubset<NodeID>( total_elements, 0);
+    Bitmap * next0 = new Bitmap(total_elements);
+    // each iteration fills one word, no atomics needed
+    parallel_for(int64_t w = 0; w < (int64_t) next0->num_words(); w++) {
+        uint64_t word = 0;
+        for (int64_t v = w * 64; v < std::min((w + 1) * 64, total_elements); v++) {
+            if (func(v))
+                word |= (uint64_t) 1 << (v - w * 64);
+        }
+        next0->set_word(w, word);
     }
-    output->num_vertices_ = sequence::sum(next0, total_elements);
-    output->bool_map_ = next0;
+    output->num_vertices_ = next0->count();
+    output->bitmap_ = next0;
     output->is_dense = true;
     return output;
 }
@@ -586,36 +766,42 @@ static void deleteObject(julienne::vertexSubset set) {
 }
 
 template <typename T>
-static VertexSubset<int> * builtin_vertexset_filter(VertexSubset<int> * input, T func) {
-    int total_elements = input->vertices_range_;
+static VertexSubset<NodeID> * builtin_vertexset_filter(VertexSubset<NodeID> * input, T func) {
+    int64_t total_elements = input->vertices_range_;
+    input->mergeInserts();
     //std::cout << "Filter range = " << total_elements << std::endl;
-    VertexSubset<int> * output = new VertexSubset<NodeID>( total_elements, 0);
-    bool * next0 = newA(bool, total_elements);
-    parallel_for(int v = 0; v < total_elements; v++)
-        next0[v] = 0;
+    VertexSubset<NodeID> * output = new VertexSubset<NodeID>( total_elements, 0);
+    Bitmap * next0 = new Bitmap(total_elements);
+    next0->reset();
     if (input->is_dense) {
         //std::cout << "Vertex subset is dense" << std::endl;
-        parallel_for(int v = 0; v < total_elements; v++) {
-            if (input->bool_map_[v] && func(v))
-                next0[v] = 1;
+        // the output keeps the bits of the input word that pass the filter
+        parallel_for(int64_t w = 0; w < (int64_t) next0->num_words(); w++) {
+            uint64_t word = 0;
+            for (uint64_t in = input->bitmap_->word(w); in != 0; in &= in - 1) {
+                int bit = __builtin_ctzll(in);
+                if (func((NodeID) (w * 64 + bit)))
+                    word |= (uint64_t) 1 << bit;
+            }
+            next0->set_word(w, word);
 	}
     } else {
         //std::cout << "Vertex subset is sparse" << std::endl;
         if(!(input->dense_vertex_set_ == nullptr && input->num_vertices_ > 0))
-            parallel_for(int v = 0; v < input->num_vertices_; v++) {
+            parallel_for(int64_t v = 0; v < input->num_vertices_; v++) {
                 //std::cout << "Vertex subset iteration for dense vertex set" << std::endl;
                 if (func(input->dense_vertex_set_[v]))
-                    next0[input->dense_vertex_set_[v]] = 1;
+                    next0->set_bit_atomic(input->dense_vertex_set_[v]);
             }
 	else 
-            parallel_for(int v = 0; v < input->num_vertices_; v++) {
+            parallel_for(int64_t v = 0; v < input->num_vertices_; v++) {
                 //std::cout << "Vertex subset iteration for tmp" << std::endl;
                 if (func(input->tmp[v]))
-                    next0[input->tmp[v]] = 1;
+                    next0->set_bit_atomic(input->tmp[v]);
             }
     }
-    output->num_vertices_ = sequence::sum(next0, total_elements);
-    output->bool_map_ = next0;
+    output->num_vertices_ = next0->count();
+    output->bitmap_ = next0;
     output->is_dense = true;
     return output;
 }
@@ -633,7 +819,8 @@ template <typename PriorityType>
 
 
 template <typename PriorityType>
-void updateBucketWithGraphItVertexSubset(VertexSubset<NodeID>* vset, julienne::PriorityQueue<PriorityType>* pq, bool nodes_init_in_bucket, int delta = 1){
+// the nodes move to the bucket of their new priority (with the queue's delta)
+void updateBucketWithGraphItVertexSubset(VertexSubset<NodeID>* vset, julienne::PriorityQueue<PriorityType>* pq, bool nodes_init_in_bucket){
     vset->toSparse();
 
     if (vset->size() == 0){
@@ -644,8 +831,7 @@ void updateBucketWithGraphItVertexSubset(VertexSubset<NodeID>* vset, julienne::P
     if (nodes_init_in_bucket){
         auto f = [&](size_t i) -> julienne::Maybe<std::tuple<julienne::uintE, julienne::uintE>> {
             const julienne::uintE v = vset->dense_vertex_set_[i];
-            PriorityType null_bkt = pq->get_null_bkt();
-            PriorityType priority = (pq->tracking_variable[v] == null_bkt) ? null_bkt : pq->tracking_variable[v]/delta;
+            const julienne::uintE priority = pq->get_bucket_id(pq->tracking_variable[v]);
 //        std::cout << "node: " << v << " priority: " << priority << " tracking val[v]: " << pq->tracking_variable[v] << " bucket: " << pq->get_bucket(priority) << std::endl;
             const julienne::uintE bkt = pq->get_bucket_no_overflow_insertion(priority);
             return julienne::Maybe<std::tuple<julienne::uintE, julienne::uintE>>(std::make_tuple(v, bkt));
@@ -660,8 +846,7 @@ void updateBucketWithGraphItVertexSubset(VertexSubset<NodeID>* vset, julienne::P
     } else {
         auto f = [&](size_t i) -> julienne::Maybe<std::tuple<julienne::uintE, julienne::uintE>> {
             const julienne::uintE v = vset->dense_vertex_set_[i];
-            PriorityType null_bkt = pq->get_null_bkt();
-            PriorityType priority = (pq->tracking_variable[v] == null_bkt) ? null_bkt : pq->tracking_variable[v]/delta;
+            const julienne::uintE priority = pq->get_bucket_id(pq->tracking_variable[v]);
 //        std::cout << "node: " << v << " priority: " << priority << " tracking val[v]: " << pq->tracking_variable[v] << " bucket: " << pq->get_bucket(priority) << std::endl;
             const julienne::uintE bkt = pq->get_bucket_with_overflow_insertion(priority);
             return julienne::Maybe<std::tuple<julienne::uintE, julienne::uintE>>(std::make_tuple(v, bkt));
@@ -5,24 +5,51 @@
 #ifndef GRAPHIT_VERTEXSUBSET_H
 #define GRAPHIT_VERTEXSUBSET_H
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
 #include <iostream>
+#include <mutex>
+#include <new>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "infra_gapbs/bitmap.h"
 #include "infra_gapbs/sliding_queue.h"
 #include "infra_ligra/ligra/parallel.h"
 #include "infra_ligra/ligra/utils.h"
 
 
+template <typename NodeID_>
+class FrontierPool;
+
 template <typename NodeID_>
 struct VertexSubset {
     int64_t vertices_range_, num_vertices_;
     bool is_dense;
     //SlidingQueue<NodeID>* dense_vertex_set_;
-    unsigned int* dense_vertex_set_;
+    // uintE (64 bit with -DEDGELONG) so Julienne vertexSubsets convert in place
+    uintE* dense_vertex_set_;
+    // the dense representation, a bit per vertex in 64-bit words (toDense)
     Bitmap * bitmap_ ;
     std::vector<NodeID> tmp;
-    bool* bool_map_;
     SlidingQueue<NodeID>* sliding_queue_;
+    // the pool the frontier goes back to when the program deletes it (deleteObject), if any
+    FrontierPool<NodeID_>* pool_ = nullptr;
+
+    // addVertex appends to the buffer of the calling worker, so vertices can be added from
+    // parallel loops. The buffers are merged into tmp (mergeInserts) before the set is read.
+    // The buffers of different workers are on different cache lines.
+    struct alignas(64) InsertBuffer {
+        std::vector<NodeID> vertices;
+    };
+    // one buffer per worker, allocated by the first addVertex (insertBuffers)
+    std::atomic<InsertBuffer*> insert_buffers_{nullptr};
+    int num_insert_buffers_ = getWorkers();
+    // vertices of threads without a buffer of their own (nested parallel loops)
+    std::vector<NodeID> shared_inserts_;
+    std::mutex shared_inserts_mutex_;
 
     // make a singleton vertex in range of n
 //    VertexSubset(int64_t vertices_range, NodeID_ v)
@@ -36,29 +63,29 @@ struct VertexSubset {
         num_vertices_ = vset.numNonzeros();
         vertices_range_ = vset.numRows();
         is_dense = false;
-        bool_map_ = nullptr;
         bitmap_ = nullptr;
         sliding_queue_ = nullptr;
 
     }
 
     VertexSubset(VertexSubset* input_vert_set)
-        : num_vertices_(input_vert_set->num_vertices_),
+        : num_vertices_(input_vert_set->size()),
             vertices_range_(input_vert_set->vertices_range_),
-            is_dense(input_vert_set->is_dense){
+            is_dense(input_vert_set->is_dense),
+            dense_vertex_set_(nullptr), bitmap_(nullptr), tmp(input_vert_set->tmp), sliding_queue_(nullptr){
             if (input_vert_set->dense_vertex_set_ != nullptr){
-                dense_vertex_set_ = newA(unsigned int, num_vertices_);
+                dense_vertex_set_ = newA(uintE, num_vertices_);
                 //TODO maybe use ligra here too
-                ligra::parallel_for_lambda((int)0, (int)num_vertices_, [&] (int i) {
+                ligra::parallel_for_lambda((int64_t)0, num_vertices_, [&] (int64_t i) {
                     dense_vertex_set_[i] = input_vert_set->dense_vertex_set_[i];
                 });
             }
 
-            if (bool_map_ != nullptr){
-                bool_map_ = newA(bool, vertices_range_);
-                //TODO maybe use ligra here too
-                ligra::parallel_for_lambda((int)0, (int)vertices_range_, [&] (int i) {
-                    bool_map_[i] = input_vert_set->bool_map_[i];
+            if (input_vert_set->bitmap_ != nullptr){
+                bitmap_ = new Bitmap(vertices_range_);
+                Bitmap * input_bitmap = input_vert_set->bitmap_;
+                ligra::parallel_for_lambda((int64_t)0, (int64_t)bitmap_->num_words(), [&] (int64_t w) {
+                    bitmap_->set_word(w, input_bitmap->word(w));
                 });
             }
 
@@ -76,10 +103,8 @@ struct VertexSubset {
             //try not to initialize unncessary data structures, this can be expensive for PageRank, which returns full set
             bitmap_ = new Bitmap(vertices_range);
             bitmap_->set_all();
-            bool_map_ = newA(bool, vertices_range);
-            ligra::parallel_for_lambda((int)0, (int)vertices_range, [&] (int i) { bool_map_[i] = 1; });
 
-            dense_vertex_set_ = new unsigned int[vertices_range];
+            dense_vertex_set_ = new uintE[vertices_range];
 // don't need this for now
 //            sliding_queue_ = new SlidingQueue<NodeID>(vertices_range);
 
@@ -91,7 +116,6 @@ struct VertexSubset {
             sliding_queue_ = nullptr;
 
         } else {
-            bool_map_ = nullptr;
             bitmap_ = nullptr;
             dense_vertex_set_ = nullptr;
             sliding_queue_ = nullptr;
@@ -107,12 +131,16 @@ struct VertexSubset {
 
     // delete the contents
      ~VertexSubset(){
+	freeInsertBuffers(insert_buffers_.load());
+	// buffers handed out by a pool go back to it, it also drops them from its in-use set
+	if(pool_) {
+		pool_->releaseBuffers(this);
+		return;
+	}
 	if(dense_vertex_set_)
 		delete[] dense_vertex_set_;
 	if(bitmap_)
 		delete bitmap_;
-	if(bool_map_)
-		delete[] bool_map_;
     }
 
     SlidingQueue<NodeID> * getSlidingQueue(){
@@ -123,23 +151,23 @@ struct VertexSubset {
         }
 
         // add nodes to the sliding queue if needed
+        mergeInserts();
         if (tmp.size() != 0) {
-            for (NodeID node : tmp) {
-                //bitmap_->set_bit(node);
-                sliding_queue_->push_back(node);
-            }
+            size_t start = sliding_queue_->shared_in;
+            sliding_queue_->shared_in += tmp.size();
+            ligra::parallel_for_lambda((int64_t)0, (int64_t)tmp.size(), [&] (int64_t i) {
+                sliding_queue_->shared[start + i] = tmp[i];
+            });
         }
 
         return sliding_queue_;
     }
 
     bool contains(NodeID_ v){
-        if (bool_map_ != nullptr)
-            return bool_map_[v];
-        else {
+        mergeInserts();
+        if (bitmap_ == nullptr)
             toDense();
-            return bool_map_[v];
-        }
+        return bitmap_->get_bit(v);
     }
 
     void addVertex(NodeID_ v){
@@ -171,13 +199,72 @@ struct VertexSubset {
 //            tmp.push_back(v);
 //        }
 
-            num_vertices_++;
-            tmp.push_back(v);
+            // safe to call concurrently, the vertex is counted when the buffers are merged
+            int worker = getWorkerId();
+            if (worker >= 0 && worker < num_insert_buffers_) {
+                insertBuffers()[worker].vertices.push_back(v);
+            } else {
+                std::lock_guard<std::mutex> lock(shared_inserts_mutex_);
+                shared_inserts_.push_back(v);
+            }
+    }
+
+    // the buffers of the workers, the first caller allocates them (cache line aligned)
+    InsertBuffer* insertBuffers() {
+        InsertBuffer* buffers = insert_buffers_.load(std::memory_order_acquire);
+        if (buffers != nullptr)
+            return buffers;
+        InsertBuffer* allocated = newA(InsertBuffer, num_insert_buffers_);
+        for (int w = 0; w < num_insert_buffers_; w++)
+            new (allocated + w) InsertBuffer();
+        if (insert_buffers_.compare_exchange_strong(buffers, allocated, std::memory_order_acq_rel))
+            return allocated;
+        // another worker was first
+        freeInsertBuffers(allocated);
+        return buffers;
+    }
+
+    void freeInsertBuffers(InsertBuffer* buffers) {
+        if (buffers == nullptr)
+            return;
+        for (int w = 0; w < num_insert_buffers_; w++)
+            buffers[w].~InsertBuffer();
+        free(buffers);
+    }
+
+    // appends the vertices added by each worker to tmp, at the offsets given by a prefix sum
+    // of the buffer sizes
+    void mergeInserts() {
+        InsertBuffer* buffers = insert_buffers_.load(std::memory_order_acquire);
+        int64_t total = shared_inserts_.size();
+        if (buffers != nullptr) {
+            for (int w = 0; w < num_insert_buffers_; w++)
+                total += buffers[w].vertices.size();
+        }
+        if (total == 0)
+            return;
+        tmp.insert(tmp.end(), shared_inserts_.begin(), shared_inserts_.end());
+        shared_inserts_.clear();
+        int64_t offset = tmp.size();
+        if (buffers != nullptr) {
+            std::vector<int64_t> offsets(num_insert_buffers_);
+            for (int w = 0; w < num_insert_buffers_; w++) {
+                offsets[w] = offset;
+                offset += buffers[w].vertices.size();
+            }
+            tmp.resize(offset);
+            ligra::parallel_for_lambda((int64_t)0, (int64_t)num_insert_buffers_, [&] (int64_t w) {
+                std::vector<NodeID> &vertices = buffers[w].vertices;
+                std::copy(vertices.begin(), vertices.end(), tmp.begin() + offsets[w]);
+                vertices.clear();
+            });
+        }
+        num_vertices_ += total;
     }
 
     long getVerticesRange() { return vertices_range_; }
-    long size() { return num_vertices_; }
-    bool isEmpty() { return num_vertices_==0; }
+    long size() { mergeInserts(); return num_vertices_; }
+    bool isEmpty() { return size()==0; }
 
     // converts to dense but keeps sparse representation if there
     void toDense() {
@@ -187,21 +274,21 @@ struct VertexSubset {
 //            {parallel_for(long i=0;i<m;i++) d[s[i]] = 1;}
 //        }
 
-        if (bool_map_ == NULL) {
-            bool_map_ = newA(bool,vertices_range_);
+        mergeInserts();
+        if (bitmap_ == nullptr) {
+            if (pool_ != nullptr) {
+                bitmap_ = pool_->acquireBitmap(vertices_range_);
+            } else {
+                bitmap_ = new Bitmap(vertices_range_);
+                bitmap_->reset();
+            }
 
-            ligra::parallel_for_lambda((long)0, (long)vertices_range_, [&] (long i) { bool_map_[i] = 0; });
-    
             if (tmp.size() != 0){
-                for (NodeID node : tmp){
-                    //bitmap_->set_bit(node);
-                    bool_map_[node] = 1;
-                    
-                }
+                ligra::parallel_for_lambda((int64_t)0, (int64_t)tmp.size(), [&] (int64_t i) { bitmap_->set_bit_atomic(tmp[i]); });
             } else if (num_vertices_ > 0){
-                ligra::parallel_for_lambda((long)0, (long)num_vertices_, [&] (long i) { bool_map_[dense_vertex_set_[i]] = 1; });
+                ligra::parallel_for_lambda((long)0, (long)num_vertices_, [&] (long i) { bitmap_->set_bit_atomic(dense_vertex_set_[i]); });
             }
-            
+
         }
 
 //        if (bitmap_ == nullptr){
@@ -224,7 +311,7 @@ struct VertexSubset {
     void printDenseSet(){
         bool first = true;
         std::cout << "dense set: ";
-        for (int i = 0; i < num_vertices_; i++){
+        for (int64_t i = 0; i < num_vertices_; i++){
             if (first){
                 std::cout << dense_vertex_set_[i];
                 first = false;
@@ -235,23 +322,42 @@ struct VertexSubset {
         std::cout << std::endl;
     }
 
+    uintE* allocSparse(int64_t n) {
+        if (pool_ != nullptr)
+            return pool_->template acquireBuffer<uintE>(n);
+        return newA(uintE, n);
+    }
+
     // converts to sparse but keeps dense representation if there
     void toSparse() {
+        mergeInserts();
         if (dense_vertex_set_ == nullptr && tmp.size() > 0) {
-            dense_vertex_set_ = new unsigned int[num_vertices_];
-            for (int i = 0; i < num_vertices_; i++) {
+            dense_vertex_set_ = allocSparse(num_vertices_);
+            ligra::parallel_for_lambda((int64_t)0, num_vertices_, [&] (int64_t i) {
                 dense_vertex_set_[i] = tmp[i];
-            }
+            });
 
         }else if (dense_vertex_set_ == nullptr && num_vertices_ > 0){
 
-                _seq<uintE> R = sequence::packIndex<uintE>(bool_map_,vertices_range_);
-                if (num_vertices_ != R.n) {
-		  cout << "num_vertices_: " << num_vertices_ << " R.n: " << R.n << endl;
+                // each word writes its vertices after the ones of the words before it
+                int64_t num_words = bitmap_->num_words();
+                uintE * word_offsets = newA(uintE, num_words);
+                ligra::parallel_for_lambda((int64_t)0, num_words, [&] (int64_t w) {
+                    word_offsets[w] = __builtin_popcountll(bitmap_->word(w));
+                });
+                int64_t total = sequence::plusScan(word_offsets, word_offsets, num_words);
+                if (num_vertices_ != total) {
+		  cout << "num_vertices_: " << num_vertices_ << " total: " << total << endl;
                     cout << "bad stored value of m" << endl;
                     abort();
                 }
-                dense_vertex_set_ = R.A;
+                dense_vertex_set_ = allocSparse(num_vertices_);
+                ligra::parallel_for_lambda((int64_t)0, num_words, [&] (int64_t w) {
+                    uintE offset = word_offsets[w];
+                    for (uint64_t word = bitmap_->word(w); word != 0; word &= word - 1)
+                        dense_vertex_set_[offset++] = w * 64 + __builtin_ctzll(word);
+                });
+                free(word_offsets);
 
         }
 
@@ -271,4 +377,243 @@ struct VertexSubset {
 
 };
 
+
+// Recycles the frontiers returned by one edgeset apply site, together with the bitvectors
+// and index arrays they are built in and the scratch arrays of the apply (generated code
+// keeps one static pool per apply function). Frontiers go back to the pool when the
+// program deletes them, so the rounds of a traversal reuse the same buffers instead of
+// allocating and page faulting new ones every round.
+template <typename NodeID_>
+class FrontierPool {
+public:
+    // free buffers kept of each kind, the others are freed
+    static const size_t kMaxFree = 16;
+
+    ~FrontierPool() {
+        for (VertexSubset<NodeID_>* frontier : free_frontiers_)
+            delete frontier;
+        for (Bitmap* bitmap : free_bitmaps_)
+            delete bitmap;
+        for (auto &buffer : free_buffers_)
+            free(buffer.first);
+    }
+
+    // an empty frontier over vertices_range vertices
+    VertexSubset<NodeID_>* acquire(int64_t vertices_range) {
+        VertexSubset<NodeID_>* frontier = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!free_frontiers_.empty()) {
+                frontier = free_frontiers_.back();
+                free_frontiers_.pop_back();
+            }
+        }
+        if (frontier == nullptr) {
+            frontier = new VertexSubset<NodeID_>(vertices_range, 0);
+        } else {
+            frontier->vertices_range_ = vertices_range;
+            frontier->num_vertices_ = 0;
+            frontier->is_dense = false;
+        }
+        frontier->pool_ = this;
+        return frontier;
+    }
+
+    // a cleared bitvector of size bits
+    Bitmap* acquireBitmap(int64_t size) {
+        Bitmap* bitmap = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (size_t i = 0; i < free_bitmaps_.size(); i++) {
+                if (free_bitmaps_[i]->size() == (size_t) size) {
+                    bitmap = free_bitmaps_[i];
+                    free_bitmaps_[i] = free_bitmaps_.back();
+                    free_bitmaps_.pop_back();
+                    break;
+                }
+            }
+        }
+        if (bitmap == nullptr)
+            bitmap = new Bitmap(size);
+        bitmap->reset();
+        return bitmap;
+    }
+
+    // an array of at least n elements, handed back with releaseBuffer (or with the frontier
+    // it becomes the sparse representation of)
+    template <typename T>
+    T* acquireBuffer(int64_t n) {
+        size_t bytes = std::max<int64_t>(n, 1) * sizeof(T);
+        std::lock_guard<std::mutex> lock(mutex_);
+        // the smallest free buffer that is large enough
+        int64_t best = -1;
+        for (size_t i = 0; i < free_buffers_.size(); i++) {
+            if (free_buffers_[i].second >= bytes
+                && (best == -1 || free_buffers_[i].second < free_buffers_[best].second))
+                best = i;
+        }
+        std::pair<void*, size_t> buffer;
+        if (best != -1) {
+            buffer = free_buffers_[best];
+            free_buffers_[best] = free_buffers_.back();
+            free_buffers_.pop_back();
+        } else {
+            buffer = std::make_pair((void*) newA(char, bytes), bytes);
+        }
+        in_use_.insert(buffer);
+        return (T*) buffer.first;
+    }
+
+    void releaseBuffer(void* buffer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = in_use_.find(buffer);
+        if (it == in_use_.end())
+            return;
+        keepBuffer(*it);
+        in_use_.erase(it);
+    }
+
+    // called by deleteObject, the buffers of the frontier are kept for the next rounds
+    void release(VertexSubset<NodeID_>* frontier) {
+        releaseBuffers(frontier);
+        frontier->tmp.clear();
+        // the insert buffers stay allocated for the next round
+        auto buffers = frontier->insert_buffers_.load();
+        if (buffers != nullptr) {
+            for (int w = 0; w < frontier->num_insert_buffers_; w++)
+                buffers[w].vertices.clear();
+        }
+        frontier->shared_inserts_.clear();
+        frontier->pool_ = nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_frontiers_.size() < kMaxFree)
+            free_frontiers_.push_back(frontier);
+        else
+            delete frontier;
+    }
+
+    // takes back the index array, bitvector and queue of a frontier of this pool (release,
+    // or the destructor of a frontier deleted without deleteObject)
+    void releaseBuffers(VertexSubset<NodeID_>* frontier) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (frontier->dense_vertex_set_ != nullptr) {
+            auto it = in_use_.find(frontier->dense_vertex_set_);
+            if (it != in_use_.end()) {
+                keepBuffer(*it);
+                in_use_.erase(it);
+            } else {
+                free(frontier->dense_vertex_set_);
+            }
+        }
+        if (frontier->bitmap_ != nullptr) {
+            if (free_bitmaps_.size() < kMaxFree)
+                free_bitmaps_.push_back(frontier->bitmap_);
+            else
+                delete frontier->bitmap_;
+        }
+        if (frontier->sliding_queue_ != nullptr)
+            delete frontier->sliding_queue_;
+        frontier->dense_vertex_set_ = nullptr;
+        frontier->bitmap_ = nullptr;
+        frontier->sliding_queue_ = nullptr;
+    }
+
+private:
+    void keepBuffer(const std::pair<void*, size_t> &buffer) {
+        if (free_buffers_.size() < kMaxFree)
+            free_buffers_.push_back(buffer);
+        else
+            free(buffer.first);
+    }
+
+    std::mutex mutex_;
+    std::vector<VertexSubset<NodeID_>*> free_frontiers_;
+    std::vector<Bitmap*> free_bitmaps_;
+    std::vector<std::pair<void*, size_t>> free_buffers_;
+    std::unordered_map<void*, size_t> in_use_;
+};
+
+
+// Picks the direction of every round of a hybrid (push/pull) edgeset apply, with the
+// heuristics of direction optimizing BFS (Beamer et al., bfs.cc in GAPBS). Generated code
+// keeps a switch per apply function and thread, so traversals run from parallel loops keep
+// their own state, and resets it when a traversal starts (a frontier the apply did not return).
+//  - while pushing, it pulls once the frontier and its out edges exceed numEdges / alpha
+//  - while pulling, it keeps pulling as long as the frontier grows or holds more than
+//    numVertices / beta vertices. beta = 0 turns the hysteresis off, every round is then
+//    decided on the edge count alone
+//  - the out edges are estimated from the degrees of an evenly spaced sample of the
+//    frontier, so rounds that pull don't sum the degrees of the whole frontier
+//  - compiled with -DLOG_DIRECTION, it prints the decision of every round
+class DirectionSwitch {
+public:
+    // frontier vertices whose degrees are read per round when alpha or beta are
+    // configured, smaller frontiers are summed exactly
+    static const long kSampleSize = 1024;
+    static const int kDefaultAlpha = 20;
+    static const int kDefaultBeta = 0;
+
+    DirectionSwitch(int alpha, int beta, const char *name)
+            : alpha_(alpha), beta_(beta), name_(name) {}
+
+    // frontier has to be sparse
+    template <typename GraphT_, typename NodeID_>
+    bool usePull(GraphT_ &g, VertexSubset<NodeID_> *frontier) {
+        long m = frontier->size();
+        // the default thresholds sum every degree like the fixed m + outDegrees > numEdges / 20
+        // check they replace, so default schedules switch on the same rounds
+        if (alpha_ == kDefaultAlpha && beta_ == kDefaultBeta) {
+            uintT *degrees = newA(uintT, m);
+            ligra::parallel_for_lambda((long)0, (long)m, [&] (long i) {
+                degrees[i] = g.out_degree(frontier->dense_vertex_set_[i]);
+            });
+            uintT out_edges = sequence::plusReduce(degrees, m);
+            free(degrees);
+            return decide(m, out_edges, g.num_nodes(), g.num_edges());
+        }
+        long k = m < kSampleSize ? m : kSampleSize;
+        // kept in uintT like the outDegrees of the generated push traversals
+        uintT sampled_degrees = 0;
+        for (long i = 0; i < k; i++)
+            sampled_degrees += g.out_degree(frontier->dense_vertex_set_[(int64_t) i * m / k]);
+        uintT out_edges = k == 0 ? 0 : (uintT) ((double) sampled_degrees * m / k);
+        return decide(m, out_edges, g.num_nodes(), g.num_edges());
+    }
+
+    // apply over all the vertices
+    template <typename GraphT_>
+    bool usePull(GraphT_ &g) {
+        return decide(g.num_nodes(), g.num_edges(), g.num_nodes(), g.num_edges());
+    }
+
+    // forgets the rounds of the previous traversal, the next one starts pushing
+    void reset() {
+        pulling_ = false;
+        prev_size_ = 0;
+        round_ = 0;
+    }
+
+private:
+    bool decide(int64_t m, uintT out_edges, int64_t num_vertices, int64_t num_edges) {
+        if (pulling_ && beta_ > 0)
+            pulling_ = m >= prev_size_ || m > num_vertices / beta_;
+        else
+            pulling_ = m + out_edges > num_edges / alpha_;
+#ifdef LOG_DIRECTION
+        std::cout << name_ << " round " << round_ << ": " << m << " vertices, ~"
+                  << out_edges << " out edges, " << (pulling_ ? "pull" : "push") << std::endl;
+#endif
+        round_++;
+        prev_size_ = m;
+        return pulling_;
+    }
+
+    int alpha_;
+    int beta_;
+    const char *name_;
+    bool pulling_ = false;
+    int64_t prev_size_ = 0;
+    int64_t round_ = 0;
+};
+
 #endif //GRAPHIT_VERTEXSUBSET_H
\ No newline at end of file
@@ -395,6 +395,16 @@ TEST_F(BackendTest, SimpleEdgeSetTranspose) {
     EXPECT_EQ (0, basicTest(is));
 }
 
+TEST_F(BackendTest, SimpleEdgeSetPublish) {
+    istringstream is("element Vertex end\n"
+                             "element Edge end\n"
+                             "const edges : edgeset{Edge}(Vertex,Vertex) = load (\"test.el\");\n"
+                             "func main() "
+                             "      edges.publish(\"test\"); \n"
+                             " end");
+    EXPECT_EQ (0, basicTest(is));
+}
+
 TEST_F(BackendTest, SimpleForLoops) {
     istringstream is("func main() for i in 1:10; print i; end end");
     EXPECT_EQ (0, basicTest(is));
@@ -1316,3 +1326,42 @@ TEST_F(BackendTest, UDFDuplicationBasicTestNoDup) {
     EXPECT_EQ(1, countSubstring(output, "struct apply_edge"));
     EXPECT_EQ(1, countSubstring(output, "void edgeset_apply_push_serial"));
 }
+
+TEST_F(BackendTest, DeleteVertexArrayUsesDeleteArray) {
+    istringstream is("element Vertex end\n"
+                     "element Edge end\n"
+                     "const edges : edgeset{Edge}(Vertex, Vertex) = load(argv[1]);\n"
+                     "const simpleArray: vector{Vertex}(int) = 0;\n"
+                     "func main()\n"
+                     "    var local_array : vector{Vertex}(int) = 0;\n"
+                     "    delete local_array;\n"
+                     "    delete simpleArray;\n"
+                     "end\n"
+    );
+    std::string output = basicTestToString(is);
+    EXPECT_EQ(1, countSubstring(output, "DeleteArray(simpleArray"));
+    EXPECT_EQ(1, countSubstring(output, "DeleteArray(local_array"));
+    EXPECT_EQ(0, countSubstring(output, "deleteObject("));
+    EXPECT_EQ(0, countSubstring(output, "new int["));
+}
+
+TEST_F(BackendTest, VertexValuedVectorUsesNodeID) {
+    istringstream is("element Vertex end\n"
+                     "element Edge end\n"
+                     "const edges : edgeset{Edge}(Vertex, Vertex) = load(argv[1]);\n"
+                     "const parent : vector{Vertex}(int) = -1;\n"
+                     "const depth : vector{Vertex}(int) = 0;\n"
+                     "func updateEdge(src : Vertex, dst : Vertex)\n"
+                     "    parent[dst] = src;\n"
+                     "    depth[dst] = depth[src] + 1;\n"
+                     "end\n"
+                     "func main()\n"
+                     "    edges.apply(updateEdge);\n"
+                     "end\n"
+    );
+    std::string output = basicTestToString(is);
+    // parent stores vertices and is as wide as NodeID, depth stays an int array
+    EXPECT_EQ(1, countSubstring(output, "NodeID  * __restrict parent"));
+    EXPECT_EQ(1, countSubstring(output, "parent = NewArray< NodeID "));
+    EXPECT_EQ(1, countSubstring(output, "int  * __restrict depth"));
+}
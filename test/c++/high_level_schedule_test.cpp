@@ -1472,6 +1472,139 @@ TEST_F(HighLevelScheduleTest, BFSPullEdgeAwareParallelSchedule) {
     EXPECT_EQ(true, mir::isa<mir::PullEdgeSetApplyExpr>(assign_stmt->expr));
 }
 
+TEST_F(HighLevelScheduleTest, BFSPushCompressedSchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyEdgeCompression("s1", "delta-varint");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::FuncDecl::Ptr main_func_decl = mir_context_->getFunction("main");
+    mir::WhileStmt::Ptr while_stmt = mir::to<mir::WhileStmt>((*(main_func_decl->body->stmts))[2]);
+    mir::AssignStmt::Ptr assign_stmt = mir::to<mir::AssignStmt>((*(while_stmt->body->stmts))[0]);
+    EXPECT_EQ(true, mir::isa<mir::PushEdgeSetApplyExpr>(assign_stmt->expr));
+    EXPECT_EQ(true, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->use_compressed_edges);
+    // the only apply on edges is compressed, so the plain neighbors can be released
+    EXPECT_EQ(1, mir_context_->compressed_only_edgesets.count("edges"));
+}
+
+TEST_F(HighLevelScheduleTest, BFSHybridDenseStreamedSchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush-DensePull");
+    program->configApplyEdgeStreaming("s1", "semi-external", 1024);
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::FuncDecl::Ptr main_func_decl = mir_context_->getFunction("main");
+    mir::WhileStmt::Ptr while_stmt = mir::to<mir::WhileStmt>((*(main_func_decl->body->stmts))[2]);
+    mir::AssignStmt::Ptr assign_stmt = mir::to<mir::AssignStmt>((*(while_stmt->body->stmts))[0]);
+    EXPECT_EQ(true, mir::isa<mir::HybridDenseEdgeSetApplyExpr>(assign_stmt->expr));
+    EXPECT_EQ(true, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->use_edge_streaming);
+    mir::AssignStmt::Ptr load_stmt = mir::to<mir::AssignStmt>(mir_context_->edgeset_alloc_stmts[0]);
+    EXPECT_EQ(1024, mir::to<mir::EdgeSetLoadExpr>(load_stmt->expr)->stream_buffer_edges);
+}
+
+TEST_F(HighLevelScheduleTest, BFSHybridDenseDirectionThresholdsSchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush-DensePull");
+    program->configApplyDirectionThresholds("s1", 15, 18);
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::FuncDecl::Ptr main_func_decl = mir_context_->getFunction("main");
+    mir::WhileStmt::Ptr while_stmt = mir::to<mir::WhileStmt>((*(main_func_decl->body->stmts))[2]);
+    mir::AssignStmt::Ptr assign_stmt = mir::to<mir::AssignStmt>((*(while_stmt->body->stmts))[0]);
+    EXPECT_EQ(true, mir::isa<mir::HybridDenseEdgeSetApplyExpr>(assign_stmt->expr));
+    EXPECT_EQ(15, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->direction_alpha);
+    EXPECT_EQ(18, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->direction_beta);
+}
+
+TEST_F(HighLevelScheduleTest, BFSPushOnlySkipsInverse) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::AssignStmt::Ptr load_stmt = mir::to<mir::AssignStmt>(mir_context_->edgeset_alloc_stmts[0]);
+    EXPECT_EQ(false, mir::to<mir::EdgeSetLoadExpr>(load_stmt->expr)->build_inverse);
+}
+
+TEST_F(HighLevelScheduleTest, BFSHybridDenseKeepsInverse) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush-DensePull");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::AssignStmt::Ptr load_stmt = mir::to<mir::AssignStmt>(mir_context_->edgeset_alloc_stmts[0]);
+    EXPECT_EQ(true, mir::to<mir::EdgeSetLoadExpr>(load_stmt->expr)->build_inverse);
+}
+
+TEST_F(HighLevelScheduleTest, BFSHybridDenseReorderedSchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush-DensePull");
+    program->configApplyVertexReordering("s1", "rcm");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    mir::AssignStmt::Ptr load_stmt = mir::to<mir::AssignStmt>(mir_context_->edgeset_alloc_stmts[0]);
+    EXPECT_EQ("rcm", mir::to<mir::EdgeSetLoadExpr>(load_stmt->expr)->vertex_reordering);
+}
+
+TEST_F(HighLevelScheduleTest, PRPullHugePagesSchedule) {
+    istringstream is (pr_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "DensePull")->configHugePages("thp");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    EXPECT_EQ ("thp", mir_context_->huge_pages);
+}
+
+TEST_F(HighLevelScheduleTest, BFSPushNUMAPlacementSchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush")->configNUMAPlacement("sockets");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    EXPECT_EQ ("sockets", mir_context_->numa_placement);
+}
+
+TEST_F(HighLevelScheduleTest, BFSHybridDenseReplicatedTopologySchedule) {
+    istringstream is (bfs_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+
+    program->configApplyDirection("s1", "SparsePush-DensePull");
+    program->configApplyTopologyReplication("s1", "sockets");
+    //generate c++ code successfully
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    EXPECT_EQ (1, mir_context_->replicated_edgesets.count("edges"));
+    EXPECT_EQ ("sockets", mir_context_->numa_placement);
+}
+
 TEST_F(HighLevelScheduleTest, BFSHybridDenseSchedule) {
     istringstream is (bfs_str_);
     fe_->parseStream(is, context_, errors_);
@@ -1690,6 +1823,18 @@ TEST_F(HighLevelScheduleTest, PRPullParallelRuntimeSegmentArgs) {
 }
 
 
+TEST_F(HighLevelScheduleTest, PRPullParallelSegmentCache) {
+    istringstream is (pr_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+    program->configApplyDirection("l1:s1", "DensePull")->configApplyParallelization("l1:s1", "dynamic-vertex-parallel");
+    program->configApplyNumSSG("l1:s1", "fixed-vertex-count",  2);
+    program->configApplySegmentCache("l1:s1", "argv[2]");
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+
+    EXPECT_EQ ("argv[2]", mir_context_->edgeset_to_label_to_segment_cache["edges"]["l1:s1"]);
+}
 
 
 
@@ -2087,6 +2232,29 @@ TEST_F(HighLevelScheduleTest, SSSPwithHybridDenseForwardSchedule) {
 
 
 
+TEST_F(HighLevelScheduleTest, SSSPwithHybridDenseSoAWeightsSchedule) {
+
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program_schedule_node
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+    program_schedule_node->configApplyDirection("s1", "SparsePush-DensePull")
+            ->configApplyWeightLayout("s1", "soa");
+    istringstream is (sssp_str_);
+    fe_->parseStream(is, context_, errors_);
+    EXPECT_EQ (0,  basicTestWithSchedule(program_schedule_node));
+    EXPECT_EQ (1, mir_context_->soa_weighted_edgesets.count("edges"));
+    // nothing else reads the NodeWeight neighbors, they are freed once the soa copy is built
+    EXPECT_EQ (1, mir_context_->soa_only_edgesets.count("edges"));
+    mir::FuncDecl::Ptr main_func_decl = mir_context_->getFunction("main");
+    for (auto stmt : *(main_func_decl->body->stmts)) {
+        if (mir::isa<mir::WhileStmt>(stmt)) {
+            mir::AssignStmt::Ptr assign_stmt = mir::to<mir::AssignStmt>((*(mir::to<mir::WhileStmt>(stmt)->body->stmts))[0]);
+            EXPECT_EQ(true, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->use_soa_weights);
+            // updateEdge adds the weight to the distance
+            EXPECT_EQ(true, mir::to<mir::EdgeSetApplyExpr>(assign_stmt->expr)->reads_weights);
+        }
+    }
+}
+
 TEST_F(HighLevelScheduleTest, SSSPwithHybridDenseForwardScheduleNewAPI) {
 
     fir::high_level_schedule::ProgramScheduleNode::Ptr program_schedule_node
@@ -2424,6 +2592,26 @@ TEST_F(HighLevelScheduleTest, DeltaSteppingWithEagerPriorityUpdate) {
     EXPECT_EQ (0, basicTestWithSchedule(program));
 }
 
+TEST_F(HighLevelScheduleTest, DeltaSteppingInt64WeightsWithEagerPriorityUpdate) {
+    string int64_str = delta_stepping_str_;
+    for (string type : {"Vertex, int)", "{Vertex}(int)", "weight : int", "new_dist : int"}) {
+        string int64_type = type;
+        int64_type.replace(int64_type.find("int"), 3, "int64");
+        for (size_t pos = int64_str.find(type); pos != string::npos;
+             pos = int64_str.find(type, pos + int64_type.size()))
+            int64_str.replace(pos, type.size(), int64_type);
+    }
+    istringstream is (int64_str);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+    program->configApplyPriorityUpdate("s1", "eager_priority_update");
+    program->configApplyPriorityUpdateDelta("s1", 2);
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    auto load_stmt = mir::to<mir::AssignStmt>(mir_context_->edgeset_alloc_stmts[0]);
+    EXPECT_EQ ("int64_t", mir::to<mir::EdgeSetLoadExpr>(load_stmt->expr)->weight_type_);
+}
+
 TEST_F(HighLevelScheduleTest, DeltaSteppingDensePullParallel) {
     istringstream is (delta_stepping_str_);
     fe_->parseStream(is, context_, errors_);
@@ -2511,6 +2699,22 @@ TEST_F(HighLevelScheduleTest, PPSPDeltaSteppingWithSparsePushParallelSchedule) {
     EXPECT_EQ (0, basicTestWithSchedule(program));
 }
 
+TEST_F(HighLevelScheduleTest, PPSPDeltaSteppingWithVertexReordering) {
+    istringstream is (ppsp_str_);
+    fe_->parseStream(is, context_, errors_);
+    fir::high_level_schedule::ProgramScheduleNode::Ptr program
+            = std::make_shared<fir::high_level_schedule::ProgramScheduleNode>(context_);
+    program->configApplyDirection("s1", "SparsePush");
+    program->configApplyVertexReordering("s1", "degree");
+    EXPECT_EQ (0, basicTestWithSchedule(program));
+    // the source and destination vertices read from argv are renumbered
+    mir::FuncDecl::Ptr main_func_decl = mir_context_->getFunction("main");
+    for (int i = 0; i < 2; i++) {
+        mir::VarDecl::Ptr var_decl = mir::to<mir::VarDecl>((*(main_func_decl->body->stmts))[i]);
+        EXPECT_EQ("builtin_toNewID", mir::to<mir::Call>(var_decl->initVal)->name);
+    }
+}
+
 
 TEST_F(HighLevelScheduleTest, PPSPDeltaSteppingWithEagerPriorityUpdateArgv) {
     istringstream is (ppsp_str_);
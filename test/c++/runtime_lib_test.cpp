@@ -17,13 +17,19 @@
 class RuntimeLibTest : public ::testing::Test {
 protected:
     virtual void SetUp() {
-
+        // graph caches go to the working directory instead of test/graphs
+        setenv("GRAPHIT_GRAPH_CACHE", ".", 1);
+        numa_placement_ = GetNUMAPlacement();
     }
 
     virtual void TearDown() {
-
+        // tests that pin threads must not leave them pinned for the next ones
+        if (GetNUMAPlacement() != numa_placement_)
+            SetNUMAPlacement(numa_placement::ModeName(numa_placement_));
     }
 
+    NUMAPlacement numa_placement_;
+
 
     // Compares against simple serial implementation
     bool SSSPVerifier(const WGraph &g, NodeID source,
@@ -153,6 +159,900 @@ TEST_F(RuntimeLibTest, SimpleLoadVerticesromEdges) {
     EXPECT_EQ (5 , num_vertices);
 }
 
+TEST_F(RuntimeLibTest, LoadSerializedGraphTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/4.el");
+    Graph sg = builtin_loadEdgesFromFile("../../test/graphs/4.sg");
+    EXPECT_EQ (g.num_nodes(), sg.num_nodes());
+    EXPECT_EQ (g.num_edges(), sg.num_edges());
+}
+
+TEST_F(RuntimeLibTest, MappableSerializedGraphTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
+    Writer(g).WriteGraph("mappable_test.sg", true, true);
+    Graph mg = builtin_loadEdgesFromFile("mappable_test.sg");
+    std::remove("mappable_test.sg");
+    EXPECT_EQ (g.num_nodes(), mg.num_nodes());
+    EXPECT_EQ (g.num_edges(), mg.num_edges());
+    EXPECT_TRUE (mg.directed());
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        EXPECT_EQ (g.out_degree(n), mg.out_degree(n));
+        EXPECT_EQ (g.in_degree(n), mg.in_degree(n));
+        EXPECT_TRUE (std::equal(g.out_neigh(n).begin(), g.out_neigh(n).end(), mg.out_neigh(n).begin()));
+        EXPECT_TRUE (std::equal(g.in_neigh(n).begin(), g.in_neigh(n).end(), mg.in_neigh(n).begin()));
+    }
+}
+
+TEST_F(RuntimeLibTest, MappableWeightedSerializedGraphTest) {
+    WGraph g = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    WeightedWriter(g).WriteGraph("mappable_test.wsg", true, true);
+    WGraph mg = builtin_loadWeightedEdgesFromFile("mappable_test.wsg");
+    std::remove("mappable_test.wsg");
+    EXPECT_EQ (g.num_edges(), mg.num_edges());
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        ASSERT_EQ (g.out_degree(n), mg.out_degree(n));
+        for (int i = 0; i < g.out_degree(n); i++) {
+            EXPECT_EQ (g.out_neigh(n).begin()[i].v, mg.out_neigh(n).begin()[i].v);
+            EXPECT_EQ (g.out_neigh(n).begin()[i].w, mg.out_neigh(n).begin()[i].w);
+        }
+    }
+}
+
+TEST_F(RuntimeLibTest, OffsetIndexTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
+    SGOffset* offsets = g.get_out_offsets_();
+    EXPECT_EQ (0, offsets[0]);
+    EXPECT_EQ (g.num_edges(), offsets[g.num_nodes()]);
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        EXPECT_EQ (g.out_degree(n), offsets[n+1] - offsets[n]);
+        EXPECT_EQ (g.get_out_neighbors_() + offsets[n], g.out_neigh(n).begin());
+    }
+    // the transpose and the load balancing offsets reuse the same index
+    Graph t = builtin_transpose(g);
+    EXPECT_EQ (offsets, t.get_in_offsets_());
+    EXPECT_EQ (g.get_in_offsets_(), g.get_offsets_());
+}
+
+TEST_F(RuntimeLibTest, CompressedGraphTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
+    g.buildCompressedGraph();
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        std::vector<NodeID> out(g.out_neigh(n).begin(), g.out_neigh(n).end());
+        std::vector<NodeID> in(g.in_neigh(n).begin(), g.in_neigh(n).end());
+        std::sort(out.begin(), out.end());
+        std::sort(in.begin(), in.end());
+        std::vector<NodeID> out_compressed, in_compressed;
+        for (NodeID d : g.out_neigh_compressed(n))
+            out_compressed.push_back(d);
+        for (NodeID s : g.in_neigh_compressed(n))
+            in_compressed.push_back(s);
+        EXPECT_EQ (out, out_compressed);
+        EXPECT_EQ (in, in_compressed);
+    }
+}
+
+TEST_F(RuntimeLibTest, CompressedWeightedGraphTest) {
+    WGraph g = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    g.buildCompressedGraph();
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        int64_t total = 0, total_compressed = 0, degree = 0;
+        for (WNode d : g.out_neigh(n))
+            total += d.v * 1000 + d.w;
+        for (WNode d : g.out_neigh_compressed(n)) {
+            total_compressed += d.v * 1000 + d.w;
+            degree++;
+        }
+        EXPECT_EQ (g.out_degree(n), degree);
+        EXPECT_EQ (total, total_compressed);
+    }
+}
+
+TEST_F(RuntimeLibTest, CompressedReleasingGraphTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/rmat10.el");
+    // a private copy of the neighbors, its pages are released while it is compressed
+    NodeID *neighs = NewArray<NodeID>(g.num_edges_directed());
+    std::copy(g.get_out_neighbors_(), g.get_out_neighbors_() + g.num_edges_directed(), neighs);
+    CompressedCSR<NodeID, NodeID> compressed(g.num_nodes(), g.get_out_offsets_(), neighs, true);
+    DeleteArray(neighs);
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        std::vector<NodeID> out(g.out_neigh(n).begin(), g.out_neigh(n).end());
+        std::sort(out.begin(), out.end());
+        std::vector<NodeID> out_compressed;
+        for (NodeID d : compressed.neigh(n))
+            out_compressed.push_back(d);
+        EXPECT_EQ (out, out_compressed);
+    }
+}
+
+TEST_F(RuntimeLibTest, ReleasePagesTest) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    std::vector<char> buffer(5 * page, 1);
+    char *base = buffer.data() + (page - reinterpret_cast<uintptr_t>(buffer.data()) % page) % page;
+    // the partial page at the end is left for the next range
+    const void *released = ReleasePages(base, base + page + page / 2);
+    EXPECT_EQ (base + page, released);
+    EXPECT_EQ (released, ReleasePages(released, base + page + page / 2 + 1));
+    EXPECT_EQ (base + 3 * page, ReleasePages(released, base + 3 * page));
+    EXPECT_EQ (1, base[3 * page]);
+}
+
+TEST_F(RuntimeLibTest, SemiExternalGraphTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
+    Graph streamed = builtin_loadEdgesSemiExternal("../../test/graphs/test.el", 3);
+    EXPECT_EQ (g.num_edges(), streamed.num_edges());
+    EXPECT_LT (1, streamed.in_stream().num_partitions());
+    // the second sweep reads the partitions prefetched at the end of the first
+    for (int sweep = 0; sweep < 2; sweep++) {
+        NodeID covered = 0;
+        for (int p = 0; p < streamed.in_stream().num_partitions(); p++) {
+            auto part = streamed.in_stream().partition(p);
+            EXPECT_EQ (covered, part.first);
+            for (NodeID d = part.first; d < part.last; d++) {
+                EXPECT_EQ (g.in_degree(d), streamed.in_degree(d));
+                std::vector<NodeID> in(g.in_neigh(d).begin(), g.in_neigh(d).end());
+                std::vector<NodeID> in_streamed(part.neigh(d).begin(), part.neigh(d).end());
+                EXPECT_EQ (in, in_streamed);
+            }
+            covered = part.last;
+        }
+        EXPECT_EQ (g.num_nodes(), covered);
+    }
+    // inputs that can't be streamed into a cache are an error, not an in-memory build
+    std::ofstream out("stream_test.graph");
+    out << "2 1\n2\n1\n";
+    out.close();
+    EXPECT_EXIT (builtin_loadEdgesSemiExternal("stream_test.graph", 3), ::testing::ExitedWithCode(256 - 33), "");
+    std::remove("stream_test.graph");
+}
+
+TEST_F(RuntimeLibTest, StreamedCacheGraphTest) {
+    // duplicates and self loops are squished out of core like in memory
+    std::ofstream out("stream_test.el");
+    for (int i = 0; i < 3000; i++)
+        out << i % 500 << " " << (i * 7 + 3) % 500 << "\n" << i % 500 << " " << i % 500 << "\n";
+    out.close();
+    Graph streamed = builtin_loadEdgesSemiExternal("stream_test.el", 100);
+    std::remove("stream_test.el.4-4.cache.sg");
+    Graph g = builtin_loadEdgesFromFile("stream_test.el");
+    std::remove("stream_test.el");
+    std::remove("stream_test.el.4-4.cache.sg");
+    EXPECT_EQ (g.num_nodes(), streamed.num_nodes());
+    EXPECT_EQ (g.num_edges(), streamed.num_edges());
+    EXPECT_LT (1, streamed.out_stream().num_partitions());
+    for (int p = 0; p < streamed.out_stream().num_partitions(); p++) {
+        auto part = streamed.out_stream().partition(p);
+        for (NodeID s = part.first; s < part.last; s++) {
+            std::vector<NodeID> out_neigh(g.out_neigh(s).begin(), g.out_neigh(s).end());
+            std::vector<NodeID> out_streamed(part.neigh(s).begin(), part.neigh(s).end());
+            EXPECT_EQ (out_neigh, out_streamed);
+        }
+    }
+    for (int p = 0; p < streamed.in_stream().num_partitions(); p++) {
+        auto part = streamed.in_stream().partition(p);
+        for (NodeID d = part.first; d < part.last; d++) {
+            std::vector<NodeID> in(g.in_neigh(d).begin(), g.in_neigh(d).end());
+            std::vector<NodeID> in_streamed(part.neigh(d).begin(), part.neigh(d).end());
+            EXPECT_EQ (in, in_streamed);
+        }
+    }
+}
+
+TEST_F(RuntimeLibTest, PullSegmentedGraphTest) {
+    // enough vertices for segments to be built from several blocks
+    std::ofstream out("segment_test.el");
+    for (int i = 0; i < 10000; i++)
+        out << i << " " << (i * 7 + 1) % 10000 << "\n" << i << " " << (i * 13 + 5) % 10000 << "\n";
+    out.close();
+    Graph g = builtin_loadEdgesFromFile("segment_test.el");
+    std::remove("segment_test.el");
+    std::remove("segment_test.el.4-4.cache.sg");
+    g.buildPullSegmentedGraphs("s1", 3);
+    int segmentRange = (g.num_nodes() + 2) / 3;
+    std::vector<std::vector<NodeID>> in(g.num_nodes());
+    int64_t num_edges = 0;
+    for (int i = 0; i < 3; i++) {
+        auto sg = g.getSegmentedGraph("s1", i);
+        num_edges += sg->numEdges;
+        EXPECT_EQ (sg->numEdges, sg->vertexArray[sg->numVertices]);
+        for (int64_t v = 0; v < sg->numVertices; v++) {
+            if (v > 0)
+                EXPECT_LT (sg->graphId[v - 1], sg->graphId[v]);
+            for (int64_t e = sg->vertexArray[v]; e < sg->vertexArray[v + 1]; e++) {
+                EXPECT_EQ (i, sg->edgeArray[e] / segmentRange);
+                in[sg->graphId[v]].push_back(sg->edgeArray[e]);
+            }
+        }
+    }
+    EXPECT_EQ (g.num_edges(), num_edges);
+    for (NodeID d = 0; d < g.num_nodes(); d++) {
+        std::vector<NodeID> expected(g.in_neigh(d).begin(), g.in_neigh(d).end());
+        std::sort(expected.begin(), expected.end());
+        std::sort(in[d].begin(), in[d].end());
+        EXPECT_EQ (expected, in[d]);
+    }
+}
+
+TEST_F(RuntimeLibTest, SegmentCacheTest) {
+    Graph built = builtin_loadEdgesFromFile("../../test/graphs/4.el");
+    built.buildPullSegmentedGraphs("s1", 2, false, ".");
+    // the second graph maps the segments written for the first one
+    Graph cached = builtin_loadEdgesFromFile("../../test/graphs/4.el");
+    cached.buildPullSegmentedGraphs("s1", 2, false, ".");
+    char name[64];
+    snprintf(name, sizeof(name), "%016" PRIx64 ".2.pull.seg", built.InFingerprint());
+    std::remove(name);
+    for (int i = 0; i < 2; i++) {
+        auto expected = built.getSegmentedGraph("s1", i);
+        auto sg = cached.getSegmentedGraph("s1", i);
+        EXPECT_EQ (nullptr, expected->mapping);
+        EXPECT_NE (nullptr, sg->mapping);
+        ASSERT_EQ (expected->numVertices, sg->numVertices);
+        ASSERT_EQ (expected->numEdges, sg->numEdges);
+        EXPECT_TRUE (std::equal(sg->graphId, sg->graphId + sg->numVertices, expected->graphId));
+        EXPECT_TRUE (std::equal(sg->vertexArray, sg->vertexArray + sg->numVertices + 1, expected->vertexArray));
+        EXPECT_TRUE (std::equal(sg->edgeArray, sg->edgeArray + sg->numEdges, expected->edgeArray));
+    }
+}
+
+TEST_F(RuntimeLibTest, SortedCSRBuilderTest) {
+    // duplicates with different weights, self-loops and a vertex without edges
+    pvector<EdgePair<NodeID, WNode>> el;
+    for (int i = 0; i < 200000; i++)
+        el.push_back(EdgePair<NodeID, WNode>((i * 7) % 100, WNode((i * 13) % 99, i % 7)));
+    el.push_back(EdgePair<NodeID, WNode>(3, WNode(3, 1)));
+    el.push_back(EdgePair<NodeID, WNode>(1001, WNode(0, 1)));
+    CLBase cli("");
+    WeightedBuilder squished(cli);
+    WGraph expected = squished.SquishGraph(squished.MakeGraphFromEL(el));
+    // the sorted graph is built from the same edges through MakeGraph, as with -DRADIX_BUILDER
+    std::ofstream out("sorted_test.wel");
+    for (auto e : el)
+        out << e.u << " " << e.v.v << " " << e.v.w << "\n";
+    out.close();
+    CLBase file_cli("sorted_test.wel");
+    WeightedBuilder sorted(file_cli);
+    sorted.sorted_build_ = true;
+    WGraph g = sorted.MakeGraph();
+    std::remove("sorted_test.wel");
+    std::remove("sorted_test.wel.4-8.cache.wsg");
+    ASSERT_EQ (expected.num_nodes(), g.num_nodes());
+    ASSERT_EQ (expected.num_edges(), g.num_edges());
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        ASSERT_EQ (expected.out_degree(n), g.out_degree(n));
+        ASSERT_EQ (expected.in_degree(n), g.in_degree(n));
+        EXPECT_TRUE (std::equal(g.out_neigh(n).begin(), g.out_neigh(n).end(), expected.out_neigh(n).begin(),
+                                [](WNode a, WNode b) { return a.v == b.v && a.w == b.w; }));
+        EXPECT_TRUE (std::equal(g.in_neigh(n).begin(), g.in_neigh(n).end(), expected.in_neigh(n).begin(),
+                                [](WNode a, WNode b) { return a.v == b.v && a.w == b.w; }));
+    }
+}
+
+TEST_F(RuntimeLibTest, DynamicGraphTest) {
+    // base edges, then a batch of insertions and a batch of deletions (some of the base, some inserted)
+    std::set<std::pair<NodeID, NodeID>> edges;
+    pvector<EdgePair<NodeID>> base_el, inserts, deletes;
+    for (int i = 0; i < 20000; i++) {
+        base_el.push_back(EdgePair<NodeID>((i * 7) % 1000, (i * 13) % 997));
+        edges.insert(std::make_pair((i * 7) % 1000, (i * 13) % 997));
+    }
+    for (int i = 0; i < 5000; i++) {
+        inserts.push_back(EdgePair<NodeID>((i * 11) % 1000, (i * 17) % 991));
+        if ((i * 11) % 1000 != (i * 17) % 991)
+            edges.insert(std::make_pair((i * 11) % 1000, (i * 17) % 991));
+    }
+    for (int i = 0; i < 20000; i += 3) {
+        deletes.push_back(EdgePair<NodeID>((i * 7) % 1000, (i * 13) % 997));
+        edges.erase(std::make_pair((i * 7) % 1000, (i * 13) % 997));
+    }
+    for (int i = 0; i < 5000; i += 5) {
+        deletes.push_back(EdgePair<NodeID>((i * 11) % 1000, (i * 17) % 991));
+        edges.erase(std::make_pair((i * 11) % 1000, (i * 17) % 991));
+    }
+    pvector<EdgePair<NodeID>> expected_el;
+    for (auto e : edges)
+        expected_el.push_back(EdgePair<NodeID>(e.first, e.second));
+    CLBase cli("");
+    Builder base_builder(cli), expected_builder(cli);
+    Graph expected = expected_builder.MakeSortedGraphFromEL(expected_el);
+
+    // no automatic compaction, the neighbors come from the base and the deltas
+    DynamicGraph<NodeID> g(base_builder.MakeSortedGraphFromEL(base_el), 1e9);
+    g.InsertEdges(inserts);
+    g.DeleteEdges(deletes);
+    ASSERT_EQ (expected.num_edges(), g.num_edges());
+    EXPECT_GT (g.pending_updates(), 0);
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        ASSERT_EQ (expected.out_degree(n), g.out_degree(n));
+        ASSERT_EQ (expected.in_degree(n), g.in_degree(n));
+        std::set<NodeID> out(g.out_neigh(n).begin(), g.out_neigh(n).end());
+        std::set<NodeID> in(g.in_neigh(n).begin(), g.in_neigh(n).end());
+        EXPECT_TRUE (std::equal(out.begin(), out.end(), expected.out_neigh(n).begin()));
+        EXPECT_TRUE (std::equal(in.begin(), in.end(), expected.in_neigh(n).begin()));
+    }
+
+    // compacted into a sorted CSR
+    Graph &compacted = g.graph();
+    EXPECT_EQ (0, g.pending_updates());
+    ASSERT_EQ (expected.num_edges(), compacted.num_edges());
+    for (NodeID n = 0; n < compacted.num_nodes(); n++) {
+        ASSERT_EQ (expected.out_degree(n), compacted.out_degree(n));
+        ASSERT_EQ (expected.in_degree(n), compacted.in_degree(n));
+        EXPECT_TRUE (std::equal(compacted.out_neigh(n).begin(), compacted.out_neigh(n).end(),
+                                expected.out_neigh(n).begin()));
+        EXPECT_TRUE (std::equal(compacted.in_neigh(n).begin(), compacted.in_neigh(n).end(),
+                                expected.in_neigh(n).begin()));
+    }
+}
+
+TEST_F(RuntimeLibTest, DynamicGraphLazyInverseTest) {
+    // a base loaded without its inverse, the batch is large enough to be bucketed by several chunks
+    std::set<std::pair<NodeID, NodeID>> edges;
+    pvector<EdgePair<NodeID>> base_el, inserts;
+    for (int i = 0; i < 20000; i++) {
+        base_el.push_back(EdgePair<NodeID>((i * 7) % 1000, (i * 13) % 997));
+        edges.insert(std::make_pair((i * 7) % 1000, (i * 13) % 997));
+    }
+    for (int i = 0; i < 30000; i++) {
+        inserts.push_back(EdgePair<NodeID>((i * 11) % 1000, (i * 17) % 991));
+        if ((i * 11) % 1000 != (i * 17) % 991)
+            edges.insert(std::make_pair((i * 11) % 1000, (i * 17) % 991));
+    }
+    pvector<EdgePair<NodeID>> expected_el;
+    for (auto e : edges)
+        expected_el.push_back(EdgePair<NodeID>(e.first, e.second));
+    CLBase cli("");
+    Builder base_builder(cli), expected_builder(cli);
+    base_builder.needs_inverse_ = false;
+    Graph expected = expected_builder.MakeSortedGraphFromEL(expected_el);
+
+    DynamicGraph<NodeID> g(base_builder.MakeSortedGraphFromEL(base_el), 1e9);
+    ASSERT_FALSE (g.graph().has_inverse());
+    g.InsertEdges(inserts);
+    ASSERT_EQ (expected.num_edges(), g.num_edges());
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        std::set<NodeID> out(g.out_neigh(n).begin(), g.out_neigh(n).end());
+        EXPECT_TRUE (std::equal(out.begin(), out.end(), expected.out_neigh(n).begin()));
+    }
+
+    // the inverse is built from the compacted out-edges
+    g.buildInverse();
+    EXPECT_EQ (0, g.pending_updates());
+    for (NodeID n = 0; n < g.num_nodes(); n++) {
+        ASSERT_EQ (expected.in_degree(n), g.in_degree(n));
+        EXPECT_TRUE (std::equal(g.in_neigh(n).begin(), g.in_neigh(n).end(), expected.in_neigh(n).begin()));
+    }
+
+    // updates have to stay within the vertices
+    pvector<EdgePair<NodeID>> invalid;
+    invalid.push_back(EdgePair<NodeID>(0, g.num_nodes()));
+    EXPECT_EXIT (g.InsertEdges(invalid), ::testing::ExitedWithCode(256 - 32), "");
+}
+
+TEST_F(RuntimeLibTest, IncrementalSSSPTest) {
+    // distinct edges, so the builder keeps every weight as it is
+    std::map<std::pair<NodeID, NodeID>, WeightT> edges;
+    pvector<EdgePair<NodeID, WNode>> base_el, added, removed;
+    for (int i = 0; i < 6000; i++) {
+        NodeID u = (i * 7) % 1000, v = (i * 13) % 997;
+        if (u != v && edges.emplace(std::make_pair(u, v), i % 9 + 1).second)
+            base_el.push_back(EdgePair<NodeID, WNode>(u, WNode(v, i % 9 + 1)));
+    }
+    for (int i = 0; i < (int) base_el.size(); i += 10) {
+        removed.push_back(base_el[i]);
+        edges.erase(std::make_pair(base_el[i].u, base_el[i].v.v));
+    }
+    for (int i = 0; i < 300; i++) {
+        NodeID u = (i * 11) % 1000, v = (i * 17) % 991;
+        if (u != v && edges.emplace(std::make_pair(u, v), i % 5 + 1).second)
+            added.push_back(EdgePair<NodeID, WNode>(u, WNode(v, i % 5 + 1)));
+    }
+    pvector<EdgePair<NodeID, WNode>> el;
+    for (auto e : edges)
+        el.push_back(EdgePair<NodeID, WNode>(e.first.first, WNode(e.first.second, e.second)));
+    CLBase cli("");
+    WeightedBuilder base_builder(cli), builder(cli);
+    WGraph base = base_builder.MakeGraphFromEL(base_el);
+    WGraph g = builder.MakeGraphFromEL(el);
+
+    auto BellmanFord = [](const WGraph &graph, NodeID source) {
+        pvector<WeightT> dist(graph.num_nodes(), std::numeric_limits<WeightT>::max());
+        dist[source] = 0;
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (NodeID u = 0; u < graph.num_nodes(); u++) {
+                if (dist[u] == std::numeric_limits<WeightT>::max())
+                    continue;
+                for (WNode v : graph.out_neigh(u)) {
+                    if (dist[u] + v.w < dist[v.v]) {
+                        dist[v.v] = dist[u] + v.w;
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return dist;
+    };
+    pvector<WeightT> dist = BellmanFord(base, 7);
+    IncrementalSSSP(g, (NodeID) 7, dist.data(), added, removed);
+    pvector<WeightT> expected = BellmanFord(g, 7);
+    for (NodeID n = 0; n < g.num_nodes(); n++)
+        ASSERT_EQ (expected[n], dist[n]);
+}
+
+TEST_F(RuntimeLibTest, IncrementalPageRankAndCCTest) {
+    // ten blocks of 100 vertices, the removals split blocks and the additions join them
+    pvector<EdgePair<NodeID>> base_el, added, removed, el;
+    std::set<std::pair<NodeID, NodeID>> edges;
+    for (int i = 0; i < 1500; i++) {
+        NodeID u = (i * 7) % 1000, v = u / 100 * 100 + (i * 13) % 100;
+        if (u != v && edges.insert(std::make_pair(std::min(u, v), std::max(u, v))).second)
+            base_el.push_back(EdgePair<NodeID>(u, v));
+    }
+    for (int i = 0; i < (int) base_el.size(); i += 4) {
+        removed.push_back(base_el[i]);
+        edges.erase(std::make_pair(std::min(base_el[i].u, base_el[i].v), std::max(base_el[i].u, base_el[i].v)));
+    }
+    for (int i = 0; i < 6; i++) {
+        NodeID u = i * 131 % 1000, v = (i * 131 + 250) % 1000;
+        if (edges.insert(std::make_pair(std::min(u, v), std::max(u, v))).second)
+            added.push_back(EdgePair<NodeID>(u, v));
+    }
+    for (auto e : edges)
+        el.push_back(EdgePair<NodeID>(e.first, e.second));
+    char *argv[] = {(char*) "test", (char*) "-f", (char*) "unused", (char*) "-s"};
+    CLBase cli(4, argv);
+    cli.ParseArgs();
+    Builder base_builder(cli), builder(cli);
+    Graph base = base_builder.MakeGraphFromEL(base_el);
+    Graph g = builder.MakeGraphFromEL(el);
+
+    // pagerank.gt iterated to its fixed point
+    auto PageRank = [](const Graph &graph) {
+        pvector<double> ranks(graph.num_nodes(), 1.0 / graph.num_nodes()), next(graph.num_nodes());
+        for (int iter = 0; iter < 1000; iter++) {
+            for (NodeID v = 0; v < graph.num_nodes(); v++) {
+                double sum = 0;
+                for (NodeID u : graph.in_neigh(v))
+                    sum += ranks[u] / graph.out_degree(u);
+                next[v] = 0.15 / graph.num_nodes() + 0.85 * sum;
+            }
+            std::swap(ranks, next);
+        }
+        return ranks;
+    };
+    pvector<double> ranks = PageRank(base);
+    IncrementalPageRank(g, ranks.data(), added, removed, 0.85, 1e-12);
+    pvector<double> expected_ranks = PageRank(g);
+    for (NodeID n = 0; n < g.num_nodes(); n++)
+        EXPECT_NEAR (expected_ranks[n], ranks[n], 1e-9);
+
+    // cc.gt labels, the smallest ID of each component
+    auto Components = [](const Graph &graph) {
+        pvector<NodeID> labels(graph.num_nodes());
+        for (NodeID v = 0; v < graph.num_nodes(); v++)
+            labels[v] = v;
+        for (bool changed = true; changed; ) {
+            changed = false;
+            for (NodeID u = 0; u < graph.num_nodes(); u++) {
+                for (NodeID v : graph.out_neigh(u)) {
+                    if (labels[u] < labels[v]) {
+                        labels[v] = labels[u];
+                        changed = true;
+                    }
+                }
+            }
+        }
+        return labels;
+    };
+    pvector<NodeID> labels = Components(base);
+    IncrementalCC(g, labels.data(), added, removed);
+    pvector<NodeID> expected_labels = Components(g);
+    for (NodeID n = 0; n < g.num_nodes(); n++)
+        ASSERT_EQ (expected_labels[n], labels[n]);
+}
+
+TEST_F(RuntimeLibTest, HugePageAllocationTest) {
+    HugePageMode mode = GetHugePages();
+    SetHugePages("thp");
+    // small arrays are cache line aligned, large ones huge page aligned
+    int64_t *small = NewArray<int64_t>(1000);
+    int64_t *large = NewArray<int64_t>(kHugePageSize);
+    bool *frontier = newA(bool, 3 * kHugePageSize);
+    EXPECT_EQ (0, reinterpret_cast<uintptr_t>(small) % kCacheLineSize);
+    EXPECT_EQ (0, reinterpret_cast<uintptr_t>(large) % kHugePageSize);
+    EXPECT_EQ (0, reinterpret_cast<uintptr_t>(frontier) % kHugePageSize);
+    for (int64_t i = 0; i < static_cast<int64_t>(kHugePageSize); i++)
+        large[i] = i;
+    EXPECT_EQ (kHugePageSize - 1, large[kHugePageSize - 1]);
+    std::ostringstream report;
+    PrintHugePageReport(report);
+    EXPECT_EQ (0, report.str().find("Huge pages: thp"));
+    DeleteArray(small);
+    DeleteArray(large);
+    free(frontier);
+
+    // the graph arrays come from the same allocator, with or without hugetlbfs pages
+    SetHugePages("hugetlb");
+    CLBase cli("");
+    Builder builder(cli);
+    pvector<EdgePair<NodeID>> el;
+    for (int i = 0; i < 1000; i++)
+        el.push_back(EdgePair<NodeID>(i, (i + 1) % 1000));
+    Graph g = builder.MakeGraphFromEL(el);
+    EXPECT_EQ (1000, g.num_edges());
+    EXPECT_EQ (0, reinterpret_cast<uintptr_t>(g.get_out_neighbors_()) % kCacheLineSize);
+    SetHugePages(mode == HugePageMode::kOff ? "off" : mode == HugePageMode::kTHP ? "thp" : "hugetlb");
+}
+
+TEST_F(RuntimeLibTest, NUMAPlacementTest) {
+#ifndef OPENMP
+    // only OpenMP threads are pinned, the calling thread keeps every CPU of the process
+    testing::internal::CaptureStderr();
+    SetNUMAPlacement("sockets");
+    EXPECT_NE (std::string::npos, testing::internal::GetCapturedStderr().find("placement stays off"));
+    EXPECT_EQ (NUMAPlacement::kOff, GetNUMAPlacement());
+    EXPECT_EQ (-1, numa_placement::ThreadNode());
+    cpu_set_t set;
+    sched_getaffinity(0, sizeof(set), &set);
+    EXPECT_TRUE (CPU_EQUAL(&set, &numa_placement::ProcessCPUs()));
+#else
+    // the page report needs move_pages, which containers often filter
+    if (!numa_placement::PagePlacementAvailable()) {
+        std::cout << "[  SKIPPED ] move_pages is not available" << std::endl;
+        return;
+    }
+    SetNUMAPlacement("sockets");
+    // large arrays come back first touched (zeroed), neighbors by vertex blocks
+    int64_t *values = NewArray<int64_t>(kHugePageSize);
+    EXPECT_EQ (0, *std::max_element(values, values + kHugePageSize));
+    pvector<SGOffset> offsets(1001);
+    for (int64_t v = 0; v <= 1000; v++)
+        offsets[v] = v * v;
+    NodeID *neighs = NewNeighborArray<NodeID>(offsets, 1000);
+    EXPECT_EQ (0, *std::max_element(neighs, neighs + offsets[1000]));
+    std::ostringstream report;
+    PrintPagePlacement(report);
+    EXPECT_EQ (0, report.str().find("NUMA placement: sockets"));
+    EXPECT_NE (std::string::npos, report.str().find("all sampled pages: node0"));
+    DeleteArray(values);
+    DeleteArray(neighs);
+
+    // graphs built with the placement are unchanged
+    CLBase cli("");
+    Builder builder(cli);
+    pvector<EdgePair<NodeID>> el;
+    for (int i = 0; i < 1 << 20; i++)
+        el.push_back(EdgePair<NodeID>(i % 1000, (i * 7 + 1) % 1000));
+    Graph g = builder.MakeGraphFromEL(el);
+    SetNUMAPlacement("off");
+    Graph expected = builder.MakeGraphFromEL(el);
+    ASSERT_EQ (expected.num_edges(), g.num_edges());
+    for (NodeID v = 0; v < 1000; v++) {
+        ASSERT_EQ (expected.out_degree(v), g.out_degree(v));
+        std::vector<NodeID> a(g.out_neigh(v).begin(), g.out_neigh(v).end());
+        std::vector<NodeID> b(expected.out_neigh(v).begin(), expected.out_neigh(v).end());
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        ASSERT_EQ (b, a);
+    }
+#endif
+}
+
+TEST_F(RuntimeLibTest, ReplicatedTopologyTest) {
+    WGraph g = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    ReplicatedCSR<NodeID, WNode> replicated(g.num_nodes(), g.out_offsets_shared_.get(),
+                                            g.out_neighbors_shared_.get());
+    EXPECT_EQ (numa_placement::NodeCPUs().size(), replicated.num_replicas());
+    for (int node = 0; node < replicated.num_replicas(); node++) {
+        auto replica = replicated.replica(node);
+        for (NodeID v = 0; v < g.num_nodes(); v++) {
+            ASSERT_EQ (g.out_degree(v), replica.offsets[v+1] - replica.offsets[v]);
+            WNode *neigh = replica.neighs + replica.offsets[v];
+            for (WNode d : g.out_neigh(v)) {
+                ASSERT_EQ (d.v, neigh->v);
+                ASSERT_EQ (d.w, neigh->w);
+                neigh++;
+            }
+        }
+    }
+
+#ifdef OPENMP
+    // pinned threads read the copy of their node, unpinned ones the graph
+    SetNUMAPlacement("sockets");
+    int missing = 0;
+    #pragma omp parallel reduction(+:missing)
+    missing += replicated.local() != &replicated.replica(numa_placement::ThreadNode());
+    EXPECT_EQ (0, missing);
+    SetNUMAPlacement("off");
+#endif
+    EXPECT_EQ (nullptr, replicated.local());
+
+    // unpinned threads would never read the replicas, they are not built
+    testing::internal::CaptureStderr();
+    g.buildReplicatedGraph();
+    std::string warning = testing::internal::GetCapturedStderr();
+    EXPECT_EQ (nullptr, g.replicated_out_);
+    EXPECT_EQ (numa_placement::NodeCPUs().size() > 1, warning.find("Topology replication") != std::string::npos);
+    EXPECT_EQ (NUMAPlacement::kOff, GetNUMAPlacement());
+
+    // replicas built for the threads of this build's backend are read by every one of them
+    SetNUMAPlacement("sockets");
+    g.buildReplicatedGraph();
+    int unread = 0;
+    #pragma omp parallel reduction(+:unread)
+    unread += g.replicated_out_ != nullptr && g.replicated_out_->local() == nullptr;
+    EXPECT_EQ (0, unread);
+    WGraph expected = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    int mismatches = 0;
+    #pragma omp parallel for reduction(+:mismatches)
+    for (NodeID v = 0; v < g.num_nodes(); v++) {
+        mismatches += expected.out_degree(v) != g.out_degree(v);
+        std::vector<WNode> a(g.in_neigh_replicated(v).begin(), g.in_neigh_replicated(v).end());
+        std::vector<WNode> b(expected.in_neigh(v).begin(), expected.in_neigh(v).end());
+        mismatches += a.size() != b.size();
+        for (size_t i = 0; i < a.size() && i < b.size(); i++)
+            mismatches += a[i].v != b[i].v || a[i].w != b[i].w;
+    }
+    EXPECT_EQ (0, mismatches);
+}
+
+TEST_F(RuntimeLibTest, SoAWeightsTest) {
+    WGraph g = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    g.buildSoAWeights();
+    for (NodeID v = 0; v < g.num_nodes(); v++) {
+        std::vector<WNode> aos(g.in_neigh(v).begin(), g.in_neigh(v).end());
+        std::vector<WNode> soa, ids;
+        for (WNode s : g.in_neigh_soa(v))
+            soa.push_back(s);
+        for (WNode s : g.in_neigh_soa_ids(v))
+            ids.push_back(s);
+        ASSERT_EQ (aos.size(), soa.size());
+        ASSERT_EQ (aos.size(), ids.size());
+        for (size_t i = 0; i < aos.size(); i++) {
+            ASSERT_EQ (aos[i].v, soa[i].v);
+            ASSERT_EQ (aos[i].w, soa[i].w);
+            ASSERT_EQ (aos[i].v, ids[i].v);
+            ASSERT_EQ (0, ids[i].w);
+        }
+    }
+    // the array of structs neighbors are only freed when no other copy of the
+    // graph shares them, the cached graphs alias a mapping so build one here
+    CLBase cli("");
+    WeightedBuilder builder(cli);
+    pvector<EdgePair<NodeID, WNode>> el;
+    for (NodeID v = 0; v < g.num_nodes(); v++)
+        for (WNode s : g.out_neigh(v))
+            el.push_back(EdgePair<NodeID, WNode>(v, s));
+    WGraph shared = builder.MakeGraphFromEL(el);
+    WGraph copy = shared;
+    shared.buildSoAWeights(true);
+    EXPECT_NE (nullptr, shared.get_out_neighbors_());
+    WGraph released = builder.MakeGraphFromEL(el);
+    released.buildSoAWeights(true);
+    EXPECT_EQ (nullptr, released.get_out_neighbors_());
+    for (NodeID v = 0; v < g.num_nodes(); v++) {
+        ASSERT_EQ (g.out_degree(v), released.out_degree(v));
+        auto soa = released.out_neigh_soa(v).begin();
+        for (WNode s : g.out_neigh(v)) {
+            ASSERT_EQ (s.v, (*soa).v);
+            ASSERT_EQ (s.w, (*soa).w);
+            ++soa;
+        }
+    }
+}
+
+TEST_F(RuntimeLibTest, ReorderGraphTest) {
+    WGraph g = builtin_loadWeightedEdgesFromFile("../../test/graphs/test.wel");
+    for (std::string method : {"degree", "hub-sort", "hub-cluster", "rcm", "gorder"}) {
+        WGraph reordered = builtin_reorder(g, method);
+        ASSERT_EQ (g.num_edges(), reordered.num_edges());
+        std::vector<bool> seen(g.num_nodes(), false);
+        for (NodeID n = 0; n < g.num_nodes(); n++) {
+            NodeID new_id = builtin_toNewID(reordered, n);
+            EXPECT_FALSE (seen[new_id]);
+            seen[new_id] = true;
+            EXPECT_EQ (n, builtin_toOldID(reordered, new_id));
+            // every edge and its weight survive under the new IDs
+            std::vector<std::pair<NodeID, WeightT>> out, in;
+            for (WNode d : g.out_neigh(n))
+                out.push_back(std::make_pair(builtin_toNewID(reordered, d.v), d.w));
+            for (WNode d : g.in_neigh(n))
+                in.push_back(std::make_pair(builtin_toNewID(reordered, d.v), d.w));
+            std::sort(out.begin(), out.end());
+            std::sort(in.begin(), in.end());
+            std::vector<std::pair<NodeID, WeightT>> new_out, new_in;
+            for (WNode d : reordered.out_neigh(new_id))
+                new_out.push_back(std::make_pair(d.v, d.w));
+            for (WNode d : reordered.in_neigh(new_id))
+                new_in.push_back(std::make_pair(d.v, d.w));
+            EXPECT_EQ (out, new_out);
+            EXPECT_EQ (in, new_in);
+        }
+    }
+}
+
+TEST_F(RuntimeLibTest, ParseEdgeListTest) {
+    // comments, blank lines, CRLF endings and no newline at the end
+    std::ofstream out("parse_test.el");
+    out << "# comment\n0 1\r\n\n1 2\n  2 0";
+    out.close();
+    Graph g = builtin_loadEdgesFromFile("parse_test.el");
+    std::remove("parse_test.el");
+    std::remove("parse_test.el.4-4.cache.sg");
+    EXPECT_EQ (3 , g.num_nodes());
+    EXPECT_EQ (3 , g.num_edges());
+    EXPECT_EQ (0 , *g.out_neigh(2).begin());
+}
+
+TEST_F(RuntimeLibTest, GraphCacheTest) {
+    std::ofstream out("cache_test.el");
+    out << "0 1\n1 2\n2 0\n2 3\n";
+    out.close();
+    Graph g = builtin_loadEdgesFromFile("cache_test.el");
+    std::ifstream cache("cache_test.el.4-4.cache.sg");
+    EXPECT_TRUE (cache.good());
+    cache.close();
+    // a cache hit reports its read time like other serialized graphs
+    testing::internal::CaptureStdout();
+    Graph cached = builtin_loadEdgesFromFile("cache_test.el");
+    EXPECT_NE (std::string::npos, testing::internal::GetCapturedStdout().find("Read Time"));
+    EXPECT_EQ (g.num_edges(), cached.num_edges());
+    EXPECT_EQ (g.out_degree(2), cached.out_degree(2));
+    EXPECT_EQ (1, cached.in_degree(0));
+    // a changed input invalidates the cache
+    out.open("cache_test.el", std::ios::app);
+    out << "3 0\n";
+    out.close();
+    Graph rebuilt = builtin_loadEdgesFromFile("cache_test.el");
+    std::remove("cache_test.el");
+    std::remove("cache_test.el.4-4.cache.sg");
+    EXPECT_EQ (5, rebuilt.num_edges());
+    EXPECT_EQ (2, rebuilt.in_degree(0));
+}
+
+TEST_F(RuntimeLibTest, LazyInverseTest) {
+    std::ofstream out("inverse_test.wel");
+    out << "0 1 3\n1 2 1\n2 0 4\n2 3 2\n0 3 5\n";
+    out.close();
+    WGraph push_only = builtin_loadWeightedEdgesFromFile("inverse_test.wel", false);
+    EXPECT_FALSE (push_only.has_inverse());
+    EXPECT_EQ (5, push_only.num_edges());
+    // the cache written without the inverse doesn't pass for a load that needs it
+    WGraph cached = builtin_loadWeightedEdgesFromFile("inverse_test.wel", false);
+    EXPECT_FALSE (cached.has_inverse());
+    WGraph full = builtin_loadWeightedEdgesFromFile("inverse_test.wel");
+    EXPECT_TRUE (full.has_inverse());
+    WGraph recached = builtin_loadWeightedEdgesFromFile("inverse_test.wel", false);
+    EXPECT_FALSE (recached.has_inverse());
+    std::remove("inverse_test.wel");
+    std::remove("inverse_test.wel.4-8.cache.wsg");
+    push_only.buildInverse();
+    EXPECT_TRUE (push_only.has_inverse());
+    for (NodeID n = 0; n < full.num_nodes(); n++) {
+        EXPECT_EQ (full.in_degree(n), push_only.in_degree(n));
+        for (int64_t i = 0; i < full.in_degree(n); i++) {
+            EXPECT_EQ (full.in_neigh(n).begin()[i].v, push_only.in_neigh(n).begin()[i].v);
+            EXPECT_EQ (full.in_neigh(n).begin()[i].w, push_only.in_neigh(n).begin()[i].w);
+        }
+    }
+    // transpose builds the inverse it is made of
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el", false);
+    Graph transposed = builtin_transpose(g);
+    EXPECT_TRUE (g.has_inverse());
+    EXPECT_EQ (g.in_degree(4), transposed.out_degree(4));
+    EXPECT_EQ (*g.out_neigh(3).begin(), *transposed.in_neigh(3).begin());
+}
+
+TEST_F(RuntimeLibTest, GraphStoreTest) {
+    setenv("GRAPHIT_GRAPH_STORE", ".", 1);
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el", false);
+    builtin_publish(g, "store_test");
+    EXPECT_TRUE (IsGraphStoreName("store:store_test"));
+    std::vector<graph_store::Entry> stored = ListStoredGraphs();
+    EXPECT_EQ (1, stored.size());
+    EXPECT_EQ (g.num_edges(), stored[0].num_edges);
+    // attaching maps the published copy, the inverse was published along with it
+    Graph attached = builtin_loadEdgesFromFile("store:store_test");
+    EXPECT_TRUE (attached.has_inverse());
+    EXPECT_EQ (g.num_nodes(), attached.num_nodes());
+    EXPECT_EQ (g.num_edges(), attached.num_edges());
+    EXPECT_EQ (g.in_degree(4), attached.in_degree(4));
+    EXPECT_EQ (*g.out_neigh(3).begin(), *attached.out_neigh(3).begin());
+    EXPECT_TRUE (UnpublishGraph("store_test"));
+    EXPECT_FALSE (UnpublishGraph("store_test"));
+    EXPECT_EQ (0, ListStoredGraphs().size());
+    std::remove("graphit.registry");
+    std::remove("graphit.registry.lock");
+    unsetenv("GRAPHIT_GRAPH_STORE");
+}
+
+TEST_F(RuntimeLibTest, LoadGraph64BitIDsTest) {
+    typedef CSRGraph<int64_t> Graph64;
+    CLBase cli ("../../test/graphs/test.el");
+    BuilderBase<int64_t> builder (cli);
+    Graph64 g = builder.MakeGraph();
+    EXPECT_EQ (7 , g.num_edges());
+    WriterBase<int64_t>(g).WriteGraph("test_64.sg", true);
+    CLBase sg_cli ("test_64.sg");
+    BuilderBase<int64_t> sg_builder (sg_cli);
+    Graph64 sg = sg_builder.MakeGraph();
+    std::remove("test_64.sg");
+    EXPECT_EQ (7 , sg.num_edges());
+    EXPECT_EQ (g.out_degree(1), sg.out_degree(1));
+    EXPECT_EQ (4 , *(sg.out_neigh(3).begin()));
+}
+
+TEST_F(RuntimeLibTest, MixedTypeCompareAndSwapTest) {
+    int64_t parent = -1;
+    // the int literal is converted to the type of the target
+    EXPECT_TRUE (compare_and_swap(parent, -1, (int64_t) 1 << 40));
+    EXPECT_EQ ((int64_t) 1 << 40, parent);
+    // same size values that round trip are converted
+    uint32_t visited = UINT32_MAX;
+    EXPECT_TRUE (compare_and_swap(visited, -1, 3));
+    EXPECT_EQ (3, visited);
+}
+
+TEST_F(RuntimeLibTest, FloatingPointWeightsTest) {
+    std::ofstream out("float_test.wel");
+    out << "0 1 0.5\n1 2 1.25\n0 2 2\n";
+    out.close();
+    WGraphT<float> g = builtin_loadWeightedEdgesFromFile<float>("float_test.wel");
+    EXPECT_EQ (3, g.num_edges());
+    EXPECT_EQ (0.5f, (*g.out_neigh(0).begin()).w);
+    EXPECT_EQ (1.25f, (*g.out_neigh(1).begin()).w);
+    // every weight type has its own cache, int32_t and float weights have the
+    // same size but not the same name
+    WGraphT<int64_t> g64 = builtin_loadWeightedEdgesFromFile<int64_t>("float_test.wel");
+    EXPECT_EQ (2, g64.out_neigh(0).begin()[1].w);
+    WGraph g32 = builtin_loadWeightedEdgesFromFile("float_test.wel");
+    EXPECT_EQ (2, g32.out_neigh(0).begin()[1].w);
+    std::ifstream float_cache("float_test.wel.4-8f.cache.wsg");
+    EXPECT_TRUE (float_cache.good());
+    float_cache.close();
+    WGraphT<float> cached = builtin_loadWeightedEdgesFromFile<float>("float_test.wel");
+    EXPECT_EQ (0.5f, (*cached.out_neigh(0).begin()).w);
+    EXPECT_EQ (2.0f, cached.out_neigh(0).begin()[1].w);
+    // .wsg files with double weights
+    WGraphT<double> g_double = builtin_loadWeightedEdgesFromFile<double>("float_test.wel");
+    WriterBase<NodeID, WNodeT<double>>(g_double).WriteGraph("float_test.wsg", true);
+    WGraphT<double> wsg = builtin_loadWeightedEdgesFromFile<double>("float_test.wsg");
+    std::remove("float_test.wel");
+    std::remove("float_test.wel.4-8f.cache.wsg");
+    std::remove("float_test.wel.4-16.cache.wsg");
+    std::remove("float_test.wel.4-8.cache.wsg");
+    std::remove("float_test.wel.4-16f.cache.wsg");
+    std::remove("float_test.wsg");
+    EXPECT_EQ (3, wsg.num_edges());
+    EXPECT_EQ (1.25, wsg.in_neigh(2).begin()[1].w);
+}
+
+TEST_F(RuntimeLibTest, FloatingPointPriorityBucketsTest) {
+    // priorities are bucketed by floor(priority/delta)
+    float priorities[5] = {0.25f, 1.75f, 0.5f, 3.0f, std::numeric_limits<float>::max()};
+    auto pq = new julienne::PriorityQueue<float>(5, priorities, julienne::increasing,
+                                                 julienne::strictly_decreasing, 4, 0.5f);
+    std::vector<julienne::uintE> order;
+    while (true) {
+        auto vset = getBucketWithGraphItVertexSubset(pq);
+        if (pq->finished())
+            break;
+        EXPECT_EQ (1, vset->num_vertices_);
+        vset->toSparse();
+        order.push_back(vset->dense_vertex_set_[0]);
+        if (order.size() == 1) {
+            EXPECT_TRUE (pq->finishedNode(0));
+            EXPECT_FALSE (pq->finishedNode(1));
+        }
+    }
+    EXPECT_EQ (std::vector<julienne::uintE>({0, 2, 1, 3}), order);
+
+    double eager_priorities[2] = {0.75, 1.0};
+    EagerPriorityQueue<double> eager_pq(eager_priorities, 0.5);
+    EXPECT_EQ (1, eager_pq.get_bin(eager_priorities[0]));
+    EXPECT_EQ (2, eager_pq.get_bin(eager_priorities[1]));
+    EXPECT_FALSE (eager_pq.finishedNode(0));
+}
+
 TEST_F(RuntimeLibTest, GetOutDegrees) {
     Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
     auto out_degrees = builtin_getOutDegrees(g);
@@ -177,6 +1077,163 @@ TEST_F(RuntimeLibTest, TimerTest) {
     EXPECT_EQ (5 , 5);
 }
 
+TEST_F(RuntimeLibTest, VertexSubsetBitvectorTest) {
+    // 130 vertices span three words, the last one partially
+    auto full = new VertexSubset<int>(130, 130);
+    EXPECT_EQ (130, full->bitmap_->count());
+    EXPECT_TRUE (full->contains(129));
+    auto evens = builtin_const_vertexset_filter([] (NodeID v) { return v % 2 == 0; }, 130);
+    EXPECT_TRUE (evens->is_dense);
+    EXPECT_EQ (65, builtin_getVertexSetSize(evens));
+    evens->toSparse();
+    for (int i = 0; i < 65; i++)
+        EXPECT_EQ (2 * i, evens->dense_vertex_set_[i]);
+    auto multiples_of_six = builtin_vertexset_filter(evens, [] (NodeID v) { return v % 3 == 0; });
+    EXPECT_EQ (22, builtin_getVertexSetSize(multiples_of_six));
+    int64_t sum = 0;
+    builtin_vertexset_apply(multiples_of_six, [&] (NodeID v) { writeAdd(&sum, (int64_t) v); });
+    EXPECT_EQ (6 * (21 * 22 / 2), sum);
+    delete full;
+    delete evens;
+    delete multiples_of_six;
+}
+
+TEST_F(RuntimeLibTest, FrontierPoolTest) {
+    FrontierPool<NodeID> pool;
+    VertexSubset<NodeID> * frontier = pool.acquire(100);
+    uintE * indices = pool.acquireBuffer<uintE>(10);
+    for (int i = 0; i < 10; i++)
+        indices[i] = 3 * i;
+    frontier->dense_vertex_set_ = indices;
+    frontier->num_vertices_ = 10;
+    EXPECT_TRUE (frontier->contains(27));
+    EXPECT_FALSE (frontier->contains(28));
+    Bitmap * bitmap = frontier->bitmap_;
+    deleteObject(frontier);
+    // the next round gets the same frontier and buffers back, emptied
+    VertexSubset<NodeID> * next = pool.acquire(100);
+    EXPECT_EQ (frontier, next);
+    EXPECT_EQ (0, next->size());
+    EXPECT_EQ (nullptr, next->dense_vertex_set_);
+    EXPECT_EQ (nullptr, next->bitmap_);
+    EXPECT_EQ (indices, pool.acquireBuffer<uintE>(5));
+    Bitmap * next_bitmap = pool.acquireBitmap(100);
+    EXPECT_EQ (bitmap, next_bitmap);
+    EXPECT_EQ (0, next_bitmap->count());
+    delete next_bitmap;
+    // too large for the free buffers
+    uintE * large = pool.acquireBuffer<uintE>(1000);
+    EXPECT_NE (indices, large);
+    pool.releaseBuffer(large);
+    pool.releaseBuffer(indices);
+    deleteObject(next);
+
+    // a frontier deleted directly still hands its buffers back to the pool
+    VertexSubset<NodeID> * direct = pool.acquire(100);
+    direct->dense_vertex_set_ = pool.acquireBuffer<uintE>(2000);
+    uintE * direct_indices = direct->dense_vertex_set_;
+    delete direct;
+    EXPECT_EQ (direct_indices, pool.acquireBuffer<uintE>(2000));
+    pool.releaseBuffer(direct_indices);
+}
+
+TEST_F(RuntimeLibTest, VertexSubsetConcurrentAddVertexTest) {
+    auto vertexSubset = new VertexSubset<NodeID>(10000, 0);
+    ligra::parallel_for_lambda((NodeID)0, (NodeID)10000, [&] (NodeID v) {
+        if (v % 3 == 0)
+            vertexSubset->addVertex(v);
+    });
+    EXPECT_EQ (3334, builtin_getVertexSetSize(vertexSubset));
+    EXPECT_TRUE (vertexSubset->contains(9999));
+    EXPECT_FALSE (vertexSubset->contains(9998));
+    vertexSubset->toSparse();
+    std::vector<NodeID> sparse(vertexSubset->dense_vertex_set_, vertexSubset->dense_vertex_set_ + 3334);
+    std::sort(sparse.begin(), sparse.end());
+    for (int i = 0; i < 3334; i++)
+        EXPECT_EQ (3 * i, sparse[i]);
+    SlidingQueue<NodeID> * queue = vertexSubset->getSlidingQueue();
+    queue->slide_window();
+    EXPECT_EQ (3334, queue->size());
+    delete queue;
+    delete vertexSubset;
+}
+
+TEST_F(RuntimeLibTest, DirectionSwitchTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/rmat10.el");
+    // alpha = 1 only pulls frontiers with more out edges than the graph
+    DirectionSwitch with_hysteresis(1, 18, "with_hysteresis");
+    DirectionSwitch without_hysteresis(1, 0, "without_hysteresis");
+    EXPECT_TRUE (with_hysteresis.usePull(g));
+    EXPECT_TRUE (without_hysteresis.usePull(g));
+
+    // a quarter of the vertices, shrinking but larger than numVertices / 18
+    auto quarter = new VertexSubset<NodeID>(g.num_nodes(), 0);
+    for (NodeID v = 0; v < g.num_nodes(); v += 4)
+        quarter->addVertex(v);
+    quarter->toSparse();
+    EXPECT_TRUE (with_hysteresis.usePull(g, quarter));
+    EXPECT_FALSE (without_hysteresis.usePull(g, quarter));
+    // a new traversal starting with the same frontier decides on the edges alone
+    with_hysteresis.reset();
+    EXPECT_FALSE (with_hysteresis.usePull(g, quarter));
+
+    auto single = new VertexSubset<NodeID>(g.num_nodes(), 0);
+    single->addVertex(1);
+    single->toSparse();
+    EXPECT_FALSE (with_hysteresis.usePull(g, single));
+    delete quarter;
+    delete single;
+
+    // only the odd vertices have out edges, the sample of every other frontier vertex misses
+    // them all while the default thresholds sum every degree
+    CLBase cli("");
+    Builder builder(cli);
+    pvector<EdgePair<NodeID>> el;
+    for (NodeID v = 1; v < 2048; v += 2)
+        for (NodeID j = 1; j <= 100; j++)
+            el.push_back(EdgePair<NodeID>(v, (v + j) % 2048));
+    Graph odd = builder.MakeGraphFromEL(el);
+    auto all = new VertexSubset<NodeID>(odd.num_nodes(), 0);
+    for (NodeID v = 0; v < odd.num_nodes(); v++)
+        all->addVertex(v);
+    all->toSparse();
+    DirectionSwitch exact(DirectionSwitch::kDefaultAlpha, DirectionSwitch::kDefaultBeta, "exact");
+    DirectionSwitch sampled(DirectionSwitch::kDefaultAlpha, 1, "sampled");
+    EXPECT_TRUE (exact.usePull(odd, all));
+    EXPECT_FALSE (sampled.usePull(odd, all));
+    delete all;
+}
+
+TEST_F(RuntimeLibTest, DeduplicationFlagsTest) {
+    Graph g = builtin_loadEdgesFromFile("../../test/graphs/test.el");
+    // concurrent traversals get their own flags
+    DeduplicationFlags * first = g.get_flags_atomic_();
+    DeduplicationFlags * second = g.get_flags_atomic_();
+    EXPECT_NE (first, second);
+    EXPECT_TRUE (first->claim(3));
+    EXPECT_FALSE (first->claim(3));
+    EXPECT_TRUE (second->claim(3));
+    g.return_flags_atomic_(second);
+    g.return_flags_atomic_(first);
+
+    // the next round can claim the vertex again without a reset, also once the epoch wraps around
+    DeduplicationFlags * flags = g.get_flags_atomic_();
+    EXPECT_TRUE (flags->claim(3));
+    for (int round = 0; round < 70000; round++) {
+        flags->nextEpoch();
+        EXPECT_TRUE (flags->claim(round % 5));
+        EXPECT_FALSE (flags->claim(round % 5));
+    }
+    g.return_flags_atomic_(flags);
+
+    // a copy of the graph leases from its own flags
+    Graph copy(g);
+    DeduplicationFlags * copy_flags = copy.get_flags_atomic_();
+    EXPECT_NE (flags, copy_flags);
+    EXPECT_EQ (g.num_nodes(), copy_flags->num_nodes());
+    copy.return_flags_atomic_(copy_flags);
+}
+
 TEST_F(RuntimeLibTest, VertexSubsetSimpleTest) {
     bool test_flag = true;
     auto vertexSubset = new VertexSubset<int>(5, 0);
@@ -0,0 +1,253 @@
+0 13
+0 13
+0 9
+0 0
+0 8
+0 0
+0 12
+9 9
+2 1
+0 3
+0 0
+0 8
+0 7
+13 9
+0 8
+7 12
+9 4
+0 0
+7 3
+0 2
+0 13
+8 4
+8 7
+0 10
+8 7
+0 13
+13 9
+7 12
+13 11
+8 13
+2 4
+0 9
+0 4
+0 12
+13 13
+0 13
+0 8
+3 9
+0 12
+7 4
+9 11
+0 8
+7 13
+0 9
+0 0
+0 2
+7 1
+0 7
+2 9
+10 1
+0 0
+0 1
+8 7
+0 7
+7 2
+0 0
+0 1
+0 11
+8 9
+8 12
+7 9
+0 7
+0 3
+7 13
+8 7
+7 1
+0 0
+0 0
+0 4
+0 8
+7 1
+0 0
+8 7
+7 4
+0 4
+9 4
+0 11
+0 9
+7 1
+8 9
+0 4
+0 4
+3 13
+0 9
+0 3
+0 0
+0 8
+8 13
+0 0
+0 3
+0 9
+0 11
+0 0
+7 2
+0 7
+0 4
+0 7
+0 8
+13 13
+0 13
+0 0
+0 10
+8 7
+13 9
+0 13
+0 12
+0 1
+0 10
+3 13
+0 7
+8 8
+8 3
+0 8
+0 7
+7 9
+0 8
+2 1
+0 0
+9 10
+0 12
+0 13
+0 7
+8 2
+13 13
+0 9
+8 7
+0 6
+0 8
+0 4
+7 7
+0 4
+8 7
+0 2
+7 10
+0 13
+0 13
+0 2
+8 11
+0 12
+0 4
+8 8
+0 8
+0 7
+0 0
+0 7
+3 13
+0 7
+0 13
+0 0
+8 1
+0 12
+3 2
+0 0
+12 1
+0 13
+13 13
+0 0
+13 9
+8 9
+8 13
+8 13
+0 0
+8 7
+7 13
+0 0
+8 7
+8 13
+0 0
+13 9
+0 3
+0 11
+0 7
+8 13
+0 8
+0 9
+3 9
+0 9
+0 0
+13 4
+0 7
+0 8
+0 8
+8 12
+13 4
+0 8
+3 4
+8 3
+0 0
+13 4
+0 13
+0 13
+0 7
+0 13
+9 10
+0 2
+0 7
+0 2
+7 11
+0 3
+0 9
+8 13
+0 8
+13 2
+3 12
+8 3
+0 13
+0 7
+0 7
+0 4
+8 13
+8 9
+0 13
+0 7
+7 9
+0 13
+0 2
+8 13
+0 4
+13 9
+0 7
+0 9
+0 8
+2 10
+0 12
+0 2
+13 4
+0 8
+0 13
+0 0
+9 9
+0 4
+0 13
+7 11
+9 1
+0 7
+0 1
+0 6
+0 8
+0 9
+7 13
+7 13
+8 2
+0 0
+0 8
+8 7
+8 9
+0 3
+0 9
+13 10
+0 10
+0 0
+0 3
+0 9
@@ -36,6 +36,8 @@ class TestGraphitCompiler(unittest.TestCase):
             os.chdir('./bin')
 
         cwd = os.getcwd()
+        # graph caches are written to the build directory, not test/graphs
+        os.environ["GRAPHIT_GRAPH_CACHE"] = cwd
         cls.root_test_input_dir = GRAPHIT_SOURCE_DIRECTORY + "/test/input/"
         cls.root_test_input_with_schedules_dir = GRAPHIT_SOURCE_DIRECTORY + "/test/input_with_schedules/"
         cls.compile_flags = "-std=gnu++1y"
@@ -62,6 +64,9 @@ class TestGraphitCompiler(unittest.TestCase):
         for line in proc.stdout.readlines():
             if isinstance(line, bytes):
                 line = line.decode()
+            # graphs loaded from a serialized file or the text input cache report their read time
+            if line.startswith("Read Time"):
+                continue
             output += line.rstrip() + "\n"
         proc.stdout.close()
         return output
@@ -81,7 +86,7 @@ class TestGraphitCompiler(unittest.TestCase):
 
     # compiles the program with a separate input algorithm file and input schedule file
     # allows us to unit test various different schedules with the same algorithm
-    def basic_compile_test_with_separate_algo_schedule_files(self, input_algo_file, input_schedule_file):
+    def basic_compile_test_with_separate_algo_schedule_files(self, input_algo_file, input_schedule_file, extra_cpp_args=""):
         input_algos_path = GRAPHIT_SOURCE_DIRECTORY + '/test/input/'
         input_schedules_path = GRAPHIT_SOURCE_DIRECTORY + '/test/input_with_schedules/'
         print ("current directory: " + os.getcwd())
@@ -90,10 +95,10 @@ class TestGraphitCompiler(unittest.TestCase):
         compile_cmd = "python graphitc.py -a " + algo_file + " -f " + schedule_file + " -o test.cpp"
         print (compile_cmd)
         subprocess.check_call(compile_cmd, shell=True)
-        cpp_compile_cmd = self.cpp_compiler + " -g -std=gnu++1y -I " + self.include_path + " " + self.numa_flags + " test.cpp -o test.o"
+        cpp_compile_cmd = self.cpp_compiler + " -g -std=gnu++1y -I " + self.include_path + " " + self.numa_flags + " " + extra_cpp_args + " test.cpp -o test.o"
         if use_parallel:
             print ("using icpc for parallel compilation")
-            cpp_compile_cmd = "icpc -g -std=gnu++1y -I " + self.include_path + " " + self.parallel_framework + " " + self.numa_flags + " test.cpp -o test.o"
+            cpp_compile_cmd = "icpc -g -std=gnu++1y -I " + self.include_path + " " + self.parallel_framework + " " + self.numa_flags + " " + extra_cpp_args + " test.cpp -o test.o"
         print (cpp_compile_cmd)
         subprocess.check_call(cpp_compile_cmd, shell=True)
 
@@ -249,9 +254,9 @@ class TestGraphitCompiler(unittest.TestCase):
         else:
             print("not supporting default schedules with AStar yet")
 
-    def bfs_verified_test(self, input_file_name, use_separate_algo_file=False):
+    def bfs_verified_test(self, input_file_name, use_separate_algo_file=False, extra_cpp_args=""):
         if use_separate_algo_file:
-            self.basic_compile_test_with_separate_algo_schedule_files("bfs_with_filename_arg.gt", input_file_name)
+            self.basic_compile_test_with_separate_algo_schedule_files("bfs_with_filename_arg.gt", input_file_name, extra_cpp_args)
         else:
             self.basic_compile_test(input_file_name)
         os.chdir("..")
@@ -271,6 +276,25 @@ class TestGraphitCompiler(unittest.TestCase):
         self.assertEqual(test_flag, True)
         os.chdir("bin")
 
+    def bfs_dynamic_verified_test(self, input_file_name):
+        self.basic_compile_test_with_separate_algo_schedule_files("bfs_dynamic.gt", input_file_name)
+        os.chdir("..")
+        # the program loads the graph without some edges and inserts the whole graph
+        cmd = "OMP_PLACES=sockets ./bin/test.o " + GRAPHIT_SOURCE_DIRECTORY + "/test/graphs/4_partial.el " + GRAPHIT_SOURCE_DIRECTORY + "/test/graphs/4.el > verifier_input"
+        print (cmd)
+        subprocess.call(cmd, shell=True)
+
+        verify_cmd = "./bin/bfs_verifier -f " + GRAPHIT_SOURCE_DIRECTORY + "/test/graphs/4.el -t verifier_input -r 8"
+        print (verify_cmd)
+        output = self.get_command_output(verify_cmd)
+        test_flag = False
+        for line in output.rstrip().split("\n"):
+            if line.rstrip().find("SUCCESSFUL") != -1:
+                test_flag = True
+                break;
+        self.assertEqual(test_flag, True)
+        os.chdir("bin")
+
     def cc_verified_test(self, input_file_name, use_separate_algo_file=False):
         if use_separate_algo_file:
             self.basic_compile_test_with_separate_algo_schedule_files("cc.gt", input_file_name)
@@ -342,12 +366,16 @@ class TestGraphitCompiler(unittest.TestCase):
     def sssp_verified_test(self, input_file_name,
                            use_separate_algo_file=True,
                            use_delta_stepping=False,
-                           use_delta_from_argv=False):
+                           use_delta_from_argv=False,
+                           use_float_weights=False,
+                           extra_cpp_args=""):
         if use_separate_algo_file:
             # just use the regular Bellman-Ford based source file
             if not use_delta_stepping:
-                self.basic_compile_test_with_separate_algo_schedule_files("sssp.gt", input_file_name)
+                self.basic_compile_test_with_separate_algo_schedule_files("sssp.gt", input_file_name, extra_cpp_args)
             # use delta stepping source file
+            elif use_float_weights:
+                self.basic_compile_test_with_separate_algo_schedule_files("delta_stepping_float.gt", input_file_name)
             else:
                 self.basic_compile_test_with_separate_algo_schedule_files("delta_stepping.gt", input_file_name)
         else:
@@ -595,12 +623,28 @@ class TestGraphitCompiler(unittest.TestCase):
     def test_bfs_hybrid_dense_parallel_cas_verified(self):
         self.bfs_verified_test("bfs_hybrid_dense_parallel_cas.gt", True)
 
+    def test_bfs_hybrid_dense_parallel_cas_thresholds_verified(self):
+        self.bfs_verified_test("bfs_hybrid_dense_parallel_cas_thresholds.gt", True)
+
+    def test_bfs_hybrid_dense_parallel_cas_compressed_verified(self):
+        self.bfs_verified_test("bfs_hybrid_dense_parallel_cas_compressed.gt", True)
+
+    def test_bfs_hybrid_dense_parallel_cas_replicated_verified(self):
+        self.bfs_verified_test("bfs_hybrid_dense_parallel_cas_replicated.gt", True)
+
+    def test_bfs_hybrid_dense_parallel_cas_streamed_verified(self):
+        self.bfs_verified_test("bfs_hybrid_dense_parallel_cas_streamed.gt", True)
+
     def test_bfs_hybrid_dense_parallel_cas_segment_verified(self):
         self.bfs_verified_test("bfs_hybrid_dense_parallel_cas_segment.gt", True)
 
     def test_bfs_push_parallel_cas_verified(self):
         self.bfs_verified_test("bfs_push_parallel_cas.gt", True)
 
+    # 64-bit vertex IDs (and 64-bit edge arrays in the Ligra/Julienne parts)
+    def test_bfs_push_parallel_cas_edgelong_verified(self):
+        self.bfs_verified_test("bfs_push_parallel_cas.gt", True, "-DEDGELONG")
+
     def test_bfs_pull_parallel_verified(self):
         self.bfs_verified_test("bfs_pull_parallel.gt", True)
 
@@ -642,12 +686,27 @@ class TestGraphitCompiler(unittest.TestCase):
     def test_sssp_push_parallel_cas_verified(self):
         self.sssp_verified_test("sssp_push_parallel_cas.gt", True)
 
+    def test_sssp_hybrid_dense_parallel_cas_edgelong_verified(self):
+        self.sssp_verified_test("sssp_hybrid_dense_parallel_cas.gt", True, extra_cpp_args="-DEDGELONG")
+
+    def test_sssp_hybrid_dense_parallel_cas_radix_builder_verified(self):
+        self.sssp_verified_test("sssp_hybrid_dense_parallel_cas.gt", True, extra_cpp_args="-DRADIX_BUILDER")
+
+    def test_sssp_push_parallel_cas_compressed_verified(self):
+        self.sssp_verified_test("sssp_push_parallel_cas_compressed.gt", True)
+
+    def test_sssp_push_parallel_cas_streamed_verified(self):
+        self.sssp_verified_test("sssp_push_parallel_cas_streamed.gt", True)
+
     def test_sssp_hybrid_denseforward_parallel_cas_verified(self):
         self.sssp_verified_test("sssp_hybrid_denseforward_parallel_cas.gt", True)
 
     def test_sssp_hybrid_dense_parallel_cas_verified(self):
         self.sssp_verified_test("sssp_hybrid_dense_parallel_cas.gt", True)
 
+    def test_sssp_hybrid_dense_parallel_cas_soa_verified(self):
+        self.sssp_verified_test("sssp_hybrid_dense_parallel_cas_soa.gt", True)
+
     def test_sssp_pull_parallel_verified(self):
         self.sssp_verified_test("sssp_pull_parallel.gt", True)
 
@@ -657,6 +716,31 @@ class TestGraphitCompiler(unittest.TestCase):
     def test_pagerank_parallel_pull_expect(self):
         self.pr_verified_test("pagerank_pull_parallel.gt", True)
 
+    def test_pagerank_parallel_pull_compressed_expect(self):
+        self.pr_verified_test("pagerank_pull_parallel_compressed.gt", True)
+
+    def test_pagerank_parallel_pull_streamed_expect(self):
+        self.pr_verified_test("pagerank_pull_parallel_streamed.gt", True)
+
+    def test_pagerank_parallel_pull_hub_sort_expect(self):
+        self.pr_verified_test("pagerank_pull_parallel_hub_sort.gt", True)
+
+    def test_pagerank_parallel_pull_huge_pages_expect(self):
+        self.pr_verified_test("pagerank_pull_parallel_huge_pages.gt", True)
+
+    def test_pagerank_parallel_pull_numa_placement_expect(self):
+        self.pr_verified_test("pagerank_pull_parallel_numa_placement.gt", True)
+
+    def test_pagerank_parallel_pull_numa_placement_unpinned_expect(self):
+        # only OpenMP threads are pinned, -DCILK (use_parallel) and serial builds keep every CPU
+        self.basic_compile_test_with_separate_algo_schedule_files("pagerank_with_filename_arg.gt", "pagerank_pull_parallel_numa_placement.gt")
+        proc = subprocess.Popen(["./" + self.executable_file_name, GRAPHIT_SOURCE_DIRECTORY + "/test/graphs/test.el"],
+                                stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        output, errors = proc.communicate()
+        self.assertEqual(proc.returncode, 0)
+        self.assertIn("NUMA placement sockets needs OpenMP threads", errors.decode())
+        self.assertIn("NUMA placement: off", output.decode())
+
     def test_pagerank_parallel_hybrid_dense_expect(self):
         self.pr_verified_test("pagerank_hybrid_dense.gt", True)
 
@@ -799,6 +883,12 @@ class TestGraphitCompiler(unittest.TestCase):
     def test_delta_stepping_SparsePushDensePull_schedule(self):
         self.sssp_verified_test("SparsePushDensePull_VertexParallel.gt", True, True)
 
+    def test_bfs_hybrid_dense_parallel_cas_dynamic_edges_verified(self):
+        self.bfs_dynamic_verified_test("bfs_hybrid_dense_parallel_cas.gt")
+
+    def test_delta_stepping_SparsePush_degree_reorder_schedule(self):
+        self.sssp_verified_test("SparsePush_VertexParallel_degree_reorder.gt", True, True)
+
     def test_delta_stepping_SparsePush_delta2_schedule(self):
         self.sssp_verified_test("SparsePush_VertexParallel_Delta2.gt", True, True)
 
@@ -811,6 +901,12 @@ class TestGraphitCompiler(unittest.TestCase):
     def test_delta_stepping_eager_with_merge(self):
         self.sssp_verified_test("priority_update_eager_with_merge.gt", True, True);
 
+    def test_delta_stepping_float_weights_eager_no_merge(self):
+        self.sssp_verified_test("priority_update_eager_no_merge.gt", True, True, use_float_weights=True);
+
+    def test_delta_stepping_float_weights_SparsePush_delta2_schedule(self):
+        self.sssp_verified_test("SparsePush_VertexParallel_Delta2.gt", True, True, use_float_weights=True)
+
     def test_ppsp_delta_stepping_eager_no_merge(self):
         self.ppsp_verified_test("priority_update_eager_no_merge.gt", True);
 
@@ -5,10 +5,22 @@
 #ifndef GRAPHIT_VERIFIER_UTILS_H
 #define GRAPHIT_VERIFIER_UTILS_H
 
+// Programs print the read time of graphs loaded from a serialized file (or
+// the text input cache) before their output, it isn't part of the output
+inline void skipReadTime(std::ifstream &file) {
+    std::streampos line_start = file.tellg();
+    std::string line;
+    while (std::getline(file, line) && line.compare(0, 9, "Read Time") == 0)
+        line_start = file.tellg();
+    file.clear();
+    file.seekg(line_start);
+}
+
 template <typename T>
 pvector<T>* readFileIntoVector(std::string file_name){
 
     std::ifstream file(file_name);
+    skipReadTime(file);
     pvector<T>* output = new pvector<T>();
     T u;
     while (file >> u) {
@@ -20,6 +32,7 @@ pvector<T>* readFileIntoVector(std::string file_name){
 template <typename T>
 T readFileIntoSize(std::string file_name) {
     std::ifstream file(file_name);
+    skipReadTime(file);
     T output;
     file >> output;
     return output;